@@ -0,0 +1,38 @@
+#pragma once
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+// payload 扫描范围：16B 到 1MB，每档 ×4
+constexpr int64_t kMinPayload = 16;
+constexpr int64_t kMaxPayload = 1 << 20;
+
+inline void payloadSweep(benchmark::internal::Benchmark* b) {
+    b->RangeMultiplier(4)->Range(kMinPayload, kMaxPayload);
+}
+
+// 确定性的伪随机字节，避免全零数据让校验和等内核走捷径
+inline std::vector<uint8_t> makeBytes(size_t size) {
+    std::vector<uint8_t> bytes(size);
+    uint32_t x = 2463534242u;
+    for (auto& b : bytes) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        b = static_cast<uint8_t>(x);
+    }
+    return bytes;
+}
+
+inline std::string makePayload(size_t size) {
+    std::vector<uint8_t> bytes = makeBytes(size);
+    return std::string(bytes.begin(), bytes.end());
+}
+
+}  // namespace bench
@@ -0,0 +1,36 @@
+#include <benchmark/benchmark.h>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "utils/Logger.hpp"
+
+/*
+与 BENCHMARK_MAIN() 相同，只是默认额外把结果以 JSON 写到 bench_results.json，
+便于保存基线并与改动后的结果对比（例如 benchmark 自带的 compare.py）；
+命令行给出 --benchmark_out 时以命令行为准
+*/
+int main(int argc, char** argv) {
+    std::vector<char*> args(argv, argv + argc);
+    bool has_out = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strncmp(argv[i], "--benchmark_out=", 16) == 0) has_out = true;
+    }
+    std::string out = "--benchmark_out=bench_results.json";
+    std::string format = "--benchmark_out_format=json";
+    if (!has_out) {
+        args.push_back(out.data());
+        args.push_back(format.data());
+    }
+    int count = static_cast<int>(args.size());
+
+    // 建立/关闭连接会打 INFO 日志，压测时只保留告警
+    utils::Logger::setLogLevel(utils::LogLevel::WARNING);
+
+    benchmark::Initialize(&count, args.data());
+    if (benchmark::ReportUnrecognizedArguments(count, args.data())) return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
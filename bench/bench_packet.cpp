@@ -0,0 +1,153 @@
+// 帧编解码与校验内核
+#include <span>
+
+#include "BenchCommon.hpp"
+#include "net/Checksum.hpp"
+#include "net/Packet.hpp"
+#include "net/packet/PacketA.hpp"
+#include "net/packet/PacketB.hpp"
+#include "net/packet/PacketFactory.hpp"
+#include "net/packet/PacketSecure.hpp"
+
+namespace {
+
+void BM_PacketSerialize(benchmark::State& state) {
+    uint16_t header =
+        state.range(1) ? Packet::kCrc32cHeader : Packet::kSum16Header;
+    Packet packet = Packet::make(bench::makePayload(state.range(0)), header);
+    for (auto _ : state) {
+        std::vector<uint8_t> frame = packet.serialize();
+        benchmark::DoNotOptimize(frame.data());
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+void BM_PacketDeserialize(benchmark::State& state) {
+    uint16_t header =
+        state.range(1) ? Packet::kCrc32cHeader : Packet::kSum16Header;
+    std::vector<uint8_t> frame =
+        Packet::make(bench::makePayload(state.range(0)), header).serialize();
+    for (auto _ : state) {
+        Packet packet = Packet::deserialize(frame);
+        benchmark::DoNotOptimize(packet.payload.data());
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+// 第二个参数选择帧格式：0 为 0xABCD（sum16），1 为 0xABCE（CRC32C）
+void packetArgs(benchmark::internal::Benchmark* b) {
+    b->ArgNames({"size", "crc"});
+    b->ArgsProduct({benchmark::CreateRange(bench::kMinPayload,
+                                           bench::kMaxPayload, 4),
+                    {0, 1}});
+}
+
+template <typename T>
+void BM_Encode(benchmark::State& state) {
+    T packet(bench::makeBytes(state.range(0)));
+    for (auto _ : state) {
+        std::vector<uint8_t> raw = packet.serialize();
+        benchmark::DoNotOptimize(raw.data());
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+template <typename T>
+void BM_Decode(benchmark::State& state) {
+    std::vector<uint8_t> raw = T(bench::makeBytes(state.range(0))).serialize();
+    for (auto _ : state) {
+        auto packet = T::deserialize(raw);
+        if (!packet) {
+            state.SkipWithError("deserialize failed");
+            break;
+        }
+        benchmark::DoNotOptimize(packet.get());
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+void BM_CalculateChecksum(benchmark::State& state) {
+    std::vector<uint8_t> data = bench::makeBytes(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(
+            calculate_checksum(std::span<const uint8_t>(data)));
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+    state.SetLabel(checksum::sum16Kernel());
+}
+
+void BM_Crc32c(benchmark::State& state) {
+    std::vector<uint8_t> data = bench::makeBytes(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(checksum::crc32c(data));
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+    state.SetLabel(checksum::crc32cKernel());
+}
+
+// 三种内置类型的帧轮流解码，分支预测不能只记住一种类型
+std::vector<std::vector<uint8_t>> mixedFrames(size_t size) {
+    return {PacketA(bench::makeBytes(size)).serialize(),
+            PacketB(bench::makeBytes(size)).serialize(),
+            PacketSecure(bench::makePayload(size)).serialize()};
+}
+
+// 静态分发：解码到调用方的 variant，payload 为视图
+void BM_FactoryDecodeStatic(benchmark::State& state) {
+    std::vector<std::vector<uint8_t>> frames = mixedFrames(state.range(0));
+    PacketFactory::Decoded decoded;
+    size_t i = 0;
+    for (auto _ : state) {
+        if (!PacketFactory::decode(frames[i], decoded)) {
+            state.SkipWithError("decode failed");
+            break;
+        }
+        size_t payload_size = std::visit(
+            [](const auto& view) -> size_t {
+                if constexpr (requires { view.payload; }) {
+                    return view.payload.size();
+                } else {
+                    return 0;
+                }
+            },
+            decoded);
+        benchmark::DoNotOptimize(payload_size);
+        i = i + 1 == frames.size() ? 0 : i + 1;
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+// 运行期注册：std::function + 拷贝 payload + shared_ptr
+void BM_FactoryDeserializeRegistry(benchmark::State& state) {
+    std::vector<std::vector<uint8_t>> frames = mixedFrames(state.range(0));
+    PacketFactory factory;
+    factory.registerType(PacketA::TYPE_ID, PacketA::deserialize);
+    factory.registerType(PacketB::TYPE_ID, PacketB::deserialize);
+    factory.registerType(PacketSecure::TYPE_ID, PacketSecure::deserialize);
+    size_t i = 0;
+    for (auto _ : state) {
+        std::shared_ptr<BasePacket> packet = factory.tryDeserialize(frames[i]);
+        if (!packet) {
+            state.SkipWithError("deserialize failed");
+            break;
+        }
+        benchmark::DoNotOptimize(packet->getTypeID());
+        i = i + 1 == frames.size() ? 0 : i + 1;
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+}  // namespace
+
+BENCHMARK(BM_PacketSerialize)->Apply(packetArgs);
+BENCHMARK(BM_PacketDeserialize)->Apply(packetArgs);
+BENCHMARK(BM_Encode<PacketA>)->Apply(bench::payloadSweep);
+BENCHMARK(BM_Decode<PacketA>)->Apply(bench::payloadSweep);
+BENCHMARK(BM_Encode<PacketB>)->Apply(bench::payloadSweep);
+BENCHMARK(BM_Decode<PacketB>)->Apply(bench::payloadSweep);
+BENCHMARK(BM_CalculateChecksum)->Apply(bench::payloadSweep);
+BENCHMARK(BM_Crc32c)->Apply(bench::payloadSweep);
+BENCHMARK(BM_FactoryDecodeStatic)->Apply(bench::payloadSweep);
+BENCHMARK(BM_FactoryDeserializeRegistry)->Apply(bench::payloadSweep);
@@ -0,0 +1,152 @@
+// TcpProtocol 接收路径：经 socketpair 走真实的 recv + 帧解析
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <memory>
+#include <span>
+
+#include "BenchCommon.hpp"
+#include "net/Packet.hpp"
+#include "net/protocol/TcpProtocol.hpp"
+
+namespace {
+
+// 流水线模式下一轮写入的目标字节数（至少 4 帧）
+constexpr size_t kPipelineBytes = 256 * 1024;
+// 分片模式下帧头之后的数据再切成的片数
+constexpr size_t kFragments = 4;
+
+/*
+一对非阻塞 Unix 流 socket：一端写入原始字节，另一端由 TcpProtocol 读取解析。
+写端缓冲区满时先让接收端读一轮，单线程即可推进任意大小的数据
+*/
+class ProtocolPair {
+   public:
+    ProtocolPair() {
+        if (::socketpair(AF_UNIX, SOCK_STREAM, 0, fds_) == 0) {
+            for (int fd : fds_) {
+                ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+                int size = 4 * 1024 * 1024;
+                ::setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &size, sizeof(size));
+                ::setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+            }
+            proto_ = std::make_unique<TcpProtocol>(fds_[1]);
+        }
+    }
+    ~ProtocolPair() {
+        proto_.reset();
+        for (int fd : fds_) {
+            if (fd >= 0) ::close(fd);
+        }
+    }
+
+    bool ok() const { return proto_ != nullptr; }
+
+    // 写入 data，期间把收到的完整帧计入 frames；出错返回 false
+    bool write(std::span<const uint8_t> data, size_t& frames) {
+        while (!data.empty()) {
+            ssize_t n = ::send(fds_[0], data.data(), data.size(), MSG_NOSIGNAL);
+            if (n > 0) {
+                data = data.subspan(static_cast<size_t>(n));
+            } else if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+                return false;
+            }
+            if (!drain(frames)) return false;
+        }
+        return true;
+    }
+
+    // 解析已到达的数据直到 NeedRetry
+    bool drain(size_t& frames) {
+        PacketView view;
+        for (;;) {
+            BaseProtocol::ReadStatus status = proto_->tryReceiveView(view);
+            if (status == BaseProtocol::ReadStatus::NeedRetry) return true;
+            if (status == BaseProtocol::ReadStatus::Error) return false;
+            benchmark::DoNotOptimize(view.payload.data());
+            ++frames;
+        }
+    }
+
+   private:
+    int fds_[2] = {-1, -1};
+    std::unique_ptr<TcpProtocol> proto_;
+};
+
+// 粘包：一次写入多帧，接收端一次 recv 解析出多帧
+void BM_TcpParsePipelined(benchmark::State& state) {
+    std::vector<uint8_t> frame =
+        Packet::make(bench::makePayload(state.range(0))).serialize();
+    size_t count = std::max<size_t>(4, kPipelineBytes / frame.size());
+    std::vector<uint8_t> batch;
+    batch.reserve(frame.size() * count);
+    for (size_t i = 0; i < count; ++i) {
+        batch.insert(batch.end(), frame.begin(), frame.end());
+    }
+
+    ProtocolPair pair;
+    if (!pair.ok()) {
+        state.SkipWithError("socketpair failed");
+        return;
+    }
+    for (auto _ : state) {
+        size_t frames = 0;
+        if (!pair.write(batch, frames)) {
+            state.SkipWithError("socket error");
+            break;
+        }
+        while (frames < count) {
+            if (!pair.drain(frames)) {
+                state.SkipWithError("socket error");
+                break;
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+    state.SetBytesProcessed(state.iterations() * batch.size());
+}
+
+// 拆包：帧头被切开，剩余部分分几次到达，每次到达都尝试解析一次
+void BM_TcpParseFragmented(benchmark::State& state) {
+    std::vector<uint8_t> frame =
+        Packet::make(bench::makePayload(state.range(0))).serialize();
+    std::vector<std::span<const uint8_t>> pieces;
+    std::span<const uint8_t> rest(frame);
+    pieces.push_back(rest.first(3));
+    rest = rest.subspan(3);
+    size_t piece_size = (rest.size() + kFragments - 1) / kFragments;
+    while (!rest.empty()) {
+        size_t n = std::min(piece_size, rest.size());
+        pieces.push_back(rest.first(n));
+        rest = rest.subspan(n);
+    }
+
+    ProtocolPair pair;
+    if (!pair.ok()) {
+        state.SkipWithError("socketpair failed");
+        return;
+    }
+    for (auto _ : state) {
+        size_t frames = 0;
+        for (std::span<const uint8_t> piece : pieces) {
+            if (!pair.write(piece, frames) || !pair.drain(frames)) {
+                state.SkipWithError("socket error");
+                break;
+            }
+        }
+        if (frames != 1) {
+            state.SkipWithError("frame not parsed");
+            break;
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * frame.size());
+}
+
+}  // namespace
+
+BENCHMARK(BM_TcpParsePipelined)->Apply(bench::payloadSweep);
+BENCHMARK(BM_TcpParseFragmented)->Apply(bench::payloadSweep);
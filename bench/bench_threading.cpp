@@ -0,0 +1,123 @@
+// 线程池提交、连接表查找与 Metrics 记录：多线程并发调用下的开销
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "BenchCommon.hpp"
+#include "net/connection/ConnectionManager.hpp"
+#include "threading/EpochReclaimer.hpp"
+#include "threading/ThreadPool.hpp"
+#include "utils/Metrics.hpp"
+
+namespace {
+
+// ---- ThreadPool::enqueue ----
+
+constexpr size_t kPoolThreads = 4;
+// 有界队列 + CallerRuns：提交快于执行时由提交线程自己执行，内存不随迭代数增长
+constexpr size_t kPoolMaxPending = 64 * 1024;
+
+std::unique_ptr<ThreadPool> g_pool;
+std::atomic<uint64_t> g_executed{0};
+
+// 多个提交线程同时往同一个线程池投递空任务
+void BM_ThreadPoolEnqueue(benchmark::State& state) {
+    if (state.thread_index() == 0) {
+        g_executed.store(0, std::memory_order_relaxed);
+        g_pool = std::make_unique<ThreadPool>(kPoolThreads, kPoolMaxPending,
+                                              TaskOverflowPolicy::CallerRuns);
+    }
+    for (auto _ : state) {
+        g_pool->enqueue(
+            [] { g_executed.fetch_add(1, std::memory_order_relaxed); });
+    }
+    state.SetItemsProcessed(state.iterations());
+    if (state.thread_index() == 0) {
+        // 循环结束时所有提交线程都已停止提交；析构会等任务全部执行完
+        uint64_t caller_runs = g_pool->callerRunsTasks();
+        g_pool.reset();
+        state.counters["caller_runs"] = static_cast<double>(caller_runs);
+    }
+}
+
+// ---- ConnectionManager 查找 ----
+
+// 连接表里放 range(0) 个连接（fd 由 eventfd 占位），按伪随机顺序查找
+class ConnectionTable {
+   public:
+    explicit ConnectionTable(size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            int fd = ::eventfd(0, EFD_NONBLOCK);
+            if (fd < 0) break;
+            generations_.resize(static_cast<size_t>(fd) + 1, 0);
+            generations_[fd] =
+                manager_.addConnection(fd, std::make_unique<Connection>(fd, -1));
+            fds_.push_back(fd);
+        }
+    }
+
+    ConnectionManager& manager() { return manager_; }
+    const std::vector<int>& fds() const { return fds_; }
+    uint32_t generation(int fd) const { return generations_[fd]; }
+
+   private:
+    // 析构时 ConnectionManager 关闭全部 fd
+    ConnectionManager manager_;
+    std::vector<int> fds_;
+    std::vector<uint32_t> generations_;
+};
+
+std::unique_ptr<ConnectionTable> g_table;
+
+void BM_ConnectionLookup(benchmark::State& state) {
+    if (state.thread_index() == 0) {
+        g_table = std::make_unique<ConnectionTable>(state.range(0));
+    }
+    {
+        // 与 Reactor/工作线程一样，查找在 EpochGuard 作用域内进行
+        EpochGuard guard;
+        uint32_t x = 0x9E3779B9u + static_cast<uint32_t>(state.thread_index());
+        for (auto _ : state) {
+            const std::vector<int>& fds = g_table->fds();
+            x ^= x << 13;
+            x ^= x >> 17;
+            x ^= x << 5;
+            int fd = fds[x % fds.size()];
+            benchmark::DoNotOptimize(
+                g_table->manager().getConnection(fd, g_table->generation(fd)));
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+    if (state.thread_index() == 0) {
+        g_table.reset();
+    }
+}
+
+// ---- Metrics ----
+
+// 每个请求在读路径上记录的计数与延迟
+void BM_MetricsRecord(benchmark::State& state) {
+    Metrics& metrics = Metrics::getInstance();
+    uint64_t latency_ns = 1000;
+    for (auto _ : state) {
+        metrics.incrementRequests();
+        metrics.incrementBytesReceived(64);
+        metrics.recordLatency(Metrics::LatencyStage::Read, latency_ns);
+        latency_ns = latency_ns * 7 % 1000003;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+}  // namespace
+
+BENCHMARK(BM_ThreadPoolEnqueue)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(BM_ConnectionLookup)
+    ->RangeMultiplier(8)
+    ->Range(64, 4096)
+    ->ThreadRange(1, 4)
+    ->UseRealTime();
+BENCHMARK(BM_MetricsRecord)->ThreadRange(1, 8)->UseRealTime();
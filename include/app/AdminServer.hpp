@@ -0,0 +1,58 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "app/ServerConfig.hpp"
+
+/*
+管理端口：在独立线程上提供 GET /metrics（Prometheus 文本格式 0.0.4）
+- 与数据面完全隔离：自己的监听 socket 和线程，不经过任何 Reactor / 工作线程，
+  抓取只读取 Metrics 的分片汇总，不会给客户端流量引入抖动
+- 每个请求短连接处理：读请求头、写完整响应后关闭，设置收发超时防止慢客户端卡住
+- 除 Metrics 中的计数器和延迟直方图外，可在 start() 前通过 addGauge / addCounter
+  登记额外的实时量
+*/
+class AdminServer {
+   public:
+    using GaugeFn = std::function<double()>;
+
+    explicit AdminServer(const ServerConfig& config);
+    ~AdminServer();
+
+    AdminServer(const AdminServer&) = delete;
+    AdminServer& operator=(const AdminServer&) = delete;
+
+    // 需在 start() 之前调用；name 为完整的 Prometheus 指标名
+    void addGauge(std::string name, std::string help, GaugeFn fn);
+    // 同上，fn 返回单调递增的累计值
+    void addCounter(std::string name, std::string help, GaugeFn fn);
+
+    bool start();
+    // 唤醒并等待管理线程退出（可重复调用）
+    void stop();
+
+    // 生成完整的 /metrics 响应体
+    std::string renderMetrics() const;
+
+   private:
+    struct Gauge {
+        std::string name;
+        std::string help;
+        const char* type;  // "gauge" 或 "counter"
+        GaugeFn fn;
+    };
+
+    void run();
+    void handleClient(int client_fd);
+
+    ServerConfig config_;
+    int listen_fd_ = -1;
+    int wake_fd_ = -1;  // eventfd：stop() 写入后管理线程退出 poll
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+    std::vector<Gauge> gauges_;
+};
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+
+#include "app/ServerConfig.hpp"
+#include "net/connection/Connection.hpp"
+#include "utils/TimerWheel.hpp"
+
+/*
+Reactor 持有的连接超时调度（只在 Reactor 线程内使用）：
+- 每个 fd 一个时间轮节点，按 fd 索引；deque 只在尾部扩展，节点地址不变
+- 惰性重排：读写路径只更新 Connection 内的时间戳，不碰时间轮；
+  节点到期时由 Connection::checkTimeouts 按最新时间戳判断，未超时就挂到新的最早期限。
+  活跃连接的每个请求不需要任何时间轮操作，每个超时周期最多被检查一次
+- 节点记录 (fd, generation)，fd 已关闭或被新连接复用时，过期节点在到期时识别并丢弃
+*/
+class ConnectionTimers {
+   public:
+    explicit ConnectionTimers(const ServerConfig& config);
+
+    ConnectionTimers(const ConnectionTimers&) = delete;
+    ConnectionTimers& operator=(const ConnectionTimers&) = delete;
+
+    bool enabled() const { return timeouts_.enabled(); }
+
+    // 新连接：按配置安排首次检查（同一 fd 的旧节点直接复用）
+    void add(int fd, uint32_t generation);
+    // 连接在本线程关闭时取消；不调用也安全，只是到期时多一次查表
+    void remove(int fd);
+
+    // 作为 epoll_wait / io_uring 等待的超时，-1 表示没有定时器
+    int timeoutMs() const { return wheel_.timeoutMs(TimerWheel::nowMs()); }
+
+    /*
+    触发到期的检查：
+    - lookup(fd, generation) 返回 Connection*，连接已不存在时返回 nullptr
+    - on_timeout(fd, conn, check) 执行关闭或发送 ping，返回 false 表示连接已关闭
+    */
+    template <typename Lookup, typename OnTimeout>
+    void expire(Lookup&& lookup, OnTimeout&& on_timeout) {
+        if (wheel_.size() == 0) return;
+        int64_t now = TimerWheel::nowMs();
+        wheel_.advance(now, [&](TimerWheel::Timer& timer) {
+            int fd = static_cast<int>(timer.data & 0xFFFFFFFFu);
+            uint32_t generation = static_cast<uint32_t>(timer.data >> 32);
+            Connection* conn = lookup(fd, generation);
+            if (!conn) return;
+            Connection::TimeoutCheck check = conn->checkTimeouts(timeouts_, now);
+            if (check.action != Connection::TimeoutAction::None &&
+                !on_timeout(fd, *conn, check)) {
+                return;
+            }
+            if (check.action != Connection::TimeoutAction::Close &&
+                check.next_check_ms > 0) {
+                wheel_.schedule(timer, check.next_check_ms);
+            }
+        });
+    }
+
+   private:
+    ConnectionTimeouts timeouts_;
+    TimerWheel wheel_;
+    std::deque<TimerWheel::Timer> timers_;
+};
@@ -0,0 +1,56 @@
+// EventLoop.hpp
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "app/ConnectionTimers.hpp"
+#include "app/IoBackend.hpp"
+#include "app/ServerConfig.hpp"
+#include "app/UdpEndpoint.hpp"
+#include "net/connection/ConnectionManager.hpp"
+
+/*
+多 Reactor 模式下的单个事件循环：
+- 独占一个 epoll 实例和一个 SO_REUSEPORT 监听 socket，内核负责把新连接分流到各个 Reactor
+- 接受的连接只在本 Reactor 线程内处理（握手、读、解析、写），不跨线程投递任务
+- 通过 eventfd 唤醒，stop() 可在任意线程（包括信号处理函数）中调用
+- 连接超时与心跳由本 Reactor 的时间轮驱动，epoll_wait 的超时取自最近的到期时刻
+- 开启 UDP 时另有一个 SO_REUSEPORT UDP 端点，与 TCP 连接在同一线程内处理
+*/
+class EventLoop : public IoBackend {
+   public:
+    EventLoop(int index, const ServerConfig& config);
+    ~EventLoop() override;
+
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    bool setup() override;  // 创建监听 socket、epoll、唤醒 eventfd 和 UDP 端点
+    void run() override;    // 事件循环，阻塞直到 stop()
+    void stop() override;   // 线程安全：置位并唤醒 epoll_wait
+    const char* name() const override { return "epoll"; }
+
+    int index() const { return index_; }
+
+   private:
+    const int index_;
+    const ServerConfig& config_;
+    int listen_fd_;
+    int epoll_fd_;
+    int wakeup_fd_;
+    std::atomic<bool> running_;
+    // 每个 Reactor 独立管理自己的连接，互不共享
+    ConnectionManager conn_manager_;
+    ConnectionTimers timers_;
+    std::unique_ptr<UdpEndpoint> udp_;  // 未开启 UDP 时为空
+    bool udp_write_armed_ = false;      // UDP socket 当前等待 EPOLLOUT（而非 EPOLLIN）
+
+    void handleNewConnection();
+    void handleClientEvent(int fd, uint32_t events);
+    void handleUdpEvent(uint32_t events);
+    void handleTimeouts();
+    void cleanupConnection(int fd);
+    void cleanupAllConnections();
+};
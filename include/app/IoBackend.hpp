@@ -0,0 +1,31 @@
+// IoBackend.hpp
+#pragma once
+
+#include <memory>
+
+#include "app/ServerConfig.hpp"
+
+/*
+Reactor 线程的 I/O 后端接口：
+- EventLoop：epoll 就绪通知 + 非阻塞 recv/sendmsg（默认，也是回退方案）
+- UringLoop：io_uring 完成通知，multishot accept/recv + 批量提交 send
+每个后端实例独占一个线程，stop() 可在任意线程（包括信号处理函数）中调用
+*/
+class IoBackend {
+   public:
+    virtual ~IoBackend() = default;
+
+    virtual bool setup() = 0;  // 创建监听 socket 与事件源
+    virtual void run() = 0;    // 事件循环，阻塞直到 stop()
+    virtual void stop() = 0;   // 线程安全：置位并唤醒事件循环
+    virtual const char* name() const = 0;  // 实际使用的后端，用于日志
+
+    // 按 config.io_backend 创建后端并完成 setup()；io_uring 不可用或初始化失败时
+    // 回退到 epoll，epoll 也初始化失败返回 nullptr
+    static std::unique_ptr<IoBackend> create(int index,
+                                             const ServerConfig& config);
+
+   protected:
+    // 把当前线程绑定到第 index % CPU 数 个核心
+    static void bindToCpu(int index);
+};
@@ -3,8 +3,15 @@
 #define SERVER_H
 
 #include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
 
+#include "app/AdminServer.hpp"
+#include "app/ConnectionTimers.hpp"
+#include "app/IoBackend.hpp"
 #include "app/ServerConfig.hpp"
+#include "app/UdpEndpoint.hpp"
 #include "net/connection/ConnectionManager.hpp"
 #include "threading/ThreadPool.hpp"
 
@@ -33,14 +40,38 @@ class Server {
     ConnectionManager conn_manager;
     // 线程池
     ThreadPool thread_pool;
+    // 新连接轮询绑定到工作线程，之后该连接的事件只在这个线程上处理
+    size_t next_worker = 0;
+    // 超时检查在主线程的时间轮上进行，关闭 / 发 ping 投递给连接绑定的工作线程
+    ConnectionTimers timers;
+    // 多 Reactor 模式（config.reuse_port 开启或使用 io_uring 后端）：
+    // 每个 Reactor 独占事件源与监听 socket，连接在接受它的 Reactor 上处理
+    bool multi_reactor;
+    std::vector<std::unique_ptr<IoBackend>> loops;
+    std::vector<std::thread> loop_threads;
+    // 线程池模式下的 UDP 端点（单个 socket，在主线程内处理）；多 Reactor 模式由各 Reactor 持有
+    std::unique_ptr<UdpEndpoint> udp;
+    bool udp_write_armed = false;  // UDP socket 当前等待 EPOLLOUT（而非 EPOLLIN）
+    // 管理端口（监控抓取），与数据面线程隔离
+    std::unique_ptr<AdminServer> admin;
 
     // 设置 socket 和 epoll
     bool setupSocket();
     bool setupEpoll();
+    bool setupReactors();
+    void runReactors();
+    bool setupAdmin();
     // 处理新连接
     void handleNewConnection();
     // 处理客户端事件
     void handleClientEvent(int fd, uint32_t events);
+    // 处理 UDP socket 事件，并按发送区是否积压切换等待可读 / 可写
+    void handleUdpEvent(uint32_t events);
+    // 合并事件，必要时把处理任务投递到连接绑定的工作线程
+    void dispatchEvents(Connection& conn, uint32_t events);
+    void handleTimeouts();
+    // 在连接绑定的工作线程上处理合并后的事件
+    void serviceConnection(Connection& conn);
     // 清理连接
     void cleanupConnection(int fd);
 };
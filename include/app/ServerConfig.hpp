@@ -1,23 +1,51 @@
 #pragma once
 #include <cstddef>  // for size_t
+#include <string>
+
+#include "threading/ThreadPool.hpp"
+
+// Reactor 线程使用的 I/O 后端
+enum class IoBackendType {
+    Epoll,    // epoll 就绪通知 + 非阻塞 recv/send
+    IoUring,  // io_uring：multishot accept/recv + provided buffer ring + 批量提交
+};
 
 struct ServerConfig {
     // 网络配置
     int port = 8888;
     int max_connections = 10000;
     int backlog = 1024;
+    // UDP 服务（可与 TCP 同时开启）：每个 Reactor 一个 SO_REUSEPORT UDP socket，0 表示不开启
+    int udp_port = 0;
+    size_t udp_batch_size = 64;        // 每次 recvmmsg / sendmmsg 的数据报数
+    size_t udp_max_sessions = 65536;   // 每个 Reactor 跟踪的对端会话上限
+    int udp_session_timeout = 60000;   // 对端多久没有数据报就回收其会话（毫秒）
     
     // 线程池配置
     int thread_pool_size = 8;  // 默认使用CPU核心数
+    size_t max_pending_tasks = 0;  // 积压任务上限，0 表示不限制
+    TaskOverflowPolicy task_overflow_policy = TaskOverflowPolicy::Reject;  // 积压满时的处理
     
     // 缓冲区配置
     size_t read_buffer_size = 8192;
     size_t write_buffer_size = 8192;
+    // 发送反压（字节）：连接待发数据达到高水位时暂停读取，降到低水位后恢复，高水位 0 表示不限制
+    size_t send_high_watermark = 4 * 1024 * 1024;
+    size_t send_low_watermark = 1024 * 1024;
+    bool buffer_pool_huge_pages = false;  // 缓冲区池 arena 使用大页（MAP_HUGETLB，失败退回透明大页）
+
+    // 批量文件传输（0xABD0，仅 TCP）：客户端可读取的根目录，空表示不开启
+    // 文件内容经 sendfile / splice 发送，待发字节计入发送反压水位
+    std::string bulk_root;
     
-    // 超时配置（毫秒）
-    int connection_timeout = 30000;  // 连接超时
-    int read_timeout = 30000;        // 读取超时
-    int write_timeout = 30000;       // 写入超时
+    // 超时配置（毫秒，0 表示不启用）：由各 Reactor 的时间轮检查，超时即关闭连接
+    int connection_timeout = 30000;  // 空闲超时：没有新请求且没有待发数据
+    int read_timeout = 30000;        // 读取超时：一帧从开始接收到收全的上限
+    int write_timeout = 30000;       // 写入超时：有待发数据但发送没有任何进展
+    // 应用层心跳（0xABCF 控制帧），用于在秒级发现半开连接
+    int heartbeat_interval = 0;      // 多久收不到任何数据就发送 ping，0 表示不发送
+    int heartbeat_timeout = 5000;    // ping 发出后仍收不到任何数据的上限
+    int timer_tick_ms = 10;          // 时间轮精度
     
     // 性能调优
     bool reuse_addr = true;          // SO_REUSEADDR
@@ -26,4 +54,23 @@ struct ServerConfig {
     int keep_alive_time = 60;        // TCP keepalive time
     int keep_alive_intvl = 5;        // TCP keepalive interval
     int keep_alive_probes = 3;       // TCP keepalive probes
-}; 
\ No newline at end of file
+
+    // 多 Reactor 配置（reuse_port 开启时生效）
+    int reactor_count = 0;              // Reactor 数量，0 表示使用 CPU 核心数
+    bool reactor_cpu_affinity = true;   // 每个 Reactor 线程绑定到独立的 CPU 核心
+
+    // I/O 后端（选择 IoUring 时强制使用 Reactor 模式；内核不支持时回退 epoll）
+    IoBackendType io_backend = IoBackendType::Epoll;
+    unsigned uring_entries = 4096;       // SQ 深度
+    unsigned uring_buffer_count = 1024;  // provided buffer 数量（必须是 2 的幂）
+    unsigned uring_buffer_size = 16384;  // 每个 provided buffer 的字节数
+
+    // 管理端口：独立线程提供 GET /metrics（Prometheus 格式），0 表示不开启
+    int admin_port = 0;
+
+    // 日志配置
+    bool async_logging = false;        // 后台线程攒批写日志，业务线程只写本线程的环形缓冲区
+    std::string log_file;              // 异步日志输出文件，空表示标准输出
+    bool log_block_when_full = false;  // 环形缓冲区写满时阻塞等待（默认丢弃并计数）
+    bool log_binary = false;           // 写二进制日志（需 log_file），用 log_decoder 还原
+};
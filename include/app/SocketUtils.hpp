@@ -0,0 +1,16 @@
+#pragma once
+
+#include "app/ServerConfig.hpp"
+
+// 创建非阻塞监听 socket 并完成 bind/listen，失败返回 -1
+// reuse_port 为 true 时设置 SO_REUSEPORT：多个 Reactor 可各自绑定同一端口，
+// 由内核按四元组哈希把新连接分流到不同的监听 socket
+int createListenSocket(const ServerConfig& config, bool reuse_port);
+
+// 创建绑定到 config.udp_port 的非阻塞 UDP socket，失败返回 -1
+// reuse_port 为 true 时设置 SO_REUSEPORT：每个 Reactor 各绑定一个，
+// 内核按四元组哈希分流，同一对端的数据报总是落到同一个 socket
+int createUdpSocket(const ServerConfig& config, bool reuse_port);
+
+// 按配置设置已接受连接的 socket 选项（TCP keep-alive）
+void applyClientSocketOptions(int client_fd, const ServerConfig& config);
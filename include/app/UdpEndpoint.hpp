@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "app/ServerConfig.hpp"
+#include "app/UdpSessionTable.hpp"
+#include "net/protocol/UdpProtocol.hpp"
+
+/*
+Reactor 持有的 UDP 服务端点（只在所属 Reactor 线程内使用）：
+- 一个 SO_REUSEPORT UDP socket，内核按四元组把对端分流到各个 Reactor，
+  同一对端总是落到同一个端点，会话表无需跨线程共享
+- 每个数据报是一帧请求，经与 TCP 相同的 RequestHandler 生成响应，
+  响应追加到 UdpProtocol 的发送区，一批处理完后用 sendmmsg（可合并为 GSO）一次发出
+- 对端会话记录在扁平哈希表里，按 udp_session_timeout 定期淘汰空闲会话
+- socket 以水平触发方式等待可读，一次事件最多处理固定批数，剩余数据留给下一轮，
+  避免 UDP 洪泛饿死同一 Reactor 上的 TCP 连接
+- 发送缓冲区满（sendmmsg 返回 EAGAIN）时响应留在发送区，调用方按 wantsWritable()
+  改为只等待可写，补发完再恢复等待可读；期间不再收取，新数据报留在内核接收队列
+*/
+class UdpEndpoint {
+   public:
+    explicit UdpEndpoint(const ServerConfig& config);
+    ~UdpEndpoint();
+
+    UdpEndpoint(const UdpEndpoint&) = delete;
+    UdpEndpoint& operator=(const UdpEndpoint&) = delete;
+
+    // 创建并绑定 socket；reuse_port 为 true 时允许多个端点绑定同一端口
+    bool setup(bool reuse_port);
+    int fd() const { return proto_ ? proto_->fd() : -1; }
+
+    // socket 可读：先补发上一轮积压的响应，再收取、处理并发出响应
+    void handleReadable();
+    // socket 可写：补发积压的响应
+    void handleWritable();
+    // 发送区仍有积压：调用方应等待可写而不是可读
+    bool wantsWritable() const { return proto_ && proto_->hasPendingSendData(); }
+    // 到达淘汰间隔时回收空闲会话，可在每轮事件处理后调用
+    void expireSessions();
+    // 与调用方已有的等待超时（-1 表示无限）合并，保证空闲会话能按时淘汰
+    int timeoutMs(int other_timeout_ms) const;
+
+    size_t sessionCount() const { return sessions_.size(); }
+
+   private:
+    // 逐个解析当前批次的数据报并生成响应
+    void processBatch(int64_t now_ms);
+    // 发出积压的响应；发送缓冲区已满时返回 false
+    bool flush();
+    void publishStats();
+
+    const ServerConfig& config_;
+    std::unique_ptr<UdpProtocol> proto_;
+    UdpSessionTable sessions_;
+    int64_t sweep_interval_ms_;
+    int64_t next_sweep_ms_ = 0;
+    UdpProtocol::Stats published_;  // 已经累加到 Metrics 的部分
+};
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <netinet/in.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 一个 UDP 对端的轻量会话：只有计数和时间戳，整体放在哈希表槽位里
+struct UdpSession {
+    uint64_t key = 0;            // (IPv4 地址 << 16) | 端口，0 表示空槽
+    int64_t created_ms = 0;
+    int64_t last_active_ms = 0;  // 最近一次收到该对端的数据报
+    uint64_t requests = 0;
+    uint64_t bytes_received = 0;
+    uint64_t bytes_sent = 0;
+};
+
+/*
+sockaddr_in → UdpSession 的扁平开放寻址哈希表（只在所属 Reactor 线程内使用）：
+- 槽位连续存放，线性探测，容量为 2 的幂且不低于会话上限的 2 倍，装载率不超过 1/2
+- 删除采用反向移位（backward shift），不留墓碑，探测链长度不会随淘汰而退化
+- 空闲淘汰由调用方按间隔触发，一次扫描整张表
+*/
+class UdpSessionTable {
+   public:
+    explicit UdpSessionTable(size_t max_sessions);
+
+    UdpSessionTable(const UdpSessionTable&) = delete;
+    UdpSessionTable& operator=(const UdpSessionTable&) = delete;
+
+    // 查找对端的会话，不存在时创建；会话数达到上限时返回 nullptr（请求照常处理，只是不跟踪）
+    UdpSession* findOrCreate(const sockaddr_in& peer, int64_t now_ms,
+                             bool& created);
+    UdpSession* find(const sockaddr_in& peer);
+
+    // 淘汰 last_active_ms 早于 now_ms - idle_ms 的会话，返回淘汰个数
+    size_t evictIdle(int64_t now_ms, int64_t idle_ms);
+
+    size_t size() const { return size_; }
+    size_t capacity() const { return slots_.size(); }
+    size_t maxSessions() const { return max_sessions_; }
+
+    static uint64_t keyOf(const sockaddr_in& peer) {
+        return (uint64_t(ntohl(peer.sin_addr.s_addr)) << 16) |
+               ntohs(peer.sin_port);
+    }
+
+   private:
+    // 斐波那契散列：乘法后取高位，地址和端口的低位差异都能扩散到槽位下标
+    size_t home(uint64_t key) const {
+        return static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> shift_);
+    }
+    void erase(size_t index);
+
+    const size_t max_sessions_;
+    std::vector<UdpSession> slots_;
+    size_t mask_;
+    unsigned shift_;
+    size_t size_ = 0;
+};
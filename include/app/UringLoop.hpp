@@ -0,0 +1,134 @@
+// UringLoop.hpp
+#pragma once
+
+#include <linux/time_types.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "app/ConnectionTimers.hpp"
+#include "app/IoBackend.hpp"
+#include "app/ServerConfig.hpp"
+#include "app/UdpEndpoint.hpp"
+#include "net/buffer/SendQueue.hpp"
+#include "net/connection/Connection.hpp"
+#include "net/io/IoUring.hpp"
+
+/*
+基于 io_uring 的 Reactor：
+- multishot accept：一次提交，持续产出新连接
+- multishot recv + provided buffer ring：内核自动挑选缓冲区，无需每次重新提交
+- 发送：一批 CQE 处理完后，把所有有待发数据的连接的 SENDMSG 一次 io_uring_enter 提交
+- 文件片段（批量传输）：socket 是阻塞的，不能像 epoll 后端那样直接 sendfile，
+  改为经连接私有的管道提交 SPLICE(文件→管道) 与以 IOSQE_IO_LINK 串联的 SPLICE(管道→socket)，
+  数据只在页缓存与管道之间移动页引用，不进用户态
+请求处理复用 Connection（handleData → 解析 → 业务 → 发送队列），与 epoll 后端一致
+连接超时由本 Reactor 的时间轮检查，等待上限通过 IORING_OP_TIMEOUT 提交
+开启 UDP 时用单次 IORING_OP_POLL_ADD 等待 UDP socket 可读（发送区积压时改为等待可写），
+处理完一轮再重新提交（水平触发语义），收发仍由 UdpEndpoint 的 recvmmsg / sendmmsg 完成
+*/
+class UringLoop : public IoBackend {
+   public:
+    UringLoop(int index, const ServerConfig& config);
+    ~UringLoop() override;
+
+    UringLoop(const UringLoop&) = delete;
+    UringLoop& operator=(const UringLoop&) = delete;
+
+    bool setup() override;
+    void run() override;
+    void stop() override;
+    const char* name() const override { return "io_uring"; }
+
+   private:
+    static constexpr uint16_t kBufferGroup = 0;
+
+    // user_data 编码：高 32 位为操作类型，低 32 位为 fd
+    enum class Op : uint32_t {
+        Accept = 1,
+        Recv,
+        Send,
+        Wakeup,
+        Timeout,
+        Cancel,
+        UdpPoll,
+        SpliceIn,   // 文件 → 管道
+        SpliceOut,  // 管道 → socket，完成结果按发送处理
+    };
+
+    struct UringConnection {
+        std::shared_ptr<Connection> conn;
+        // SENDMSG 在完成前会引用 msg/iov，必须放在地址稳定的位置
+        msghdr msg{};
+        iovec iov[SendQueue::kMaxIov];
+        bool recv_armed = false;
+        bool recv_cancelling = false;  // 读取暂停，已提交取消 recv
+        bool send_inflight = false;  // SENDMSG 或 SpliceOut 在途
+        bool splice_in_inflight = false;
+        bool closing = false;
+        // 发送文件片段时才创建的管道；pipe_bytes 是已从文件读入、尚未写到 socket 的字节
+        int pipe_fds[2] = {-1, -1};
+        size_t pipe_size = 0;
+        size_t pipe_bytes = 0;
+
+        UringConnection() = default;
+        UringConnection(const UringConnection&) = delete;
+        UringConnection& operator=(const UringConnection&) = delete;
+        ~UringConnection();
+    };
+
+    static uint64_t encode(Op op, int fd) {
+        return (uint64_t(op) << 32) | uint32_t(fd);
+    }
+
+    void armAccept();
+    void armRecv(int fd, UringConnection& uc);
+    // 按连接的读取暂停状态取消或重新提交 multishot recv
+    void updateRecv(int fd, UringConnection& uc);
+    void armWakeup();
+    void armUdpPoll();
+    void armTimeout(long long nsec);
+    // 按时间轮最近的到期时刻补一个超时请求（已有不晚于它的在途请求时不提交）
+    void armTimerTick();
+    void handleTimeouts();
+    void submitSend(int fd, UringConnection& uc);
+    // 队首是文件片段时由 submitSend 调用，经连接的管道提交 splice
+    void submitSplice(int fd, UringConnection& uc);
+    void flushPendingSends();
+
+    void handleCqe(const io_uring_cqe& cqe);
+    void onAccept(const io_uring_cqe& cqe);
+    void onRecv(int fd, const io_uring_cqe& cqe);
+    void onSend(int fd, const io_uring_cqe& cqe, bool from_pipe);
+    void onSpliceIn(int fd, const io_uring_cqe& cqe);
+
+    void closeConnection(int fd, UringConnection& uc);
+    // 连接已关闭且没有在途请求时才释放，避免内核仍引用其缓冲区
+    void maybeRelease(int fd, UringConnection& uc);
+    void cleanupAllConnections();
+
+    const int index_;
+    const ServerConfig& config_;
+    int listen_fd_;
+    int wakeup_fd_;
+    uint64_t wakeup_value_ = 0;
+    std::atomic<bool> running_;
+    bool accept_armed_ = false;
+
+    std::unique_ptr<UdpEndpoint> udp_;  // 未开启 UDP 时为空
+
+    IoUring ring_;
+    std::unordered_map<int, std::unique_ptr<UringConnection>> conns_;
+    // 本批 CQE 中产生了新响应、需要提交发送的连接
+    std::vector<int> pending_sends_;
+
+    ConnectionTimers timers_;
+    // IORING_OP_TIMEOUT 在提交时才读取 timespec，必须在提交前保持有效
+    __kernel_timespec timeout_ts_{};
+    int64_t tick_deadline_ms_ = 0;  // 在途超时请求的到期时刻，0 表示没有
+};
@@ -5,31 +5,141 @@
 #include <vector>
 #include <thread>
 #include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <random>
+
+#include "utils/LatencyHistogram.hpp"
+
+/// 请求 payload 大小分布
+struct PayloadSizes {
+    enum class Kind { Fixed, Uniform, Exponential };
+    Kind   kind = Kind::Fixed;
+    size_t min = 64;              ///< Fixed 的大小 / Uniform 的下界
+    size_t max = 64;              ///< Uniform 的上界 / Exponential 的截断上限
+    double mean = 64;             ///< Exponential 的均值
+
+    /// 解析 "256"（固定）、"64-1024"（均匀）、"exp:256"（均值 256 的指数分布，截断到 1MB）
+    static bool parse(const std::string& spec, PayloadSizes& out);
+    size_t sample(std::mt19937_64& rng) const;
+    std::string describe() const;
+};
+
+/// 开环压测参数：请求按计划时刻发出，与响应何时到达无关
+struct OpenLoopOptions {
+    double rate = 1000;           ///< 目标总请求速率（req/s），平均分给各线程
+    double duration = 10;         ///< 每个速率的发送时长（秒）
+    bool poisson = false;         ///< true：泊松到达（指数分布间隔）；false：恒定间隔
+    PayloadSizes payload;         ///< 请求 payload 大小分布
+    double drain_timeout = 2;     ///< 停止发送后等待剩余响应的上限（秒）
+};
+
+/// 多路复用压测参数：每个线程用一个 epoll 驱动大量非阻塞连接
+struct MultiplexOptions {
+    int connections_per_thread = 1000;
+    int pipeline_depth = 1;       ///< 每个连接同时在途的请求数 K
+    uint64_t requests_per_connection = 100;  ///< 0 表示按 duration 计时
+    double duration = 0;          ///< requests_per_connection 为 0 时的发送时长（秒）
+    double connect_rate = 0;      ///< 总建连速率（conn/s），0 表示不限
+    PayloadSizes payload;
+    double drain_timeout = 5;     ///< 停止发送后等待剩余响应的上限（秒）
+    std::string csv_path;         ///< 非空时把逐连接结果写成 CSV
+};
+
+/// 一次开环压测的结果
+struct OpenLoopResult {
+    double target_rate = 0;
+    double achieved_rate = 0;     ///< 收到响应的速率
+    uint64_t sent = 0;
+    uint64_t received = 0;
+    uint64_t errors = 0;          ///< 连接失败或断开时未完成的请求
+    uint64_t timed_out = 0;       ///< drain_timeout 内仍未收到响应的请求
+    /// 延迟（纳秒），从计划发送时刻算起：发送端落后或排队的时间都计入，
+    /// 不会因为闭环等待而漏掉慢请求（coordinated omission）
+    LatencyHistogram::Snapshot latency;
+};
 
 /// 并发压测工具
 class LoadTester {
 public:
     /// @param host               服务器 IP 或域名
     /// @param port               服务器端口
-    /// @param num_threads        并发线程数
-    /// @param messages_per_thread 每线程发送的消息数
+    /// @param num_threads        并发线程数（每线程一个连接）
+    /// @param messages_per_thread 每线程发送的消息数（闭环模式）
+    /// @param frame_header       帧头：0xABCD 字节和校验，0xABCE CRC32C 校验
     LoadTester(std::string host,
                uint16_t port,
                int num_threads,
-               int messages_per_thread);
+               int messages_per_thread,
+               uint16_t frame_header = 0xABCD);
 
-    /// 执行压测：阻塞直到全部线程结束
+    /// 闭环压测：每个连接发一条、收一条，阻塞直到全部线程结束
     void run();
 
+    /// 开环压测：按 options.rate 发送，打印结果与完整的延迟百分位分布
+    OpenLoopResult runOpenLoop(const OpenLoopOptions& options);
+
+    /// 吞吐-延迟扫描：依次以每个速率做一次开环压测，打印汇总表
+    std::vector<OpenLoopResult> sweep(const OpenLoopOptions& options,
+                                      const std::vector<double>& rates);
+
+    /// 多路复用压测：每线程 connections_per_thread 个非阻塞连接、每连接 K 个在途请求，
+    /// 打印总体、逐线程和逐连接的结果
+    void runMultiplexed(const MultiplexOptions& options);
+
+    /// 打印 HdrHistogram 风格的百分位分布（单位微秒）
+    static void printLatencyDistribution(
+        const LatencyHistogram::Snapshot& latency);
+
 private:
+    using Clock = std::chrono::steady_clock;
+
+    /// 开环压测中各线程共享的计数
+    struct OpenLoopCounters {
+        std::atomic<uint64_t> sent{0};
+        std::atomic<uint64_t> received{0};
+        std::atomic<uint64_t> errors{0};
+        std::atomic<uint64_t> timed_out{0};
+    };
+
+    /// 多路复用模式下单个连接的结果
+    struct ConnectionStats {
+        bool     connected = false;
+        int      error = 0;            ///< 建连或收发失败时的 errno
+        uint64_t connect_ns = 0;       ///< 从发起 connect 到连接建立
+        uint64_t requests = 0;         ///< 收到响应的请求数
+        uint64_t unanswered = 0;       ///< 出错或超时时仍在途的请求
+        uint64_t latency_sum_ns = 0;
+        uint64_t latency_max_ns = 0;
+    };
+    /// 多路复用模式下单个线程的结果
+    struct ThreadStats {
+        std::vector<ConnectionStats> connections;
+        LatencyHistogram::Snapshot latency;
+        double seconds = 0;
+    };
+
     /// 单个线程的工作函数
     void worker(int thread_index);
+    /// 多路复用模式下单个线程的事件循环
+    void multiplexWorker(int thread_index, const MultiplexOptions& options,
+                         Clock::time_point start, LatencyHistogram& latency,
+                         ThreadStats& stats);
+    /// 开环模式下单个线程的工作函数
+    void openLoopWorker(int thread_index, const OpenLoopOptions& options,
+                        Clock::time_point start, LatencyHistogram& latency,
+                        OpenLoopCounters& counters);
+    /// 建立到服务器的阻塞 TCP 连接，失败返回 -1
+    int connectToServer() const;
+    /// 执行一次开环压测，不打印
+    OpenLoopResult measureOpenLoop(const OpenLoopOptions& options);
 
     // 参数
     std::string host_;
     uint16_t    port_;
     int         num_threads_;
     int         messages_per_thread_;
+    uint16_t    frame_header_;
 
     // 统计
     std::atomic<int> success_count_{0};
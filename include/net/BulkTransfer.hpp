@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+
+#include "net/PacketView.hpp"
+
+class SendQueue;
+class TcpProtocol;
+
+/*
+批量文件传输（仅 TCP）：客户端请求文件的一段区域，服务端不经用户态直接把页缓存发往 socket
+    请求 0xABD0 payload：[offset(8)][length(8)][path]，length 为 0 表示直到文件末尾
+    响应 0xABD1 payload：[status(1)][offset(8)][length(8)][file_size(8)]
+整数均为大端序。响应帧之后紧跟 length 字节的文件原始内容（不在帧内，不做校验），
+status 非 Ok 时 length 为 0；file_size 让客户端可以据此续传或校验区间
+- 服务端：文件区域作为 SendQueue 的文件片段入队，epoll 后端用 sendfile 发送，
+  io_uring 后端经管道 splice 发送，待发字节多少都不占用用户态内存
+- 路径相对于服务端配置的根目录，openat2(RESOLVE_BENEATH) 保证解析结果不越出根目录
+- 客户端：receiveToFile 按块接收并 pwrite 到目标文件，内存占用与文件大小无关
+*/
+namespace bulk {
+
+enum class Status : uint8_t {
+    Ok = 0,
+    NotFound,  // 文件不存在
+    BadRange,  // offset 超出文件大小
+    Denied,    // 路径非法、越出根目录、不是普通文件，或服务端未开启批量传输
+    IoError,   // 其他打开 / 读取错误
+};
+const char* statusName(Status status);
+
+struct Request {
+    uint64_t offset = 0;
+    uint64_t length = 0;
+    std::string_view path;
+};
+
+struct Response {
+    Status status = Status::Ok;
+    uint64_t offset = 0;
+    uint64_t length = 0;
+    uint64_t file_size = 0;
+};
+
+constexpr size_t kRequestFixedSize = 16;
+constexpr size_t kResponseSize = 25;
+constexpr size_t kMaxPathLength = 4096;
+
+// 编码为完整的 0xABD0 请求帧
+std::string encodeRequest(const Request& request);
+// payload 长度或格式不对时返回 false；request.path 引用 payload
+bool parseRequest(std::span<const uint8_t> payload, Request& request);
+bool parseResponse(std::span<const uint8_t> payload, Response& response);
+
+// 服务端：校验并打开 root 下的文件，把响应帧和文件区域追加到 out，返回入队的文件字节数；
+// root 为空表示未开启，回复 Denied。请求格式非法时抛出 std::runtime_error
+uint64_t serve(const PacketView& request, std::string_view root,
+               SendQueue& out);
+
+// 客户端：已收到 Ok 响应后，把紧随其后的 length 字节写入 file_fd 的 offset 处。
+// 先取走 proto 接收缓冲区里已读到的部分，其余直接从 socket 读；
+// 失败返回 false（连接中断或写盘失败，errno 保留）
+bool receiveToFile(TcpProtocol& proto, int sock_fd, int file_fd,
+                   uint64_t offset, uint64_t length);
+
+}  // namespace bulk
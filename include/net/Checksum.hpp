@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+/*
+帧完整性校验内核
+- sum16：逐字节累加取低 16 位（0xABCD 帧的校验和）。加法满足结合律，
+  可以分段计算后相加，结果与逐字节循环逐位一致
+- crc32c：Castagnoli 多项式 CRC（0xABCE 帧的校验值），标准初值/终值取反，
+  crc32c("123456789") == 0xE3069283；传入上一段的结果即可分段续算
+两者都在首次调用时按 CPU 能力选择实现：
+    sum16:  AVX2 → SSE2（x86-64 基线）→ NEON → 标量
+    crc32c: SSE4.2 crc32 指令 / ARMv8 CRC 扩展 → 查表（slicing-by-8）
+*/
+namespace checksum {
+
+uint16_t sum16(std::span<const uint8_t> data);
+uint32_t crc32c(std::span<const uint8_t> data, uint32_t crc = 0);
+
+// 当前选用的实现名，用于启动日志与压测报告
+const char* sum16Kernel();
+const char* crc32cKernel();
+
+// 单个实现：sum16 的 fn 返回完整字节和（取低 16 位即结果）；
+// crc32c 的 fn 处理取反后的内部状态，即 crc32c(data, crc) == ~fn(~crc, data)
+struct Sum16Impl {
+    uint64_t (*fn)(const uint8_t* data, size_t size);
+    const char* name;
+};
+struct Crc32cImpl {
+    uint32_t (*fn)(uint32_t state, const uint8_t* data, size_t size);
+    const char* name;
+};
+
+// 本机 CPU 可用的全部实现，按优先级排列，第一个即选用的实现；供测试逐个对照
+std::vector<Sum16Impl> sum16Impls();
+std::vector<Crc32cImpl> crc32cImpls();
+
+}  // namespace checksum
@@ -2,20 +2,52 @@
 #define PACKET_HPP
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <cstdint>  // 用于 uint32_t 这类类型   
+#include <span>
 
-// 计算校验和：将数据按字节累加
+// 计算校验和：将数据按字节累加（低 16 位），内部按 CPU 选择向量化实现
 uint16_t calculate_checksum(const std::vector<uint8_t>& data);
+// 直接在原始内存上计算，无需先拷贝出 vector
+uint16_t calculate_checksum(std::span<const uint8_t> data);
+uint16_t calculate_checksum(std::string_view data);
 
 /*
-[header(2)][length(4)][payload(内容)][checksum(2)]
+[header(2)][length(4)][payload(内容)][checksum(2 或 4)]
+header 决定尾部校验字段：
+    0xABCD  checksum 2 字节，payload 字节和的低 16 位
+    0xABCE  checksum 4 字节，payload 的 CRC32C（能发现字节和漏掉的换位、成对错误）
+    0xABCF  控制帧，checksum 同 0xABCD；payload 首字节为类型：
+            0x01 ping（其余字节原样带回），0x02 pong
+    0xABD0  批量传输请求（仅 TCP），checksum 同 0xABCD，payload 见 BulkTransfer.hpp
+    0xABD1  批量传输响应，checksum 同 0xABCD；帧后紧跟帧内声明长度的文件原始内容
+服务端按请求帧的 header 回复同一种格式；控制帧不计入请求，收到 ping 回复 pong
 */
 struct Packet {
-    uint16_t header = 0xABCD;     // 2 字节：固定魔数标志
+    static constexpr uint16_t kSum16Header = 0xABCD;
+    static constexpr uint16_t kCrc32cHeader = 0xABCE;
+    static constexpr uint16_t kControlHeader = 0xABCF;
+    static constexpr uint16_t kBulkRequestHeader = 0xABD0;
+    static constexpr uint16_t kBulkResponseHeader = 0xABD1;
+    // 控制帧类型（payload 首字节）
+    static constexpr uint8_t kPing = 0x01;
+    static constexpr uint8_t kPong = 0x02;
+
+    uint16_t header = kSum16Header;  // 2 字节：固定魔数标志
     uint32_t length;              // 4 字节：payload长度
     std::string payload;          // n 字节：正文
-    uint16_t checksum;            // 2 字节：校验值
+    uint32_t checksum;            // 2/4 字节：校验值
+
+    // 按 header 填好 length 与 checksum
+    static Packet make(std::string payload, uint16_t header = kSum16Header);
+
+    // header 对应的尾部校验字段长度；未知 header 按 2 字节处理（解析时会被拒绝）
+    static size_t trailerSize(uint16_t header) {
+        return header == kCrc32cHeader ? 4 : 2;
+    }
+    static uint32_t computeChecksum(uint16_t header,
+                                    std::span<const uint8_t> payload);
 
     std::vector<uint8_t> serialize() const;
     /* const 成员函数，表示该函数不会修改对象的成员变量 */
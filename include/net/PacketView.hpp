@@ -0,0 +1,50 @@
+#ifndef PACKET_VIEW_HPP
+#define PACKET_VIEW_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+#include "net/Packet.hpp"
+
+/*
+Packet 的零拷贝视图：在接收缓冲区上原地校验 header、length 与 checksum，
+payload 直接指向缓冲区内部，不复制。
+视图只在对应帧被消费之前有效（见 TcpProtocol::tryReceiveView），
+需要长期持有数据的处理逻辑调用 toPacket() 物化一份拥有所有权的 Packet。
+*/
+struct PacketView {
+    static constexpr size_t kHeaderSize = 6;  // header(2) + length(4)
+
+    uint16_t header = 0;
+    uint32_t length = 0;
+    uint32_t checksum = 0;
+    std::span<const uint8_t> payload;
+
+    std::string_view payloadString() const {
+        return {reinterpret_cast<const char*>(payload.data()), payload.size()};
+    }
+    size_t frameSize() const {
+        return kHeaderSize + length + Packet::trailerSize(header);
+    }
+
+    // 拷贝出拥有所有权的 Packet
+    Packet toPacket() const;
+
+    // 读取帧头中的魔数，data 至少需要 2 字节
+    static uint16_t peekHeader(const uint8_t* data);
+    // 是否为协议定义的帧类型
+    static bool isKnownHeader(uint16_t header);
+    // 读取帧头中的 payload 长度，data 至少需要 kHeaderSize 字节
+    static uint32_t peekPayloadLength(const uint8_t* data);
+    // 按帧头计算整帧长度（含尾部校验字段），data 至少需要 kHeaderSize 字节
+    static size_t peekFrameSize(const uint8_t* data);
+
+    // 尝试从 data 开头解析一个完整帧：
+    // 数据不足返回 false；header 或 checksum 非法时抛出 std::runtime_error；
+    // 成功返回 true，view 指向 data 内部
+    static bool parse(std::span<const uint8_t> data, PacketView& view);
+};
+
+#endif
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+
+#include "net/Packet.hpp"
+#include "net/PacketView.hpp"
+#include "utils/Metrics.hpp"
+
+/*
+业务处理，TCP 连接与 UDP 数据报共用同一套逻辑：
+响应写入 Sink，Sink 提供与 SendQueue 相同的帧构建接口
+    beginFrame(header) → appendBorrowed / appendCopy ... → endFrame()
+TCP 直接传连接的 SendQueue，UDP 传面向请求来源的 UdpReply
+*/
+class RequestHandler {
+   public:
+    // 业务请求：生成响应并写入 out
+    template <typename Sink>
+    static void handleRequest(const PacketView& request, Sink& out) {
+        Metrics::getInstance().incrementBytesReceived(request.frameSize());
+        Metrics::getInstance().incrementRequests();
+
+        // 生成响应（示例：简单回显）：
+        // 静态前缀借用发送，请求 payload 只拷贝这一次（视图随后失效），
+        // 拷贝目标来自 BufferPool，发送完成后归还，稳态下不调用 malloc
+        static constexpr std::string_view kPrefix = "Server received: ";
+        // 按请求帧的 header 回复同一种完整性校验格式（字节和 / CRC32C）
+        out.beginFrame(request.header);
+        out.appendBorrowed(kPrefix);
+        out.appendCopy(request.payloadString());
+        // 校验和在构建时累加
+        out.endFrame();
+    }
+
+    // 控制帧：ping 回复 pong，pong 只作为存活信号；非法控制帧抛出 std::runtime_error
+    template <typename Sink>
+    static void handleControl(const PacketView& frame, Sink& out) {
+        if (frame.payload.empty()) {
+            throw std::runtime_error("Empty control frame");
+        }
+        switch (frame.payload[0]) {
+            case Packet::kPing: {
+                // 原样带回 ping 携带的数据，对端可用它计算往返时间
+                static constexpr uint8_t kPongType = Packet::kPong;
+                out.beginFrame(Packet::kControlHeader);
+                out.appendBorrowed(&kPongType, 1);
+                out.appendCopy(frame.payload.data() + 1,
+                               frame.payload.size() - 1);
+                out.endFrame();
+                break;
+            }
+            case Packet::kPong:
+                // 收到任何数据都会清除未回应的 ping，这里无需额外处理
+                break;
+            default:
+                throw std::runtime_error("Unknown control frame type");
+        }
+    }
+};
@@ -0,0 +1,150 @@
+// BufferPool.hpp
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+
+#include "utils/ThreadShards.hpp"
+
+/*
+按尺寸分级的缓冲区池：收发缓冲区、payload 片段都从这里取，用完归还而不是 free
+- 尺寸分级为 2 的幂：64B .. 4MB，申请按向上取整的级别分配，超过上限直接走堆
+- 每个线程每个级别一条本地空闲链表（链表指针就存在空闲块内部），命中时无锁、无系统调用；
+  本地超过上限时把一半还给全局仓库，本地为空时从全局仓库成批取回，
+  因此在 A 线程申请、B 线程释放的场景也能稳定复用
+- 全局仓库也为空时从 arena 切一块新 slab；arena 按 2MB 向操作系统申请，
+  可选大页（MAP_HUGETLB，失败时退回透明大页 madvise），内存只进不出
+- 命中/未命中按线程分片计数，由 Metrics 汇总
+*/
+class BufferPool {
+   public:
+    static constexpr size_t kMinClassShift = 6;   // 64B
+    static constexpr size_t kMaxClassShift = 22;  // 4MB
+    static constexpr size_t kNumClasses = kMaxClassShift - kMinClassShift + 1;
+    static constexpr size_t kMaxPooledSize = size_t(1) << kMaxClassShift;
+
+    struct Stats {
+        uint64_t hits = 0;            // 本线程缓存直接命中
+        uint64_t refills = 0;         // 本线程缓存为空，从全局仓库成批取回
+        uint64_t misses = 0;          // 需要新内存：切新 slab 或超过上限走堆
+        uint64_t reserved_bytes = 0;  // arena 已向操作系统申请的字节数
+    };
+
+    // 进程级单例，永不析构：线程本地缓存在线程退出时仍要归还到这里
+    static BufferPool& getInstance();
+
+    // 需在首次分配之前调用
+    void setHugePages(bool enabled) { huge_pages_ = enabled; }
+
+    // 返回至少 size 字节的缓冲区，capacity 为实际可用字节数（级别大小）
+    uint8_t* allocate(size_t size, size_t& capacity);
+    // capacity 必须是 allocate 返回的值
+    void deallocate(uint8_t* data, size_t capacity);
+
+    Stats stats() const;
+
+   private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+    struct FreeList {
+        FreeBlock* head = nullptr;
+        size_t count = 0;
+
+        void push(FreeBlock* block) {
+            block->next = head;
+            head = block;
+            ++count;
+        }
+        FreeBlock* pop() {
+            FreeBlock* block = head;
+            head = block->next;
+            --count;
+            return block;
+        }
+    };
+    struct Depot {
+        std::mutex mutex;
+        FreeList list;
+    };
+    struct StatShard {
+        std::atomic<uint64_t> hits{0};
+        std::atomic<uint64_t> refills{0};
+        std::atomic<uint64_t> misses{0};
+    };
+
+    friend struct BufferPoolThreadCache;
+
+    BufferPool() = default;
+    BufferPool(const BufferPool&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+
+    static size_t classIndex(size_t size);
+    static size_t classSize(size_t index) {
+        return size_t(1) << (index + kMinClassShift);
+    }
+    // 线程本地缓存每个级别最多保留的块数（按字节预算折算）
+    static size_t cacheLimit(size_t index);
+
+    // 从全局仓库取最多 n 块放进 out；仓库为空时切新 slab 并返回 true
+    bool refill(size_t index, FreeList& out, size_t n);
+    // 把 list 中的 n 块还给全局仓库
+    void release(size_t index, FreeList& list, size_t n);
+    void carveSlab(size_t index, FreeList& out);
+    uint8_t* reserve(size_t bytes);
+
+    Depot depots_[kNumClasses];
+
+    std::mutex arena_mutex_;
+    uint8_t* arena_pos_ = nullptr;
+    uint8_t* arena_end_ = nullptr;
+    std::atomic<uint64_t> reserved_bytes_{0};
+    bool huge_pages_ = false;
+
+    ThreadShards<StatShard> stats_;
+};
+
+/*
+池化缓冲区的 RAII 句柄：析构时归还给 BufferPool
+只记录地址和容量，不记录已用长度，由使用方自己管理读写位置
+*/
+class PoolBuffer {
+   public:
+    PoolBuffer() = default;
+    explicit PoolBuffer(size_t size) {
+        data_ = BufferPool::getInstance().allocate(size, capacity_);
+    }
+    ~PoolBuffer() { reset(); }
+
+    PoolBuffer(PoolBuffer&& other) noexcept
+        : data_(std::exchange(other.data_, nullptr)),
+          capacity_(std::exchange(other.capacity_, 0)) {}
+    PoolBuffer& operator=(PoolBuffer&& other) noexcept {
+        if (this != &other) {
+            reset();
+            data_ = std::exchange(other.data_, nullptr);
+            capacity_ = std::exchange(other.capacity_, 0);
+        }
+        return *this;
+    }
+    PoolBuffer(const PoolBuffer&) = delete;
+    PoolBuffer& operator=(const PoolBuffer&) = delete;
+
+    uint8_t* data() const { return data_; }
+    size_t capacity() const { return capacity_; }
+    explicit operator bool() const { return data_ != nullptr; }
+
+    void reset() {
+        if (data_) {
+            BufferPool::getInstance().deallocate(data_, capacity_);
+            data_ = nullptr;
+            capacity_ = 0;
+        }
+    }
+
+   private:
+    uint8_t* data_ = nullptr;
+    size_t capacity_ = 0;
+};
@@ -0,0 +1,53 @@
+// RecvBuffer.hpp
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#include "net/buffer/BufferPool.hpp"
+
+/*
+接收缓冲区：读/写双指针 + 连续内存
++-------------------+------------------+------------------+
+|   已消费 (可复用)   |  可读 (readable)  |  可写 (writable)  |
++-------------------+------------------+------------------+
+0               read_pos_          write_pos_         capacity_
+
+- consume() 只移动 read_pos_，O(1)，不再像 vector::erase 那样搬移整段剩余数据
+- 可写空间不足时才把剩余未读数据搬到头部（只搬未读部分，摊还 O(1)），仍不够再扩容
+- 可读数据始终连续，解析层可以直接在缓冲区上原地读取完整帧
+- 内存取自 BufferPool，扩容/收缩时旧块归还池中，容量按池的尺寸级别取整
+*/
+class RecvBuffer {
+   public:
+    explicit RecvBuffer(size_t initial_capacity = 4096);
+
+    RecvBuffer(const RecvBuffer&) = delete;
+    RecvBuffer& operator=(const RecvBuffer&) = delete;
+
+    size_t readableBytes() const { return write_pos_ - read_pos_; }
+    size_t writableBytes() const { return capacity_ - write_pos_; }
+    size_t capacity() const { return capacity_; }
+    bool empty() const { return read_pos_ == write_pos_; }
+
+    // 可读数据起始地址（连续 readableBytes() 字节）
+    const uint8_t* peek() const { return data_.data() + read_pos_; }
+
+    // 消费 n 字节：O(1)
+    void consume(size_t n);
+
+    // 保证至少 n 字节连续可写空间，返回写入起点；写完后调用 commitWrite()
+    uint8_t* prepareWrite(size_t n);
+    void commitWrite(size_t n) { write_pos_ += n; }
+
+    // 缓冲区为空且容量超过 max_idle_capacity 时释放多余内存（大帧过后回落）
+    void shrinkIfIdle(size_t max_idle_capacity);
+
+    void clear() { read_pos_ = write_pos_ = 0; }
+
+   private:
+    PoolBuffer data_;
+    size_t capacity_;
+    size_t read_pos_ = 0;
+    size_t write_pos_ = 0;
+    size_t initial_capacity_;
+};
@@ -0,0 +1,137 @@
+// SendQueue.hpp
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "net/buffer/BufferPool.hpp"
+
+struct iovec;
+
+/*
+分段发送队列：每个帧由若干片段组成
+    [header+length 内联 6B][payload 片段 ...][checksum 内联 2B/4B]
+- payload 片段要么转移所有权（appendOwned，std::string 直接 move 进来），
+  要么借用调用方内存（appendBorrowed，调用方保证发送完成前有效，如静态常量），均不拷贝；
+  必须拷贝时用 appendCopy，数据放进 BufferPool 的块里，发送完归还池中
+- 片段存放在只增不减的环形数组里，稳态下入队/出队都不分配内存；
+  数组只保存片段指针，扩容不移动片段，已交给 io_uring 的 iovec 在发送完成前保持有效
+- writeTo() 用 sendmsg 一次提交多个 iovec；部分写只推进 head_offset_，不搬移内存
+- 文件片段（appendFile）不进用户态：writeTo() 到达文件片段时改用 sendfile 从页缓存直接发送，
+  io_uring 后端通过 frontFile() 取得区域自行 splice；片段持有文件 fd，发送完或队列销毁时关闭
+*/
+class SendQueue {
+   public:
+    SendQueue() = default;
+    SendQueue(const SendQueue&) = delete;
+    SendQueue& operator=(const SendQueue&) = delete;
+
+    // 帧构建：beginFrame → appendXxx ... → endFrame（回填长度并追加校验和）
+    // header 为 Packet::kCrc32cHeader 时尾部是 4 字节 CRC32C，否则是 2 字节字节和
+    void beginFrame(uint16_t header);
+    void appendBorrowed(const void* data, size_t size);
+    void appendBorrowed(std::string_view data) {
+        appendBorrowed(data.data(), data.size());
+    }
+    void appendOwned(std::string data);
+    // 拷贝到池化缓冲区（适合生命周期短于发送过程的数据，如接收缓冲区里的请求视图）
+    void appendCopy(const void* data, size_t size);
+    void appendCopy(std::string_view data) { appendCopy(data.data(), data.size()); }
+    // 无参版本使用构建过程中累加的校验和，带参版本使用调用方给定的值
+    void endFrame();
+    void endFrame(uint32_t checksum);
+
+    // 直接追加已序列化好的字节（拷贝）
+    void appendRaw(const void* data, size_t size);
+    // 追加文件 [offset, offset + length) 的原始内容，接管 fd（length 为 0 时立即关闭）；
+    // 只能在帧外追加：内容不计入帧长度和校验和
+    void appendFile(int fd, uint64_t offset, size_t length);
+
+    // 尽量把队列写入 fd：返回本次写入字节数，出错返回 -1 并保留 errno
+    // （文件在发送过程中被截短时为 EIO）
+    ssize_t writeTo(int fd);
+
+    // 供异步 I/O 后端（io_uring）使用：填充最多 max 个待发送 iovec，返回个数；
+    // 完成后调用 consume() 推进。两次调用之间只允许在队尾追加。
+    // 遇到文件片段即停止，此时 file_follows 置为 true，发送时应带 MSG_MORE，
+    // 让帧头与随后的文件内容合并成段，而不是被 Nagle 拖住一个延迟 ACK
+    size_t prepareIov(iovec* iov, size_t max,
+                      bool* file_follows = nullptr) const;
+    void consume(size_t n) { advance(n); }
+    // 队首是文件片段时给出尚未发送的区域，否则返回 false
+    bool frontFile(int& fd, uint64_t& offset, size_t& remaining) const;
+
+    // 单次 sendmsg 最多提交的 iovec 数（远小于 IOV_MAX，保证栈上数组足够小）
+    static constexpr size_t kMaxIov = 64;
+    // 单次 sendfile 的字节上限，让 writeTo 的返回值及时反映进度
+    static constexpr size_t kMaxSendfileChunk = 4 * 1024 * 1024;
+
+    bool empty() const { return count_ == 0; }
+    size_t pendingBytes() const { return pending_bytes_; }
+
+   private:
+    // 文件片段持有的描述符：片段复位（移动赋值）或销毁时关闭
+    class FileHandle {
+       public:
+        FileHandle() = default;
+        explicit FileHandle(int fd) : fd_(fd) {}
+        FileHandle(FileHandle&& other) noexcept : fd_(other.release()) {}
+        FileHandle& operator=(FileHandle&& other) noexcept;
+        ~FileHandle() { reset(); }
+
+        int get() const { return fd_; }
+        int release() {
+            int fd = fd_;
+            fd_ = -1;
+            return fd;
+        }
+        void reset();
+
+       private:
+        int fd_ = -1;
+    };
+
+    struct Segment {
+        enum class Kind : uint8_t { Inline, Owned, Borrowed, Pooled, File };
+        Kind kind = Kind::Inline;
+        uint8_t inline_size = 0;
+        uint8_t inline_data[8];
+        std::string owned;
+        PoolBuffer pooled;
+        FileHandle file;
+        uint64_t file_offset = 0;           // File 时为区域起点
+        const uint8_t* borrowed = nullptr;  // Pooled 时指向 pooled.data()，File 时为空
+        size_t borrowed_size = 0;           // Pooled 时为有效字节数，File 时为区域长度
+
+        const uint8_t* data() const;
+        size_t size() const;
+    };
+
+    static constexpr size_t kNoFrame = SIZE_MAX;
+    static constexpr size_t kInitialSegments = 16;
+
+    Segment& pushSegment();
+    void popSegment();
+    void growRing();
+    void appendInline(const void* data, size_t size);
+    void appendSegmentData(const uint8_t* data, size_t size);
+    void accumulateChecksum(const uint8_t* data, size_t size);
+    void advance(size_t n);
+    ssize_t sendFileTo(int fd);
+
+    // 环形数组：容量为 2 的幂，[head_, head_ + count_) 为有效片段
+    std::vector<std::unique_ptr<Segment>> ring_;
+    size_t head_ = 0;
+    size_t count_ = 0;
+    size_t head_offset_ = 0;  // 队首片段已发送的字节数
+    size_t pending_bytes_ = 0;
+
+    // 正在构建的帧：帧头片段在 ring_ 中的下标，扩容时随之重排
+    size_t frame_header_ = kNoFrame;
+    uint32_t frame_length_ = 0;
+    uint32_t frame_checksum_ = 0;
+    bool frame_crc32c_ = false;
+};
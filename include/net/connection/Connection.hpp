@@ -1,13 +1,32 @@
 // Connection.hpp
 #pragma once
-#include <mutex>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
 
-#include "net/protocol/BaseProtocol.hpp"
+#include "net/protocol/TcpProtocol.hpp"
 
+// 连接级超时（毫秒，0 表示不启用），由持有时间轮的线程按这些参数检查
+struct ConnectionTimeouts {
+    int64_t idle_ms = 0;                // 没有新请求且没有待发数据
+    int64_t read_ms = 0;                // 半帧从开始接收到收全
+    int64_t write_ms = 0;               // 有待发数据但发送没有进展
+    int64_t heartbeat_interval_ms = 0;  // 多久收不到任何数据就发 ping
+    int64_t heartbeat_timeout_ms = 0;   // ping 发出后等待任何数据的上限
+
+    bool enabled() const {
+        return idle_ms > 0 || read_ms > 0 || write_ms > 0 ||
+               heartbeat_interval_ms > 0;
+    }
+};
 
 class Connection {
    public:
     explicit Connection(int fd);
+    // epoll_fd < 0 表示由非 epoll 的 I/O 后端（io_uring）驱动
     Connection(int fd, int epoll_fd);
     ~Connection();
 
@@ -18,15 +37,112 @@ class Connection {
     Connection& operator=(Connection&&) = delete;
 
     int getFd() const { return fd_; }
-    bool handleRead();   // 处理读事件（线程安全）
-    bool handleWrite();  // 处理写事件（线程安全）
+    // 关闭 socket（幂等）；析构时若尚未关闭也会调用
+    void close();
+    // fd 已在别处关闭时只更新状态，不再 close
+    void markClosed() { closed_ = true; }
+    // 连接表为每次 fd 复用分配的代号，用于识别过期的 (fd, 连接) 引用
+    uint32_t generation() const { return generation_; }
+    void setGeneration(uint32_t generation) { generation_ = generation; }
+    // handle* 不加锁：同一连接同一时刻只会被一个线程处理
+    // （多 Reactor 模式下是所属 Reactor，线程池模式下是绑定的工作线程）
+    bool handleRead();   // 处理读事件
+    bool handleWrite();  // 处理写事件
+    // 由 I/O 后端收取的数据交给连接解析并处理
+    bool handleData(std::span<const uint8_t> data);
+    // 供 I/O 后端直接访问发送队列，调用方需保证与 handle* 不并发
+    TcpProtocol& protocol() { return proto_; }
+
+    /*
+    发送反压：待发字节数达到高水位时暂停读取（epoll 去掉 EPOLLIN，
+    io_uring 由后端取消 recv），对端读走数据、降到低水位以下后恢复。
+    对端只发不收时，每个连接占用的内存止于高水位附近，不会无限增长。
+    high 为 0 表示不限制
+    */
+    void setSendWatermarks(size_t high, size_t low) {
+        send_high_watermark_ = high;
+        send_low_watermark_ = low < high ? low : high;
+    }
+    bool readingPaused() const {
+        return reading_paused_.load(std::memory_order_relaxed);
+    }
+    // 发送有进展后调用：已暂停且降到低水位时恢复读取并返回 true，
+    // 调用方随后需处理暂停期间已缓冲的数据
+    bool maybeResumeReading();
+
+    // 批量传输（0xABD0）可访问的根目录，空表示不开启（请求一律回复 Denied）
+    void setBulkRoot(std::string_view root) { bulk_root_ = root; }
+
+    // 线程池模式下连接绑定的工作线程
+    size_t worker() const { return worker_; }
+    void setWorker(size_t worker) { worker_ = worker; }
+
+    /*
+    事件合并调度（线程池模式）：
+    - I/O 线程调用 addPendingEvents 合并就绪事件，返回 true 时才需要投递处理任务，
+      任务已在途时事件只会并入，不会产生第二个任务
+    - 处理任务循环 takePendingEvents 取出事件处理，直到 finishScheduled 返回 true
+    由此同一连接的处理天然串行，不需要互斥锁
+    */
+    bool addPendingEvents(uint32_t events);
+    uint32_t takePendingEvents();
+    bool finishScheduled();
+    // 线程池模式下由 I/O 线程请求工作线程发送 ping
+    // （借用 EPOLLONESHOT 位，epoll_wait 不会返回它）
+    static constexpr uint32_t kHeartbeatEvent = 1u << 30;
+
+    /*
+    超时检查：读写路径只更新下面的时间戳（relaxed 原子量，处理线程写），
+    持有时间轮的线程到期时调用 checkTimeouts 读取并判断，
+    线程池模式下两者不是同一个线程，动作（关闭 / 发 ping）仍交给连接所属线程执行
+    */
+    enum class TimeoutAction { None, SendPing, Close };
+    struct TimeoutCheck {
+        TimeoutAction action = TimeoutAction::None;
+        const char* reason = nullptr;  // Close 时为超时类型
+        int64_t next_check_ms = 0;     // 下一次需要检查的时刻，0 表示不再检查
+    };
+    // 返回 SendPing 时同时记下 ping 的发出时间
+    TimeoutCheck checkTimeouts(const ConnectionTimeouts& timeouts,
+                               int64_t now_ms);
+    // 入队一个 ping 控制帧；epoll 后端立即尝试发送，io_uring 后端由调用方提交
+    bool sendPing();
+    // io_uring 后端发送完成后调用，更新写进度
+    void onBytesSent(size_t bytes);
 
    private:
     const int fd_;              // 使用 const 防止意外修改
     int epoll_fd_;              // epoll 实例描述符
-    BaseProtocol proto_;            // 协议处理器（内部管理发送/接收缓冲区）
-    mutable std::mutex mutex_;  // 保护协议操作
+    TcpProtocol proto_;         // 协议处理器（内部管理发送/接收缓冲区）
+    uint32_t epoll_events_;     // 当前注册的 epoll 事件
+    bool closed_ = false;
+    uint32_t generation_ = 0;
+    size_t worker_ = 0;
+    // 低位为待处理的 epoll 事件，kScheduled 表示已有处理任务在途
+    // （epoll_wait 返回的事件不会带 EPOLLET 位，借用最高位）
+    static constexpr uint32_t kScheduled = 1u << 31;
+    std::atomic<uint32_t> pending_events_{0};
+    size_t send_high_watermark_ = 0;
+    size_t send_low_watermark_ = 0;
+    std::string bulk_root_;
+    // 处理线程写；超时检查线程读，暂停期间不计读超时和心跳
+    std::atomic<bool> reading_paused_{false};
+    // 活动时间戳（TimerWheel::nowMs 时间基，0 表示当前没有）
+    std::atomic<int64_t> last_request_ms_;            // 最近一次处理业务请求
+    std::atomic<int64_t> last_receive_ms_;            // 最近一次收到任何数据
+    std::atomic<int64_t> partial_since_ms_{0};        // 当前半帧开始接收的时刻
+    std::atomic<int64_t> write_stalled_since_ms_{0};  // 待发数据最近一次有进展的时刻
+    std::atomic<int64_t> ping_sent_ms_{0};            // 尚未得到回应的 ping
 
-    /** 根据 want_write 决定是否在 epoll 事件里加上 EPOLLOUT */
+    /** 根据 want_write 决定是否加上 EPOLLOUT，读取暂停时去掉 EPOLLIN */
     void modifyEpollEvents(bool want_write);
+    // 循环解析并处理请求；read_socket 为 false 时只解析已缓冲的数据
+    bool processRequests(bool read_socket);
+    // 业务处理：生成响应并放入发送队列
+    void handleRequest(const PacketView& request);
+    // 控制帧：ping 回复 pong，pong 只作为存活信号
+    void handleControl(const PacketView& frame);
+    // 批量传输请求：响应帧之后追加文件区域，由发送路径 sendfile / splice
+    void handleBulkRequest(const PacketView& request);
+    void updateWriteProgress(int64_t now_ms, bool progressed);
 };
\ No newline at end of file
@@ -1,22 +1,78 @@
 #pragma once  // 防止头文件重复包含
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
-#include <shared_mutex>
-#include <unordered_map>
+#include <vector>
 
-#include "net/Connection.hpp"
+#include "net/connection/Connection.hpp"
+#include "threading/EpochReclaimer.hpp"
 
+/*
+按 fd 直接索引的连接表：
+- 两级数组：fd 高位选块、低位选槽，块按需分配且一经分配不再移动
+- 查找只有一次原子读，不加锁、不复制 shared_ptr；返回的裸指针在调用方的
+  EpochGuard 作用域内有效
+- 每次 fd 被复用时分配新的 generation（保存在 Connection 中），
+  投递到线程池的任务可用 (fd, generation) 重新查找以识别过期连接
+- 删除时立即关闭 fd，Connection 对象本身交给 EpochReclaimer 延迟释放
+写操作（add/remove）同一 fd 只会由一个线程执行（接受连接的线程或连接所属线程）
+*/
 class ConnectionManager {
    public:
-    void addConnection(int fd, std::shared_ptr<Connection> conn);
+    ConnectionManager();
+    ~ConnectionManager();
+
+    ConnectionManager(const ConnectionManager&) = delete;
+    ConnectionManager& operator=(const ConnectionManager&) = delete;
+
+    // 返回分配给该连接的 generation；fd 超出范围时返回 0 并销毁连接
+    uint32_t addConnection(int fd, std::unique_ptr<Connection> conn);
     void removeConnection(int fd);
-    std::shared_ptr<Connection> getConnection(int fd) const;
-    const std::unordered_map<int, std::shared_ptr<Connection>>&
-    getAllConnections() const {
-        return connections_;
+    // 以下查找需在 EpochGuard 作用域内调用
+    Connection* getConnection(int fd) const;
+    // generation 不匹配（fd 已被新连接复用）时返回 nullptr
+    Connection* getConnection(int fd, uint32_t generation) const;
+
+    size_t size() const { return count_.load(std::memory_order_relaxed); }
+
+    // 遍历所有连接（关闭时使用）：可在遍历过程中删除当前连接
+    template <typename Fn>
+    void forEach(Fn&& fn) const {
+        EpochGuard guard;
+        for (size_t c = 0; c < kMaxChunks; ++c) {
+            Chunk* chunk = chunks_[c].load(std::memory_order_acquire);
+            if (!chunk) continue;
+            for (size_t i = 0; i < kChunkSize; ++i) {
+                Connection* conn =
+                    chunk->slots[i].conn.load(std::memory_order_acquire);
+                if (conn) {
+                    fn(static_cast<int>((c << kChunkBits) | i), conn);
+                }
+            }
+        }
     }
+    // 拷贝出当前所有 fd，便于调用方在遍历后逐个清理
+    std::vector<int> getAllFds() const;
 
    private:
-    mutable std::shared_mutex mutex_;
-    std::unordered_map<int, std::shared_ptr<Connection>> connections_;
+    static constexpr size_t kChunkBits = 10;
+    static constexpr size_t kChunkSize = size_t(1) << kChunkBits;
+    static constexpr size_t kMaxFds = size_t(1) << 22;
+    static constexpr size_t kMaxChunks = kMaxFds / kChunkSize;
+
+    struct Slot {
+        std::atomic<Connection*> conn{nullptr};
+        uint32_t next_generation = 1;  // 仅写者访问
+    };
+    struct Chunk {
+        Slot slots[kChunkSize];
+    };
+
+    Slot* slotFor(int fd) const;
+    Slot* slotForWrite(int fd);
+
+    std::unique_ptr<std::atomic<Chunk*>[]> chunks_;
+    std::atomic<size_t> count_{0};
 };
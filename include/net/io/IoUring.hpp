@@ -0,0 +1,101 @@
+// IoUring.hpp
+#pragma once
+#include <linux/io_uring.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/*
+io_uring 的最小封装，直接使用内核 ABI（io_uring_setup / io_uring_enter / io_uring_register），
+不依赖 liburing。只覆盖本项目用到的功能：
+- SQ/CQ 环的映射、取 SQE、批量提交、遍历 CQE
+- provided buffer ring（IORING_REGISTER_PBUF_RING），供 multishot recv 自动选取缓冲区
+非线程安全：一个 IoUring 只在所属 Reactor 线程内使用
+*/
+class IoUring {
+   public:
+    IoUring() = default;
+    ~IoUring();
+
+    IoUring(const IoUring&) = delete;
+    IoUring& operator=(const IoUring&) = delete;
+
+    // 创建 SQ 深度为 entries 的环；失败返回 false 并保留 errno
+    bool init(unsigned entries);
+    // 探测当前内核/容器是否提供本项目需要的全部功能：io_uring 本身可用、
+    // 用到的请求类型都支持（含 6.0 的 multishot recv），且能注册 provided buffer ring
+    static bool isSupported();
+
+    // 取一个空闲 SQE（已清零）；SQ 满时先把已有 SQE 提交给内核
+    io_uring_sqe* getSqe();
+    // 提交所有待提交的 SQE，并至少等待 wait_nr 个完成事件
+    int submitAndWait(unsigned wait_nr);
+
+    // 遍历并消费当前所有 CQE，返回处理的个数
+    template <typename Fn>
+    unsigned forEachCqe(Fn&& fn) {
+        unsigned head = *cq_head_;
+        unsigned tail = std::atomic_ref<unsigned>(*cq_tail_).load(
+            std::memory_order_acquire);
+        unsigned count = 0;
+        while (head != tail) {
+            fn(cqes_[head & cq_mask_]);
+            ++head;
+            ++count;
+        }
+        std::atomic_ref<unsigned>(*cq_head_).store(head,
+                                                   std::memory_order_release);
+        return count;
+    }
+
+    // 注册 provided buffer ring：count 个（2 的幂）大小为 size 的缓冲区，组号 group_id
+    bool setupBufferRing(uint16_t group_id, unsigned count, unsigned size);
+    uint8_t* bufferAddress(uint16_t bid) const {
+        return buffers_ + size_t(bid) * buffer_size_;
+    }
+    unsigned bufferSize() const { return buffer_size_; }
+    // 把用完的缓冲区归还给内核
+    void recycleBuffer(uint16_t bid);
+
+   private:
+    int ring_fd_ = -1;
+
+    // SQ
+    void* sq_ring_ptr_ = nullptr;
+    size_t sq_ring_size_ = 0;
+    unsigned* sq_head_ = nullptr;
+    unsigned* sq_tail_ = nullptr;
+    unsigned* sq_array_ = nullptr;
+    unsigned sq_mask_ = 0;
+    unsigned sq_entries_ = 0;
+    io_uring_sqe* sqes_ = nullptr;
+    size_t sqes_size_ = 0;
+    unsigned sqe_tail_ = 0;  // 本地已填充但尚未发布的 SQE 尾
+    unsigned sqe_submitted_ = 0;
+
+    // CQ
+    void* cq_ring_ptr_ = nullptr;
+    size_t cq_ring_size_ = 0;
+    unsigned* cq_head_ = nullptr;
+    unsigned* cq_tail_ = nullptr;
+    unsigned cq_mask_ = 0;
+    io_uring_cqe* cqes_ = nullptr;
+
+    // provided buffer ring
+    io_uring_buf_ring* buf_ring_ = nullptr;
+    size_t buf_ring_size_ = 0;
+    uint8_t* buffers_ = nullptr;
+    size_t buffers_size_ = 0;
+    unsigned buffer_count_ = 0;
+    unsigned buffer_size_ = 0;
+    uint16_t buf_ring_tail_ = 0;
+
+    unsigned flushSq();
+    // uapi 头文件的 bufs 是 __DECLARE_FLEX_ARRAY，在 C++ 下空结构体占 1 字节，
+    // 导致 bufs 偏移为 8 而不是 0；这里按内核布局直接把环当作 io_uring_buf 数组访问
+    io_uring_buf& bufRingEntry(unsigned index) {
+        return reinterpret_cast<io_uring_buf*>(buf_ring_)[index &
+                                                          (buffer_count_ - 1)];
+    }
+};
@@ -0,0 +1,141 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+/*
+PacketSecure 的 payload 压缩
+- 算法：LZ4（默认，速度优先），zstd（可选，压缩率更高，并提供字典训练）
+  编译时分别由 MCS_HAVE_LZ4 / MCS_HAVE_ZSTD 开启（CMake 找到对应库时定义），
+  未开启的算法 isAvailable() 返回 false：发送方原样发送，接收方拒绝该算法压缩的包
+- 阈值：payload 小于 Options::min_size 时不压缩，小包压缩收益低于帧开销和 CPU 成本
+- 三种上下文，由编码后的标志位区分，接收方据此选择解码方式：
+    无状态       每个包独立压缩，可以任意顺序、在任意连接上解码
+    字典         以训练出的共享字典为初始历史（payload 前 4 字节为字典 id），重复结构的小包收益最大
+    流式         每连接一个 Compressor / Decompressor，后一个包可以引用此前所有包（及字典）的内容；
+                 包必须按发送顺序在同一连接上解码，任何一个包解码失败后该连接的流即不可用
+- 压缩 / 解压的字节数与耗时计入 Metrics，运维据此按真实流量调整阈值
+*/
+namespace compression {
+
+enum class Algorithm : uint8_t { Lz4, Zstd };
+
+// 编码后写入 PacketSecure Flags 的标志位（与 PacketSecure::SecurityFlags 一致）
+constexpr uint8_t kFlagCompressed = 0x01;
+constexpr uint8_t kFlagZstd = 0x04;        // 未置位为 LZ4
+constexpr uint8_t kFlagStream = 0x08;      // 依赖连接上的流式上下文
+constexpr uint8_t kFlagDictionary = 0x10;  // payload 以 4 字节大端字典 id 开头
+
+constexpr size_t kDefaultMinSize = 256;
+constexpr size_t kDefaultDictionaryCapacity = 64 * 1024;
+
+bool isAvailable(Algorithm algorithm);
+const char* algorithmName(Algorithm algorithm);
+
+// 共享字典：创建后只读，可被多个连接、多个线程同时使用
+class Dictionary {
+   public:
+    ~Dictionary();
+    Dictionary(const Dictionary&) = delete;
+    Dictionary& operator=(const Dictionary&) = delete;
+
+    // 以原始内容作为字典（LZ4 只使用末尾 64KB）；zstd_level 用于预处理 zstd 压缩字典
+    static std::shared_ptr<const Dictionary> create(std::string content,
+                                                    int zstd_level = 0);
+    // 从抓取的流量样本训练：有 zstd 时用 ZDICT 训练，否则按新到旧拼接样本直到 capacity；
+    // 样本为空或训练失败返回 nullptr
+    static std::shared_ptr<const Dictionary> train(
+        const std::vector<std::string>& samples,
+        size_t capacity = kDefaultDictionaryCapacity, int zstd_level = 0);
+    // 字典文件就是字典内容本身，可与 `zstd --train` 的输出互换
+    static std::shared_ptr<const Dictionary> load(const std::string& path,
+                                                  int zstd_level = 0);
+    bool save(const std::string& path) const;
+
+    // 内容的 CRC32C（非 0），收发双方据此确认使用的是同一份字典
+    uint32_t id() const { return id_; }
+    const std::string& content() const { return content_; }
+
+    struct Native;  // 各算法预处理后的字典，实现细节
+    const Native& native() const { return *native_; }
+
+   private:
+    Dictionary(std::string content, int zstd_level);
+
+    std::string content_;
+    uint32_t id_ = 0;
+    std::unique_ptr<Native> native_;
+};
+
+struct Options {
+    Algorithm algorithm = Algorithm::Lz4;
+    size_t min_size = kDefaultMinSize;  // 小于它的 payload 不压缩
+    int level = 0;           // LZ4 为加速因子，zstd 为压缩级别；0 为各自默认值
+    bool streaming = false;  // 启用连接级流式上下文
+    std::shared_ptr<const Dictionary> dictionary;  // 可选
+};
+
+// 发送方向的压缩上下文，每连接一个；不是线程安全的
+class Compressor {
+   public:
+    explicit Compressor(Options options = {});
+    ~Compressor();
+    Compressor(const Compressor&) = delete;
+    Compressor& operator=(const Compressor&) = delete;
+
+    // 成功时 out 为编码后的 payload，flags 为需要写进包头的标志位（含 kFlagCompressed）；
+    // 小于阈值、算法不可用，或非流式下压缩后不比原文小时返回 false，调用方原样发送。
+    // 流式上下文一旦压缩了某个包，即使结果更大也必须发送，接收方的历史才能保持一致
+    bool compress(std::span<const uint8_t> in, std::string& out,
+                  uint8_t& flags);
+
+    const Options& options() const { return options_; }
+
+   private:
+    struct Stream;
+
+    bool compressStream(std::span<const uint8_t> in, std::string& out,
+                        uint8_t& flags);
+
+    Options options_;
+    std::unique_ptr<Stream> stream_;  // 第一个流式包时创建
+};
+
+// 接收方向的解压上下文，每连接一个；不是线程安全的
+class Decompressor {
+   public:
+    Decompressor();
+    ~Decompressor();
+    Decompressor(const Decompressor&) = delete;
+    Decompressor& operator=(const Decompressor&) = delete;
+
+    // 登记对端可能使用的字典，按 id 查找
+    void addDictionary(std::shared_ptr<const Dictionary> dictionary);
+
+    // 按 flags 还原 payload，结果长度必须恰为 raw_length；失败返回 false
+    bool decompress(uint8_t flags, std::span<const uint8_t> in,
+                    size_t raw_length, std::string& out);
+
+   private:
+    struct Stream;
+
+    const Dictionary* findDictionary(uint32_t id) const;
+    bool decompressStream(uint8_t flags, std::span<const uint8_t> in,
+                          size_t raw_length, std::string& out);
+
+    std::vector<std::shared_ptr<const Dictionary>> dictionaries_;
+    std::unique_ptr<Stream> stream_;
+};
+
+// 无状态压缩（不使用流式上下文），供不持有连接上下文的调用方使用
+bool compress(const Options& options, std::span<const uint8_t> in,
+              std::string& out, uint8_t& flags);
+// 解码无状态包；带 kFlagStream 的包需要连接的 Decompressor，这里返回 false
+bool decompress(uint8_t flags, std::span<const uint8_t> in, size_t raw_length,
+                std::string& out,
+                const Dictionary* dictionary = nullptr);
+
+}  // namespace compression
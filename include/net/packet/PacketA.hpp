@@ -3,6 +3,7 @@
 #include "net/packet/BasePacket.hpp"
 #include <cstring>  // memcpy
 #include <memory>
+#include <span>
 /*
 +------------+--------+-----------+------------+----------------+------------+
 | TypeID(2) | Ver(1) | Magic(2B)  | Length(4B) | Payload(n字节) | Checksum(2B)|
@@ -14,15 +15,23 @@ class PacketA : public BasePacket {
         static constexpr uint8_t VERSION = 1;
         static constexpr uint16_t MAGIC = 0xABCD;
     
+        // 零拷贝解码结果：payload 指向原始数据内部，在原始数据释放前有效
+        struct View {
+            std::span<const uint8_t> payload;
+        };
+
         std::vector<uint8_t> payload;
     
         PacketA() = default;
         explicit PacketA(std::vector<uint8_t> p);
     
         uint16_t getTypeID() const override;
+        uint8_t getVersion() const override;
         std::vector<uint8_t> serialize() const override;
         
+        // 原地校验并解码到 view，不分配内存；格式非法返回 false
+        static bool decode(std::span<const uint8_t> raw, View& view);
         // 反序列化，成功则返回PacketA智能指针，失败返回nullptr
         static std::shared_ptr<BasePacket> deserialize(const std::vector<uint8_t>& raw);
-        static uint16_t calculateChecksum(const std::vector<uint8_t>& data);
+        static uint16_t calculateChecksum(std::span<const uint8_t> data);
 };
\ No newline at end of file
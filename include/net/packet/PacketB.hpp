@@ -3,6 +3,7 @@
 #include "net/packet/BasePacket.hpp"
 #include <cstring>  // memcpy
 #include <memory>
+#include <span>
 /*
 +------------+--------+------------+----------------+
 | TypeID(2) | Ver(1) | Length(4B) | Payload(n字节) | 
@@ -12,14 +13,22 @@ class PacketB : public BasePacket {
     public:
         static constexpr uint16_t TYPE_ID = 0x1002;
         static constexpr uint8_t VERSION = 2;
+        // 零拷贝解码结果：payload 指向原始数据内部，在原始数据释放前有效
+        struct View {
+            std::span<const uint8_t> payload;
+        };
+
         std::vector<uint8_t> payload;
     
         PacketB() = default;
         explicit PacketB(std::vector<uint8_t> p);
     
         uint16_t getTypeID() const override;
+        uint8_t getVersion() const override;
         std::vector<uint8_t> serialize() const override;
         
-        // 反序列化，成功则返回PacketA智能指针，失败返回nullptr
+        // 原地校验并解码到 view，不分配内存；格式非法返回 false
+        static bool decode(std::span<const uint8_t> raw, View& view);
+        // 反序列化，成功则返回PacketB智能指针，失败返回nullptr
         static std::shared_ptr<BasePacket> deserialize(const std::vector<uint8_t>& raw);
 };
\ No newline at end of file
@@ -1,17 +1,84 @@
-#include <memory>
+#pragma once
+#include <cstdint>
 #include <functional>
+#include <memory>
+#include <span>
+#include <unordered_map>
+#include <variant>
 #include <vector>
+
 #include "net/packet/BasePacket.hpp"
+#include "net/packet/PacketA.hpp"
+#include "net/packet/PacketB.hpp"
+#include "net/packet/PacketSecure.hpp"
+
+/*
+编译期确定的包类型分发：
+- 类型列表在编译期给定，按 TypeID 选中类型后直接调用其静态 decode，没有 std::function、
+  虚函数和哈希查找（TypeID 比较链由编译器展开，可生成跳转表）
+- 解码结果写入调用方提供的 std::variant，每个类型的 View 只引用原始数据，
+  整个过程不分配内存；用 std::visit 处理结果
+- 每个类型需要提供 TYPE_ID、嵌套的 View 结构和 static bool decode(span, View&)
+*/
+template <typename... Packets>
+class StaticPacketDispatch {
+   public:
+    // monostate 表示没有解码出任何类型
+    using Decoded = std::variant<std::monostate, typename Packets::View...>;
+
+    static constexpr bool contains(uint16_t type_id) {
+        return ((type_id == Packets::TYPE_ID) || ...);
+    }
+
+    // 未知类型或格式非法返回 false，out 置为 monostate
+    static bool decode(std::span<const uint8_t> data, Decoded& out) {
+        if (data.size() >= 2) {
+            uint16_t type_id = static_cast<uint16_t>((data[0] << 8) | data[1]);
+            if ((decodeAs<Packets>(type_id, data, out) || ...)) return true;
+        }
+        out.template emplace<std::monostate>();
+        return false;
+    }
+
+   private:
+    static constexpr bool uniqueTypeIds() {
+        constexpr uint16_t ids[] = {Packets::TYPE_ID...};
+        for (size_t i = 0; i < sizeof...(Packets); ++i) {
+            for (size_t j = i + 1; j < sizeof...(Packets); ++j) {
+                if (ids[i] == ids[j]) return false;
+            }
+        }
+        return true;
+    }
+    static_assert(uniqueTypeIds(), "duplicate packet TYPE_ID");
+
+    template <typename P>
+    static bool decodeAs(uint16_t type_id, std::span<const uint8_t> data,
+                         Decoded& out) {
+        if (type_id != P::TYPE_ID) return false;
+        return P::decode(data, out.template emplace<typename P::View>());
+    }
+};
 
 class PacketFactory {
     public:
+        // 内置包类型：走静态分发
+        using BuiltinTypes = StaticPacketDispatch<PacketA, PacketB, PacketSecure>;
+        using Decoded = BuiltinTypes::Decoded;
         using Deserializer = std::function<std::shared_ptr<BasePacket>(const std::vector<uint8_t>&)>;
 
         static PacketFactory& instance();
-        
+
+        // 常用路径：内置类型零分配解码，payload 以视图形式给出（生命周期同 data）；
+        // 返回 false 且 TypeID 不属于内置类型时，可再交给 tryDeserialize 走插件注册的类型
+        static bool decode(std::span<const uint8_t> data, Decoded& out) {
+            return BuiltinTypes::decode(data, out);
+        }
+
+        // 扩展路径：运行期注册的插件类型，每个包分配一个对象
         void registerType(uint16_t typeID, Deserializer deserializer);
         std::shared_ptr<BasePacket> tryDeserialize(const std::vector<uint8_t>& data);
-    
+
     private:
         std::unordered_map<uint16_t, Deserializer> registry_;
-};
\ No newline at end of file
+};
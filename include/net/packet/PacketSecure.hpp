@@ -1,9 +1,11 @@
 #pragma once
 #include <sys/types.h>
 #include "net/packet/BasePacket.hpp"
+#include "net/packet/Compression.hpp"
 #include <cstdint>
 #include <string>
 #include <memory>
+#include <span>
 #include <vector>
 /*
 +-----------+---------+--------+--------+------------+-------------+
@@ -13,20 +15,42 @@ TypeID (2 字节)：固定格式，用于识别 packet 类型。
 Flags (1 字节)：
     Bit 0: 是否压缩
     Bit 1: 是否加密
+    Bit 2: 压缩算法为 zstd（未置位为 LZ4）
+    Bit 3: 压缩依赖连接上的流式上下文，必须按序在同一连接上解码
+    Bit 4: 压缩使用了共享字典，编码后的 payload 以 4 字节字典 id 开头
 Len (4 字节)：原始 payload 长度（未压缩、未加密的长度）
-IV (16 字节)：加密使用的初始化向量（例如用于 AES）
-Payload (n 字节)：经过压缩/加密后的数据
-Checksum (2 字节)：用于校验（可用 CRC 或简单校验）
+IV (16 字节)：加密使用的初始化向量（例如用于 AES），未加密时全零
+Payload (n 字节)：经过压缩/加密后的数据，长度 = 总长度 - 25
+Checksum (2 字节)：编码后 payload 的字节和（sum16）
 */
 class PacketSecure : public BasePacket {
     public:
         static constexpr uint16_t TYPE_ID = 0x2001;
         static constexpr uint8_t CURRENT_VERSION = 1;
+        static constexpr size_t IV_SIZE = 16;
+        // TypeID + Flags + Len + IV + Checksum
+        static constexpr size_t OVERHEAD = 2 + 1 + 4 + IV_SIZE + 2;
+        // 还原后的 payload 上限，与 TCP 帧的上限一致，防止伪造的 Len 触发超大分配
+        static constexpr size_t MAX_RAW_LENGTH = 64 * 1024 * 1024;
 
         // 标志位定义
+        // COMPRESSED 由调用方设置，表示希望压缩；其余压缩相关的位由 serialize 按实际编码写出，
+        // 小于阈值或压缩无收益时线上的 COMPRESSED 位会被清除
         enum class SecurityFlags : uint8_t {
-            COMPRESSED = 0x01,
-            ENCRYPTED = 0x02
+            COMPRESSED = compression::kFlagCompressed,
+            ENCRYPTED = 0x02,
+            COMPRESSED_ZSTD = compression::kFlagZstd,
+            COMPRESSED_STREAM = compression::kFlagStream,
+            COMPRESSED_DICT = compression::kFlagDictionary
+        };
+
+        // 零拷贝解码结果：iv/payload 指向原始数据内部，在原始数据释放前有效；
+        // payload 是线上的编码形式，带压缩/加密标志时需由调用方还原
+        struct View {
+            uint8_t flags = 0;
+            uint32_t raw_length = 0;  // 还原后的 payload 长度
+            std::span<const uint8_t> iv;
+            std::span<const uint8_t> payload;
         };
 
         uint8_t version = CURRENT_VERSION;
@@ -41,8 +65,8 @@ class PacketSecure : public BasePacket {
                             uint8_t ver = CURRENT_VERSION);
         
         // 实现基类接口
-        uint16_t getTypeID() const override { return TYPE_ID };
-        uint8_t getVersion() const override { return version };
+        uint16_t getTypeID() const override { return TYPE_ID; }
+        uint8_t getVersion() const override { return version; }
         
         // 标志位操作API
         void setFlag(SecurityFlags flag, bool value) {
@@ -52,8 +76,25 @@ class PacketSecure : public BasePacket {
         bool hasFlag(SecurityFlags flag) const {
             return flags & static_cast<uint8_t>(flag);
         }
+        // 设置了 COMPRESSED 时按默认 Options（LZ4、无状态）压缩
         std::vector<uint8_t> serialize() const override;
+        // 使用连接的压缩上下文（算法、阈值、字典、流式均由 compressor 决定）
+        std::vector<uint8_t> serialize(compression::Compressor& compressor) const;
     
+        // 原地校验并解码到 view，不分配内存；格式非法返回 false
+        static bool decode(std::span<const uint8_t> data, View& view);
+        // 把 view 的 payload 还原为原始内容；流式包需要传入连接的 decompressor。
+        // 加密的包、解压失败或长度不符返回 false
+        static bool restorePayload(const View& view, std::string& out,
+                                   compression::Decompressor* decompressor = nullptr);
         static std::shared_ptr<BasePacket> deserialize(const std::vector<uint8_t>& data);
+        static std::shared_ptr<BasePacket> deserializeWith(
+            const std::vector<uint8_t>& data, compression::Decompressor& decompressor);
+
+    private:
+        std::vector<uint8_t> encode(std::span<const uint8_t> payload,
+                                    uint8_t wire_flags) const;
+        static std::shared_ptr<BasePacket> deserializeImpl(
+            const std::vector<uint8_t>& data, compression::Decompressor* decompressor);
 };
     
\ No newline at end of file
@@ -1,5 +1,5 @@
 #pragma once
-#include "net/packet/BasePacket.hpp"
+#include "net/Packet.hpp"
 
 class BaseProtocol {
     public:
@@ -7,8 +7,8 @@ class BaseProtocol {
 
         virtual ~BaseProtocol() = default;
 
-        virtual ReadStatus tryReceivePacket(BasePacket& pkt) = 0;
-        virtual void enqueuePacket(const BasePacket& pkt) = 0;
+        virtual ReadStatus tryReceivePacket(Packet& pkt) = 0;
+        virtual void enqueuePacket(const Packet& pkt) = 0;
         virtual bool flushSendBuffer(int& saved_errno) = 0;
         virtual bool hasPendingSendData() const = 0;
 };
\ No newline at end of file
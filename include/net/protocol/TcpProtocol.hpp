@@ -1,6 +1,7 @@
 #pragma once  // 防止头文件重复包含
-#include <vector>
-
+#include "net/PacketView.hpp"
+#include "net/buffer/RecvBuffer.hpp"
+#include "net/buffer/SendQueue.hpp"
 #include "net/protocol/BaseProtocol.hpp"
 
 class TcpProtocol : public BaseProtocol {
@@ -15,16 +16,66 @@ class TcpProtocol : public BaseProtocol {
 
     // enum class ReadStatus { OK, NeedRetry, Error };
 
-    ReadStatus tryReceivePacket(BasePacket& pkt) override;
-    void enqueuePacket(const BasePacket& pkt) override;
+    // OK：解析出一个完整包；NeedRetry：socket 已读到 EAGAIN 且无完整包；
+    // Error：对端关闭或读错误（关闭前已收到的完整包会先全部返回）
+    ReadStatus tryReceivePacket(Packet& pkt) override;
+    // 零拷贝接收：view.payload 直接指向接收缓冲区，
+    // 在下一次 tryReceiveView/tryReceivePacket 或 releaseView() 之前有效
+    ReadStatus tryReceiveView(PacketView& view);
+    // 提前归还当前视图对应的帧（可选，下一次接收时也会自动归还）
+    void releaseView();
+
+    // 供异步 I/O 后端（io_uring）使用：数据由后端收取后追加到接收缓冲区，
+    // 再用 tryParseView 只解析已缓冲的数据（不读 socket，不会返回 Error 以外的读错误）
+    void appendReceived(std::span<const uint8_t> data);
+    ReadStatus tryParseView(PacketView& view);
+    // 取走接收缓冲区里尚未解析的字节（最多 max 个），返回实际字节数；
+    // 用于帧后跟随的非帧数据（批量传输的文件内容），之后从下一个字节重新按帧解析
+    size_t takeBuffered(void* out, size_t max);
+    // 拷贝 payload 到池化缓冲区入队（一次拷贝，不再先序列化再追加）
+    void enqueuePacket(const Packet& pkt) override;
+    // 转移 payload 所有权入队，零拷贝
+    void enqueuePacket(Packet&& pkt);
+    // 直接构建分段帧，例如借用静态前缀 + 转移所有权的正文：
+    //   auto& out = proto.sendQueue();
+    //   out.beginFrame(0xABCD); out.appendBorrowed(prefix);
+    //   out.appendOwned(std::move(body)); out.endFrame();
+    SendQueue& sendQueue() { return send_queue_; }
     bool flushSendBuffer(int& saved_errno) override;
     // 如果还有没发完的数据，返回 true
-    bool hasPendingSendData() const override { return !send_buffer_.empty(); }
+    bool hasPendingSendData() const override { return !send_queue_.empty(); }
+    size_t pendingSendBytes() const { return send_queue_.pendingBytes(); }
+    // 接收缓冲区里尚未解析成帧的字节数（不含已交给上层的视图），非 0 即有半帧
+    size_t bufferedBytes() const {
+        return recv_buffer_.readableBytes() - pending_consume_;
+    }
+
+    // 单帧 payload 上限，防止恶意长度字段导致无限扩容
+    static constexpr size_t kMaxPayloadLength = 64 * 1024 * 1024;
 
    private:
-    bool parseFromBuffer(std::vector<uint8_t>& buffer, BasePacket& pkt);
+    // 自适应读窗口：一次读满则翻倍，连续小读则减半
+    static constexpr size_t kMinReadSize = 2048;
+    static constexpr size_t kInitialReadSize = 4096;
+    static constexpr size_t kMaxReadSize = 256 * 1024;
+    // 单次排空 socket 的字节预算，缓冲区已有完整帧时达到预算先返回，避免单连接霸占线程
+    static constexpr size_t kMaxBytesPerPass = 1024 * 1024;
+
+    enum class FillStatus { Drained, BudgetExhausted, Closed, Error };
+
+    bool parseFromBuffer(RecvBuffer& buffer, PacketView& view);
+    FillStatus fillFromSocket();
+    bool hasCompleteFrame() const;
+    size_t nextReadSize() const;
+    void adaptReadSize(size_t received, size_t requested);
 
     const int sockfd_;
-    std::vector<uint8_t> send_buffer_;
-    std::vector<uint8_t> recv_buffer_;
-};
\ No newline at end of file
+    SendQueue send_queue_;
+    RecvBuffer recv_buffer_;
+
+    size_t read_size_ = kInitialReadSize;
+    int small_reads_ = 0;
+    size_t expected_frame_size_ = 0;  // 已知头部但未收全的帧总长度，0 表示未知
+    size_t pending_consume_ = 0;      // 已交给上层视图、尚未消费的帧长度
+    bool peer_closed_ = false;
+};
@@ -1,20 +1,135 @@
 #pragma once
-#include "net/protocol/BaseProtocol.hpp"
-#include <vector>
 #include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "net/PacketView.hpp"
+#include "net/buffer/BufferPool.hpp"
+#include "net/protocol/BaseProtocol.hpp"
 
+/*
+批量 UDP 数据报收发（每个数据报承载一个完整帧）：
+- 接收：一次 recvmmsg 收取最多 batch_size 个数据报，直接落在预先从 BufferPool
+  取得的槽位里，稳态下不分配内存；开启 UDP_GRO 时内核把同一对端的等长数据报合并成
+  一个大报文交上来，这里按 cmsg 给出的 gso_size 拆回原始边界
+- 发送：出站数据报依次追加到连续的发送区，flushSendBuffer 用 sendmmsg 一次提交一批；
+  同一对端连续的等长数据报合并成一条消息并附带 UDP_SEGMENT（GSO），由内核 / 网卡切分
+- 内核不支持 GSO / GRO 时自动退回普通的逐报文批量收发
+既可以作为面向单一对端的 BaseProtocol 使用（客户端），
+也可以由服务端在一个未连接的 socket 上与任意多个对端收发
+*/
 class UdpProtocol : public BaseProtocol {
-    public:
-        UdpProtocol(int socket_fd, sockaddr_in peer_addr);
-        ~UdpProtocol();
-
-        ReadStatus tryReceivePacket(BasePacket& pkt) override;
-        void enqueuePacket(const BasePacket& pkt) override;
-        bool flushSendBuffer(int& saved_errno) override;
-        bool hasPendingSendData() const override;
-
-    private:
-        const int sockfd_;
-        sockaddr_in peer_;
-        std::vector<uint8_t> send_buffer_;
-};
\ No newline at end of file
+   public:
+    struct Options {
+        size_t batch_size = 64;       // 每次 recvmmsg / sendmmsg 的最大消息数
+        size_t max_datagram = 2048;   // 不开 GRO 时单个接收槽的大小，超长数据报被丢弃
+        bool gso = true;              // 发送端 UDP_SEGMENT
+        bool gro = true;              // 接收端 UDP_GRO
+    };
+
+    // 收到的一个数据报：data 指向接收槽，在下一次 receiveBatch 之前有效
+    struct Datagram {
+        std::span<const uint8_t> data;
+        sockaddr_in peer;
+    };
+
+    // socket 的所有权转移给 UdpProtocol，析构时关闭
+    explicit UdpProtocol(int socket_fd);
+    UdpProtocol(int socket_fd, const Options& options);
+    // 面向单一对端：BaseProtocol 接口的收发都以 peer 为对象
+    UdpProtocol(int socket_fd, sockaddr_in peer);
+    UdpProtocol(int socket_fd, sockaddr_in peer, const Options& options);
+    ~UdpProtocol();
+
+    UdpProtocol(const UdpProtocol&) = delete;
+    UdpProtocol& operator=(const UdpProtocol&) = delete;
+
+    // BaseProtocol：逐帧收取（内部仍按批次 recvmmsg），非法数据报直接丢弃
+    ReadStatus tryReceivePacket(Packet& pkt) override;
+    // 发往构造时指定的对端
+    void enqueuePacket(const Packet& pkt) override;
+    // sendmmsg 尽量发出全部排队的数据报；EAGAIN 时返回 false 并保留剩余部分
+    bool flushSendBuffer(int& saved_errno) override;
+    bool hasPendingSendData() const override { return out_head_ < out_.size(); }
+
+    /*
+    一次 recvmmsg 收取一批数据报（GRO 合并的已拆开）：
+    OK 表示 datagrams() 非空；NeedRetry 为 EAGAIN；Error 为 socket 错误
+    */
+    ReadStatus receiveBatch();
+    const std::vector<Datagram>& datagrams() const { return in_; }
+
+    // 出站帧直接写进发送区：beginFrame → appendFrame ... → endFrame
+    void beginFrame(const sockaddr_in& peer, uint16_t header);
+    void appendFrame(std::span<const uint8_t> data);
+    // 整帧超过单个数据报的上限时丢弃该帧并返回 false
+    bool endFrame();
+    // 追加一个已经编码好的数据报
+    void enqueueDatagram(const sockaddr_in& peer, std::span<const uint8_t> data);
+    size_t pendingDatagrams() const { return out_.size() - out_head_; }
+
+    int fd() const { return sockfd_; }
+    bool gsoEnabled() const { return gso_; }
+    bool groEnabled() const { return gro_; }
+
+    struct Stats {
+        uint64_t recv_calls = 0;      // recvmmsg 次数
+        uint64_t datagrams_in = 0;    // 收到的数据报（GRO 拆分后计数）
+        uint64_t send_calls = 0;      // sendmmsg 次数
+        uint64_t datagrams_out = 0;   // 发出的数据报（GSO 合并前计数）
+        uint64_t dropped = 0;         // 截断或帧非法而丢弃的数据报
+    };
+    const Stats& stats() const { return stats_; }
+
+    // 单个 UDP 数据报的最大负载（IPv4）
+    static constexpr size_t kMaxDatagram = 65507;
+
+   private:
+    struct Outbound {
+        size_t offset;  // 在发送区中的起点
+        uint32_t size;
+        sockaddr_in peer;
+    };
+
+    void setupReceive();
+    uint8_t* reserveSend(size_t size);
+    // 从 out_head_ 开始为 sendmmsg 组装最多 batch_size_ 条消息，返回条数，
+    // counts[i] 为第 i 条消息包含的数据报个数
+    size_t buildSendBatch(uint32_t* counts);
+
+    const int sockfd_;
+    sockaddr_in peer_{};
+    const size_t batch_size_;
+    size_t slot_size_;
+    bool gso_;
+    bool gro_;
+
+    // 接收：batch_size_ 个槽位共用一块池化内存
+    PoolBuffer recv_slots_;
+    std::vector<mmsghdr> recv_msgs_;
+    std::vector<iovec> recv_iov_;
+    std::vector<sockaddr_in> recv_addrs_;
+    std::vector<uint8_t> recv_control_;
+    std::vector<Datagram> in_;
+    size_t in_pos_ = 0;  // tryReceivePacket 在当前批次中的位置
+
+    // 发送：连续的发送区 + 每个数据报的位置
+    PoolBuffer send_area_;
+    size_t send_used_ = 0;
+    std::vector<Outbound> out_;
+    size_t out_head_ = 0;
+    size_t frame_start_ = SIZE_MAX;  // 正在构建的帧的起点
+    uint16_t frame_header_ = 0;
+    sockaddr_in frame_peer_{};
+    std::vector<mmsghdr> send_msgs_;
+    std::vector<iovec> send_iov_;
+    std::vector<uint8_t> send_control_;
+    std::vector<uint32_t> send_counts_;
+
+    Stats stats_;
+};
@@ -0,0 +1,80 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+/*
+基于纪元（epoch）的延迟回收，用于无锁读路径上的对象释放：
+- 读者在 EpochGuard 作用域内访问共享指针，进入/退出只写本线程的记录，无锁、无引用计数
+- 写者把对象从共享结构摘除后调用 retire，对象在所有读者都离开旧纪元后才真正释放
+- 全局纪元只有在所有活跃读者都已观察到当前纪元时才推进；
+  在纪元 e 退休的对象，待全局纪元推进到 e + 2 时即可安全释放
+retire 只发生在连接关闭等冷路径上，待回收列表用互斥锁保护即可
+*/
+class EpochReclaimer {
+   public:
+    using Deleter = void (*)(void*);
+
+    static EpochReclaimer& getInstance() {
+        static EpochReclaimer instance;
+        return instance;
+    }
+
+    // 进入/退出读临界区，可嵌套
+    void enter();
+    void exit();
+
+    // 延迟释放 ptr；调用前 ptr 必须已从所有共享结构中摘除
+    void retire(void* ptr, Deleter deleter);
+    template <typename T>
+    void retire(T* ptr) {
+        retire(ptr, [](void* p) { delete static_cast<T*>(p); });
+    }
+
+    // 尝试推进纪元并释放已过期的对象
+    void collect();
+    // 在确定没有读者时（如所有工作线程已退出）释放全部待回收对象
+    void drain();
+
+   private:
+    struct alignas(64) ThreadRecord {
+        // 最低位表示是否处于临界区，其余位为进入时观察到的纪元
+        std::atomic<uint64_t> state{0};
+        std::atomic<bool> in_use{false};
+        int nesting = 0;  // 仅所属线程访问
+        ThreadRecord* next = nullptr;
+    };
+
+    struct Retired {
+        void* ptr;
+        Deleter deleter;
+        uint64_t epoch;
+    };
+
+    EpochReclaimer() = default;
+    ~EpochReclaimer();
+
+    ThreadRecord* localRecord();
+    ThreadRecord* acquireRecord();
+    bool tryAdvance();
+
+    // 纪元从 2 开始，保证 epoch - 2 不会下溢
+    alignas(64) std::atomic<uint64_t> global_epoch_{2};
+    // 线程记录链表只增不删，线程退出后记录被标记为空闲供新线程复用
+    std::atomic<ThreadRecord*> records_{nullptr};
+    std::mutex retired_mutex_;
+    std::vector<Retired> retired_;
+
+    friend struct ThreadRecordOwner;
+};
+
+// RAII 读临界区
+class EpochGuard {
+   public:
+    EpochGuard() { EpochReclaimer::getInstance().enter(); }
+    ~EpochGuard() { EpochReclaimer::getInstance().exit(); }
+
+    EpochGuard(const EpochGuard&) = delete;
+    EpochGuard& operator=(const EpochGuard&) = delete;
+};
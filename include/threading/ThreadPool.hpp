@@ -1,46 +1,143 @@
 #pragma once
 #include <vector>
 #include <thread>
-#include <queue>
 #include <functional>
-#include <mutex>
-#include <condition_variable>
+#include <memory>
 #include <atomic>
+#include <cstdint>
 
+#include "threading/WorkStealingDeque.hpp"
+
+// 有界线程池在积压任务数达到上限时的处理方式
+enum class TaskOverflowPolicy {
+    Reject,      // 不执行，enqueue 返回 false，由调用方决定如何降级
+    CallerRuns,  // 在提交线程内直接执行：提交方被拖慢，天然形成反压
+};
+
+/*
+工作窃取线程池：
+- 每个工作线程一个无锁双端队列（Chase-Lev），工作线程内提交的任务直接压入自己的队列
+- 外部线程（如 epoll 主循环）提交的任务轮询投递到各工作线程的无锁收件箱（MPSC）
+- 本地队列为空时随机挑选受害者窃取，先偷其队列，再把其收件箱搬到自己队列
+- enqueuePinned 投递到指定工作线程的专属收件箱，不可被窃取，同一目标的任务按提交顺序执行
+- 空闲时先自旋一段时间，仍无任务再用 atomic wait 挂起，提交方只在有线程挂起时才唤醒
+- 任务节点执行完后回收到空闲栈，提交方成批取回复用，稳态下提交任务不分配内存
+- max_pending 非 0 时为有界队列：提交先占一个名额（开始执行时归还），
+  占不到就按 TaskOverflowPolicy 拒绝或由提交线程自己执行，过载时内存不再增长
+*/
 class ThreadPool {
 public:
     // std::function<void()> 是一个模板类，表示一个可调用对象，可以接受0个或多个参数，并且返回void
     // 它继承自 std::function 类，可以像函数一样使用
-    // using 是类型别名，可以给类型取一个别名   
+    // using 是类型别名，可以给类型取一个别名
     using Task = std::function<void()>;
     // explicit 是显式构造函数，禁止隐式转换
     // 它禁止了隐式转换，例如：ThreadPool pool = 4; 这样的语句会被禁止
     // 它要求必须显式地传入一个参数，例如：ThreadPool pool(4);
     // std::thread::hardware_concurrency() 是获取硬件支持的并发线程数
     // 例如：ThreadPool pool(std::thread::hardware_concurrency());
-    // 这样就可以根据硬件支持的并发线程数来创建线程池   
-    explicit ThreadPool(size_t threads = std::thread::hardware_concurrency());
+    // 这样就可以根据硬件支持的并发线程数来创建线程池
+    // max_pending 为 0 表示不限制积压任务数
+    explicit ThreadPool(size_t threads = std::thread::hardware_concurrency(),
+                        size_t max_pending = 0,
+                        TaskOverflowPolicy policy = TaskOverflowPolicy::Reject);
     ~ThreadPool();
 
     // 向线程池提交任务
     // 它接受一个 Task 类型的参数，表示一个可调用对象，可以接受0个或多个参数，并且返回void
     // 例如：pool.enqueue([]{std::cout << "Hello, World!" << std::endl;});
-    // 这样就可以向线程池提交一个任务，任务的内容是打印一句话   
-    void enqueue(Task task);
+    // 这样就可以向线程池提交一个任务，任务的内容是打印一句话
+    // 线程池已停止时抛出 std::runtime_error；没有工作线程时在调用线程内直接执行
+    // 返回 false 表示队列已满且策略为 Reject，任务没有执行
+    bool enqueue(Task task);
+    // 提交到第 worker % size() 个工作线程执行，不参与窃取（用于连接亲和调度）
+    // CallerRuns 时任务改在提交线程执行，调用方需保证这样不会破坏串行约束
+    bool enqueuePinned(size_t worker, Task task);
+    // 停止接收新任务；已提交的任务仍会执行完
     void shutdown();
     void wait();
 
+    size_t size() const { return workers.size(); }
+    // 已提交但尚未开始执行的任务数（近似值，用于监控）
+    size_t pendingTasks() const;
+    // 队列满时被拒绝 / 由提交线程执行的任务数
+    uint64_t rejectedTasks() const {
+        return rejected.load(std::memory_order_relaxed);
+    }
+    uint64_t callerRunsTasks() const {
+        return caller_runs.load(std::memory_order_relaxed);
+    }
+
 private:
+    // 任务节点：同时作为收件箱（侵入式 MPSC 链表）节点和双端队列元素
+    struct TaskNode {
+        std::atomic<TaskNode*> next{nullptr};
+        Task fn;
+    };
+
+    // Vyukov 侵入式 MPSC 队列：push 无锁且只有一次 exchange，
+    // pop 只允许单个消费者（由 Worker::inbox_busy 保证）
+    class Inbox {
+    public:
+        Inbox();
+        void push(TaskNode* node);
+        TaskNode* pop();
+
+    private:
+        alignas(64) std::atomic<TaskNode*> head_;  // 生产者端
+        alignas(64) TaskNode* tail_;               // 消费者端
+        TaskNode stub_;
+    };
+
+    // 每个工作线程的状态，按缓存行对齐避免伪共享
+    struct alignas(64) Worker {
+        WorkStealingDeque<TaskNode*> deque;
+        Inbox inbox;
+        std::atomic<int64_t> inbox_size{0};
+        // 收件箱的消费权，谁抢到谁把任务搬进自己的队列
+        std::atomic<bool> inbox_busy{false};
+        // 专属收件箱：只有所属工作线程消费
+        Inbox pinned;
+        std::atomic<int64_t> pinned_size{0};
+        // 挂起状态：sleeping 供提交方判断是否需要唤醒，wake_seq 为 atomic wait 对象
+        std::atomic<bool> sleeping{false};
+        std::atomic<uint32_t> wake_seq{0};
+    };
+
+    // 提交线程本地的空闲节点链表，线程退出时释放
+    struct NodeCache;
+
+    static constexpr int kSpinRounds = 64;
+
+    // 有界时占一个积压名额；失败时按策略处理，返回值即 enqueue 的返回值
+    bool admit();
+    bool overflow(Task& task);
+    TaskNode* allocateNode(Task task);
+    void recycleNode(TaskNode* node);
+
+    void workerLoop(size_t index);
+    TaskNode* findTask(size_t index, uint64_t& rng);
+    TaskNode* takeInbox(Worker& victim, Worker& self);
+    TaskNode* takePinned(Worker& self);
+    bool hasPendingWork(size_t index) const;
+    void park(size_t index);
+    void wakeOne();
+    void wakeWorker(Worker& w);
+
     std::vector<std::thread> workers;  // 工作线程
-    std::queue<Task> tasks;    // 任务队列
-    // std::mutex 是一个互斥锁，用于保护共享资源
-    // 它是一个线程安全的锁，可以防止多个线程同时访问共享资源
-    // 什么时候需要使用互斥锁？
-    std::mutex mtx;
-    // std::condition_variable 是一个条件变量，用于线程之间的同步
-    // 它是一个条件变量，用于线程之间的同步
-    std::condition_variable cv;
+    std::vector<std::unique_ptr<Worker>> queues;  // 与 workers 一一对应
     // std::atomic 是一个原子变量，用于线程之间的同步
-    // 它是一个原子变量，用于线程之间的同步
     std::atomic<bool> stop;
+    std::atomic<size_t> next_worker{0};  // 外部提交时轮询的目标
+    // 挂起线程数；为 0 时提交方无需扫描唤醒
+    alignas(64) std::atomic<int> sleepers{0};
+    // 已执行完的节点（Treiber 栈）：工作线程逐个压入，提交方一次 exchange 整体取走，
+    // 只有整体取走这一种出栈方式，因此没有 ABA 问题
+    alignas(64) std::atomic<TaskNode*> free_nodes{nullptr};
+    // 有界队列：已提交但尚未开始执行的任务数（只在 max_pending 非 0 时维护）
+    const size_t max_pending;
+    const TaskOverflowPolicy overflow_policy;
+    alignas(64) std::atomic<size_t> admitted{0};
+    std::atomic<uint64_t> rejected{0};
+    std::atomic<uint64_t> caller_runs{0};
 };
@@ -0,0 +1,123 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/*
+Chase-Lev 无锁双端队列（内存序参考 Lê et al., "Correct and Efficient
+Work-Stealing for Weak Memory Models", PPoPP'13）
+- push/pop 只允许所有者线程在底部操作（LIFO，缓存局部性好）
+- steal 允许任意线程在顶部窃取（FIFO，先偷最老的任务）
+- T 必须是可以放进 std::atomic 的平凡类型（这里用指针）
+*/
+template <typename T>
+class WorkStealingDeque {
+   public:
+    explicit WorkStealingDeque(int64_t capacity = 256)
+        : top_(0), bottom_(0) {
+        auto array = std::make_unique<Array>(capacity);
+        array_.store(array.get(), std::memory_order_relaxed);
+        arrays_.push_back(std::move(array));
+    }
+
+    WorkStealingDeque(const WorkStealingDeque&) = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+    // 仅所有者线程调用
+    void push(T item) {
+        int64_t b = bottom_.load(std::memory_order_relaxed);
+        int64_t t = top_.load(std::memory_order_acquire);
+        Array* a = array_.load(std::memory_order_relaxed);
+        if (b - t > a->capacity - 1) {
+            a = grow(a, b, t);
+        }
+        a->put(b, item);
+        // release 保证窃取者 acquire 读到新的 bottom 时也能看到元素内容
+        bottom_.store(b + 1, std::memory_order_release);
+    }
+
+    // 仅所有者线程调用；为空时返回 nullptr
+    T pop() {
+        int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+        Array* a = array_.load(std::memory_order_relaxed);
+        bottom_.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = top_.load(std::memory_order_relaxed);
+
+        if (t > b) {
+            bottom_.store(b + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        T item = a->get(b);
+        if (t == b) {
+            // 只剩最后一个元素，与窃取者竞争
+            if (!top_.compare_exchange_strong(t, t + 1,
+                                              std::memory_order_seq_cst,
+                                              std::memory_order_relaxed)) {
+                item = nullptr;
+            }
+            bottom_.store(b + 1, std::memory_order_relaxed);
+        }
+        return item;
+    }
+
+    // 任意线程调用；为空或竞争失败时返回 nullptr
+    T steal() {
+        int64_t t = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = bottom_.load(std::memory_order_acquire);
+        if (t >= b) {
+            return nullptr;
+        }
+        Array* a = array_.load(std::memory_order_acquire);
+        T item = a->get(t);
+        if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                          std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        return item;
+    }
+
+    // 近似大小，只用于判断是否有任务
+    int64_t sizeApprox() const {
+        int64_t b = bottom_.load(std::memory_order_relaxed);
+        int64_t t = top_.load(std::memory_order_relaxed);
+        return b > t ? b - t : 0;
+    }
+
+   private:
+    struct Array {
+        explicit Array(int64_t cap)
+            : capacity(cap), mask(cap - 1), slots(new std::atomic<T>[cap]) {}
+
+        T get(int64_t i) const {
+            return slots[i & mask].load(std::memory_order_relaxed);
+        }
+        void put(int64_t i, T item) {
+            slots[i & mask].store(item, std::memory_order_relaxed);
+        }
+
+        const int64_t capacity;  // 必须是 2 的幂
+        const int64_t mask;
+        std::unique_ptr<std::atomic<T>[]> slots;
+    };
+
+    Array* grow(Array* old, int64_t b, int64_t t) {
+        auto bigger = std::make_unique<Array>(old->capacity * 2);
+        for (int64_t i = t; i < b; ++i) {
+            bigger->put(i, old->get(i));
+        }
+        Array* raw = bigger.get();
+        // 窃取者可能仍在读旧数组，旧数组保留到析构时才释放
+        arrays_.push_back(std::move(bigger));
+        array_.store(raw, std::memory_order_release);
+        return raw;
+    }
+
+    // top_ 被窃取者频繁 CAS，与所有者写的 bottom_ 分开缓存行
+    alignas(64) std::atomic<int64_t> top_;
+    alignas(64) std::atomic<int64_t> bottom_;
+    std::atomic<Array*> array_;
+    std::vector<std::unique_ptr<Array>> arrays_;  // 仅所有者线程修改
+};
@@ -0,0 +1,81 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "utils/ThreadShards.hpp"
+
+/*
+对数-线性（HdrHistogram 风格）延迟直方图：
+- 按 2 的幂分组，每组再线性划分 kSubBuckets 个桶，相对误差约 1/kSubBuckets（~3%）
+- 每个线程写自己的分片（ThreadShards）：单写者，计数只需 relaxed load + store，无锁、无原子 RMW
+- 读取时合并所有分片得到快照，再计算百分位
+数值单位由调用方决定（Metrics 中为纳秒）
+*/
+class LatencyHistogram {
+   public:
+    static constexpr uint32_t kSubBucketBits = 5;
+    static constexpr uint32_t kSubBuckets = 1u << kSubBucketBits;
+    // 可记录的最大值约 2^36 ns ≈ 68 s，更大的值计入最后一个桶
+    static constexpr uint32_t kMaxValueBits = 36;
+    static constexpr size_t kBucketCount =
+        (kMaxValueBits - kSubBucketBits + 1) * kSubBuckets;
+
+    // 合并后的只读快照
+    struct Snapshot {
+        std::vector<uint64_t> counts;
+        uint64_t count = 0;
+        uint64_t sum = 0;
+        uint64_t max = 0;
+
+        double mean() const {
+            return count > 0 ? static_cast<double>(sum) / count : 0.0;
+        }
+        // p 取值 [0, 100]；返回所在桶的上界（不超过 max）
+        uint64_t percentile(double p) const;
+        // 累加另一个快照（例如合并多个独立直方图）
+        void merge(const Snapshot& other);
+    };
+
+    LatencyHistogram() = default;
+
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    void record(uint64_t value) {
+        Shard& shard = shards_.local();
+        bumpLocal<uint64_t>(shard.counts[bucketIndex(value)], 1);
+        bumpLocal<uint64_t>(shard.count, 1);
+        bumpLocal(shard.sum, value);
+        if (value > shard.max.load(std::memory_order_relaxed)) {
+            shard.max.store(value, std::memory_order_relaxed);
+        }
+    }
+
+    Snapshot snapshot() const;
+    // 清零所有分片；与并发记录竞争时可能丢失少量样本
+    void reset();
+
+    static size_t bucketIndex(uint64_t value) {
+        if (value < kSubBuckets) return static_cast<size_t>(value);
+        uint32_t msb = 63 - std::countl_zero(value);
+        if (msb >= kMaxValueBits) return kBucketCount - 1;
+        uint32_t shift = msb - kSubBucketBits;
+        return (shift + 1) * kSubBuckets + ((value >> shift) - kSubBuckets);
+    }
+    // 桶内可能出现的最大值
+    static uint64_t bucketUpperBound(size_t index);
+
+   private:
+    struct Shard {
+        std::array<std::atomic<uint64_t>, kBucketCount> counts{};
+        std::atomic<uint64_t> count{0};
+        std::atomic<uint64_t> sum{0};
+        std::atomic<uint64_t> max{0};
+    };
+
+    ThreadShards<Shard> shards_;
+};
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace utils {
+
+/*
+二进制日志参数编码：热路径只按类型把参数原样拷贝进缓冲区，不做 printf 格式化；
+后台写线程或离线解码工具（log_decoder）再结合格式串渲染成文本
+每个参数 = 1 字节类型标签 + 数据：
+    Int/UInt/Double/Pointer: 8 字节（本机字节序）
+    String: 2 字节长度 + 字节内容（不含结尾 '\0'）
+*/
+enum class LogArgType : uint8_t {
+    Int = 1,
+    UInt = 2,
+    Double = 3,
+    String = 4,
+    Pointer = 5,
+};
+
+namespace detail {
+
+inline bool putLogBytes(uint8_t*& pos, uint8_t* end, const void* data,
+                        size_t size) {
+    if (static_cast<size_t>(end - pos) < size) return false;
+    std::memcpy(pos, data, size);
+    pos += size;
+    return true;
+}
+
+template <typename T>
+inline bool putLogScalar(uint8_t*& pos, uint8_t* end, LogArgType type,
+                         T value) {
+    if (static_cast<size_t>(end - pos) < 1 + sizeof(T)) return false;
+    *pos++ = static_cast<uint8_t>(type);
+    return putLogBytes(pos, end, &value, sizeof(T));
+}
+
+inline bool putLogString(uint8_t*& pos, uint8_t* end, std::string_view s) {
+    if (static_cast<size_t>(end - pos) < 3) return false;
+    // 空间不足时截断字符串，而不是丢弃整条日志
+    size_t size = std::min(s.size(), static_cast<size_t>(end - pos) - 3);
+    uint16_t length = static_cast<uint16_t>(size);
+    *pos++ = static_cast<uint8_t>(LogArgType::String);
+    putLogBytes(pos, end, &length, sizeof(length));
+    return putLogBytes(pos, end, s.data(), size);
+}
+
+template <typename T>
+inline bool encodeLogArg(uint8_t*& pos, uint8_t* end, const T& value) {
+    using U = std::decay_t<T>;
+    if constexpr (std::is_array_v<T>) {
+        // 字符数组（如字面量）一定非空
+        return putLogString(pos, end, std::string_view(value));
+    } else if constexpr (std::is_same_v<U, const char*> ||
+                         std::is_same_v<U, char*>) {
+        return putLogString(pos, end, value ? std::string_view(value)
+                                            : std::string_view("(null)"));
+    } else if constexpr (std::is_same_v<U, std::string> ||
+                         std::is_same_v<U, std::string_view>) {
+        return putLogString(pos, end, value);
+    } else if constexpr (std::is_enum_v<U>) {
+        return encodeLogArg(pos, end,
+                            static_cast<std::underlying_type_t<U>>(value));
+    } else if constexpr (std::is_floating_point_v<U>) {
+        return putLogScalar<double>(pos, end, LogArgType::Double, value);
+    } else if constexpr (std::is_integral_v<U> && std::is_signed_v<U>) {
+        return putLogScalar<int64_t>(pos, end, LogArgType::Int, value);
+    } else if constexpr (std::is_integral_v<U>) {
+        return putLogScalar<uint64_t>(pos, end, LogArgType::UInt, value);
+    } else if constexpr (std::is_pointer_v<U>) {
+        return putLogScalar<uint64_t>(pos, end, LogArgType::Pointer,
+                                      reinterpret_cast<uintptr_t>(value));
+    } else {
+        static_assert(std::is_void_v<U>, "unsupported log argument type");
+        return false;
+    }
+}
+
+}  // namespace detail
+
+// 把参数编码进 [buffer, buffer + capacity)，返回写入的字节数
+template <typename... Args>
+inline size_t encodeLogArgs(uint8_t* buffer, size_t capacity,
+                            const Args&... args) {
+    uint8_t* pos = buffer;
+    [[maybe_unused]] uint8_t* end = buffer + capacity;
+    (void)(detail::encodeLogArg(pos, end, args) && ...);
+    return static_cast<size_t>(pos - buffer);
+}
+
+/*
+二进制日志文件（AsyncLogOptions::binary）由以下记录顺序组成，整数均为本机字节序：
+    'S' "MCSBLOG1"                                  每次开始写入时的会话头，解码器据此清空格式表
+    'F' id:u32 level:u8 line:u32 file_len:u16 file fmt_len:u16 fmt   格式串定义，先于引用它的事件
+    'E' timestamp_ns:i64 id:u32 level:u8 args_len:u16 args   一条日志事件，args 为上面的参数编码
+*/
+namespace binlog {
+constexpr char kSession = 'S';
+constexpr char kFormat = 'F';
+constexpr char kEvent = 'E';
+constexpr char kMagic[] = "MCSBLOG1";
+constexpr size_t kMagicSize = sizeof(kMagic) - 1;
+}  // namespace binlog
+
+// 按 printf 风格格式串渲染已编码的参数，输出截断到 capacity - 1 并以 '\0' 结尾，
+// 返回写入的字节数（不含 '\0'）
+// 参数类型与转换符不匹配时输出占位文本，不会产生未定义行为
+size_t renderLogMessage(char* out, size_t capacity, const char* format,
+                        const uint8_t* args, size_t args_size);
+
+}  // namespace utils
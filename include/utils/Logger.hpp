@@ -1,10 +1,25 @@
 #pragma once
 
-#include <iostream>
-#include <sstream>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
 #include <mutex>
-#include <iomanip>
-#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "utils/LogFormat.hpp"
+#include "utils/ThreadShards.hpp"
+
+// 编译期最低日志级别（0=DEBUG ... 4=FATAL）：低于它的 LOG_* 宏展开为空，
+// 参数不会被求值。例如 -DMCS_LOG_MIN_LEVEL=1 去掉所有 LOG_DEBUG
+#ifndef MCS_LOG_MIN_LEVEL
+#define MCS_LOG_MIN_LEVEL 0
+#endif
 
 namespace utils {
 
@@ -16,8 +31,33 @@ enum class LogLevel {
     FATAL
 };
 
+// 异步模式下线程本地环形缓冲区写满时的处理方式
+enum class LogOverflowPolicy {
+    Drop,   // 丢弃本条并计数，由后台线程补一条告警
+    Block   // 唤醒后台线程并等待空间
+};
+
+struct AsyncLogOptions {
+    std::string path;  // 输出文件（追加），空表示标准输出
+    LogOverflowPolicy overflow = LogOverflowPolicy::Drop;
+    // 直接写出二进制记录（格式串 id + 原始参数），由 log_decoder 离线渲染；需指定 path
+    bool binary = false;
+};
+
+/*
+两种模式：
+- 同步（默认）：调用线程格式化并写标准输出，全局互斥，便于调试
+- 异步（startAsync）：LOG_* 宏只把格式串 id 和原始参数（LogFormat.hpp 编码）写进
+  本线程的无锁 SPSC 环形缓冲区，不做 printf 格式化；后台线程再渲染文本、补上时间戳
+  （按秒缓存）和级别，攒批后大块 write 到文件。binary 模式下后台线程连渲染也省掉，
+  直接写二进制记录，由 log_decoder 工具离线还原
+  不同线程的日志各自保序，线程之间只按后台线程的收集顺序交错
+每个 LOG_* 调用点第一次执行时登记格式串（函数内静态变量），之后只是一次已初始化检查
+*/
 class Logger {
 public:
+    static constexpr size_t kMaxMessageSize = 1024;
+
     static Logger& getInstance() {
         static Logger instance;
         return instance;
@@ -25,64 +65,176 @@ public:
 
     template<typename... Args>
     static void log(LogLevel level, const char* format, Args... args) {
-        getInstance().logImpl(level, format, args...);
+        Logger& logger = getInstance();
+        if (!logger.isEnabled(level)) return;
+        logger.writeFormatted(level, format, args...);
+    }
+
+    // LOG_* 宏使用：format 必须是字符串字面量（登记后按指针保存）
+    template<typename... Args>
+    static void logFormat(uint32_t format_id, LogLevel level,
+                          const char* format, const Args&... args) {
+        Logger& logger = getInstance();
+        if (logger.async_.load(std::memory_order_acquire)) {
+            // 热路径只拷贝参数，格式化推迟到后台线程或离线工具
+            uint8_t buffer[kMaxMessageSize];
+            size_t size = encodeLogArgs(buffer, sizeof(buffer), args...);
+            logger.pushBinary(level, format_id, buffer, size);
+        } else {
+            logger.writeFormatted(level, format, args...);
+        }
+    }
+
+    static bool isEnabled(LogLevel level) {
+        return level >= getInstance().currentLevel.load(std::memory_order_relaxed);
     }
 
     static void setLogLevel(LogLevel level) {
-        getInstance().currentLevel = level;
+        getInstance().currentLevel.store(level, std::memory_order_relaxed);
     }
 
+    // 登记一个调用点的格式串，返回其 id（冷路径，加锁）
+    static uint32_t registerFormat(LogLevel level, const char* format,
+                                   const char* file, int line);
+
+    // 切换到异步模式；失败（如文件无法打开）时保持同步模式并返回 false
+    bool startAsync(const AsyncLogOptions& options);
+    // 写完所有已提交的日志后回到同步模式；调用时应已没有其他线程在写日志
+    void stopAsync();
+    // 等待后台线程写完当前已提交的日志
+    void flush();
+
 private:
-    Logger() : currentLevel(LogLevel::INFO) {}
-    ~Logger() = default;
+    // 按秒缓存 "YYYY-MM-DD HH:MM:SS"：同一秒内的日志不再调用 localtime
+    struct TimestampCache {
+        int64_t second = -1;
+        char text[32] = {};
+        const char* format(int64_t seconds);
+    };
+
+    // 单生产者（所属线程）单消费者（后台线程）字节环：
+    // 每条记录 = 记录头 + 正文，按 16 字节对齐；尾部放不下时写一条填充记录后回绕
+    struct LogRing {
+        static constexpr size_t kCapacity = size_t(1) << 18;
+
+        std::unique_ptr<uint8_t[]> data{new uint8_t[kCapacity]};
+        alignas(64) std::atomic<uint64_t> head{0};  // 仅后台线程推进
+        alignas(64) std::atomic<uint64_t> tail{0};  // 仅所属线程推进
+        std::atomic<uint64_t> dropped{0};
+    };
+
+    struct FormatInfo {
+        LogLevel level;
+        const char* format;
+        const char* file;
+        int line;
+    };
+
+    Logger();
+    ~Logger();
     Logger(const Logger&) = delete;
     Logger& operator=(const Logger&) = delete;
 
-    LogLevel currentLevel;
-    std::mutex logMutex;
-
     template<typename... Args>
-    void logImpl(LogLevel level, const char* format, Args... args) {
-        if (level < currentLevel) return;
-
-        std::lock_guard<std::mutex> lock(logMutex);
-        std::stringstream ss;
-        
-        // Add timestamp
-        auto now = std::chrono::system_clock::now();
-        auto now_c = std::chrono::system_clock::to_time_t(now);
-        ss << std::put_time(std::localtime(&now_c), "%Y-%m-%d %H:%M:%S") << " ";
-        
-        // Add log level
-        switch (level) {
-            case LogLevel::DEBUG:   ss << "[DEBUG] "; break;
-            case LogLevel::INFO:    ss << "[INFO] "; break;
-            case LogLevel::WARNING: ss << "[WARNING] "; break;
-            case LogLevel::ERROR:   ss << "[ERROR] "; break;
-            case LogLevel::FATAL:   ss << "[FATAL] "; break;
-        }
-
-        // Format the message
-        char buffer[1024];
+    void writeFormatted(LogLevel level, const char* format, const Args&... args) {
+        char buffer[kMaxMessageSize];
+        int length;
         if constexpr (sizeof...(args) > 0) {
             // 有额外格式化参数，按 用户 format + args 来 snprintf
-            std::snprintf(buffer, sizeof(buffer), format, args...);
+            length = std::snprintf(buffer, sizeof(buffer), format, args...);
         } else {
             // 没有参数，直接把 format 当作普通字符串拷贝
-            std::snprintf(buffer, sizeof(buffer), "%s", format);
+            length = std::snprintf(buffer, sizeof(buffer), "%s", format);
         }
+        if (length < 0) return;
+        size_t size = std::min(static_cast<size_t>(length), sizeof(buffer) - 1);
+        write(level, buffer, size);
+    }
 
-        ss << buffer << std::endl;
+    void write(LogLevel level, const char* message, size_t size);
+    void pushBinary(LogLevel level, uint32_t format_id, const uint8_t* args,
+                    size_t size);
+    // 写入一条记录：flags 区分文本正文和二进制参数
+    void pushRecord(LogLevel level, uint16_t flags, const void* prefix,
+                    size_t prefix_size, const void* body, size_t body_size);
+    void writeSync(LogLevel level, const char* message, size_t size);
+    void writerLoop();
+    // 消费所有环中的记录并写出，返回是否处理了数据
+    bool drainRings();
+    void appendLine(int64_t timestamp_ns, LogLevel level, const char* message,
+                    size_t size);
+    // 已是文本的记录：文本模式直接追加，binary 模式以 0 号格式串写出
+    void appendText(int64_t timestamp_ns, LogLevel level, const char* text,
+                    size_t size);
+    // binary 模式：写出一条事件记录，必要时先写出其格式串定义
+    void appendBinaryEvent(int64_t timestamp_ns, LogLevel level,
+                           uint32_t format_id, const uint8_t* args,
+                           size_t size);
+    FormatInfo formatInfo(uint32_t format_id);
+    void flushOutput();
+    void wakeWriter();
 
-        std::cout << ss.str();
-    }
+    std::atomic<LogLevel> currentLevel;
+    std::mutex logMutex;  // 同步模式下串行化输出
+    TimestampCache sync_timestamp_;
+
+    // 异步模式
+    std::atomic<bool> async_{false};
+    LogOverflowPolicy overflow_ = LogOverflowPolicy::Drop;
+    ThreadShards<LogRing> rings_;
+    std::thread writer_;
+    std::atomic<bool> stopping_{false};
+    std::atomic<bool> wake_requested_{false};
+    std::mutex wake_mutex_;
+    std::condition_variable wake_cv_;
+    std::atomic<uint64_t> writer_passes_{0};  // 后台线程完成的轮数，供 flush 等待
+    int out_fd_ = -1;
+    bool binary_ = false;
+    std::string out_buffer_;  // 仅后台线程访问
+    std::vector<LogRing*> drain_list_;  // drainRings 本轮要消费的环（仅后台线程访问）
+    TimestampCache async_timestamp_;  // 仅后台线程访问
+    std::vector<bool> formats_written_;  // binary 模式下已写出定义的格式串（仅后台线程访问）
+    std::vector<FormatInfo> format_cache_;  // 登记表副本（仅后台线程访问）
+
+    // 格式串登记表，id 即下标；0 号保留给不经宏的 log() 文本记录
+    std::mutex formats_mutex_;
+    std::vector<FormatInfo> formats_;
 };
 
 } // namespace utils
 
 // Define macros outside the namespace to make them globally accessible
-#define LOG_DEBUG(...)   utils::Logger::log(utils::LogLevel::DEBUG, __VA_ARGS__)
-#define LOG_INFO(...)    utils::Logger::log(utils::LogLevel::INFO, __VA_ARGS__)
-#define LOG_WARNING(...) utils::Logger::log(utils::LogLevel::WARNING, __VA_ARGS__)
-#define LOG_ERROR(...)   utils::Logger::log(utils::LogLevel::ERROR, __VA_ARGS__)
-#define LOG_FATAL(...)   utils::Logger::log(utils::LogLevel::FATAL, __VA_ARGS__) 
\ No newline at end of file
+// 先按运行期级别过滤再求值参数；调用点的格式串 id 只在第一次执行时登记
+#define MCS_LOG(level, format, ...)                                            \
+    do {                                                                       \
+        if (utils::Logger::isEnabled(level)) {                                 \
+            static const uint32_t mcs_log_format_id =                          \
+                utils::Logger::registerFormat(level, format, __FILE__,         \
+                                              __LINE__);                       \
+            utils::Logger::logFormat(mcs_log_format_id, level,                 \
+                                     format __VA_OPT__(, ) __VA_ARGS__);       \
+        }                                                                      \
+    } while (0)
+
+#if MCS_LOG_MIN_LEVEL <= 0
+#define LOG_DEBUG(...)   MCS_LOG(utils::LogLevel::DEBUG, __VA_ARGS__)
+#else
+#define LOG_DEBUG(...)   ((void)0)
+#endif
+#if MCS_LOG_MIN_LEVEL <= 1
+#define LOG_INFO(...)    MCS_LOG(utils::LogLevel::INFO, __VA_ARGS__)
+#else
+#define LOG_INFO(...)    ((void)0)
+#endif
+#if MCS_LOG_MIN_LEVEL <= 2
+#define LOG_WARNING(...) MCS_LOG(utils::LogLevel::WARNING, __VA_ARGS__)
+#else
+#define LOG_WARNING(...) ((void)0)
+#endif
+#if MCS_LOG_MIN_LEVEL <= 3
+#define LOG_ERROR(...)   MCS_LOG(utils::LogLevel::ERROR, __VA_ARGS__)
+#else
+#define LOG_ERROR(...)   ((void)0)
+#endif
+// FATAL 不允许编译期去掉
+#define LOG_FATAL(...)   MCS_LOG(utils::LogLevel::FATAL, __VA_ARGS__)
@@ -1,9 +1,13 @@
 #pragma once
+#include <array>
 #include <atomic>
 #include <chrono>
+#include <cstdio>
 #include <string>
-#include <unordered_map>
-#include <mutex>
+
+#include "net/buffer/BufferPool.hpp"
+#include "utils/LatencyHistogram.hpp"
+#include "utils/ThreadShards.hpp"
 
 class Metrics {
 public:
@@ -12,45 +16,306 @@ public:
         return instance;
     }
 
+    // 计数器按线程分片：热路径只写本线程的缓存行，读取时再汇总
     // 连接统计
-    void incrementConnections() { ++total_connections_; }
-    void decrementConnections() { --current_connections_; }
-    uint64_t getTotalConnections() const { return total_connections_; }
-    uint64_t getCurrentConnections() const { return current_connections_; }
+    void incrementConnections() {
+        auto& shard = counters_.local();
+        bumpLocal<uint64_t>(shard.total_connections, 1);
+        bumpLocal<int64_t>(shard.current_connections, 1);
+    }
+    // 连接可能在另一个线程关闭，单个分片的当前连接数可以为负，汇总后才有意义
+    void decrementConnections() {
+        bumpLocal<int64_t>(counters_.local().current_connections, -1);
+    }
+    uint64_t getTotalConnections() const {
+        return sum(&CounterShard::total_connections);
+    }
+    uint64_t getCurrentConnections() const {
+        int64_t current = sum(&CounterShard::current_connections);
+        return current > 0 ? static_cast<uint64_t>(current) : 0;
+    }
 
     // 请求统计
-    void incrementRequests() { ++total_requests_; }
-    void incrementBytesReceived(uint64_t bytes) { bytes_received_ += bytes; }
-    void incrementBytesSent(uint64_t bytes) { bytes_sent_ += bytes; }
-    uint64_t getTotalRequests() const { return total_requests_; }
-    uint64_t getBytesReceived() const { return bytes_received_; }
-    uint64_t getBytesSent() const { return bytes_sent_; }
+    void incrementRequests() {
+        bumpLocal<uint64_t>(counters_.local().requests, 1);
+    }
+    void incrementBytesReceived(uint64_t bytes) {
+        bumpLocal(counters_.local().bytes_received, bytes);
+    }
+    void incrementBytesSent(uint64_t bytes) {
+        bumpLocal(counters_.local().bytes_sent, bytes);
+    }
+    uint64_t getTotalRequests() const { return sum(&CounterShard::requests); }
+    uint64_t getBytesReceived() const {
+        return sum(&CounterShard::bytes_received);
+    }
+    uint64_t getBytesSent() const { return sum(&CounterShard::bytes_sent); }
 
     // 错误统计
-    void incrementErrors() { ++total_errors_; }
-    uint64_t getTotalErrors() const { return total_errors_; }
+    void incrementErrors() { bumpLocal<uint64_t>(counters_.local().errors, 1); }
+    uint64_t getTotalErrors() const { return sum(&CounterShard::errors); }
+
+    // 发送反压：待发数据超过高水位而暂停读取的次数
+    void incrementReadPauses() {
+        bumpLocal<uint64_t>(counters_.local().read_pauses, 1);
+    }
 
-    // 延迟统计
-    void recordLatency(uint64_t microseconds) {
-        std::lock_guard<std::mutex> lock(latency_mutex_);
-        total_latency_ += microseconds;
-        ++latency_samples_;
+    // 批量文件传输：开始发送的文件区域数与其字节数（实际发出的字节计入 bytes_sent）
+    void incrementBulkTransfers(uint64_t bytes) {
+        auto& shard = counters_.local();
+        bumpLocal<uint64_t>(shard.bulk_transfers, 1);
+        bumpLocal(shard.bulk_bytes, bytes);
     }
+
+    // payload 压缩：输入 / 输出字节与耗时（纳秒），两者之比即压缩率和吞吐；
+    // rejected 为压缩后不比原文小而放弃的包（耗时照样计入），skipped 为未达阈值直接跳过的包
+    void recordCompression(uint64_t in_bytes, uint64_t out_bytes,
+                           uint64_t nanoseconds) {
+        auto& shard = counters_.local();
+        bumpLocal<uint64_t>(shard.compressions, 1);
+        bumpLocal(shard.compress_in_bytes, in_bytes);
+        bumpLocal(shard.compress_out_bytes, out_bytes);
+        bumpLocal(shard.compress_ns, nanoseconds);
+    }
+    void recordCompressionRejected(uint64_t nanoseconds) {
+        auto& shard = counters_.local();
+        bumpLocal<uint64_t>(shard.compress_rejected, 1);
+        bumpLocal(shard.compress_ns, nanoseconds);
+    }
+    void incrementCompressionSkipped() {
+        bumpLocal<uint64_t>(counters_.local().compress_skipped, 1);
+    }
+    void recordDecompression(uint64_t in_bytes, uint64_t out_bytes,
+                             uint64_t nanoseconds) {
+        auto& shard = counters_.local();
+        bumpLocal<uint64_t>(shard.decompressions, 1);
+        bumpLocal(shard.decompress_in_bytes, in_bytes);
+        bumpLocal(shard.decompress_out_bytes, out_bytes);
+        bumpLocal(shard.decompress_ns, nanoseconds);
+    }
+
+    // UDP：收发的数据报（按批次累加）、丢弃的数据报，以及当前跟踪的对端会话数
+    void incrementUdpDatagrams(uint64_t received, uint64_t sent) {
+        auto& shard = counters_.local();
+        if (received) bumpLocal(shard.udp_datagrams_received, received);
+        if (sent) bumpLocal(shard.udp_datagrams_sent, sent);
+    }
+    void incrementUdpDropped(uint64_t count) {
+        bumpLocal(counters_.local().udp_dropped, count);
+    }
+    void adjustUdpSessions(int64_t delta) {
+        bumpLocal(counters_.local().udp_sessions, delta);
+    }
+
+    // 缓冲区池：命中本线程缓存 / 从全局仓库取回 / 需要新内存
+    BufferPool::Stats getBufferPoolStats() const {
+        return BufferPool::getInstance().stats();
+    }
+
+    // 某一时刻所有计数器的汇总值；两次快照相减得到区间速率
+    struct Snapshot {
+        std::chrono::steady_clock::time_point time;
+        uint64_t total_connections = 0;
+        uint64_t current_connections = 0;
+        uint64_t requests = 0;
+        uint64_t bytes_received = 0;
+        uint64_t bytes_sent = 0;
+        uint64_t errors = 0;
+        uint64_t read_pauses = 0;
+        uint64_t bulk_transfers = 0;
+        uint64_t bulk_bytes = 0;
+        uint64_t compressions = 0;
+        uint64_t compress_in_bytes = 0;
+        uint64_t compress_out_bytes = 0;
+        uint64_t compress_ns = 0;
+        uint64_t compress_rejected = 0;
+        uint64_t compress_skipped = 0;
+        uint64_t decompressions = 0;
+        uint64_t decompress_in_bytes = 0;
+        uint64_t decompress_out_bytes = 0;
+        uint64_t decompress_ns = 0;
+        uint64_t udp_datagrams_received = 0;
+        uint64_t udp_datagrams_sent = 0;
+        uint64_t udp_dropped = 0;
+        uint64_t udp_sessions = 0;
+        BufferPool::Stats buffer_pool;
+    };
+    struct Rates {
+        double requests_per_sec = 0;
+        double bytes_received_per_sec = 0;
+        double bytes_sent_per_sec = 0;
+        double errors_per_sec = 0;
+        double connections_per_sec = 0;
+    };
+
+    Snapshot snapshot() const {
+        Snapshot snap;
+        int64_t current = 0;
+        int64_t udp_sessions = 0;
+        // 一次遍历汇总所有字段，各字段之间近似一致即可
+        counters_.forEach([&](const CounterShard& shard) {
+            snap.total_connections += load(shard.total_connections);
+            current += load(shard.current_connections);
+            snap.requests += load(shard.requests);
+            snap.bytes_received += load(shard.bytes_received);
+            snap.bytes_sent += load(shard.bytes_sent);
+            snap.errors += load(shard.errors);
+            snap.read_pauses += load(shard.read_pauses);
+            snap.bulk_transfers += load(shard.bulk_transfers);
+            snap.bulk_bytes += load(shard.bulk_bytes);
+            snap.compressions += load(shard.compressions);
+            snap.compress_in_bytes += load(shard.compress_in_bytes);
+            snap.compress_out_bytes += load(shard.compress_out_bytes);
+            snap.compress_ns += load(shard.compress_ns);
+            snap.compress_rejected += load(shard.compress_rejected);
+            snap.compress_skipped += load(shard.compress_skipped);
+            snap.decompressions += load(shard.decompressions);
+            snap.decompress_in_bytes += load(shard.decompress_in_bytes);
+            snap.decompress_out_bytes += load(shard.decompress_out_bytes);
+            snap.decompress_ns += load(shard.decompress_ns);
+            snap.udp_datagrams_received += load(shard.udp_datagrams_received);
+            snap.udp_datagrams_sent += load(shard.udp_datagrams_sent);
+            snap.udp_dropped += load(shard.udp_dropped);
+            udp_sessions += load(shard.udp_sessions);
+        });
+        snap.current_connections = current > 0 ? current : 0;
+        snap.udp_sessions = udp_sessions > 0 ? udp_sessions : 0;
+        snap.buffer_pool = getBufferPoolStats();
+        snap.time = std::chrono::steady_clock::now();
+        return snap;
+    }
+
+    static Rates rates(const Snapshot& prev, const Snapshot& cur) {
+        Rates r;
+        double seconds =
+            std::chrono::duration<double>(cur.time - prev.time).count();
+        if (seconds <= 0) return r;
+        // reset() 之后计数可能回退，此时按 0 处理
+        auto delta = [seconds](uint64_t before, uint64_t after) {
+            return after > before ? (after - before) / seconds : 0.0;
+        };
+        r.requests_per_sec = delta(prev.requests, cur.requests);
+        r.bytes_received_per_sec =
+            delta(prev.bytes_received, cur.bytes_received);
+        r.bytes_sent_per_sec = delta(prev.bytes_sent, cur.bytes_sent);
+        r.errors_per_sec = delta(prev.errors, cur.errors);
+        r.connections_per_sec =
+            delta(prev.total_connections, cur.total_connections);
+        return r;
+    }
+
+    // 延迟统计：按阶段分别记录到无锁直方图，单位纳秒
+    enum class LatencyStage {
+        Read,   // handleRead：开始读取到响应入队
+        Write,  // handleWrite：一次发送队列刷新耗时
+        Count
+    };
+    static const char* stageName(LatencyStage stage) {
+        static constexpr const char* kNames[] = {"read", "write"};
+        return kNames[static_cast<size_t>(stage)];
+    }
+    void recordLatency(LatencyStage stage, uint64_t nanoseconds) {
+        latency_[static_cast<size_t>(stage)].record(nanoseconds);
+    }
+    LatencyHistogram::Snapshot getLatency(LatencyStage stage) const {
+        return latency_[static_cast<size_t>(stage)].snapshot();
+    }
+    // 所有阶段的平均延迟（微秒），保留给只需要均值的调用方
     double getAverageLatency() const {
-        std::lock_guard<std::mutex> lock(latency_mutex_);
-        return latency_samples_ > 0 ? static_cast<double>(total_latency_) / latency_samples_ : 0.0;
+        uint64_t sum = 0, samples = 0;
+        for (const auto& histogram : latency_) {
+            auto snap = histogram.snapshot();
+            sum += snap.sum;
+            samples += snap.count;
+        }
+        return samples > 0 ? static_cast<double>(sum) / samples / 1000.0 : 0.0;
+    }
+    // 形如 "read: n=.. p50=..us p90=.. p99=.. p99.9=.. max=.." 的单行摘要
+    std::string formatLatency() const {
+        std::string out;
+        for (size_t i = 0; i < latency_.size(); ++i) {
+            auto snap = latency_[i].snapshot();
+            char line[192];
+            snprintf(line, sizeof(line),
+                     "%s%s: n=%llu p50=%.1fus p90=%.1fus p99=%.1fus "
+                     "p99.9=%.1fus max=%.1fus",
+                     out.empty() ? "" : "; ",
+                     stageName(static_cast<LatencyStage>(i)),
+                     static_cast<unsigned long long>(snap.count),
+                     snap.percentile(50) / 1000.0, snap.percentile(90) / 1000.0,
+                     snap.percentile(99) / 1000.0,
+                     snap.percentile(99.9) / 1000.0, snap.max / 1000.0);
+            out += line;
+        }
+        return out;
+    }
+
+    // 形如 "hits=.. refills=.. misses=.. reserved=..KB" 的单行摘要
+    std::string formatBufferPool() const {
+        BufferPool::Stats stats = getBufferPoolStats();
+        char line[160];
+        snprintf(line, sizeof(line),
+                 "hits=%llu refills=%llu misses=%llu reserved=%lluKB",
+                 static_cast<unsigned long long>(stats.hits),
+                 static_cast<unsigned long long>(stats.refills),
+                 static_cast<unsigned long long>(stats.misses),
+                 static_cast<unsigned long long>(stats.reserved_bytes / 1024));
+        return line;
+    }
+
+    // 形如 "ratio=2.41 compress=n=.. 512.0MB/s decompress=n=.. 1800.0MB/s rejected=.. skipped=.."
+    // 的单行摘要；压缩率为输入 / 输出，吞吐按原文字节计算
+    std::string formatCompression() const {
+        Snapshot snap = snapshot();
+        auto throughput = [](uint64_t bytes, uint64_t ns) {
+            return ns > 0 ? bytes * 1000.0 / ns : 0.0;  // 字节/纳秒 × 1000 = MB/s
+        };
+        char line[224];
+        snprintf(line, sizeof(line),
+                 "ratio=%.2f compress=n=%llu %.1fMB/s decompress=n=%llu "
+                 "%.1fMB/s rejected=%llu skipped=%llu",
+                 snap.compress_out_bytes > 0
+                     ? static_cast<double>(snap.compress_in_bytes) /
+                           snap.compress_out_bytes
+                     : 0.0,
+                 static_cast<unsigned long long>(snap.compressions),
+                 throughput(snap.compress_in_bytes, snap.compress_ns),
+                 static_cast<unsigned long long>(snap.decompressions),
+                 throughput(snap.decompress_out_bytes, snap.decompress_ns),
+                 static_cast<unsigned long long>(snap.compress_rejected),
+                 static_cast<unsigned long long>(snap.compress_skipped));
+        return line;
     }
 
-    // 重置统计
+    // 重置统计（与并发写入竞争时可能丢失少量计数）
     void reset() {
-        total_connections_ = 0;
-        current_connections_ = 0;
-        total_requests_ = 0;
-        bytes_received_ = 0;
-        bytes_sent_ = 0;
-        total_errors_ = 0;
-        total_latency_ = 0;
-        latency_samples_ = 0;
+        counters_.forEach([](CounterShard& shard) {
+            shard.total_connections.store(0, std::memory_order_relaxed);
+            shard.current_connections.store(0, std::memory_order_relaxed);
+            shard.requests.store(0, std::memory_order_relaxed);
+            shard.bytes_received.store(0, std::memory_order_relaxed);
+            shard.bytes_sent.store(0, std::memory_order_relaxed);
+            shard.errors.store(0, std::memory_order_relaxed);
+            shard.read_pauses.store(0, std::memory_order_relaxed);
+            shard.bulk_transfers.store(0, std::memory_order_relaxed);
+            shard.bulk_bytes.store(0, std::memory_order_relaxed);
+            shard.compressions.store(0, std::memory_order_relaxed);
+            shard.compress_in_bytes.store(0, std::memory_order_relaxed);
+            shard.compress_out_bytes.store(0, std::memory_order_relaxed);
+            shard.compress_ns.store(0, std::memory_order_relaxed);
+            shard.compress_rejected.store(0, std::memory_order_relaxed);
+            shard.compress_skipped.store(0, std::memory_order_relaxed);
+            shard.decompressions.store(0, std::memory_order_relaxed);
+            shard.decompress_in_bytes.store(0, std::memory_order_relaxed);
+            shard.decompress_out_bytes.store(0, std::memory_order_relaxed);
+            shard.decompress_ns.store(0, std::memory_order_relaxed);
+            shard.udp_datagrams_received.store(0, std::memory_order_relaxed);
+            shard.udp_datagrams_sent.store(0, std::memory_order_relaxed);
+            shard.udp_dropped.store(0, std::memory_order_relaxed);
+        });
+        for (auto& histogram : latency_) {
+            histogram.reset();
+        }
     }
 
 private:
@@ -59,14 +324,48 @@ private:
     Metrics(const Metrics&) = delete;
     Metrics& operator=(const Metrics&) = delete;
 
-    std::atomic<uint64_t> total_connections_{0};
-    std::atomic<uint64_t> current_connections_{0};
-    std::atomic<uint64_t> total_requests_{0};
-    std::atomic<uint64_t> bytes_received_{0};
-    std::atomic<uint64_t> bytes_sent_{0};
-    std::atomic<uint64_t> total_errors_{0};
-    
-    mutable std::mutex latency_mutex_;
-    uint64_t total_latency_{0};
-    uint64_t latency_samples_{0};
-}; 
\ No newline at end of file
+    // ThreadShards 按缓存行对齐每个分片
+    struct CounterShard {
+        std::atomic<uint64_t> total_connections{0};
+        std::atomic<int64_t> current_connections{0};
+        std::atomic<uint64_t> requests{0};
+        std::atomic<uint64_t> bytes_received{0};
+        std::atomic<uint64_t> bytes_sent{0};
+        std::atomic<uint64_t> errors{0};
+        std::atomic<uint64_t> read_pauses{0};
+        std::atomic<uint64_t> bulk_transfers{0};
+        std::atomic<uint64_t> bulk_bytes{0};
+        std::atomic<uint64_t> compressions{0};
+        std::atomic<uint64_t> compress_in_bytes{0};
+        std::atomic<uint64_t> compress_out_bytes{0};
+        std::atomic<uint64_t> compress_ns{0};
+        std::atomic<uint64_t> compress_rejected{0};
+        std::atomic<uint64_t> compress_skipped{0};
+        std::atomic<uint64_t> decompressions{0};
+        std::atomic<uint64_t> decompress_in_bytes{0};
+        std::atomic<uint64_t> decompress_out_bytes{0};
+        std::atomic<uint64_t> decompress_ns{0};
+        std::atomic<uint64_t> udp_datagrams_received{0};
+        std::atomic<uint64_t> udp_datagrams_sent{0};
+        std::atomic<uint64_t> udp_dropped{0};
+        // 与当前连接数一样是增量，会话数不随 reset() 清零
+        std::atomic<int64_t> udp_sessions{0};
+    };
+
+    template <typename T>
+    static T load(const std::atomic<T>& counter) {
+        return counter.load(std::memory_order_relaxed);
+    }
+    template <typename T>
+    T sum(std::atomic<T> CounterShard::*field) const {
+        T total = 0;
+        counters_.forEach(
+            [&](const CounterShard& shard) { total += load(shard.*field); });
+        return total;
+    }
+
+    ThreadShards<CounterShard> counters_;
+
+    std::array<LatencyHistogram, static_cast<size_t>(LatencyStage::Count)>
+        latency_;
+};
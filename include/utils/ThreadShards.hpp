@@ -0,0 +1,114 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace detail {
+
+// 每个线程一份：按 ThreadShards 实例 id 索引到本线程的分片
+struct ThreadShardCache {
+    std::vector<void*> shards;
+    std::vector<std::atomic<bool>*> owned;
+
+    ~ThreadShardCache() {
+        // 线程退出时归还分片：数据保留，由之后注册的线程接着写
+        for (auto* flag : owned) {
+            if (flag) flag->store(false, std::memory_order_release);
+        }
+    }
+};
+
+inline thread_local ThreadShardCache tls_shard_cache;
+inline std::atomic<size_t> next_thread_shards_id{0};
+
+}  // namespace detail
+
+/*
+按线程分片的统计存储：
+- local() 返回当前线程独占的分片，首次访问时注册，之后只是一次线程本地数组查找
+- 分片只由所属线程写入，写者可用 relaxed load + store 代替原子 RMW，
+  各分片按缓存行对齐，线程之间没有伪共享
+- forEach() 在读取时遍历所有分片做汇总（冷路径，加锁）
+实例需比所有写入它的线程活得更久（统计对象均为进程级单例）
+*/
+template <typename Shard>
+class ThreadShards {
+   public:
+    ThreadShards()
+        : id_(detail::next_thread_shards_id.fetch_add(
+              1, std::memory_order_relaxed)) {}
+
+    ThreadShards(const ThreadShards&) = delete;
+    ThreadShards& operator=(const ThreadShards&) = delete;
+
+    Shard& local() {
+        auto& cache = detail::tls_shard_cache;
+        if (id_ < cache.shards.size() && cache.shards[id_]) {
+            return *static_cast<Shard*>(cache.shards[id_]);
+        }
+        return registerLocal();
+    }
+
+    template <typename Fn>
+    void forEach(Fn&& fn) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& entry : entries_) {
+            fn(static_cast<const Shard&>(entry->shard));
+        }
+    }
+    template <typename Fn>
+    void forEach(Fn&& fn) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& entry : entries_) {
+            fn(entry->shard);
+        }
+    }
+
+   private:
+    struct alignas(64) Entry {
+        Shard shard;
+        std::atomic<bool> owned{false};
+    };
+
+    Shard& registerLocal() {
+        Entry* entry = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            // 优先接管已退出线程留下的分片，避免线程反复创建时分片无限增长
+            for (auto& candidate : entries_) {
+                bool expected = false;
+                if (candidate->owned.compare_exchange_strong(
+                        expected, true, std::memory_order_acq_rel)) {
+                    entry = candidate.get();
+                    break;
+                }
+            }
+            if (!entry) {
+                entries_.push_back(std::make_unique<Entry>());
+                entry = entries_.back().get();
+                entry->owned.store(true, std::memory_order_relaxed);
+            }
+        }
+        auto& cache = detail::tls_shard_cache;
+        if (cache.shards.size() <= id_) {
+            cache.shards.resize(id_ + 1, nullptr);
+            cache.owned.resize(id_ + 1, nullptr);
+        }
+        cache.shards[id_] = &entry->shard;
+        cache.owned[id_] = &entry->owned;
+        return entry->shard;
+    }
+
+    const size_t id_;
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<Entry>> entries_;
+};
+
+// 单写者计数：只有所属线程修改，relaxed 保证读者不会读到撕裂的值
+template <typename T>
+inline void bumpLocal(std::atomic<T>& counter, T delta) {
+    counter.store(counter.load(std::memory_order_relaxed) + delta,
+                  std::memory_order_relaxed);
+}
@@ -0,0 +1,109 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+/*
+分层时间轮（每个 Reactor 一个，只在所属线程内使用，不加锁）：
+- 4 层：第 0 层 256 槽，其余每层 64 槽；tick 默认 10ms 时覆盖约 7.7 天，
+  更远的期限按最大范围处理
+- 定时器节点侵入式（双向链表），由调用方持有：schedule / 重新 schedule / cancel
+  都只是链表摘挂，O(1)，不分配内存，也不占用内核定时器
+- 高层槽在低层转完一圈时整体下放（cascade），每个定时器最多下放 3 次
+- 调用方用 timeoutMs() 作为 epoll_wait / io_uring 超时，醒来后 advance() 触发到期回调
+到期回调里可以重新 schedule 当前或其他定时器
+*/
+class TimerWheel {
+   public:
+    static constexpr uint32_t kDefaultTickMs = 10;
+
+    struct Timer {
+        Timer* prev = nullptr;
+        Timer* next = nullptr;
+        uint64_t expires = 0;  // 到期 tick
+        uint64_t data = 0;     // 调用方自定义（如 fd + generation）
+        uint32_t slot = 0;
+
+        bool scheduled() const { return next != nullptr; }
+    };
+
+    explicit TimerWheel(uint32_t tick_ms = kDefaultTickMs);
+
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+
+    // 单调时钟的毫秒数（CLOCK_MONOTONIC_COARSE，读取只需几纳秒）
+    static int64_t nowMs();
+
+    // 在 deadline_ms（nowMs 时间基）或之后触发；已挂在轮上时先摘下再挂
+    void schedule(Timer& timer, int64_t deadline_ms);
+    void cancel(Timer& timer);
+
+    // 触发所有期限不晚于 now_ms 的定时器，返回触发个数
+    template <typename Fn>
+    size_t advance(int64_t now_ms, Fn&& on_expire) {
+        uint64_t target = floorTick(now_ms);
+        size_t fired = 0;
+        while (current_tick_ <= target) {
+            if (size_ == 0) {
+                // 空轮直接跳到目标时刻
+                current_tick_ = target + 1;
+                break;
+            }
+            Timer expired;
+            expired.prev = expired.next = &expired;
+            step(expired);
+            // 先整体摘出再逐个回调，回调里重新 schedule 不会影响遍历
+            while (expired.next != &expired) {
+                Timer* timer = expired.next;
+                unlink(*timer);
+                --size_;
+                ++fired;
+                on_expire(*timer);
+            }
+        }
+        return fired;
+    }
+
+    // 距离下一次需要 advance 的毫秒数，轮为空时返回 -1（无限等待）
+    int timeoutMs(int64_t now_ms) const;
+
+    size_t size() const { return size_; }
+
+   private:
+    static constexpr uint32_t kLevel0Bits = 8;
+    static constexpr uint32_t kLevelBits = 6;
+    static constexpr uint32_t kLevels = 4;
+    static constexpr uint32_t kLevel0Slots = 1u << kLevel0Bits;
+    static constexpr uint32_t kLevelSlots = 1u << kLevelBits;
+    static constexpr uint32_t kTotalSlots =
+        kLevel0Slots + (kLevels - 1) * kLevelSlots;
+    static constexpr uint64_t kMaxTicks =
+        (uint64_t(1) << (kLevel0Bits + (kLevels - 1) * kLevelBits)) - 1;
+
+    // 期限向上取整、当前时间向下取整到 tick，保证不会提前触发
+    uint64_t ceilTick(int64_t ms) const {
+        return ms <= 0 ? 0
+                       : (static_cast<uint64_t>(ms) + tick_ms_ - 1) / tick_ms_;
+    }
+    uint64_t floorTick(int64_t ms) const {
+        return ms <= 0 ? 0 : static_cast<uint64_t>(ms) / tick_ms_;
+    }
+    static void unlink(Timer& timer) {
+        timer.prev->next = timer.next;
+        timer.next->prev = timer.prev;
+        timer.prev = timer.next = nullptr;
+    }
+    // 按 expires 挂到对应层的槽
+    void insert(Timer& timer);
+    // 下放 level 层当前槽，返回该层的槽下标
+    uint32_t cascade(uint32_t level);
+    // 推进一个 tick，把到期的定时器整体移到 expired
+    void step(Timer& expired);
+
+    const uint32_t tick_ms_;
+    uint64_t current_tick_;  // 下一个待处理的 tick
+    size_t size_ = 0;
+    Timer slots_[kTotalSlots];  // 各槽链表的哨兵
+    // 第 0 层非空槽位图，timeoutMs 用它找下一个到期的槽
+    uint64_t level0_bitmap_[kLevel0Slots / 64] = {};
+};
@@ -1,20 +1,152 @@
 // client.cpp
 #include <arpa/inet.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/stat.h>
 #include <unistd.h>
 
+#include <chrono>
+#include <cstring>
 #include <iostream>
+#include <memory>
+#include <sstream>
 #include <string>
 #include <vector>
 
+#include "net/BulkTransfer.hpp"
 #include "net/Packet.hpp"
-#include "net/Protocol.hpp"
+#include "net/protocol/TcpProtocol.hpp"
+#include "net/protocol/UdpProtocol.hpp"
+
+// 等待期间收到服务端 ping 时回复 pong
+static bool replyPing(BaseProtocol& proto, const Packet& resp) {
+    if (resp.payload.empty() ||
+        static_cast<uint8_t>(resp.payload[0]) != Packet::kPing) {
+        return true;
+    }
+    proto.enqueuePacket(Packet::make(
+        std::string(1, static_cast<char>(Packet::kPong)),
+        Packet::kControlHeader));
+    int saved_errno = 0;
+    if (!proto.flushSendBuffer(saved_errno)) {
+        std::cerr << "send failed, errno=" << saved_errno << "\n";
+        return false;
+    }
+    return true;
+}
+
+// get <远端路径> <本地文件> [offset [length]]：批量传输下载文件区域（仅 TCP）。
+// 不给 offset 时从本地文件当前大小处续传；内容边收边写盘，内存占用与文件大小无关。
+// 返回 false 表示连接已不可用
+static bool fetchFile(TcpProtocol& proto, int sockfd, const std::string& args) {
+    std::istringstream in(args);
+    std::string remote, local;
+    bulk::Request request;
+    if (!(in >> remote >> local)) {
+        std::cerr << "usage: get <remote> <local> [offset [length]]\n\n";
+        return true;
+    }
+    bool has_offset = static_cast<bool>(in >> request.offset);
+    if (has_offset) in >> request.length;
+
+    int file_fd = ::open(local.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+    if (file_fd < 0) {
+        std::cerr << "open " << local << ": " << strerror(errno) << "\n\n";
+        return true;
+    }
+    struct stat st {};
+    if (!has_offset && ::fstat(file_fd, &st) == 0) {
+        request.offset = static_cast<uint64_t>(st.st_size);
+    }
+    request.path = remote;
+
+    auto start = std::chrono::steady_clock::now();
+    std::string frame = bulk::encodeRequest(request);
+    proto.sendQueue().appendRaw(frame.data(), frame.size());
+    int saved_errno = 0;
+    while (proto.hasPendingSendData()) {
+        if (!proto.flushSendBuffer(saved_errno)) {
+            std::cerr << "send failed, errno=" << saved_errno << "\n";
+            ::close(file_fd);
+            return false;
+        }
+    }
+
+    // 等待响应帧，期间可能夹着服务端的心跳
+    bulk::Response response;
+    Packet resp;
+    while (true) {
+        auto status = proto.tryReceivePacket(resp);
+        if (status == BaseProtocol::ReadStatus::Error) {
+            std::cerr << "server closed or error\n";
+            ::close(file_fd);
+            return false;
+        }
+        if (status != BaseProtocol::ReadStatus::OK) continue;
+        if (resp.header == Packet::kControlHeader) {
+            if (!replyPing(proto, resp)) {
+                ::close(file_fd);
+                return false;
+            }
+            continue;
+        }
+        if (resp.header != Packet::kBulkResponseHeader) continue;
+        std::span<const uint8_t> payload(
+            reinterpret_cast<const uint8_t*>(resp.payload.data()),
+            resp.payload.size());
+        if (!bulk::parseResponse(payload, response)) {
+            std::cerr << "malformed bulk response\n";
+            ::close(file_fd);
+            return false;
+        }
+        break;
+    }
+    if (response.status != bulk::Status::Ok) {
+        std::cerr << "get " << remote << ": "
+                  << bulk::statusName(response.status)
+                  << " (remote size " << response.file_size << ")\n\n";
+        ::close(file_fd);
+        return true;
+    }
+
+    bool ok = bulk::receiveToFile(proto, sockfd, file_fd, response.offset,
+                                  response.length);
+    if (!ok) {
+        std::cerr << "transfer failed: " << strerror(errno) << "\n";
+    } else if (response.offset + response.length == response.file_size) {
+        // 读到远端末尾：去掉本地文件比远端多出的旧内容
+        ::ftruncate(file_fd, static_cast<off_t>(response.file_size));
+    }
+    ::close(file_fd);
+    if (!ok) return false;
+
+    double seconds = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+    std::cout << "Got " << response.length << " bytes [" << response.offset
+              << ", " << response.offset + response.length << ") of "
+              << response.file_size << " in " << seconds << "s ("
+              << (seconds > 0 ? response.length / seconds / (1024 * 1024) : 0)
+              << " MiB/s)\n\n";
+    return true;
+}
 
 int main(int argc, char* argv[]) {
     const char* server_ip = (argc > 1 ? argv[1] : "127.0.0.1");
     int server_port = (argc > 2 ? std::stoi(argv[2]) : 8888);
+    // 其余参数：crc 使用 CRC32C 校验帧（0xABCE），udp 改用 UDP 数据报收发
+    bool use_crc = false;
+    bool use_udp = false;
+    for (int i = 3; i < argc; ++i) {
+        std::string option = argv[i];
+        if (option == "crc") use_crc = true;
+        if (option == "udp") use_udp = true;
+    }
+    uint16_t frame_header =
+        use_crc ? Packet::kCrc32cHeader : Packet::kSum16Header;
 
-    // 1) 创建 TCP socket
-    int sockfd = ::socket(AF_INET, SOCK_STREAM, 0);
+    // 1) 创建 TCP / UDP socket
+    int sockfd = ::socket(AF_INET, use_udp ? SOCK_DGRAM : SOCK_STREAM, 0);
     if (sockfd < 0) {
         perror("socket");
         return 1;
@@ -34,10 +166,20 @@ int main(int argc, char* argv[]) {
         ::close(sockfd);
         return 1;
     }
-    std::cout << "Connected to " << server_ip << ":" << server_port << "\n";
+    std::cout << "Connected to " << server_ip << ":" << server_port
+              << (use_udp ? " (udp)" : "") << "\n";
 
-    // 3) 用 Protocol 封装读写
-    Protocol proto(sockfd);
+    // 3) 用 Protocol 封装读写；UdpProtocol 接管 socket，析构时关闭
+    std::unique_ptr<BaseProtocol> owner;
+    int udp_fd = -1;
+    if (use_udp) {
+        owner = std::make_unique<UdpProtocol>(sockfd, servaddr);
+        udp_fd = sockfd;
+        sockfd = -1;
+    } else {
+        owner = std::make_unique<TcpProtocol>(sockfd);
+    }
+    BaseProtocol& proto = *owner;
 
     while (true) {
         // 4) 从 stdin 读一行
@@ -46,15 +188,18 @@ int main(int argc, char* argv[]) {
         if (!std::getline(std::cin, line) || line == "exit") {
             break;
         }
+        if (line.rfind("get ", 0) == 0) {
+            if (use_udp) {
+                std::cerr << "get is only supported over TCP\n\n";
+            } else if (!fetchFile(static_cast<TcpProtocol&>(proto), sockfd,
+                                  line.substr(4))) {
+                goto CLEANUP;
+            }
+            continue;
+        }
 
         // 5) 构造 Packet 并 enqueue 到 Protocol
-        Packet pkt;
-        pkt.header = 0xABCD;
-        pkt.payload = line;
-        pkt.length = static_cast<uint32_t>(line.size());
-        pkt.checksum =
-            calculate_checksum(std::vector<uint8_t>(line.begin(), line.end()));
-        proto.enqueuePacket(pkt);
+        proto.enqueuePacket(Packet::make(line, frame_header));
 
         // 6) flushSendBuffer 直到 send_buffer_ 清空
         int saved_errno = 0;
@@ -74,19 +219,33 @@ int main(int argc, char* argv[]) {
         Packet resp;
         while (true) {
             auto status = proto.tryReceivePacket(resp);
-            if (status == Protocol::ReadStatus::OK) {
+            if (status == BaseProtocol::ReadStatus::OK) {
+                if (resp.header == Packet::kControlHeader) {
+                    // 服务端心跳：回复 pong 后继续等待本次请求的响应
+                    if (!replyPing(proto, resp)) goto CLEANUP;
+                    continue;
+                }
                 std::cout << "Echo> " << resp.payload << "\n\n";
                 break;
             }
-            if (status == Protocol::ReadStatus::Error) {
+            if (status == BaseProtocol::ReadStatus::Error) {
                 std::cerr << "server closed or error\n";
                 goto CLEANUP;
             }
-            // NeedRetry：继续循环，从 socket 再读
+            // NeedRetry：TCP 继续循环，从 socket 再读；
+            // UDP 等待数据报到达，超时视为请求或响应丢失
+            if (use_udp) {
+                pollfd pfd{udp_fd, POLLIN, 0};
+                if (::poll(&pfd, 1, 1000) == 0) {
+                    std::cerr << "no response (datagram lost)\n\n";
+                    break;
+                }
+            }
         }
     }
 
 CLEANUP:
-    ::close(sockfd);
+    owner.reset();
+    if (sockfd >= 0) ::close(sockfd);
     return 0;
 }
@@ -1,19 +1,128 @@
 // main/main_load_test.cpp
 #include "load_test/LoadTester.hpp"
+#include "net/Packet.hpp"
 #include <iostream>
+#include <sstream>
+
+static void usage(const char* prog) {
+    std::cerr << "Usage:\n"
+              << "  " << prog
+              << " <host> <port> <threads> <msgs_per_thread> [crc]\n"
+              << "      closed loop: each connection sends the next message "
+                 "after the previous echo\n"
+              << "  " << prog
+              << " <host> <port> <connections> --rate <req/s> [--duration <s>]"
+                 " [--poisson] [--size <spec>] [--sweep <r1,r2,...>] [--crc]\n"
+              << "      open loop: requests follow a fixed schedule, latency is "
+                 "measured from the intended send time\n"
+              << "  " << prog
+              << " <host> <port> <threads> --conns <per_thread> [--depth <K>]"
+                 " [--requests <per_conn> | --duration <s>]"
+                 " [--connect-rate <conn/s>] [--size <spec>] [--csv <file>]"
+                 " [--crc]\n"
+              << "      multiplexed: each thread drives many nonblocking "
+                 "connections through epoll, K requests in flight each\n"
+              << "  <spec>: 256 (fixed), 64-1024 (uniform), exp:256 "
+                 "(exponential mean)\n";
+}
 
 int main(int argc, char** argv) {
-    if (argc != 5) {
-        std::cerr << "Usage: " << argv[0]
-                  << " <host> <port> <threads> <msgs_per_thread>\n";
+    if (argc < 5) {
+        usage(argv[0]);
         return 1;
     }
     auto host  = std::string(argv[1]);
     auto port  = static_cast<uint16_t>(std::stoi(argv[2]));
     int  threads = std::stoi(argv[3]);
-    int  msgs    = std::stoi(argv[4]);
 
-    LoadTester tester(host, port, threads, msgs);
-    tester.run();
+    // 闭环模式：<msgs_per_thread> [crc]
+    if (std::string(argv[4]).rfind("--", 0) != 0) {
+        if (argc != 5 && !(argc == 6 && std::string(argv[5]) == "crc")) {
+            usage(argv[0]);
+            return 1;
+        }
+        int msgs = std::stoi(argv[4]);
+        // crc：使用 CRC32C 校验帧（0xABCE）
+        uint16_t header =
+            argc == 6 ? Packet::kCrc32cHeader : Packet::kSum16Header;
+        LoadTester tester(host, port, threads, msgs, header);
+        tester.run();
+        return 0;
+    }
+
+    // 开环 / 多路复用模式
+    OpenLoopOptions open_loop;
+    MultiplexOptions multiplex;
+    std::vector<double> sweep_rates;
+    uint16_t header = Packet::kSum16Header;
+    bool has_rate = false;
+    bool has_conns = false;
+    bool has_requests = false;
+    bool has_duration = false;
+    PayloadSizes payload;
+    for (int i = 4; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--rate" && has_value) {
+            open_loop.rate = std::stod(argv[++i]);
+            has_rate = true;
+        } else if (arg == "--duration" && has_value) {
+            open_loop.duration = multiplex.duration = std::stod(argv[++i]);
+            has_duration = true;
+        } else if (arg == "--size" && has_value) {
+            if (!PayloadSizes::parse(argv[++i], payload)) {
+                usage(argv[0]);
+                return 1;
+            }
+        } else if (arg == "--sweep" && has_value) {
+            std::stringstream list(argv[++i]);
+            std::string rate;
+            while (std::getline(list, rate, ',')) {
+                if (!rate.empty()) sweep_rates.push_back(std::stod(rate));
+            }
+        } else if (arg == "--poisson") {
+            open_loop.poisson = true;
+        } else if (arg == "--conns" && has_value) {
+            multiplex.connections_per_thread = std::stoi(argv[++i]);
+            has_conns = true;
+        } else if (arg == "--depth" && has_value) {
+            multiplex.pipeline_depth = std::stoi(argv[++i]);
+        } else if (arg == "--requests" && has_value) {
+            multiplex.requests_per_connection = std::stoull(argv[++i]);
+            has_requests = true;
+        } else if (arg == "--connect-rate" && has_value) {
+            multiplex.connect_rate = std::stod(argv[++i]);
+        } else if (arg == "--csv" && has_value) {
+            multiplex.csv_path = argv[++i];
+        } else if (arg == "--crc") {
+            header = Packet::kCrc32cHeader;
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (threads <= 0) {
+        usage(argv[0]);
+        return 1;
+    }
+    open_loop.payload = multiplex.payload = payload;
+
+    LoadTester tester(host, port, threads, 0, header);
+    if (has_conns) {
+        if (multiplex.connections_per_thread <= 0) {
+            usage(argv[0]);
+            return 1;
+        }
+        // 只给 --duration 时按时长运行
+        if (has_duration && !has_requests) multiplex.requests_per_connection = 0;
+        tester.runMultiplexed(multiplex);
+    } else if (!sweep_rates.empty()) {
+        tester.sweep(open_loop, sweep_rates);
+    } else if (has_rate) {
+        tester.runOpenLoop(open_loop);
+    } else {
+        usage(argv[0]);
+        return 1;
+    }
     return 0;
 }
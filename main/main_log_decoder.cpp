@@ -0,0 +1,141 @@
+// main/main_log_decoder.cpp
+// 把二进制日志（AsyncLogOptions::binary）还原成与文本日志相同格式的行
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "utils/LogFormat.hpp"
+
+namespace {
+
+struct FormatDef {
+    std::string file;
+    uint32_t line = 0;
+    std::string format;
+};
+
+class Reader {
+   public:
+    explicit Reader(std::vector<uint8_t> data) : data_(std::move(data)) {}
+
+    bool done() const { return pos_ >= data_.size(); }
+
+    template <typename T>
+    bool read(T& value) {
+        if (data_.size() - pos_ < sizeof(T)) return false;
+        std::memcpy(&value, data_.data() + pos_, sizeof(T));
+        pos_ += sizeof(T);
+        return true;
+    }
+    bool readBytes(size_t size, const uint8_t*& out) {
+        if (data_.size() - pos_ < size) return false;
+        out = data_.data() + pos_;
+        pos_ += size;
+        return true;
+    }
+    bool readString(std::string& out) {
+        uint16_t size;
+        const uint8_t* bytes;
+        if (!read(size) || !readBytes(size, bytes)) return false;
+        out.assign(reinterpret_cast<const char*>(bytes), size);
+        return true;
+    }
+    size_t offset() const { return pos_; }
+
+   private:
+    std::vector<uint8_t> data_;
+    size_t pos_ = 0;
+};
+
+const char* levelTag(uint8_t level) {
+    static const char* kTags[] = {"[DEBUG] ", "[INFO] ", "[WARNING] ",
+                                  "[ERROR] ", "[FATAL] "};
+    return level < 5 ? kTags[level] : "[?] ";
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    if (argc != 2 && !(argc == 3 && std::string(argv[1]) == "-v")) {
+        std::cerr << "Usage: " << argv[0] << " [-v] <binary_log_file>\n"
+                  << "  -v  append the source location of each record\n";
+        return 1;
+    }
+    bool verbose = argc == 3;
+    std::ifstream in(argv[argc - 1], std::ios::binary);
+    if (!in) {
+        std::cerr << "Cannot open " << argv[argc - 1] << "\n";
+        return 1;
+    }
+    Reader reader(std::vector<uint8_t>(std::istreambuf_iterator<char>(in), {}));
+
+    std::unordered_map<uint32_t, FormatDef> formats;
+    char message[4096];
+    char timestamp[32];
+    while (!reader.done()) {
+        size_t record_offset = reader.offset();
+        uint8_t type;
+        reader.read(type);
+        bool ok = true;
+        if (type == utils::binlog::kSession) {
+            const uint8_t* magic;
+            ok = reader.readBytes(utils::binlog::kMagicSize, magic) &&
+                 std::memcmp(magic, utils::binlog::kMagic,
+                             utils::binlog::kMagicSize) == 0;
+            // 新的一次写入会重新分配格式串 id
+            formats.clear();
+        } else if (type == utils::binlog::kFormat) {
+            uint32_t id;
+            uint8_t level;
+            FormatDef def;
+            ok = reader.read(id) && reader.read(level) && reader.read(def.line) &&
+                 reader.readString(def.file) && reader.readString(def.format);
+            if (ok) formats[id] = std::move(def);
+        } else if (type == utils::binlog::kEvent) {
+            int64_t timestamp_ns;
+            uint32_t id;
+            uint8_t level;
+            uint16_t args_size;
+            const uint8_t* args;
+            ok = reader.read(timestamp_ns) && reader.read(id) &&
+                 reader.read(level) && reader.read(args_size) &&
+                 reader.readBytes(args_size, args);
+            if (ok) {
+                auto it = formats.find(id);
+                if (it == formats.end()) {
+                    std::snprintf(message, sizeof(message),
+                                  "<unknown format id %u>", id);
+                } else {
+                    utils::renderLogMessage(message, sizeof(message),
+                                            it->second.format.c_str(), args,
+                                            args_size);
+                }
+                time_t seconds = static_cast<time_t>(timestamp_ns / 1000000000);
+                struct tm tm_buf;
+                localtime_r(&seconds, &tm_buf);
+                strftime(timestamp, sizeof(timestamp), "%Y-%m-%d %H:%M:%S",
+                         &tm_buf);
+                std::cout << timestamp << ' ' << levelTag(level) << message;
+                if (verbose && it != formats.end()) {
+                    std::cout << "  (" << it->second.file << ':'
+                              << it->second.line << ')';
+                }
+                std::cout << '\n';
+            }
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            // 进程崩溃时最后一批可能只写了一半
+            std::cerr << "Corrupt or truncated record at offset "
+                      << record_offset << "\n";
+            return 1;
+        }
+    }
+    return 0;
+}
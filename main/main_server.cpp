@@ -1,6 +1,7 @@
 // main.cpp
 #include <csignal>
 #include <iostream>
+#include <string>
 
 #include "app/Server.hpp"
 #include "app/ServerConfig.hpp"
@@ -14,7 +15,15 @@ void handleSignal(int) {
     }
 }
 
-int main() {
+static void usage(const char* prog) {
+    std::cerr << "Usage: " << prog << " [--udp <port>] [--bulk-root <dir>]\n"
+              << "  --udp <port>       also serve UDP requests on <port> "
+                 "(default: TCP only)\n"
+              << "  --bulk-root <dir>  serve bulk file requests from files "
+                 "under <dir> (default: denied)\n";
+}
+
+int main(int argc, char* argv[]) {
     // 1) 配置
     ServerConfig config;
     config.port = 8888;
@@ -26,6 +35,20 @@ int main() {
     config.keep_alive_intvl = 10;
     config.keep_alive_probes = 5;
 
+    // 可选服务默认关闭，只在命令行显式开启
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--udp" && has_value) {
+            config.udp_port = std::stoi(argv[++i]);  // 可与 TCP 端口相同
+        } else if (arg == "--bulk-root" && has_value) {
+            config.bulk_root = argv[++i];  // 批量传输只提供该目录下的文件
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
     // 2) 创建 Server
     Server server(config);
     g_server = &server;
@@ -33,6 +56,8 @@ int main() {
     // 3) 注册信号，优雅退出
     std::signal(SIGINT, handleSignal);
     std::signal(SIGTERM, handleSignal);
+    // sendfile / splice 没有 MSG_NOSIGNAL，对端关闭时改为返回 EPIPE
+    std::signal(SIGPIPE, SIG_IGN);
 
     // 4) 初始化资源
     if (!server.setup()) {
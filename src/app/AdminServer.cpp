@@ -0,0 +1,348 @@
+#include "app/AdminServer.hpp"
+
+#include <poll.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+
+#include "app/SocketUtils.hpp"
+#include "utils/Logger.hpp"
+#include "utils/Metrics.hpp"
+
+namespace {
+
+// 导出给 Prometheus 的直方图桶上界（秒）。内部直方图是对数-线性桶，
+// 累计到每个上界时只统计整桶都不超过该上界的样本，误差在桶宽（~3%）以内
+constexpr double kLatencyBucketsSeconds[] = {
+    1e-6,   2.5e-6, 5e-6, 1e-5,  2.5e-5, 5e-5, 1e-4, 2.5e-4,
+    5e-4,   1e-3,   2.5e-3, 5e-3, 1e-2,  2.5e-2, 5e-2, 0.1,
+    0.25,   0.5,    1,      2.5,  5,     10};
+constexpr double kQuantiles[] = {0.5, 0.9, 0.99, 0.999};
+
+// 单个请求头的上限；/metrics 请求远小于此
+constexpr size_t kMaxRequestSize = 4096;
+// 单个抓取请求（读请求 + 写响应）的总时限，不是每次 recv/send 的超时：
+// 管理线程一次只服务一个客户端，慢速客户端不能借逐字节发送长期占住它
+constexpr std::chrono::seconds kClientTimeout{2};
+
+void appendf(std::string& out, const char* format, ...)
+    __attribute__((format(printf, 2, 3)));
+
+void appendf(std::string& out, const char* format, ...) {
+    char buffer[512];
+    va_list args;
+    va_start(args, format);
+    int n = vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    if (n > 0) {
+        out.append(buffer, std::min(static_cast<size_t>(n), sizeof(buffer) - 1));
+    }
+}
+
+void appendHeader(std::string& out, const char* name, const char* type,
+                  const char* help) {
+    appendf(out, "# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+}
+
+void appendCounter(std::string& out, const char* name, const char* help,
+                   uint64_t value) {
+    appendHeader(out, name, "counter", help);
+    appendf(out, "%s %llu\n", name, static_cast<unsigned long long>(value));
+}
+
+using Deadline = std::chrono::steady_clock::time_point;
+
+// 等待 fd 就绪直到 deadline；超时或出错返回 false
+bool waitReady(int fd, short events, Deadline deadline) {
+    while (true) {
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now());
+        if (remaining.count() <= 0) return false;
+        pollfd pfd{fd, events, 0};
+        int n = poll(&pfd, 1, static_cast<int>(remaining.count()));
+        if (n < 0 && errno == EINTR) continue;
+        return n > 0;
+    }
+}
+
+bool sendAll(int fd, const char* data, size_t size, Deadline deadline) {
+    while (size > 0) {
+        if (!waitReady(fd, POLLOUT, deadline)) return false;
+        ssize_t n = ::send(fd, data, size, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (n < 0) {
+            if (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK) {
+                continue;
+            }
+            return false;
+        }
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+}  // namespace
+
+AdminServer::AdminServer(const ServerConfig& config) : config_(config) {
+    // 管理端口复用数据面的监听参数，只替换端口，且不参与 SO_REUSEPORT 分流
+    config_.port = config.admin_port;
+}
+
+AdminServer::~AdminServer() { stop(); }
+
+void AdminServer::addGauge(std::string name, std::string help, GaugeFn fn) {
+    gauges_.push_back(
+        {std::move(name), std::move(help), "gauge", std::move(fn)});
+}
+
+void AdminServer::addCounter(std::string name, std::string help, GaugeFn fn) {
+    gauges_.push_back(
+        {std::move(name), std::move(help), "counter", std::move(fn)});
+}
+
+bool AdminServer::start() {
+    listen_fd_ = createListenSocket(config_, false);
+    if (listen_fd_ == -1) {
+        LOG_ERROR("Failed to start admin server on port %d", config_.port);
+        return false;
+    }
+    wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wake_fd_ == -1) {
+        LOG_ERROR("Failed to create admin eventfd: %s", strerror(errno));
+        close(listen_fd_);
+        listen_fd_ = -1;
+        return false;
+    }
+    running_ = true;
+    thread_ = std::thread([this]() { run(); });
+    LOG_INFO("Admin server listening on port %d (/metrics)", config_.port);
+    return true;
+}
+
+void AdminServer::stop() {
+    if (running_.exchange(false)) {
+        uint64_t one = 1;
+        ssize_t ignored = write(wake_fd_, &one, sizeof(one));
+        (void)ignored;
+    }
+    if (thread_.joinable()) thread_.join();
+    if (listen_fd_ != -1) {
+        close(listen_fd_);
+        listen_fd_ = -1;
+    }
+    if (wake_fd_ != -1) {
+        close(wake_fd_);
+        wake_fd_ = -1;
+    }
+}
+
+void AdminServer::run() {
+    pollfd fds[2] = {{listen_fd_, POLLIN, 0}, {wake_fd_, POLLIN, 0}};
+    while (running_) {
+        int n = poll(fds, 2, -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            LOG_ERROR("Admin poll failed: %s", strerror(errno));
+            break;
+        }
+        if (fds[1].revents) break;
+        if (!(fds[0].revents & POLLIN)) continue;
+        // 一次只处理一个抓取请求，管理流量不需要并发
+        int client_fd = accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+        if (client_fd == -1) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                LOG_ERROR("Admin accept failed: %s", strerror(errno));
+            }
+            continue;
+        }
+        handleClient(client_fd);
+        close(client_fd);
+    }
+}
+
+void AdminServer::handleClient(int client_fd) {
+    Deadline deadline = std::chrono::steady_clock::now() + kClientTimeout;
+
+    // 只需要请求行：读到请求头结束或缓冲区满为止；超过总时限直接断开，不回复
+    std::string request;
+    char buffer[1024];
+    while (request.find("\r\n\r\n") == std::string::npos &&
+           request.size() < kMaxRequestSize) {
+        if (!waitReady(client_fd, POLLIN, deadline)) return;
+        ssize_t n = recv(client_fd, buffer, sizeof(buffer), MSG_DONTWAIT);
+        if (n < 0 && (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK)) {
+            continue;
+        }
+        if (n <= 0) break;
+        request.append(buffer, static_cast<size_t>(n));
+    }
+
+    const char* status = "200 OK";
+    const char* content_type = "text/plain; version=0.0.4; charset=utf-8";
+    std::string body;
+    if (request.compare(0, 13, "GET /metrics ") == 0 ||
+        request.compare(0, 13, "GET /metrics?") == 0) {
+        body = renderMetrics();
+    } else if (request.compare(0, 4, "GET ") == 0) {
+        status = "404 Not Found";
+        content_type = "text/plain";
+        body = "Not Found\n";
+    } else {
+        status = "405 Method Not Allowed";
+        content_type = "text/plain";
+        body = "Method Not Allowed\n";
+    }
+
+    std::string response;
+    appendf(response,
+            "HTTP/1.1 %s\r\nContent-Type: %s\r\nContent-Length: %zu\r\n"
+            "Connection: close\r\n\r\n",
+            status, content_type, body.size());
+    response += body;
+    sendAll(client_fd, response.data(), response.size(), deadline);
+}
+
+std::string AdminServer::renderMetrics() const {
+    Metrics& metrics = Metrics::getInstance();
+    Metrics::Snapshot snap = metrics.snapshot();
+    std::string out;
+    out.reserve(8192);
+
+    appendCounter(out, "mcs_connections_accepted_total",
+                  "Connections accepted since start.", snap.total_connections);
+    appendCounter(out, "mcs_requests_total", "Requests processed.",
+                  snap.requests);
+    appendCounter(out, "mcs_received_bytes_total", "Bytes of request frames.",
+                  snap.bytes_received);
+    appendCounter(out, "mcs_sent_bytes_total", "Bytes written to sockets.",
+                  snap.bytes_sent);
+    appendCounter(out, "mcs_errors_total", "Request handling errors.",
+                  snap.errors);
+    appendCounter(out, "mcs_read_pauses_total",
+                  "Reads paused because pending output hit the high watermark.",
+                  snap.read_pauses);
+    appendCounter(out, "mcs_bulk_transfers_total",
+                  "File regions queued by bulk transfer requests.",
+                  snap.bulk_transfers);
+    appendCounter(out, "mcs_bulk_bytes_total",
+                  "Bytes of file regions queued for sendfile/splice.",
+                  snap.bulk_bytes);
+    appendCounter(out, "mcs_compressions_total",
+                  "Payloads compressed and sent compressed.", snap.compressions);
+    appendCounter(out, "mcs_compress_in_bytes_total",
+                  "Uncompressed bytes of compressed payloads.",
+                  snap.compress_in_bytes);
+    appendCounter(out, "mcs_compress_out_bytes_total",
+                  "Compressed bytes of compressed payloads.",
+                  snap.compress_out_bytes);
+    appendCounter(out, "mcs_compress_nanoseconds_total",
+                  "Time spent compressing, including rejected attempts.",
+                  snap.compress_ns);
+    appendCounter(out, "mcs_compress_rejected_total",
+                  "Payloads sent raw because compression did not shrink them.",
+                  snap.compress_rejected);
+    appendCounter(out, "mcs_compress_skipped_total",
+                  "Payloads below the compression size threshold.",
+                  snap.compress_skipped);
+    appendCounter(out, "mcs_decompressions_total", "Payloads decompressed.",
+                  snap.decompressions);
+    appendCounter(out, "mcs_decompress_in_bytes_total",
+                  "Compressed bytes fed to the decompressor.",
+                  snap.decompress_in_bytes);
+    appendCounter(out, "mcs_decompress_out_bytes_total",
+                  "Bytes produced by the decompressor.",
+                  snap.decompress_out_bytes);
+    appendCounter(out, "mcs_decompress_nanoseconds_total",
+                  "Time spent decompressing.", snap.decompress_ns);
+    appendCounter(out, "mcs_udp_datagrams_received_total",
+                  "UDP datagrams received.", snap.udp_datagrams_received);
+    appendCounter(out, "mcs_udp_datagrams_sent_total", "UDP datagrams sent.",
+                  snap.udp_datagrams_sent);
+    appendCounter(out, "mcs_udp_dropped_total",
+                  "UDP datagrams dropped (invalid, truncated or unsendable).",
+                  snap.udp_dropped);
+
+    appendCounter(out, "mcs_buffer_pool_hits_total",
+                  "Buffer allocations served from the thread-local cache.",
+                  snap.buffer_pool.hits);
+    appendCounter(out, "mcs_buffer_pool_refills_total",
+                  "Buffer allocations that refilled from the shared depot.",
+                  snap.buffer_pool.refills);
+    appendCounter(out, "mcs_buffer_pool_misses_total",
+                  "Buffer allocations that needed new memory.",
+                  snap.buffer_pool.misses);
+    appendHeader(out, "mcs_buffer_pool_reserved_bytes", "gauge",
+                 "Bytes reserved by the buffer pool arena.");
+    appendf(out, "mcs_buffer_pool_reserved_bytes %llu\n",
+            static_cast<unsigned long long>(snap.buffer_pool.reserved_bytes));
+
+    appendHeader(out, "mcs_connections", "gauge", "Currently open connections.");
+    appendf(out, "mcs_connections %llu\n",
+            static_cast<unsigned long long>(snap.current_connections));
+    appendHeader(out, "mcs_udp_sessions", "gauge",
+                 "UDP peers currently tracked.");
+    appendf(out, "mcs_udp_sessions %llu\n",
+            static_cast<unsigned long long>(snap.udp_sessions));
+    for (const auto& gauge : gauges_) {
+        appendHeader(out, gauge.name.c_str(), gauge.type, gauge.help.c_str());
+        appendf(out, "%s %.17g\n", gauge.name.c_str(), gauge.fn());
+    }
+
+    // 延迟：可跨实例聚合的直方图 + 服务端按完整直方图算出的分位数
+    constexpr auto kStages = static_cast<size_t>(Metrics::LatencyStage::Count);
+    LatencyHistogram::Snapshot latency[kStages];
+    for (size_t i = 0; i < kStages; ++i) {
+        latency[i] = metrics.getLatency(static_cast<Metrics::LatencyStage>(i));
+    }
+
+    appendHeader(out, "mcs_latency_seconds", "histogram",
+                 "Per-request processing latency by stage.");
+    for (size_t i = 0; i < kStages; ++i) {
+        const char* stage =
+            Metrics::stageName(static_cast<Metrics::LatencyStage>(i));
+        const auto& h = latency[i];
+        uint64_t cumulative = 0;
+        size_t bucket = 0;
+        for (double le : kLatencyBucketsSeconds) {
+            uint64_t le_ns = static_cast<uint64_t>(le * 1e9);
+            while (bucket < h.counts.size() &&
+                   LatencyHistogram::bucketUpperBound(bucket) <= le_ns) {
+                cumulative += h.counts[bucket++];
+            }
+            appendf(out,
+                    "mcs_latency_seconds_bucket{stage=\"%s\",le=\"%g\"} %llu\n",
+                    stage, le, static_cast<unsigned long long>(cumulative));
+        }
+        appendf(out,
+                "mcs_latency_seconds_bucket{stage=\"%s\",le=\"+Inf\"} %llu\n",
+                stage, static_cast<unsigned long long>(h.count));
+        appendf(out, "mcs_latency_seconds_sum{stage=\"%s\"} %.9f\n", stage,
+                h.sum / 1e9);
+        appendf(out, "mcs_latency_seconds_count{stage=\"%s\"} %llu\n", stage,
+                static_cast<unsigned long long>(h.count));
+    }
+
+    appendHeader(out, "mcs_latency_quantile_seconds", "gauge",
+                 "Latency quantiles since start, from the server-side histogram.");
+    for (size_t i = 0; i < kStages; ++i) {
+        const char* stage =
+            Metrics::stageName(static_cast<Metrics::LatencyStage>(i));
+        for (double q : kQuantiles) {
+            appendf(out,
+                    "mcs_latency_quantile_seconds{stage=\"%s\",quantile=\"%g\"} "
+                    "%.9f\n",
+                    stage, q, latency[i].percentile(q * 100) / 1e9);
+        }
+        appendf(out,
+                "mcs_latency_quantile_seconds{stage=\"%s\",quantile=\"1\"} %.9f\n",
+                stage, latency[i].max / 1e9);
+    }
+    return out;
+}
@@ -0,0 +1,33 @@
+#include "app/ConnectionTimers.hpp"
+
+ConnectionTimers::ConnectionTimers(const ServerConfig& config)
+    : wheel_(static_cast<uint32_t>(
+          config.timer_tick_ms > 0 ? config.timer_tick_ms : 1)) {
+    timeouts_.idle_ms = config.connection_timeout;
+    timeouts_.read_ms = config.read_timeout;
+    timeouts_.write_ms = config.write_timeout;
+    timeouts_.heartbeat_interval_ms = config.heartbeat_interval;
+    timeouts_.heartbeat_timeout_ms = config.heartbeat_timeout;
+}
+
+void ConnectionTimers::add(int fd, uint32_t generation) {
+    if (!enabled() || fd < 0) return;
+    if (static_cast<size_t>(fd) >= timers_.size()) {
+        timers_.resize(static_cast<size_t>(fd) + 1);
+    }
+    TimerWheel::Timer& timer = timers_[fd];
+    timer.data = (uint64_t(generation) << 32) | uint32_t(fd);
+    // 首次检查放在最短的超时之后，之后由 checkTimeouts 给出准确期限
+    int64_t first = INT64_MAX;
+    for (int64_t limit : {timeouts_.idle_ms, timeouts_.read_ms,
+                          timeouts_.write_ms, timeouts_.heartbeat_interval_ms}) {
+        if (limit > 0 && limit < first) first = limit;
+    }
+    wheel_.schedule(timer, TimerWheel::nowMs() + first);
+}
+
+void ConnectionTimers::remove(int fd) {
+    if (fd >= 0 && static_cast<size_t>(fd) < timers_.size()) {
+        wheel_.cancel(timers_[fd]);
+    }
+}
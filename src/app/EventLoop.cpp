@@ -0,0 +1,256 @@
+#include "app/EventLoop.hpp"
+
+#include <arpa/inet.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include "app/SocketUtils.hpp"
+#include "utils/Logger.hpp"
+
+EventLoop::EventLoop(int index, const ServerConfig& config)
+    : index_(index),
+      config_(config),
+      listen_fd_(-1),
+      epoll_fd_(-1),
+      wakeup_fd_(-1),
+      running_(false),
+      timers_(config) {}
+
+EventLoop::~EventLoop() {
+    cleanupAllConnections();
+    if (wakeup_fd_ != -1) close(wakeup_fd_);
+    if (epoll_fd_ != -1) close(epoll_fd_);
+    if (listen_fd_ != -1) close(listen_fd_);
+}
+
+bool EventLoop::setup() {
+    listen_fd_ = createListenSocket(config_, config_.reuse_port);
+    if (listen_fd_ == -1) {
+        return false;
+    }
+
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd_ == -1) {
+        LOG_ERROR("Reactor %d: failed to create epoll: %s", index_,
+                  strerror(errno));
+        return false;
+    }
+
+    wakeup_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakeup_fd_ == -1) {
+        LOG_ERROR("Reactor %d: failed to create eventfd: %s", index_,
+                  strerror(errno));
+        return false;
+    }
+
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = listen_fd_;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, listen_fd_, &ev) == -1) {
+        LOG_ERROR("Reactor %d: failed to add listen socket to epoll: %s",
+                  index_, strerror(errno));
+        return false;
+    }
+    ev.data.fd = wakeup_fd_;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wakeup_fd_, &ev) == -1) {
+        LOG_ERROR("Reactor %d: failed to add eventfd to epoll: %s", index_,
+                  strerror(errno));
+        return false;
+    }
+
+    if (config_.udp_port > 0) {
+        udp_ = std::make_unique<UdpEndpoint>(config_);
+        if (!udp_->setup(config_.reuse_port)) return false;
+        // 水平触发：一次事件只处理有限批次，剩余数据报下一轮继续通知
+        ev.events = EPOLLIN;
+        ev.data.fd = udp_->fd();
+        if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, udp_->fd(), &ev) == -1) {
+            LOG_ERROR("Reactor %d: failed to add UDP socket to epoll: %s",
+                      index_, strerror(errno));
+            return false;
+        }
+    }
+
+    running_ = true;
+    return true;
+}
+
+void EventLoop::run() {
+    if (config_.reactor_cpu_affinity) {
+        bindToCpu(index_);
+    }
+
+    const int MAX_EVENTS = 1024;
+    epoll_event events[MAX_EVENTS];
+
+    LOG_INFO("Reactor %d loop started", index_);
+    while (running_) {
+        // 等待时长取最近的超时检查时刻，没有连接时无限等待
+        int timeout = timers_.timeoutMs();
+        if (udp_) timeout = udp_->timeoutMs(timeout);
+        int n = epoll_wait(epoll_fd_, events, MAX_EVENTS, timeout);
+        if (n == -1) {
+            if (errno == EINTR) continue;
+            LOG_ERROR("Reactor %d: epoll_wait error: %s", index_,
+                      strerror(errno));
+            break;
+        }
+        // 整批事件共用一个读临界区：查到的连接指针在批次内不会被释放
+        EpochGuard guard;
+        for (int i = 0; i < n; ++i) {
+            int fd = events[i].data.fd;
+            if (fd == listen_fd_) {
+                handleNewConnection();
+            } else if (fd == wakeup_fd_) {
+                uint64_t value;
+                while (read(wakeup_fd_, &value, sizeof(value)) > 0) {
+                }
+            } else if (udp_ && fd == udp_->fd()) {
+                handleUdpEvent(events[i].events);
+            } else {
+                handleClientEvent(fd, events[i].events);
+            }
+        }
+        handleTimeouts();
+        if (udp_) udp_->expireSessions();
+    }
+    // 连接只属于本 Reactor，退出前在本线程内清理
+    cleanupAllConnections();
+    LOG_INFO("Reactor %d loop stopped", index_);
+}
+
+void EventLoop::stop() {
+    running_ = false;
+    if (wakeup_fd_ != -1) {
+        // write 是 async-signal-safe 的，可以在信号处理函数中调用
+        uint64_t one = 1;
+        ssize_t n = write(wakeup_fd_, &one, sizeof(one));
+        (void)n;
+    }
+}
+
+void EventLoop::handleNewConnection() {
+    while (true) {
+        sockaddr_in client_addr{};
+        socklen_t client_len = sizeof(client_addr);
+        int client_fd = accept4(listen_fd_, (sockaddr*)&client_addr,
+                                &client_len, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (client_fd < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            // EMFILE 等错误下继续 accept 只会空转，等待下一次通知
+            LOG_ERROR("Reactor %d: failed to accept connection: %s", index_,
+                      strerror(errno));
+            break;
+        }
+
+        applyClientSocketOptions(client_fd, config_);
+
+        epoll_event ev{};
+        ev.events = EPOLLIN | EPOLLET;
+        ev.data.fd = client_fd;
+        if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, client_fd, &ev) == -1) {
+            LOG_ERROR("Reactor %d: failed to add client to epoll: %s", index_,
+                      strerror(errno));
+            close(client_fd);
+            continue;
+        }
+        auto conn = std::make_unique<Connection>(client_fd, epoll_fd_);
+        conn->setSendWatermarks(config_.send_high_watermark,
+                                config_.send_low_watermark);
+        conn->setBulkRoot(config_.bulk_root);
+        uint32_t generation =
+            conn_manager_.addConnection(client_fd, std::move(conn));
+        if (generation != 0) {
+            timers_.add(client_fd, generation);
+        }
+
+        char ip[INET_ADDRSTRLEN];
+        inet_ntop(AF_INET, &client_addr.sin_addr, ip, sizeof(ip));
+        LOG_INFO("Reactor %d accepted connection: fd=%d, addr=%s:%d", index_,
+                 client_fd, ip, ntohs(client_addr.sin_port));
+    }
+}
+
+void EventLoop::handleClientEvent(int fd, uint32_t events) {
+    Connection* conn = conn_manager_.getConnection(fd);
+    if (!conn) {
+        epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+        return;
+    }
+    if (events & (EPOLLERR | EPOLLHUP | EPOLLRDHUP)) {
+        cleanupConnection(fd);
+        return;
+    }
+    // 读、解析、处理、写全部在本 Reactor 线程内完成
+    if (events & EPOLLIN) {
+        if (!conn->handleRead()) {
+            LOG_INFO("Client disconnected: fd=%d", fd);
+            cleanupConnection(fd);
+            return;
+        }
+    }
+    if (events & EPOLLOUT) {
+        if (!conn->handleWrite()) {
+            LOG_INFO("Client write error: fd=%d", fd);
+            cleanupConnection(fd);
+        }
+    }
+}
+
+void EventLoop::handleUdpEvent(uint32_t events) {
+    if (events & EPOLLOUT) {
+        udp_->handleWritable();
+    } else {
+        udp_->handleReadable();
+    }
+    // 发送区有积压时只等可写（不再收取），补发完再切回可读，避免水平触发下空转
+    bool want_write = udp_->wantsWritable();
+    if (want_write == udp_write_armed_) return;
+    epoll_event ev{};
+    ev.events = want_write ? EPOLLOUT : EPOLLIN;
+    ev.data.fd = udp_->fd();
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, udp_->fd(), &ev) == -1) {
+        LOG_ERROR("Reactor %d: failed to modify UDP socket in epoll: %s",
+                  index_, strerror(errno));
+        return;
+    }
+    udp_write_armed_ = want_write;
+}
+
+void EventLoop::handleTimeouts() {
+    timers_.expire(
+        [this](int fd, uint32_t generation) {
+            return conn_manager_.getConnection(fd, generation);
+        },
+        [this](int fd, Connection& conn, const Connection::TimeoutCheck& check) {
+            if (check.action == Connection::TimeoutAction::Close) {
+                LOG_INFO("Reactor %d: connection timed out: fd=%d (%s)", index_,
+                         fd, check.reason);
+                cleanupConnection(fd);
+                return false;
+            }
+            if (!conn.sendPing()) {
+                LOG_INFO("Client write error: fd=%d", fd);
+                cleanupConnection(fd);
+                return false;
+            }
+            return true;
+        });
+}
+
+void EventLoop::cleanupConnection(int fd) {
+    timers_.remove(fd);
+    // 先从 epoll 中移除，再由连接表关闭 fd，
+    // 避免 fd 被关闭后又被其他 Reactor 的新连接复用时误删
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+    conn_manager_.removeConnection(fd);
+}
+
+void EventLoop::cleanupAllConnections() {
+    for (int fd : conn_manager_.getAllFds()) {
+        cleanupConnection(fd);
+    }
+}
@@ -0,0 +1,46 @@
+#include "app/IoBackend.hpp"
+
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+
+#include <thread>
+
+#include "app/EventLoop.hpp"
+#include "app/UringLoop.hpp"
+#include "net/io/IoUring.hpp"
+#include "utils/Logger.hpp"
+
+std::unique_ptr<IoBackend> IoBackend::create(int index,
+                                             const ServerConfig& config) {
+    if (config.io_backend == IoBackendType::IoUring) {
+        if (IoUring::isSupported()) {
+            auto loop = std::make_unique<UringLoop>(index, config);
+            if (loop->setup()) return loop;
+            // 探测之后仍可能失败（如 memlock 限制导致缓冲区注册被拒）；
+            // 失败的 loop 析构时关闭已创建的监听 socket，epoll 后端可重新绑定
+            LOG_WARNING("Reactor %d: io_uring setup failed, falling back to epoll",
+                        index);
+        } else {
+            LOG_WARNING("Reactor %d: io_uring unavailable, falling back to epoll",
+                        index);
+        }
+    }
+    auto loop = std::make_unique<EventLoop>(index, config);
+    if (!loop->setup()) return nullptr;
+    return loop;
+}
+
+void IoBackend::bindToCpu(int index) {
+    unsigned cpus = std::thread::hardware_concurrency();
+    if (cpus == 0) return;
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(index % cpus, &set);
+    int rc = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (rc != 0) {
+        LOG_WARNING("Reactor %d: failed to set CPU affinity: %s", index,
+                    strerror(rc));
+    }
+}
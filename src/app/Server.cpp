@@ -2,26 +2,66 @@
 
 #include <arpa/inet.h>  // 包含IP地址转换函数
 #include <fcntl.h>
-#include <netinet/tcp.h>  // for TCP keepalive options
+#include <signal.h>
 #include <string.h>
 #include <sys/epoll.h>  // 包含epoll API
 #include <unistd.h>
 
-#include "net/Connection.hpp"
+#include "app/SocketUtils.hpp"
+#include "net/Checksum.hpp"
+#include "net/buffer/BufferPool.hpp"
+#include "net/connection/Connection.hpp"
 #include "utils/Logger.hpp"
+#include "utils/Metrics.hpp"
 
 Server::Server(const ServerConfig& config)
     : config(config),
       server_fd(-1),
       epoll_fd(-1),
       running(false),
-      thread_pool(config.thread_pool_size) {
+      // 多 Reactor 模式下请求在 Reactor 线程内处理，不需要工作线程
+      thread_pool(config.reuse_port ||
+                          config.io_backend == IoBackendType::IoUring
+                      ? 0
+                      : config.thread_pool_size,
+                  config.max_pending_tasks, config.task_overflow_policy),
+      timers(config),
+      multi_reactor(config.reuse_port ||
+                    config.io_backend == IoBackendType::IoUring) {
     utils::Logger::getInstance().setLogLevel(utils::LogLevel::INFO);
+    // 必须在任何连接分配缓冲区之前设置
+    BufferPool::getInstance().setHugePages(config.buffer_pool_huge_pages);
+    if (config.async_logging) {
+        utils::AsyncLogOptions options;
+        options.path = config.log_file;
+        options.overflow = config.log_block_when_full
+                               ? utils::LogOverflowPolicy::Block
+                               : utils::LogOverflowPolicy::Drop;
+        options.binary = config.log_binary;
+        utils::Logger::getInstance().startAsync(options);
+    }
 }
 
-Server::~Server() { stop(); }
+Server::~Server() {
+    stop();
+    if (admin) {
+        admin->stop();
+    }
+    // 所有 Reactor/工作线程都已退出，写完剩余日志
+    if (config.async_logging) {
+        utils::Logger::getInstance().stopAsync();
+    }
+}
 
 bool Server::setup() {
+    LOG_INFO("Checksum kernels: sum16=%s crc32c=%s", checksum::sum16Kernel(),
+             checksum::crc32cKernel());
+    if (!setupAdmin()) {
+        return false;
+    }
+    if (multi_reactor) {
+        return setupReactors();
+    }
     if (!setupSocket()) {
         return false;
     }
@@ -35,52 +75,44 @@ bool Server::setup() {
 }
 
 // 启动服务器
-bool Server::setupSocket() {
-    // 创建socket
-    // AF_INET: IPv4地址族
-    // SOCK_STREAM: 流式套接字，提供可靠的、面向连接的数据传输服务
-    // SOCK_NONBLOCK: 非阻塞模式，套接字操作不会阻塞，而是立即返回
-    // 0: 默认协议
-    server_fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
-    if (server_fd == -1) {
-        // errno 是系统错误码
-        LOG_ERROR("Failed to create socket: %s", strerror(errno));
-        return false;
+bool Server::setupAdmin() {
+    if (config.admin_port <= 0) {
+        return true;
     }
-    // 后续所有错误路径需关闭 socket
-    auto cleanup = [this]() {
-        close(server_fd);
-        server_fd = -1;
-    };
-    // 设置socket选项
-    int opt = 1;
-    // 设置socket选项 SO_REUSEADDR 允许在同一端口上多次绑定和启动服务器
-    if (config.reuse_addr && setsockopt(server_fd, SOL_SOCKET, SO_REUSEADDR,
-                                        &opt, sizeof(opt)) < 0) {
-        LOG_ERROR("Failed to set SO_REUSEADDR: %s", strerror(errno));
-        cleanup();  // 新增：关闭 socket
-        return false;
-    }
-
-    sockaddr_in addr{};
-    addr.sin_family = AF_INET;
-    addr.sin_addr.s_addr = INADDR_ANY;
-    addr.sin_port = htons(config.port);
-
-    // 绑定socket到本地地址和端口
-    if (bind(server_fd, (sockaddr*)&addr, sizeof(addr)) < 0) {
-        LOG_ERROR("Failed to bind: %s", strerror(errno));
-        cleanup();  // 新增：关闭 socket
+    admin = std::make_unique<AdminServer>(config);
+    admin->addGauge("mcs_threadpool_pending_tasks",
+                    "Tasks queued on the worker pool but not yet started.",
+                    [this]() {
+                        return static_cast<double>(thread_pool.pendingTasks());
+                    });
+    admin->addGauge("mcs_threadpool_workers", "Worker threads in the pool.",
+                    [this]() { return static_cast<double>(thread_pool.size()); });
+    admin->addCounter(
+        "mcs_threadpool_rejected_tasks_total",
+        "Tasks rejected because the pending queue was full.",
+        [this]() { return static_cast<double>(thread_pool.rejectedTasks()); });
+    admin->addCounter(
+        "mcs_threadpool_caller_runs_tasks_total",
+        "Tasks run by the submitting thread because the queue was full.",
+        [this]() { return static_cast<double>(thread_pool.callerRunsTasks()); });
+    admin->addGauge("mcs_reactors", "Reactor threads serving client traffic.",
+                    [this]() {
+                        return static_cast<double>(multi_reactor ? loops.size()
+                                                                 : 1);
+                    });
+    if (!admin->start()) {
+        admin.reset();
         return false;
     }
+    return true;
+}
 
-    // 监听连接请求
-    if (listen(server_fd, config.backlog) < 0) {
-        LOG_ERROR("Failed to listen: %s", strerror(errno));
-        cleanup();  // 新增：关闭 socket
+bool Server::setupSocket() {
+    // 创建非阻塞 socket，设置端口复用并完成 bind/listen
+    server_fd = createListenSocket(config, false);
+    if (server_fd == -1) {
         return false;
     }
-
     LOG_INFO("Server listening on port %d", config.port);
     return true;
 }
@@ -105,10 +137,78 @@ bool Server::setupEpoll() {
         return false;
     }
 
+    if (config.udp_port > 0) {
+        udp = std::make_unique<UdpEndpoint>(config);
+        if (!udp->setup(false)) {
+            return false;
+        }
+        // 水平触发：一次事件只处理有限批次，剩余数据报下一轮继续通知
+        ev.events = EPOLLIN;
+        ev.data.fd = udp->fd();
+        if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, udp->fd(), &ev) == -1) {
+            LOG_ERROR("Failed to add UDP socket to epoll: %s", strerror(errno));
+            return false;
+        }
+    }
+
     return true;
 }
 
+bool Server::setupReactors() {
+    int count = config.reactor_count;
+    if (!config.reuse_port) {
+        // 没有 SO_REUSEPORT 时多个 socket 无法绑定同一端口，只能使用单个 Reactor
+        count = 1;
+    } else if (count <= 0) {
+        count = static_cast<int>(std::thread::hardware_concurrency());
+        if (count <= 0) count = 1;
+    }
+    for (int i = 0; i < count; ++i) {
+        auto loop = IoBackend::create(i, config);
+        if (!loop) {
+            loops.clear();
+            return false;
+        }
+        loops.push_back(std::move(loop));
+    }
+    running = true;
+    LOG_INFO("Server started on port %d with %d reactors (%s)", config.port,
+             count, loops.front()->name());
+    return true;
+}
+
+void Server::runReactors() {
+    // 屏蔽 SIGINT/SIGTERM 后再创建 Reactor 线程，使信号只投递到调用线程
+    sigset_t block_set, old_set;
+    sigemptyset(&block_set);
+    sigaddset(&block_set, SIGINT);
+    sigaddset(&block_set, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &block_set, &old_set);
+    for (size_t i = 1; i < loops.size(); ++i) {
+        IoBackend* loop = loops[i].get();
+        loop_threads.emplace_back([loop]() { loop->run(); });
+    }
+    pthread_sigmask(SIG_SETMASK, &old_set, nullptr);
+
+    // 第 0 个 Reactor 复用调用线程
+    loops[0]->run();
+
+    for (auto& t : loop_threads) {
+        if (t.joinable()) t.join();
+    }
+    loop_threads.clear();
+    LOG_INFO("Latency %s", Metrics::getInstance().formatLatency().c_str());
+    LOG_INFO("Buffer pool %s",
+             Metrics::getInstance().formatBufferPool().c_str());
+    LOG_INFO("Server shutdown complete");
+}
+
 void Server::run() {
+    if (multi_reactor) {
+        runReactors();
+        return;
+    }
+
     const int MAX_EVENTS = 1024;
     epoll_event events[MAX_EVENTS];
 
@@ -117,21 +217,31 @@ void Server::run() {
         /*
         主线程的事件循环（非阻塞）​
         */
-        int n = epoll_wait(epoll_fd, events, MAX_EVENTS, -1);
+        // 等待时长取最近的超时检查时刻
+        int timeout = timers.timeoutMs();
+        if (udp) timeout = udp->timeoutMs(timeout);
+        int n = epoll_wait(epoll_fd, events, MAX_EVENTS, timeout);
         if (n == -1) {
             if (errno == EINTR) continue;  // 被信号中断，继续等待
             LOG_ERROR("epoll_wait error: %s", strerror(errno));
             break;
         }
+        // 整批事件共用一个读临界区：查到的连接指针在批次内不会被释放
+        EpochGuard guard;
         for (int i = 0; i < n; ++i) {
             // 处理服务器socket事件
             if (events[i].data.fd == server_fd) {
                 handleNewConnection();
+            } else if (udp && events[i].data.fd == udp->fd()) {
+                // UDP 请求很短，直接在主线程处理，不投递给工作线程
+                handleUdpEvent(events[i].events);
             } else {
                 // 处理客户端socket事件
                 handleClientEvent(events[i].data.fd, events[i].events);
             }
         }
+        handleTimeouts();
+        if (udp) udp->expireSessions();
     }
     LOG_INFO("Server main loop stopped");
 }
@@ -152,22 +262,7 @@ void Server::handleNewConnection() {
         }
 
         // 设置客户端socket选项
-        if (config.keep_alive) {
-            int opt = 1;
-            // 启用TCP保活机制
-            setsockopt(client_fd, SOL_SOCKET, SO_KEEPALIVE, &opt, sizeof(opt));
-            // 连接空闲多久后开始发送保活探测包（秒）
-            setsockopt(client_fd, IPPROTO_TCP, TCP_KEEPIDLE,
-                       &config.keep_alive_time, sizeof(config.keep_alive_time));
-            // 保活探测包发送间隔（秒）
-            setsockopt(client_fd, IPPROTO_TCP, TCP_KEEPINTVL,
-                       &config.keep_alive_intvl,
-                       sizeof(config.keep_alive_intvl));
-            // 发送多少次未响应后断开连接
-            setsockopt(client_fd, IPPROTO_TCP, TCP_KEEPCNT,
-                       &config.keep_alive_probes,
-                       sizeof(config.keep_alive_probes));
-        }
+        applyClientSocketOptions(client_fd, config);
 
         // 注册到epoll​
         epoll_event ev{};
@@ -185,8 +280,18 @@ void Server::handleNewConnection() {
             close(client_fd);
             continue;
         }
-        auto conn = std::make_shared<Connection>(client_fd, epoll_fd);
-        conn_manager.addConnection(client_fd, conn);
+        auto conn = std::make_unique<Connection>(client_fd, epoll_fd);
+        conn->setSendWatermarks(config.send_high_watermark,
+                                config.send_low_watermark);
+        conn->setBulkRoot(config.bulk_root);
+        if (thread_pool.size() > 0) {
+            conn->setWorker(next_worker++ % thread_pool.size());
+        }
+        uint32_t generation =
+            conn_manager.addConnection(client_fd, std::move(conn));
+        if (generation != 0) {
+            timers.add(client_fd, generation);
+        }
 
         char ip[INET_ADDRSTRLEN];
         inet_ntop(AF_INET, &client_addr.sin_addr, ip, sizeof(ip));
@@ -196,43 +301,117 @@ void Server::handleNewConnection() {
 }
 
 void Server::handleClientEvent(int fd, uint32_t events) {
-    auto conn = conn_manager.getConnection(fd);
+    // 调用方（run 的事件批次）持有 EpochGuard，查表无锁、无引用计数
+    Connection* conn = conn_manager.getConnection(fd);
     if (!conn) {
-        cleanupConnection(fd);
+        epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
         return;
     }
-    if (events & (EPOLLERR | EPOLLHUP | EPOLLRDHUP)) {
-        cleanupConnection(fd);
+    dispatchEvents(*conn, events);
+}
+
+void Server::dispatchEvents(Connection& conn, uint32_t events) {
+    // 已有任务在途时事件只并入该任务，不再投递
+    if (!conn.addPendingEvents(events)) {
         return;
     }
-    // 传递 weak_ptr 到线程池
-    std::weak_ptr<Connection> weak_conn = conn;
-    // 使用线程池处理客户端事件
-    thread_pool.enqueue([this, fd, events, weak_conn]() {
-        // 在异步多线程模型中，主线程（处理事件循环）和工作线程（处理具体任务）存在竞态条件。可能在主线程获取连接后，任务进入线程池队列前，连接已被关闭。因此，在线程池任务内部需要再次检查连接状态。
-        if (auto conn = weak_conn.lock()) {
-            // EPOLLIN
-            // 事件​​：表示套接字可读（有数据到达或连接关闭）。
-            if (events & EPOLLIN) {
-                if (!conn->handleRead()) {
-                    LOG_INFO("Client disconnected: fd=%d", fd);
-                    cleanupConnection(fd);
-                }
+    // 任务只携带 (fd, generation)，执行时重新查表：
+    // 在异步多线程模型中，主线程（处理事件循环）和工作线程（处理具体任务）存在竞态条件。可能在主线程获取连接后，任务进入线程池队列前，连接已被关闭，fd 甚至已被新连接复用。generation 不匹配即说明是过期任务。
+    int fd = conn.getFd();
+    uint32_t generation = conn.generation();
+    // 连接固定在同一个工作线程上处理：读写顺序由调度保证，缓冲区也不会在核间来回迁移
+    // CallerRuns 时任务在本线程执行：调度标记已置位，仍与工作线程互斥
+    bool accepted =
+        thread_pool.enqueuePinned(conn.worker(), [this, fd, generation]() {
+            EpochGuard guard;
+            if (Connection* conn = conn_manager.getConnection(fd, generation)) {
+                serviceConnection(*conn);
             }
-            if (events & EPOLLOUT) {
-                if (!conn->handleWrite()) {
-                    LOG_INFO("Client write error: fd=%d", fd);
-                    cleanupConnection(fd);
-                }
+        });
+    if (!accepted) {
+        // 任务队列已满：丢弃这个连接而不是继续积压。没有任务在途，可以直接在本线程清理
+        LOG_WARNING("Task queue full, dropping connection: fd=%d", fd);
+        cleanupConnection(fd);
+    }
+}
+
+void Server::serviceConnection(Connection& conn) {
+    int fd = conn.getFd();
+    do {
+        uint32_t events = conn.takePendingEvents();
+        // 出错/挂断也在绑定线程上清理，与读写严格串行
+        // 清理后调度标记保持置位，之后的事件不会再投递任务
+        if (events & (EPOLLERR | EPOLLHUP | EPOLLRDHUP)) {
+            cleanupConnection(fd);
+            return;
+        }
+        // EPOLLIN
+        // 事件​​：表示套接字可读（有数据到达或连接关闭）。
+        if (events & EPOLLIN) {
+            if (!conn.handleRead()) {
+                LOG_INFO("Client disconnected: fd=%d", fd);
+                cleanupConnection(fd);
+                return;
             }
         }
-    });
+        if (events & EPOLLOUT) {
+            if (!conn.handleWrite()) {
+                LOG_INFO("Client write error: fd=%d", fd);
+                cleanupConnection(fd);
+                return;
+            }
+        }
+        if (events & Connection::kHeartbeatEvent) {
+            if (!conn.sendPing()) {
+                LOG_INFO("Client write error: fd=%d", fd);
+                cleanupConnection(fd);
+                return;
+            }
+        }
+    } while (!conn.finishScheduled());
+}
+
+void Server::handleUdpEvent(uint32_t events) {
+    if (events & EPOLLOUT) {
+        udp->handleWritable();
+    } else {
+        udp->handleReadable();
+    }
+    // 发送区有积压时只等可写（不再收取），补发完再切回可读，避免水平触发下空转
+    bool want_write = udp->wantsWritable();
+    if (want_write == udp_write_armed) return;
+    epoll_event ev{};
+    ev.events = want_write ? EPOLLOUT : EPOLLIN;
+    ev.data.fd = udp->fd();
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_MOD, udp->fd(), &ev) == -1) {
+        LOG_ERROR("Failed to modify UDP socket in epoll: %s", strerror(errno));
+        return;
+    }
+    udp_write_armed = want_write;
+}
+
+void Server::handleTimeouts() {
+    // 主线程只做判断；连接可能正被工作线程处理，关闭与发送都投递给它执行。
+    // 工作线程关闭的连接不会取消这里的节点，到期时按 generation 识别后丢弃
+    timers.expire(
+        [this](int fd, uint32_t generation) {
+            return conn_manager.getConnection(fd, generation);
+        },
+        [this]([[maybe_unused]] int fd, Connection& conn, const Connection::TimeoutCheck& check) {
+            if (check.action == Connection::TimeoutAction::Close) {
+                LOG_INFO("Connection timed out: fd=%d (%s)", fd, check.reason);
+                dispatchEvents(conn, EPOLLHUP);
+                return false;
+            }
+            dispatchEvents(conn, Connection::kHeartbeatEvent);
+            return true;
+        });
 }
 
 void Server::cleanupConnection(int fd) {
-    conn_manager.removeConnection(fd);
+    // 先从 epoll 移除，再由连接表关闭 fd 并延迟释放 Connection
     epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
-    close(fd);
+    conn_manager.removeConnection(fd);
 }
 
 void Server::stop() {
@@ -240,20 +419,32 @@ void Server::stop() {
         LOG_INFO("Server shutting down...");
         running = false;
 
+        if (multi_reactor) {
+            // 只负责唤醒各 Reactor；连接在各自线程内清理，run() 负责 join
+            for (auto& loop : loops) {
+                loop->stop();
+            }
+            return;
+        }
+
         // 1. 关闭线程池（停止接受新任务）
         thread_pool.shutdown();
 
         // 2. 等待所有任务完成
         thread_pool.wait();
 
-        // 3. 关闭所有连接和资源
-        for (const auto& pair : conn_manager.getAllConnections()) {
-            cleanupConnection(pair.first);
+        // 3. 关闭所有连接和资源（工作线程已退出，没有并发读者）
+        for (int fd : conn_manager.getAllFds()) {
+            cleanupConnection(fd);
         }
+        EpochReclaimer::getInstance().drain();
 
         if (epoll_fd != -1) close(epoll_fd);
         if (server_fd != -1) close(server_fd);
 
+        LOG_INFO("Latency %s", Metrics::getInstance().formatLatency().c_str());
+        LOG_INFO("Buffer pool %s",
+                 Metrics::getInstance().formatBufferPool().c_str());
         LOG_INFO("Server shutdown complete");
     }
 }
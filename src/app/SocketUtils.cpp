@@ -0,0 +1,99 @@
+#include "app/SocketUtils.hpp"
+
+#include <arpa/inet.h>
+#include <netinet/tcp.h>  // for TCP keepalive options
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+
+#include "utils/Logger.hpp"
+
+int createListenSocket(const ServerConfig& config, bool reuse_port) {
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd == -1) {
+        LOG_ERROR("Failed to create socket: %s", strerror(errno));
+        return -1;
+    }
+
+    int opt = 1;
+    // SO_REUSEADDR 允许在同一端口上多次绑定和启动服务器
+    if (config.reuse_addr &&
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0) {
+        LOG_ERROR("Failed to set SO_REUSEADDR: %s", strerror(errno));
+        close(fd);
+        return -1;
+    }
+    // SO_REUSEPORT 必须在 bind 之前设置，每个 Reactor 拥有独立的 accept 队列
+    if (reuse_port &&
+        setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) < 0) {
+        LOG_ERROR("Failed to set SO_REUSEPORT: %s", strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = INADDR_ANY;
+    addr.sin_port = htons(config.port);
+
+    if (bind(fd, (sockaddr*)&addr, sizeof(addr)) < 0) {
+        LOG_ERROR("Failed to bind: %s", strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+    if (listen(fd, config.backlog) < 0) {
+        LOG_ERROR("Failed to listen: %s", strerror(errno));
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int createUdpSocket(const ServerConfig& config, bool reuse_port) {
+    int fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd == -1) {
+        LOG_ERROR("Failed to create UDP socket: %s", strerror(errno));
+        return -1;
+    }
+
+    int opt = 1;
+    if (reuse_port &&
+        setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) < 0) {
+        LOG_ERROR("Failed to set SO_REUSEPORT on UDP socket: %s",
+                  strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = INADDR_ANY;
+    addr.sin_port = htons(config.udp_port);
+
+    if (bind(fd, (sockaddr*)&addr, sizeof(addr)) < 0) {
+        LOG_ERROR("Failed to bind UDP socket: %s", strerror(errno));
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+void applyClientSocketOptions(int client_fd, const ServerConfig& config) {
+    if (!config.keep_alive) return;
+
+    int opt = 1;
+    // 启用TCP保活机制
+    setsockopt(client_fd, SOL_SOCKET, SO_KEEPALIVE, &opt, sizeof(opt));
+    // 连接空闲多久后开始发送保活探测包（秒）
+    setsockopt(client_fd, IPPROTO_TCP, TCP_KEEPIDLE, &config.keep_alive_time,
+               sizeof(config.keep_alive_time));
+    // 保活探测包发送间隔（秒）
+    setsockopt(client_fd, IPPROTO_TCP, TCP_KEEPINTVL, &config.keep_alive_intvl,
+               sizeof(config.keep_alive_intvl));
+    // 发送多少次未响应后断开连接
+    setsockopt(client_fd, IPPROTO_TCP, TCP_KEEPCNT, &config.keep_alive_probes,
+               sizeof(config.keep_alive_probes));
+}
@@ -0,0 +1,213 @@
+#include "app/UdpEndpoint.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <stdexcept>
+#include <string_view>
+
+#include "app/SocketUtils.hpp"
+#include "net/RequestHandler.hpp"
+#include "utils/Logger.hpp"
+#include "utils/Metrics.hpp"
+#include "utils/TimerWheel.hpp"
+
+namespace {
+
+// 一次可读事件最多处理的批数（每批最多 udp_batch_size 个数据报）
+constexpr int kMaxBatchesPerEvent = 16;
+
+/*
+把 RequestHandler 的帧构建接口接到 UdpProtocol 的发送区：
+数据报发送前必须整体放在发送区里，借用和拷贝一样都是拷贝
+*/
+class UdpReply {
+   public:
+    UdpReply(UdpProtocol& proto, const sockaddr_in& peer)
+        : proto_(proto), peer_(peer) {}
+
+    void beginFrame(uint16_t header) {
+        header_ = header;
+        frame_bytes_ = 0;
+        proto_.beginFrame(peer_, header);
+    }
+    void appendBorrowed(const void* data, size_t size) {
+        appendCopy(data, size);
+    }
+    void appendBorrowed(std::string_view data) {
+        appendCopy(data.data(), data.size());
+    }
+    void appendCopy(const void* data, size_t size) {
+        proto_.appendFrame({static_cast<const uint8_t*>(data), size});
+        frame_bytes_ += size;
+    }
+    void appendCopy(std::string_view data) {
+        appendCopy(data.data(), data.size());
+    }
+    void endFrame() {
+        // 超过单个数据报上限的响应由 UdpProtocol 丢弃并计数
+        if (proto_.endFrame()) {
+            bytes_ += PacketView::kHeaderSize + frame_bytes_ +
+                      Packet::trailerSize(header_);
+        }
+    }
+
+    size_t bytes() const { return bytes_; }
+
+   private:
+    UdpProtocol& proto_;
+    const sockaddr_in& peer_;
+    uint16_t header_ = 0;
+    size_t frame_bytes_ = 0;
+    size_t bytes_ = 0;
+};
+
+}  // namespace
+
+UdpEndpoint::UdpEndpoint(const ServerConfig& config)
+    : config_(config), sessions_(config.udp_max_sessions) {
+    // 每个间隔扫描一次整张表，会话最迟在 1.25 倍超时后被回收
+    int64_t timeout = config.udp_session_timeout;
+    sweep_interval_ms_ = timeout > 0 ? std::max<int64_t>(timeout / 4, 100) : 0;
+}
+
+UdpEndpoint::~UdpEndpoint() {
+    publishStats();
+    if (sessions_.size() > 0) {
+        Metrics::getInstance().adjustUdpSessions(
+            -static_cast<int64_t>(sessions_.size()));
+    }
+}
+
+bool UdpEndpoint::setup(bool reuse_port) {
+    int fd = createUdpSocket(config_, reuse_port);
+    if (fd < 0) return false;
+
+    UdpProtocol::Options options;
+    options.batch_size = config_.udp_batch_size;
+    proto_ = std::make_unique<UdpProtocol>(fd, options);
+    next_sweep_ms_ = TimerWheel::nowMs() + sweep_interval_ms_;
+    LOG_INFO("UDP endpoint listening on port %d (fd=%d, gro=%d)",
+             config_.udp_port, fd, proto_->groEnabled() ? 1 : 0);
+    return true;
+}
+
+void UdpEndpoint::handleReadable() {
+    if (!proto_) return;
+    // 发送缓冲区仍然满：先不收，数据报留在内核接收队列里，超出部分由内核丢弃
+    if (proto_->hasPendingSendData() && !flush()) return;
+
+    for (int batch = 0; batch < kMaxBatchesPerEvent; ++batch) {
+        BaseProtocol::ReadStatus status = proto_->receiveBatch();
+        if (status == BaseProtocol::ReadStatus::NeedRetry) break;
+        if (status == BaseProtocol::ReadStatus::Error) {
+            LOG_WARNING("UDP receive failed on fd %d: %s", proto_->fd(),
+                        strerror(errno));
+            break;
+        }
+        processBatch(TimerWheel::nowMs());
+        if (!flush()) break;
+    }
+    publishStats();
+}
+
+void UdpEndpoint::handleWritable() {
+    if (!proto_) return;
+    flush();
+    publishStats();
+}
+
+void UdpEndpoint::processBatch(int64_t now_ms) {
+    size_t bytes_sent = 0;
+    for (const UdpProtocol::Datagram& datagram : proto_->datagrams()) {
+        // 一个数据报恰好是一帧；非法数据报只丢弃，不建会话
+        PacketView request;
+        bool valid = false;
+        try {
+            // 批量传输依赖帧后的字节流，数据报不支持
+            valid = PacketView::parse(datagram.data, request) &&
+                    request.frameSize() == datagram.data.size() &&
+                    request.header != Packet::kBulkRequestHeader &&
+                    request.header != Packet::kBulkResponseHeader;
+        } catch (const std::runtime_error&) {
+        }
+        if (!valid) {
+            Metrics::getInstance().incrementUdpDropped(1);
+            continue;
+        }
+
+        UdpReply reply(*proto_, datagram.peer);
+        try {
+            if (request.header == Packet::kControlHeader) {
+                RequestHandler::handleControl(request, reply);
+            } else {
+                RequestHandler::handleRequest(request, reply);
+            }
+        } catch (const std::runtime_error&) {
+            Metrics::getInstance().incrementUdpDropped(1);
+            continue;
+        }
+
+        bool created = false;
+        UdpSession* session =
+            sessions_.findOrCreate(datagram.peer, now_ms, created);
+        if (created) Metrics::getInstance().adjustUdpSessions(1);
+        if (session) {
+            session->last_active_ms = now_ms;
+            ++session->requests;
+            session->bytes_received += datagram.data.size();
+            session->bytes_sent += reply.bytes();
+        }
+        bytes_sent += reply.bytes();
+    }
+    if (bytes_sent > 0) Metrics::getInstance().incrementBytesSent(bytes_sent);
+}
+
+bool UdpEndpoint::flush() {
+    int saved_errno = 0;
+    if (proto_->flushSendBuffer(saved_errno)) return true;
+    if (saved_errno == EAGAIN || saved_errno == EWOULDBLOCK) return false;
+    // 个别对端不可达等错误：出错的消息已被丢弃，其余已发出
+    LOG_DEBUG("UDP send failed on fd %d: %s", proto_->fd(),
+              strerror(saved_errno));
+    return true;
+}
+
+void UdpEndpoint::publishStats() {
+    if (!proto_) return;
+    const UdpProtocol::Stats& stats = proto_->stats();
+    Metrics& metrics = Metrics::getInstance();
+    metrics.incrementUdpDatagrams(stats.datagrams_in - published_.datagrams_in,
+                                  stats.datagrams_out - published_.datagrams_out);
+    if (stats.dropped != published_.dropped) {
+        metrics.incrementUdpDropped(stats.dropped - published_.dropped);
+    }
+    published_ = stats;
+}
+
+void UdpEndpoint::expireSessions() {
+    if (sweep_interval_ms_ == 0 || sessions_.size() == 0) return;
+    int64_t now = TimerWheel::nowMs();
+    if (now < next_sweep_ms_) return;
+    next_sweep_ms_ = now + sweep_interval_ms_;
+    size_t evicted = sessions_.evictIdle(now, config_.udp_session_timeout);
+    if (evicted > 0) {
+        Metrics::getInstance().adjustUdpSessions(-static_cast<int64_t>(evicted));
+        LOG_DEBUG("Evicted %zu idle UDP sessions, %zu remaining", evicted,
+                  sessions_.size());
+    }
+}
+
+int UdpEndpoint::timeoutMs(int other_timeout_ms) const {
+    if (sweep_interval_ms_ == 0 || sessions_.size() == 0) {
+        return other_timeout_ms;
+    }
+    int64_t wait = next_sweep_ms_ - TimerWheel::nowMs();
+    if (wait < 0) wait = 0;
+    if (wait > INT_MAX) wait = INT_MAX;
+    if (other_timeout_ms >= 0 && other_timeout_ms < wait) {
+        return other_timeout_ms;
+    }
+    return static_cast<int>(wait);
+}
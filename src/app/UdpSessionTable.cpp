@@ -0,0 +1,79 @@
+#include "app/UdpSessionTable.hpp"
+
+#include <bit>
+
+UdpSessionTable::UdpSessionTable(size_t max_sessions)
+    : max_sessions_(max_sessions > 0 ? max_sessions : 1) {
+    size_t capacity = std::bit_ceil(max_sessions_ * 2);
+    if (capacity < 16) capacity = 16;
+    slots_.resize(capacity);
+    mask_ = capacity - 1;
+    shift_ = 64 - static_cast<unsigned>(std::countr_zero(capacity));
+}
+
+UdpSession* UdpSessionTable::find(const sockaddr_in& peer) {
+    uint64_t key = keyOf(peer);
+    for (size_t i = home(key);; i = (i + 1) & mask_) {
+        UdpSession& slot = slots_[i];
+        if (slot.key == key) return &slot;
+        if (slot.key == 0) return nullptr;
+    }
+}
+
+UdpSession* UdpSessionTable::findOrCreate(const sockaddr_in& peer,
+                                          int64_t now_ms, bool& created) {
+    created = false;
+    uint64_t key = keyOf(peer);
+    // 端口 0 不会出现在合法的源地址上，key 为 0 的对端不跟踪
+    if (key == 0) return nullptr;
+    size_t i = home(key);
+    for (;; i = (i + 1) & mask_) {
+        UdpSession& slot = slots_[i];
+        if (slot.key == key) return &slot;
+        if (slot.key == 0) break;
+    }
+    if (size_ >= max_sessions_) return nullptr;
+
+    UdpSession& slot = slots_[i];
+    slot = UdpSession{};
+    slot.key = key;
+    slot.created_ms = now_ms;
+    slot.last_active_ms = now_ms;
+    ++size_;
+    created = true;
+    return &slot;
+}
+
+void UdpSessionTable::erase(size_t index) {
+    // 反向移位：把后面探测链上"可以前移"的元素逐个移到空位，直到遇到空槽
+    size_t hole = index;
+    for (size_t i = (hole + 1) & mask_; slots_[i].key != 0;
+         i = (i + 1) & mask_) {
+        // 元素的起始槽不在 (hole, i] 区间内时，移到 hole 后仍可从起始槽探测到
+        size_t distance_to_home = (i - home(slots_[i].key)) & mask_;
+        size_t distance_to_hole = (i - hole) & mask_;
+        if (distance_to_home >= distance_to_hole) {
+            slots_[hole] = slots_[i];
+            hole = i;
+        }
+    }
+    slots_[hole] = UdpSession{};
+    --size_;
+}
+
+size_t UdpSessionTable::evictIdle(int64_t now_ms, int64_t idle_ms) {
+    if (size_ == 0 || idle_ms <= 0) return 0;
+    int64_t deadline = now_ms - idle_ms;
+    size_t evicted = 0;
+    for (size_t i = 0; i < slots_.size() && size_ > 0;) {
+        UdpSession& slot = slots_[i];
+        if (slot.key != 0 && slot.last_active_ms <= deadline) {
+            // 删除后后面的元素可能移到当前位置，原地再检查一次
+            erase(i);
+            ++evicted;
+            continue;
+        }
+        ++i;
+    }
+    return evicted;
+}
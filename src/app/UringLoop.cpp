@@ -0,0 +1,525 @@
+#include "app/UringLoop.hpp"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "app/SocketUtils.hpp"
+#include "utils/Logger.hpp"
+#include "utils/Metrics.hpp"
+
+// 文件片段经管道 splice 时管道的目标容量，一次 SpliceIn 最多搬这么多
+static constexpr int kSplicePipeSize = 1024 * 1024;
+
+UringLoop::UringConnection::~UringConnection() {
+    if (pipe_fds[0] != -1) close(pipe_fds[0]);
+    if (pipe_fds[1] != -1) close(pipe_fds[1]);
+}
+
+UringLoop::UringLoop(int index, const ServerConfig& config)
+    : index_(index),
+      config_(config),
+      listen_fd_(-1),
+      wakeup_fd_(-1),
+      running_(false),
+      timers_(config) {}
+
+UringLoop::~UringLoop() {
+    // 先释放连接（关闭 fd），ring_ 随后析构时内核取消剩余请求
+    conns_.clear();
+    if (wakeup_fd_ != -1) close(wakeup_fd_);
+    if (listen_fd_ != -1) close(listen_fd_);
+}
+
+bool UringLoop::setup() {
+    listen_fd_ = createListenSocket(config_, config_.reuse_port);
+    if (listen_fd_ == -1) {
+        return false;
+    }
+
+    wakeup_fd_ = eventfd(0, EFD_CLOEXEC);
+    if (wakeup_fd_ == -1) {
+        LOG_ERROR("Reactor %d: failed to create eventfd: %s", index_,
+                  strerror(errno));
+        return false;
+    }
+
+    if (!ring_.init(config_.uring_entries)) {
+        LOG_ERROR("Reactor %d: io_uring_setup failed: %s", index_,
+                  strerror(errno));
+        return false;
+    }
+    if (!ring_.setupBufferRing(kBufferGroup, config_.uring_buffer_count,
+                               config_.uring_buffer_size)) {
+        LOG_ERROR("Reactor %d: failed to register provided buffers: %s",
+                  index_, strerror(errno));
+        return false;
+    }
+
+    if (config_.udp_port > 0) {
+        udp_ = std::make_unique<UdpEndpoint>(config_);
+        if (!udp_->setup(config_.reuse_port)) return false;
+    }
+
+    running_ = true;
+    return true;
+}
+
+void UringLoop::run() {
+    if (config_.reactor_cpu_affinity) {
+        bindToCpu(index_);
+    }
+
+    armAccept();
+    armWakeup();
+    if (udp_) armUdpPoll();
+
+    LOG_INFO("Reactor %d io_uring loop started", index_);
+    while (running_) {
+        armTimerTick();
+        // 上一轮积累的 SQE（recv 重新提交、批量 send 等）在这里一次性下发
+        int ret = ring_.submitAndWait(1);
+        if (ret < 0 && errno != EINTR && errno != EBUSY) {
+            LOG_ERROR("Reactor %d: io_uring_enter error: %s", index_,
+                      strerror(errno));
+            break;
+        }
+        ring_.forEachCqe([this](const io_uring_cqe& cqe) { handleCqe(cqe); });
+        handleTimeouts();
+        if (udp_) udp_->expireSessions();
+        flushPendingSends();
+    }
+    cleanupAllConnections();
+    LOG_INFO("Reactor %d io_uring loop stopped", index_);
+}
+
+void UringLoop::stop() {
+    running_ = false;
+    if (wakeup_fd_ != -1) {
+        // write 是 async-signal-safe 的，可以在信号处理函数中调用
+        uint64_t one = 1;
+        ssize_t n = write(wakeup_fd_, &one, sizeof(one));
+        (void)n;
+    }
+}
+
+void UringLoop::armAccept() {
+    io_uring_sqe* sqe = ring_.getSqe();
+    if (!sqe) return;
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = listen_fd_;
+    sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+    // 不设置 SOCK_NONBLOCK：阻塞语义的 socket 由 io_uring 内部 poll 重试，不会返回 -EAGAIN
+    sqe->accept_flags = SOCK_CLOEXEC;
+    sqe->user_data = encode(Op::Accept, listen_fd_);
+    accept_armed_ = true;
+}
+
+void UringLoop::armRecv(int fd, UringConnection& uc) {
+    io_uring_sqe* sqe = ring_.getSqe();
+    if (!sqe) {
+        closeConnection(fd, uc);
+        return;
+    }
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = fd;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = kBufferGroup;
+    sqe->user_data = encode(Op::Recv, fd);
+    uc.recv_armed = true;
+}
+
+void UringLoop::updateRecv(int fd, UringConnection& uc) {
+    if (uc.closing) return;
+    if (!uc.conn->readingPaused()) {
+        if (!uc.recv_armed) armRecv(fd, uc);
+        return;
+    }
+    if (!uc.recv_armed || uc.recv_cancelling) return;
+    // multishot recv 会一直向连接投递数据，暂停读取只能取消它；
+    // 取消前已在途的数据照常进入接收缓冲区，恢复后再处理
+    io_uring_sqe* sqe = ring_.getSqe();
+    if (!sqe) return;
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->fd = -1;
+    sqe->addr = encode(Op::Recv, fd);
+    sqe->user_data = encode(Op::Cancel, fd);
+    uc.recv_cancelling = true;
+}
+
+void UringLoop::armWakeup() {
+    io_uring_sqe* sqe = ring_.getSqe();
+    if (!sqe) return;
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = wakeup_fd_;
+    sqe->addr = reinterpret_cast<uint64_t>(&wakeup_value_);
+    sqe->len = sizeof(wakeup_value_);
+    sqe->user_data = encode(Op::Wakeup, wakeup_fd_);
+}
+
+void UringLoop::armUdpPoll() {
+    io_uring_sqe* sqe = ring_.getSqe();
+    if (!sqe) return;
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = udp_->fd();
+    // 发送区有积压时只等可写（不再收取），补发完再恢复等待可读
+    sqe->poll32_events = udp_->wantsWritable() ? POLLOUT : POLLIN;
+    sqe->user_data = encode(Op::UdpPoll, udp_->fd());
+}
+
+void UringLoop::armTimeout(long long nsec) {
+    timeout_ts_.tv_sec = nsec / 1000000000LL;
+    timeout_ts_.tv_nsec = nsec % 1000000000LL;
+    io_uring_sqe* sqe = ring_.getSqe();
+    if (!sqe) return;
+    sqe->opcode = IORING_OP_TIMEOUT;
+    sqe->fd = -1;
+    sqe->addr = reinterpret_cast<uint64_t>(&timeout_ts_);
+    sqe->len = 1;
+    sqe->user_data = encode(Op::Timeout, 0);
+}
+
+void UringLoop::armTimerTick() {
+    int timeout = timers_.timeoutMs();
+    if (udp_) timeout = udp_->timeoutMs(timeout);
+    if (timeout < 0) return;
+    int64_t deadline = TimerWheel::nowMs() + timeout;
+    if (tick_deadline_ms_ != 0 && tick_deadline_ms_ <= deadline) return;
+    // 更早的期限再补一个请求即可，旧请求到期时只是多一次空转
+    armTimeout(static_cast<long long>(timeout) * 1000000LL);
+    tick_deadline_ms_ = deadline;
+}
+
+void UringLoop::handleTimeouts() {
+    timers_.expire(
+        [this](int fd, uint32_t) -> Connection* {
+            auto it = conns_.find(fd);
+            if (it == conns_.end() || it->second->closing) return nullptr;
+            return it->second->conn.get();
+        },
+        [this](int fd, Connection& conn, const Connection::TimeoutCheck& check) {
+            UringConnection& uc = *conns_.find(fd)->second;
+            if (check.action == Connection::TimeoutAction::Close) {
+                LOG_INFO("Reactor %d: connection timed out: fd=%d (%s)", index_,
+                         fd, check.reason);
+                closeConnection(fd, uc);
+                maybeRelease(fd, uc);
+                return false;
+            }
+            // ping 与本批其他响应一起提交
+            conn.sendPing();
+            pending_sends_.push_back(fd);
+            return true;
+        });
+}
+
+void UringLoop::submitSend(int fd, UringConnection& uc) {
+    SendQueue& queue = uc.conn->protocol().sendQueue();
+    int file_fd;
+    uint64_t file_offset;
+    size_t file_remaining;
+    if (queue.frontFile(file_fd, file_offset, file_remaining)) {
+        submitSplice(fd, uc);
+        return;
+    }
+    bool file_follows = false;
+    size_t iov_count =
+        queue.prepareIov(uc.iov, SendQueue::kMaxIov, &file_follows);
+    if (iov_count == 0) return;
+
+    io_uring_sqe* sqe = ring_.getSqe();
+    if (!sqe) {
+        closeConnection(fd, uc);
+        return;
+    }
+    uc.msg = msghdr{};
+    uc.msg.msg_iov = uc.iov;
+    uc.msg.msg_iovlen = iov_count;
+    sqe->opcode = IORING_OP_SENDMSG;
+    sqe->fd = fd;
+    sqe->addr = reinterpret_cast<uint64_t>(&uc.msg);
+    sqe->len = 1;
+    sqe->msg_flags = MSG_NOSIGNAL | (file_follows ? MSG_MORE : 0);
+    sqe->user_data = encode(Op::Send, fd);
+    uc.send_inflight = true;
+}
+
+void UringLoop::submitSplice(int fd, UringConnection& uc) {
+    int file_fd;
+    uint64_t offset;
+    size_t remaining;
+    if (!uc.conn->protocol().sendQueue().frontFile(file_fd, offset,
+                                                   remaining)) {
+        return;
+    }
+
+    if (uc.pipe_fds[0] == -1) {
+        // 阻塞管道：splice 由 io_uring 的工作线程执行，不会返回 -EAGAIN
+        if (pipe2(uc.pipe_fds, O_CLOEXEC) < 0) {
+            LOG_ERROR("Reactor %d: pipe2 failed for fd=%d: %s", index_, fd,
+                      strerror(errno));
+            closeConnection(fd, uc);
+            return;
+        }
+        // 扩大管道减少 splice 次数；超过 /proc/sys/fs/pipe-max-size 时保持默认大小
+        fcntl(uc.pipe_fds[1], F_SETPIPE_SZ, kSplicePipeSize);
+        int size = fcntl(uc.pipe_fds[1], F_GETPIPE_SZ);
+        uc.pipe_size = size > 0 ? static_cast<size_t>(size) : 65536;
+    }
+
+    // 管道里还有上次没写完的数据时只需 SpliceOut；否则先从文件读入，
+    // 两者用 IOSQE_IO_LINK 串联，一次提交完成一轮搬运
+    size_t out_len = uc.pipe_bytes;
+    if (out_len == 0) {
+        io_uring_sqe* in = ring_.getSqe();
+        if (!in) {
+            closeConnection(fd, uc);
+            return;
+        }
+        out_len = std::min(remaining, uc.pipe_size);
+        in->opcode = IORING_OP_SPLICE;
+        in->fd = uc.pipe_fds[1];
+        in->off = static_cast<uint64_t>(-1);
+        in->splice_fd_in = file_fd;
+        in->splice_off_in = offset;
+        in->len = static_cast<uint32_t>(out_len);
+        // 读入不足 len 时链路中断，SpliceOut 以 -ECANCELED 结束，随后按实际字节重新提交
+        in->flags = IOSQE_IO_LINK;
+        in->user_data = encode(Op::SpliceIn, fd);
+        uc.splice_in_inflight = true;
+    }
+
+    io_uring_sqe* out = ring_.getSqe();
+    if (!out) {
+        closeConnection(fd, uc);
+        return;
+    }
+    out->opcode = IORING_OP_SPLICE;
+    out->fd = fd;
+    out->off = static_cast<uint64_t>(-1);
+    out->splice_fd_in = uc.pipe_fds[0];
+    out->splice_off_in = static_cast<uint64_t>(-1);
+    out->len = static_cast<uint32_t>(out_len);
+    out->user_data = encode(Op::SpliceOut, fd);
+    uc.send_inflight = true;
+}
+
+void UringLoop::flushPendingSends() {
+    // 同一批次里产生的所有响应只在下一次 submitAndWait 时一次性提交
+    for (int fd : pending_sends_) {
+        auto it = conns_.find(fd);
+        if (it == conns_.end()) continue;
+        UringConnection& uc = *it->second;
+        if (!uc.closing && !uc.send_inflight &&
+            uc.conn->protocol().hasPendingSendData()) {
+            submitSend(fd, uc);
+        }
+    }
+    pending_sends_.clear();
+}
+
+void UringLoop::handleCqe(const io_uring_cqe& cqe) {
+    Op op = static_cast<Op>(cqe.user_data >> 32);
+    int fd = static_cast<int>(cqe.user_data & 0xFFFFFFFFu);
+    switch (op) {
+        case Op::Accept:
+            onAccept(cqe);
+            break;
+        case Op::Recv:
+            onRecv(fd, cqe);
+            break;
+        case Op::Send:
+            onSend(fd, cqe, false);
+            break;
+        case Op::SpliceIn:
+            onSpliceIn(fd, cqe);
+            break;
+        case Op::SpliceOut:
+            onSend(fd, cqe, true);
+            break;
+        case Op::Wakeup:
+            if (running_) armWakeup();
+            break;
+        case Op::Timeout:
+            tick_deadline_ms_ = 0;
+            break;
+        case Op::Cancel:
+            // 结果体现在被取消的 recv 的 CQE 上
+            break;
+        case Op::UdpPoll:
+            if (cqe.res < 0) {
+                // 除退出时的取消外不再重新提交，避免对失效的 socket 空转
+                if (cqe.res != -ECANCELED) {
+                    LOG_ERROR("Reactor %d: UDP poll failed: %s", index_,
+                              strerror(-cqe.res));
+                }
+                break;
+            }
+            if (running_) {
+                // res 为就绪的事件掩码
+                if (cqe.res & POLLOUT) {
+                    udp_->handleWritable();
+                } else {
+                    udp_->handleReadable();
+                }
+                armUdpPoll();
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+void UringLoop::onAccept(const io_uring_cqe& cqe) {
+    if (!(cqe.flags & IORING_CQE_F_MORE)) {
+        // multishot 终止（出错或被取消），需要重新提交
+        accept_armed_ = false;
+    }
+    if (cqe.res < 0) {
+        if (cqe.res != -ECANCELED) {
+            LOG_ERROR("Reactor %d: accept failed: %s", index_,
+                      strerror(-cqe.res));
+        }
+    } else {
+        int client_fd = cqe.res;
+        applyClientSocketOptions(client_fd, config_);
+        auto uc = std::make_unique<UringConnection>();
+        uc->conn = std::make_shared<Connection>(client_fd, -1);
+        UringConnection& ref = *uc;
+        ref.conn->setSendWatermarks(config_.send_high_watermark,
+                                    config_.send_low_watermark);
+        ref.conn->setBulkRoot(config_.bulk_root);
+        conns_[client_fd] = std::move(uc);
+        timers_.add(client_fd, 0);
+        armRecv(client_fd, ref);
+        LOG_INFO("Reactor %d accepted connection: fd=%d", index_, client_fd);
+    }
+    if (!accept_armed_ && running_) {
+        armAccept();
+    }
+}
+
+void UringLoop::onRecv(int fd, const io_uring_cqe& cqe) {
+    auto it = conns_.find(fd);
+    if (it == conns_.end()) return;
+    UringConnection& uc = *it->second;
+    if (!(cqe.flags & IORING_CQE_F_MORE)) {
+        uc.recv_armed = false;
+        uc.recv_cancelling = false;
+    }
+
+    if (cqe.res > 0 && (cqe.flags & IORING_CQE_F_BUFFER)) {
+        uint16_t bid = static_cast<uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+        bool ok = true;
+        if (!uc.closing) {
+            ok = uc.conn->handleData(
+                {ring_.bufferAddress(bid), static_cast<size_t>(cqe.res)});
+        }
+        // 数据已拷入连接的接收缓冲区，立即归还 provided buffer
+        ring_.recycleBuffer(bid);
+        if (!ok) {
+            LOG_INFO("Client disconnected: fd=%d", fd);
+            closeConnection(fd, uc);
+        } else if (uc.conn->protocol().hasPendingSendData()) {
+            pending_sends_.push_back(fd);
+        }
+    } else if (cqe.res == 0) {
+        // 对端正常关闭
+        LOG_INFO("Client disconnected: fd=%d", fd);
+        closeConnection(fd, uc);
+    } else if (cqe.res != -ENOBUFS && cqe.res != -ECANCELED) {
+        // -ENOBUFS 只是 provided buffer 暂时用完，重新提交即可；
+        // -ECANCELED 是读取暂停时主动取消，恢复读取时重新提交
+        LOG_INFO("Client read error: fd=%d, %s", fd, strerror(-cqe.res));
+        closeConnection(fd, uc);
+    }
+
+    updateRecv(fd, uc);
+    maybeRelease(fd, uc);
+}
+
+void UringLoop::onSend(int fd, const io_uring_cqe& cqe, bool from_pipe) {
+    auto it = conns_.find(fd);
+    if (it == conns_.end()) return;
+    UringConnection& uc = *it->second;
+    uc.send_inflight = false;
+
+    if (cqe.res > 0) {
+        if (from_pipe) uc.pipe_bytes -= static_cast<size_t>(cqe.res);
+        // 部分写只推进偏移，剩余部分继续提交
+        uc.conn->protocol().sendQueue().consume(static_cast<size_t>(cqe.res));
+        uc.conn->onBytesSent(static_cast<size_t>(cqe.res));
+        Metrics::getInstance().incrementBytesSent(static_cast<size_t>(cqe.res));
+        if (!uc.closing && uc.conn->maybeResumeReading()) {
+            // 先处理暂停期间已缓冲的请求，新响应与剩余数据一起发送
+            if (!uc.conn->handleData({})) {
+                LOG_INFO("Client disconnected: fd=%d", fd);
+                closeConnection(fd, uc);
+            }
+            updateRecv(fd, uc);
+        }
+        if (!uc.closing && uc.conn->protocol().hasPendingSendData()) {
+            submitSend(fd, uc);
+        }
+    } else if (cqe.res == -EAGAIN || cqe.res == -EINTR ||
+               (from_pipe && cqe.res == -ECANCELED)) {
+        // SpliceOut 被取消说明串联的 SpliceIn 读入不足或失败，后者失败时已关闭连接
+        if (!uc.closing) submitSend(fd, uc);
+    } else if (!uc.closing) {
+        LOG_INFO("Client write error: fd=%d, %s", fd, strerror(-cqe.res));
+        closeConnection(fd, uc);
+    }
+    maybeRelease(fd, uc);
+}
+
+void UringLoop::onSpliceIn(int fd, const io_uring_cqe& cqe) {
+    auto it = conns_.find(fd);
+    if (it == conns_.end()) return;
+    UringConnection& uc = *it->second;
+    uc.splice_in_inflight = false;
+
+    if (cqe.res > 0) {
+        uc.pipe_bytes += static_cast<size_t>(cqe.res);
+    } else if (!uc.closing) {
+        // 0 表示文件在发送过程中被截短，已承诺的长度无法兑现
+        LOG_WARNING("Bulk transfer read failed: fd=%d, %s", fd,
+                    cqe.res == 0 ? "file truncated" : strerror(-cqe.res));
+        Metrics::getInstance().incrementErrors();
+        closeConnection(fd, uc);
+    }
+    maybeRelease(fd, uc);
+}
+
+void UringLoop::closeConnection(int fd, UringConnection& uc) {
+    if (uc.closing) return;
+    uc.closing = true;
+    // shutdown 让在途的 multishot recv / send 尽快完成，之后再释放连接并关闭 fd
+    shutdown(fd, SHUT_RDWR);
+}
+
+void UringLoop::maybeRelease(int fd, UringConnection& uc) {
+    if (uc.closing && !uc.recv_armed && !uc.send_inflight &&
+        !uc.splice_in_inflight) {
+        // Connection 析构时关闭 fd
+        timers_.remove(fd);
+        conns_.erase(fd);
+    }
+}
+
+void UringLoop::cleanupAllConnections() {
+    for (auto& pair : conns_) {
+        closeConnection(pair.first, *pair.second);
+    }
+    // 等待在途请求完成，最多等待约 1 秒
+    for (int i = 0; i < 10 && !conns_.empty(); ++i) {
+        armTimeout(100 * 1000 * 1000LL);
+        ring_.submitAndWait(1);
+        ring_.forEachCqe([this](const io_uring_cqe& cqe) { handleCqe(cqe); });
+    }
+    conns_.clear();
+}
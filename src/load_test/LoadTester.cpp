@@ -1,20 +1,33 @@
 // src/load_test/LoadTester.cpp
 #include <arpa/inet.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/epoll.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <fstream>
 #include <iostream>
+#include <map>
+#include <memory>
 #include <ostream>
+#include <random>
 
 #include "load_test/LoadTester.hpp"
 #include "net/Packet.hpp"
-#include "net/Protocol.hpp"
+#include "net/protocol/TcpProtocol.hpp"
 
 LoadTester::LoadTester(std::string host, uint16_t port, int num_threads,
-                       int messages_per_thread)
+                       int messages_per_thread, uint16_t frame_header)
     : host_(std::move(host)),
       port_(port),
       num_threads_(num_threads),
-      messages_per_thread_(messages_per_thread) {}
+      messages_per_thread_(messages_per_thread),
+      frame_header_(frame_header) {}
 
 void LoadTester::run() {
     threads_.reserve(num_threads_);
@@ -39,12 +52,10 @@ void LoadTester::run() {
               << " msg/s" << std::endl;
 }
 
-void LoadTester::worker(int thread_index) {
-    // 1) 建立连接
+int LoadTester::connectToServer() const {
     int sockfd = ::socket(AF_INET, SOCK_STREAM, 0);
     if (sockfd < 0) {
-        ++failure_count_;
-        return;
+        return -1;
     }
     sockaddr_in servaddr{};
     servaddr.sin_family = AF_INET;
@@ -52,23 +63,26 @@ void LoadTester::worker(int thread_index) {
     if (::inet_pton(AF_INET, host_.c_str(), &servaddr.sin_addr) != 1 ||
         ::connect(sockfd, (sockaddr*)&servaddr, sizeof(servaddr)) < 0) {
         ::close(sockfd);
+        return -1;
+    }
+    return sockfd;
+}
+
+void LoadTester::worker(int thread_index) {
+    // 1) 建立连接
+    int sockfd = connectToServer();
+    if (sockfd < 0) {
         ++failure_count_;
         return;
     }
 
-    Protocol proto(sockfd);
+    TcpProtocol proto(sockfd);
     for (int i = 0; i < messages_per_thread_; ++i) {
         // 构造并发送 Packet
         std::string payload = "msg from thread " +
                               std::to_string(thread_index) + "#" +
                               std::to_string(i);
-        Packet pkt;
-        pkt.header = 0xABCD;
-        pkt.payload = payload;
-        pkt.length = static_cast<uint32_t>(payload.size());
-        pkt.checksum = calculate_checksum(
-            std::vector<uint8_t>(payload.begin(), payload.end()));
-        proto.enqueuePacket(pkt);
+        proto.enqueuePacket(Packet::make(std::move(payload), frame_header_));
 
         // flush 发送缓冲区
         int err = 0;
@@ -84,12 +98,12 @@ void LoadTester::worker(int thread_index) {
         Packet resp;
         while (true) {
             auto status = proto.tryReceivePacket(resp);
-            if (status == Protocol::ReadStatus::OK) {
+            if (status == TcpProtocol::ReadStatus::OK) {
                 // std::cout << "Echo> " << resp.payload << "\n";
                 ++success_count_;
                 break;
             }
-            if (status == Protocol::ReadStatus::Error) {
+            if (status == TcpProtocol::ReadStatus::Error) {
                 ++failure_count_;
                 break;
             }
@@ -99,3 +113,670 @@ void LoadTester::worker(int thread_index) {
 
     ::close(sockfd);
 }
+
+OpenLoopResult LoadTester::measureOpenLoop(const OpenLoopOptions& options) {
+    LatencyHistogram latency;
+    OpenLoopCounters counters;
+
+    // 留出建立连接的时间，所有线程从同一时刻开始按计划发送
+    auto start = Clock::now() + std::chrono::milliseconds(100);
+    std::vector<std::thread> threads;
+    threads.reserve(num_threads_);
+    for (int i = 0; i < num_threads_; ++i) {
+        threads.emplace_back(&LoadTester::openLoopWorker, this, i,
+                             std::cref(options), start, std::ref(latency),
+                             std::ref(counters));
+    }
+    for (auto& t : threads) t.join();
+    double secs = std::chrono::duration<double>(Clock::now() - start).count();
+
+    OpenLoopResult result;
+    result.target_rate = options.rate;
+    result.sent = counters.sent.load();
+    result.received = counters.received.load();
+    result.errors = counters.errors.load();
+    result.timed_out = counters.timed_out.load();
+    result.achieved_rate = secs > 0 ? result.received / secs : 0;
+    result.latency = latency.snapshot();
+    return result;
+}
+
+void LoadTester::openLoopWorker(int thread_index,
+                                const OpenLoopOptions& options,
+                                Clock::time_point start,
+                                LatencyHistogram& latency,
+                                OpenLoopCounters& counters) {
+    int sockfd = connectToServer();
+    if (sockfd < 0) {
+        ++counters.errors;
+        return;
+    }
+    // 非阻塞：发送被对端反压时不阻塞计划，积压的请求照样计时
+    ::fcntl(sockfd, F_SETFL, ::fcntl(sockfd, F_GETFL, 0) | O_NONBLOCK);
+    TcpProtocol proto(sockfd);
+    const std::string filler(options.payload.max, 'x');
+
+    // 每个线程承担总速率的 1/num_threads_；恒定间隔时各线程错开相位，避免同步突发
+    double thread_rate = options.rate / num_threads_;
+    std::mt19937_64 rng(0x9E3779B97F4A7C15ull ^ uint64_t(thread_index));
+    std::exponential_distribution<double> poisson_gap(thread_rate);
+    auto gap = [&]() {
+        double seconds = options.poisson ? poisson_gap(rng) : 1.0 / thread_rate;
+        return std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(seconds));
+    };
+    Clock::time_point next =
+        start + std::chrono::duration_cast<Clock::duration>(
+                    std::chrono::duration<double>(
+                        options.poisson ? 0.0
+                                        : 1.0 / thread_rate * thread_index /
+                                              num_threads_));
+    const Clock::time_point send_end =
+        start + std::chrono::duration_cast<Clock::duration>(
+                    std::chrono::duration<double>(options.duration));
+    const Clock::time_point drain_end =
+        send_end + std::chrono::duration_cast<Clock::duration>(
+                       std::chrono::duration<double>(options.drain_timeout));
+
+    // 已发出、等待响应的请求的计划发送时刻；TCP 上响应按请求顺序返回
+    std::deque<Clock::time_point> inflight;
+    bool failed = false;
+    while (!failed) {
+        Clock::time_point now = Clock::now();
+        // 1) 发出所有计划时刻已到的请求：落后时一次补齐，计划时刻不顺延
+        while (next <= now && next < send_end) {
+            proto.enqueuePacket(Packet::make(
+                filler.substr(0, options.payload.sample(rng)), frame_header_));
+            inflight.push_back(next);
+            ++counters.sent;
+            next += gap();
+        }
+        int err = 0;
+        if (proto.hasPendingSendData() && !proto.flushSendBuffer(err)) {
+            failed = true;
+            break;
+        }
+
+        // 2) 收取已到达的响应，延迟从该请求的计划发送时刻算起
+        Packet resp;
+        while (true) {
+            auto status = proto.tryReceivePacket(resp);
+            if (status == TcpProtocol::ReadStatus::OK) {
+                if (resp.header == Packet::kControlHeader) continue;
+                if (inflight.empty()) {
+                    ++counters.errors;
+                    continue;
+                }
+                auto elapsed = Clock::now() - inflight.front();
+                inflight.pop_front();
+                latency.record(static_cast<uint64_t>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed)
+                        .count()));
+                ++counters.received;
+                continue;
+            }
+            if (status == TcpProtocol::ReadStatus::Error) failed = true;
+            break;
+        }
+        if (failed) break;
+
+        now = Clock::now();
+        if (next >= send_end && inflight.empty()) break;
+        if (now >= drain_end) {
+            counters.timed_out += inflight.size();
+            inflight.clear();
+            break;
+        }
+
+        // 3) 等到下一个计划发送时刻，期间有响应到达或可写时提前醒来
+        Clock::time_point wake = next < send_end ? next : drain_end;
+        auto wait = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            wake > now ? wake - now : Clock::duration::zero());
+        timespec timeout{static_cast<time_t>(wait.count() / 1000000000),
+                         static_cast<long>(wait.count() % 1000000000)};
+        pollfd pfd{sockfd, static_cast<short>(
+                               POLLIN | (proto.hasPendingSendData() ? POLLOUT
+                                                                    : 0)),
+                   0};
+        ::ppoll(&pfd, 1, &timeout, nullptr);
+    }
+    if (failed) {
+        counters.errors += inflight.size();
+    }
+    ::close(sockfd);
+}
+
+OpenLoopResult LoadTester::runOpenLoop(const OpenLoopOptions& options) {
+    OpenLoopResult result = measureOpenLoop(options);
+
+    std::cout << "Open-loop: target " << options.rate << " req/s ("
+              << (options.poisson ? "poisson" : "constant") << " arrivals), "
+              << num_threads_ << " connections, " << options.duration
+              << " s, payload " << options.payload.describe() << std::endl;
+    std::cout << "Sent: " << result.sent << ", Received: " << result.received
+              << ", Errors: " << result.errors
+              << ", Timed out: " << result.timed_out << std::endl;
+    std::cout << "Achieved: " << result.achieved_rate << " req/s" << std::endl;
+    std::cout << "Latency from intended send time (coordinated omission "
+                 "corrected):"
+              << std::endl;
+    printLatencyDistribution(result.latency);
+    return result;
+}
+
+std::vector<OpenLoopResult> LoadTester::sweep(
+    const OpenLoopOptions& options, const std::vector<double>& rates) {
+    std::vector<OpenLoopResult> results;
+    std::printf("%14s %12s %10s %10s %10s %10s %10s %8s\n", "target(req/s)",
+                "achieved", "p50(us)", "p90(us)", "p99(us)", "p99.9(us)",
+                "max(us)", "errors");
+    for (double rate : rates) {
+        OpenLoopOptions step = options;
+        step.rate = rate;
+        OpenLoopResult r = measureOpenLoop(step);
+        const auto& h = r.latency;
+        std::printf("%14.0f %12.0f %10.1f %10.1f %10.1f %10.1f %10.1f %8llu\n",
+                    rate, r.achieved_rate, h.percentile(50) / 1000.0,
+                    h.percentile(90) / 1000.0, h.percentile(99) / 1000.0,
+                    h.percentile(99.9) / 1000.0, h.max / 1000.0,
+                    static_cast<unsigned long long>(r.errors + r.timed_out));
+        std::fflush(stdout);
+        results.push_back(std::move(r));
+    }
+    return results;
+}
+
+void LoadTester::printLatencyDistribution(
+    const LatencyHistogram::Snapshot& latency) {
+    if (latency.count == 0) {
+        std::cout << "  (no samples)" << std::endl;
+        return;
+    }
+    std::printf("  mean=%.1fus p50=%.1fus p90=%.1fus p99=%.1fus p99.9=%.1fus "
+                "p99.99=%.1fus max=%.1fus\n",
+                latency.mean() / 1000.0, latency.percentile(50) / 1000.0,
+                latency.percentile(90) / 1000.0,
+                latency.percentile(99) / 1000.0,
+                latency.percentile(99.9) / 1000.0,
+                latency.percentile(99.99) / 1000.0, latency.max / 1000.0);
+
+    // 与 HdrHistogram 的百分位输出相同：剩余比例每减半打 5 个点，直到覆盖全部样本
+    std::printf("%14s %14s %12s %18s\n", "Value(us)", "Percentile",
+                "TotalCount", "1/(1-Percentile)");
+    constexpr int kTicksPerHalf = 5;
+    for (int tick = 0;; ++tick) {
+        double remaining = std::pow(0.5, double(tick) / kTicksPerHalf);
+        double fraction = 1.0 - remaining;
+        bool last = remaining * latency.count < 1.0;
+        if (last) fraction = 1.0;
+        uint64_t rank = static_cast<uint64_t>(std::ceil(fraction * latency.count));
+        double value = latency.percentile(fraction * 100.0) / 1000.0;
+        if (last) {
+            std::printf("%14.1f %14.12f %12llu %18s\n", value, 1.0,
+                        static_cast<unsigned long long>(latency.count), "inf");
+            break;
+        }
+        std::printf("%14.1f %14.12f %12llu %18.2f\n", value, fraction,
+                    static_cast<unsigned long long>(rank < 1 ? 1 : rank),
+                    1.0 / remaining);
+    }
+}
+
+// ---------------- payload 大小分布 ----------------
+
+bool PayloadSizes::parse(const std::string& spec, PayloadSizes& out) {
+    // 指数分布截断上限，避免长尾样本生成过大的帧
+    constexpr size_t kExponentialCap = 1 << 20;
+    try {
+        size_t pos = 0;
+        if (spec.rfind("exp:", 0) == 0) {
+            double mean = std::stod(spec.substr(4), &pos);
+            if (pos != spec.size() - 4 || mean <= 0) return false;
+            out.kind = Kind::Exponential;
+            out.mean = mean;
+            out.min = 0;
+            out.max = kExponentialCap;
+            return true;
+        }
+        size_t dash = spec.find('-');
+        if (dash != std::string::npos) {
+            size_t lo = std::stoul(spec.substr(0, dash), &pos);
+            if (pos != dash) return false;
+            std::string upper = spec.substr(dash + 1);
+            size_t hi = std::stoul(upper, &pos);
+            if (pos != upper.size() || lo > hi) return false;
+            out.kind = Kind::Uniform;
+            out.min = lo;
+            out.max = hi;
+            return true;
+        }
+        size_t size = std::stoul(spec, &pos);
+        if (pos != spec.size()) return false;
+        out.kind = Kind::Fixed;
+        out.min = out.max = size;
+        return true;
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+size_t PayloadSizes::sample(std::mt19937_64& rng) const {
+    switch (kind) {
+        case Kind::Uniform:
+            return std::uniform_int_distribution<size_t>(min, max)(rng);
+        case Kind::Exponential: {
+            double size = std::exponential_distribution<double>(1.0 / mean)(rng);
+            return std::min(static_cast<size_t>(size), max);
+        }
+        case Kind::Fixed:
+        default:
+            return min;
+    }
+}
+
+std::string PayloadSizes::describe() const {
+    switch (kind) {
+        case Kind::Uniform:
+            return "uniform " + std::to_string(min) + "-" + std::to_string(max) +
+                   " B";
+        case Kind::Exponential:
+            return "exponential mean " +
+                   std::to_string(static_cast<size_t>(mean)) + " B";
+        case Kind::Fixed:
+        default:
+            return std::to_string(min) + " B";
+    }
+}
+
+// ---------------- 多路复用压测 ----------------
+
+namespace {
+
+// 多路复用模式下单个连接的运行状态（只在所属线程内使用）
+struct MuxConnection {
+    enum class State { Idle, Connecting, Active, Done, Failed };
+    State state = State::Idle;
+    int fd = -1;
+    std::unique_ptr<TcpProtocol> proto;
+    std::deque<std::chrono::steady_clock::time_point> inflight;  // 各在途请求的发送时刻
+    uint64_t issued = 0;  // 已发出的请求数
+    std::chrono::steady_clock::time_point connect_start;
+};
+
+}  // namespace
+
+void LoadTester::runMultiplexed(const MultiplexOptions& options) {
+    std::vector<ThreadStats> stats(num_threads_);
+    // 直方图必须比写入它的线程活得更久（见 ThreadShards）
+    std::vector<std::unique_ptr<LatencyHistogram>> histograms;
+    for (int i = 0; i < num_threads_; ++i) {
+        histograms.push_back(std::make_unique<LatencyHistogram>());
+    }
+
+    auto start = Clock::now();
+    std::vector<std::thread> threads;
+    threads.reserve(num_threads_);
+    for (int i = 0; i < num_threads_; ++i) {
+        threads.emplace_back(&LoadTester::multiplexWorker, this, i,
+                             std::cref(options), start,
+                             std::ref(*histograms[i]), std::ref(stats[i]));
+    }
+    for (auto& t : threads) t.join();
+    double secs = std::chrono::duration<double>(Clock::now() - start).count();
+
+    // 总体
+    LatencyHistogram::Snapshot total_latency;
+    uint64_t connected = 0, failed = 0, requests = 0, unanswered = 0;
+    std::vector<const ConnectionStats*> all;
+    for (const ThreadStats& ts : stats) {
+        total_latency.merge(ts.latency);
+        for (const ConnectionStats& cs : ts.connections) {
+            (cs.connected ? connected : failed) += 1;
+            requests += cs.requests;
+            unanswered += cs.unanswered;
+            all.push_back(&cs);
+        }
+    }
+    std::cout << "Multiplexed: " << num_threads_ << " threads x "
+              << options.connections_per_thread << " connections, depth "
+              << options.pipeline_depth << ", payload "
+              << options.payload.describe() << std::endl;
+    std::cout << "Connections: " << connected << " established, " << failed
+              << " failed" << std::endl;
+    std::cout << "Requests: " << requests << " answered, " << unanswered
+              << " unanswered" << std::endl;
+    std::cout << "Elapsed: " << secs << ", Throughput: " << requests / secs
+              << " req/s" << std::endl;
+    std::cout << "Latency:" << std::endl;
+    printLatencyDistribution(total_latency);
+
+    // 逐线程
+    std::printf("\n%6s %8s %8s %12s %12s %10s %10s %10s\n", "thread",
+                "conns", "failed", "requests", "req/s", "p50(us)", "p99(us)",
+                "max(us)");
+    for (int i = 0; i < num_threads_; ++i) {
+        const ThreadStats& ts = stats[i];
+        uint64_t ok = 0, bad = 0, reqs = 0;
+        for (const ConnectionStats& cs : ts.connections) {
+            (cs.connected ? ok : bad) += 1;
+            reqs += cs.requests;
+        }
+        std::printf("%6d %8llu %8llu %12llu %12.0f %10.1f %10.1f %10.1f\n", i,
+                    static_cast<unsigned long long>(ok),
+                    static_cast<unsigned long long>(bad),
+                    static_cast<unsigned long long>(reqs),
+                    ts.seconds > 0 ? reqs / ts.seconds : 0.0,
+                    ts.latency.percentile(50) / 1000.0,
+                    ts.latency.percentile(99) / 1000.0, ts.latency.max / 1000.0);
+    }
+
+    // 逐连接：各连接吞吐与平均延迟的分布，以及最慢的几个连接
+    std::vector<const ConnectionStats*> live;
+    for (const ConnectionStats* cs : all) {
+        if (cs->connected && cs->requests > 0) live.push_back(cs);
+    }
+    if (!live.empty()) {
+        auto mean_us = [](const ConnectionStats* cs) {
+            return cs->latency_sum_ns / 1000.0 / cs->requests;
+        };
+        std::sort(live.begin(), live.end(),
+                  [&](const ConnectionStats* a, const ConnectionStats* b) {
+                      return mean_us(a) < mean_us(b);
+                  });
+        auto at = [&](double q) {
+            return live[std::min(live.size() - 1,
+                                 static_cast<size_t>(q * live.size()))];
+        };
+        std::printf(
+            "\nPer-connection mean latency: min=%.1fus p50=%.1fus p99=%.1fus "
+            "max=%.1fus\n",
+            mean_us(live.front()), mean_us(at(0.5)), mean_us(at(0.99)),
+            mean_us(live.back()));
+        std::vector<const ConnectionStats*> by_requests = live;
+        std::sort(by_requests.begin(), by_requests.end(),
+                  [](const ConnectionStats* a, const ConnectionStats* b) {
+                      return a->requests < b->requests;
+                  });
+        std::printf("Per-connection requests: min=%llu p50=%llu max=%llu\n",
+                    static_cast<unsigned long long>(by_requests.front()->requests),
+                    static_cast<unsigned long long>(
+                        by_requests[by_requests.size() / 2]->requests),
+                    static_cast<unsigned long long>(by_requests.back()->requests));
+    }
+
+    // 失败原因
+    std::map<int, uint64_t> errors;
+    for (const ConnectionStats* cs : all) {
+        if (cs->error != 0) ++errors[cs->error];
+    }
+    for (const auto& [err, count] : errors) {
+        std::printf("Error %s: %llu connections\n", std::strerror(err),
+                    static_cast<unsigned long long>(count));
+    }
+
+    if (!options.csv_path.empty()) {
+        std::ofstream csv(options.csv_path);
+        csv << "thread,connection,connected,error,connect_us,requests,"
+               "unanswered,mean_latency_us,max_latency_us\n";
+        for (int i = 0; i < num_threads_; ++i) {
+            const auto& conns = stats[i].connections;
+            for (size_t c = 0; c < conns.size(); ++c) {
+                const ConnectionStats& cs = conns[c];
+                csv << i << ',' << c << ',' << cs.connected << ','
+                    << cs.error << ',' << cs.connect_ns / 1000.0 << ','
+                    << cs.requests << ',' << cs.unanswered << ','
+                    << (cs.requests ? cs.latency_sum_ns / 1000.0 / cs.requests
+                                    : 0.0)
+                    << ',' << cs.latency_max_ns / 1000.0 << '\n';
+            }
+        }
+        std::cout << "Per-connection results written to " << options.csv_path
+                  << std::endl;
+    }
+}
+
+void LoadTester::multiplexWorker(int thread_index,
+                                 const MultiplexOptions& options,
+                                 Clock::time_point start,
+                                 LatencyHistogram& latency,
+                                 ThreadStats& stats) {
+    const int count = options.connections_per_thread;
+    const size_t depth = std::max(options.pipeline_depth, 1);
+    stats.connections.assign(count, ConnectionStats{});
+    std::vector<MuxConnection> conns(count);
+
+    int epfd = ::epoll_create1(EPOLL_CLOEXEC);
+    if (epfd < 0) {
+        for (auto& cs : stats.connections) cs.error = errno;
+        return;
+    }
+    sockaddr_in servaddr{};
+    servaddr.sin_family = AF_INET;
+    servaddr.sin_port = htons(port_);
+    if (::inet_pton(AF_INET, host_.c_str(), &servaddr.sin_addr) != 1) {
+        for (auto& cs : stats.connections) cs.error = EINVAL;
+        ::close(epfd);
+        return;
+    }
+
+    std::mt19937_64 rng(0xC2B2AE3D27D4EB4Full ^ uint64_t(thread_index));
+    const std::string filler(options.payload.max, 'x');
+    // 建连节奏：每个线程承担总速率的 1/num_threads_
+    const double thread_connect_rate =
+        options.connect_rate > 0 ? options.connect_rate / num_threads_ : 0;
+    const bool timed = options.requests_per_connection == 0;
+    const auto to_duration = [](double seconds) {
+        return std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(seconds));
+    };
+    Clock::time_point send_end = start + to_duration(options.duration);
+    int opened = 0;     // 已发起 connect 的连接数
+    int finished = 0;   // Done 或 Failed 的连接数
+    int quota_reached = 0;  // 计数模式：已发完配额或已失败的连接数
+    bool sending = true;
+
+    auto fail = [&](int index, int err) {
+        MuxConnection& mc = conns[index];
+        ConnectionStats& cs = stats.connections[index];
+        if (cs.error == 0) cs.error = err;
+        if (!timed && mc.issued < options.requests_per_connection) {
+            ++quota_reached;
+        }
+        cs.unanswered += mc.inflight.size();
+        mc.inflight.clear();
+        mc.proto.reset();
+        if (mc.fd >= 0) ::close(mc.fd);
+        mc.fd = -1;
+        mc.state = MuxConnection::State::Failed;
+        ++finished;
+    };
+    auto finish = [&](int index) {
+        MuxConnection& mc = conns[index];
+        mc.proto.reset();
+        ::close(mc.fd);
+        mc.fd = -1;
+        mc.state = MuxConnection::State::Done;
+        ++finished;
+    };
+    // 补满流水线并尽量发出
+    auto pump = [&](int index) {
+        MuxConnection& mc = conns[index];
+        const uint64_t issued_before = mc.issued;
+        while (sending && mc.inflight.size() < depth &&
+               (timed || mc.issued < options.requests_per_connection)) {
+            mc.proto->enqueuePacket(Packet::make(
+                filler.substr(0, options.payload.sample(rng)), frame_header_));
+            mc.inflight.push_back(Clock::now());
+            ++mc.issued;
+        }
+        if (!timed && issued_before < options.requests_per_connection &&
+            mc.issued >= options.requests_per_connection) {
+            ++quota_reached;
+        }
+        int err = 0;
+        if (mc.proto->hasPendingSendData() && !mc.proto->flushSendBuffer(err)) {
+            fail(index, err);
+            return;
+        }
+        // 计数模式：全部请求都已应答；计时模式：停止发送后在途请求已清空
+        bool quota_done = !timed && mc.issued >= options.requests_per_connection;
+        if ((quota_done || !sending) && mc.inflight.empty()) finish(index);
+    };
+    auto open = [&](int index) {
+        MuxConnection& mc = conns[index];
+        mc.connect_start = Clock::now();
+        mc.fd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (mc.fd < 0) {
+            fail(index, errno);
+            return;
+        }
+        if (::connect(mc.fd, (sockaddr*)&servaddr, sizeof(servaddr)) < 0 &&
+            errno != EINPROGRESS) {
+            fail(index, errno);
+            return;
+        }
+        // 边沿触发：可读时 TcpProtocol 一次读到 EAGAIN，可写通知只用于建连完成和发送恢复
+        epoll_event ev{};
+        ev.events = EPOLLIN | EPOLLOUT | EPOLLET;
+        ev.data.u32 = static_cast<uint32_t>(index);
+        if (::epoll_ctl(epfd, EPOLL_CTL_ADD, mc.fd, &ev) < 0) {
+            fail(index, errno);
+            return;
+        }
+        mc.state = MuxConnection::State::Connecting;
+    };
+    auto onEvent = [&](int index, uint32_t events) {
+        MuxConnection& mc = conns[index];
+        ConnectionStats& cs = stats.connections[index];
+        if (mc.state == MuxConnection::State::Connecting) {
+            int err = 0;
+            socklen_t len = sizeof(err);
+            ::getsockopt(mc.fd, SOL_SOCKET, SO_ERROR, &err, &len);
+            if (err != 0) {
+                fail(index, err);
+                return;
+            }
+            if (!(events & (EPOLLOUT | EPOLLIN))) return;
+            mc.state = MuxConnection::State::Active;
+            mc.proto = std::make_unique<TcpProtocol>(mc.fd);
+            cs.connected = true;
+            cs.connect_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                Clock::now() - mc.connect_start)
+                                .count();
+            pump(index);
+            return;
+        }
+        if (mc.state != MuxConnection::State::Active) return;
+
+        if (events & EPOLLIN) {
+            Packet resp;
+            while (true) {
+                auto status = mc.proto->tryReceivePacket(resp);
+                if (status == TcpProtocol::ReadStatus::OK) {
+                    if (resp.header == Packet::kControlHeader) continue;
+                    if (mc.inflight.empty()) continue;
+                    uint64_t ns =
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            Clock::now() - mc.inflight.front())
+                            .count();
+                    mc.inflight.pop_front();
+                    latency.record(ns);
+                    ++cs.requests;
+                    cs.latency_sum_ns += ns;
+                    cs.latency_max_ns = std::max(cs.latency_max_ns, ns);
+                    continue;
+                }
+                if (status == TcpProtocol::ReadStatus::Error) {
+                    // 对端关闭或帧非法
+                    fail(index, ECONNRESET);
+                    return;
+                }
+                break;
+            }
+        } else if (events & (EPOLLERR | EPOLLHUP)) {
+            fail(index, ECONNRESET);
+            return;
+        }
+        pump(index);
+    };
+
+    Clock::time_point drain_end{};
+    Clock::time_point next_stall_check{};
+    std::vector<epoll_event> events(1024);
+    while (finished < count) {
+        Clock::time_point now = Clock::now();
+        // 按建连速率发起新连接
+        int due = count;
+        if (thread_connect_rate > 0) {
+            double elapsed = std::chrono::duration<double>(now - start).count();
+            due = std::min<int>(count,
+                                static_cast<int>(elapsed * thread_connect_rate) + 1);
+        }
+        while (opened < due) open(opened++);
+
+        // 计时模式到点后停止发新请求，已空闲的连接直接结束
+        if (timed && sending && now >= send_end) {
+            sending = false;
+            drain_end = now + to_duration(options.drain_timeout);
+            for (int i = 0; i < opened; ++i) {
+                if (conns[i].state == MuxConnection::State::Active &&
+                    conns[i].inflight.empty()) {
+                    finish(i);
+                }
+            }
+        }
+        // 计数模式：流水线已满而对端不再应答时连接永远发不完配额，
+        // 最早的在途请求超过 drain_timeout 仍未应答即按 ETIMEDOUT 结束该连接
+        if (!timed && sending && now >= next_stall_check) {
+            next_stall_check = now + std::chrono::milliseconds(100);
+            Clock::time_point stalled = now - to_duration(options.drain_timeout);
+            for (int i = 0; i < opened; ++i) {
+                if (conns[i].state == MuxConnection::State::Active &&
+                    !conns[i].inflight.empty() &&
+                    conns[i].inflight.front() < stalled) {
+                    fail(i, ETIMEDOUT);
+                }
+            }
+        }
+        // 计数模式：最后一个连接发完配额后同样只等待排空超时，
+        // 丢失的应答或不再回复的对端按 ETIMEDOUT 计入，不会一直等下去
+        if (!timed && sending && quota_reached == count) {
+            sending = false;
+            drain_end = now + to_duration(options.drain_timeout);
+        }
+        if (!sending && now >= drain_end) {
+            // 超时未应答的请求计入 unanswered，连接视为失败
+            for (int i = 0; i < opened; ++i) {
+                auto state = conns[i].state;
+                if (state == MuxConnection::State::Active ||
+                    state == MuxConnection::State::Connecting) {
+                    fail(i, ETIMEDOUT);
+                }
+            }
+            break;
+        }
+
+        int timeout = 100;
+        if (opened < count && thread_connect_rate > 0) {
+            double next = opened / thread_connect_rate;
+            double wait = next - std::chrono::duration<double>(now - start).count();
+            timeout = std::clamp(static_cast<int>(wait * 1000), 0, 100);
+        }
+        int n = ::epoll_wait(epfd, events.data(), static_cast<int>(events.size()),
+                             timeout);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        for (int i = 0; i < n; ++i) {
+            onEvent(static_cast<int>(events[i].data.u32), events[i].events);
+        }
+    }
+    stats.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    stats.latency = latency.snapshot();
+    for (auto& mc : conns) {
+        mc.proto.reset();
+        if (mc.fd >= 0) ::close(mc.fd);
+    }
+    ::close(epfd);
+}
@@ -0,0 +1,275 @@
+#include "net/BulkTransfer.hpp"
+
+#include <fcntl.h>
+#include <linux/openat2.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#include "net/Packet.hpp"
+#include "net/buffer/SendQueue.hpp"
+#include "net/protocol/TcpProtocol.hpp"
+
+namespace bulk {
+
+namespace {
+
+void putU64(uint8_t* out, uint64_t value) {
+    for (int i = 7; i >= 0; --i) {
+        out[i] = static_cast<uint8_t>(value);
+        value >>= 8;
+    }
+}
+
+uint64_t getU64(const uint8_t* in) {
+    uint64_t value = 0;
+    for (int i = 0; i < 8; ++i) {
+        value = (value << 8) | in[i];
+    }
+    return value;
+}
+
+// 只接受相对路径，不含 ".." 分量和 NUL；openat2 不可用时的回退路径依赖这里的检查
+bool validPath(std::string_view path) {
+    if (path.empty() || path.size() > kMaxPathLength || path.front() == '/' ||
+        path.find('\0') != std::string_view::npos) {
+        return false;
+    }
+    size_t start = 0;
+    while (start <= path.size()) {
+        size_t end = path.find('/', start);
+        if (end == std::string_view::npos) end = path.size();
+        if (path.substr(start, end - start) == "..") return false;
+        start = end + 1;
+    }
+    return true;
+}
+
+Status statusFromErrno(int err) {
+    switch (err) {
+        case ENOENT:
+        case ENOTDIR:
+            return Status::NotFound;
+        case EXDEV:   // RESOLVE_BENEATH：解析越出根目录
+        case ELOOP:   // 回退路径遇到符号链接
+        case EACCES:
+        case EPERM:
+            return Status::Denied;
+        default:
+            return Status::IoError;
+    }
+}
+
+// 回退路径（内核早于 5.6）：逐级用 O_NOFOLLOW 打开，任何一级是符号链接都拒绝，
+// 加上不含 ".." 的检查，同样不会越出根目录
+int openBeneathFallback(int root_fd, const std::string& path) {
+    int dir_fd = dup(root_fd);
+    if (dir_fd < 0) return -1;
+    size_t start = 0;
+    while (true) {
+        size_t end = path.find('/', start);
+        bool last = end == std::string::npos;
+        std::string name = path.substr(start, last ? std::string::npos
+                                                   : end - start);
+        start = end + 1;
+        if (!last && (name.empty() || name == ".")) continue;
+        int flags = O_NOFOLLOW | O_CLOEXEC |
+                    (last ? O_RDONLY : O_PATH | O_DIRECTORY);
+        int next = ::openat(dir_fd, name.c_str(), flags);
+        int saved_errno = errno;
+        ::close(dir_fd);
+        errno = saved_errno;
+        if (next < 0 || last) return next;
+        dir_fd = next;
+    }
+}
+
+// 在 root 之下打开 path（只读），失败返回 -1 并保留 errno
+int openBeneath(std::string_view root, std::string_view path) {
+    std::string root_path(root);
+    std::string rel_path(path);
+    int root_fd = ::open(root_path.c_str(), O_PATH | O_DIRECTORY | O_CLOEXEC);
+    if (root_fd < 0) return -1;
+
+    open_how how{};
+    how.flags = O_RDONLY | O_CLOEXEC;
+    // 符号链接可以用，但解析结果必须仍在根目录之下；/proc 魔法链接一律拒绝
+    how.resolve = RESOLVE_BENEATH | RESOLVE_NO_MAGICLINKS;
+    int fd = static_cast<int>(
+        ::syscall(SYS_openat2, root_fd, rel_path.c_str(), &how, sizeof(how)));
+    if (fd < 0 && errno == ENOSYS) {
+        fd = openBeneathFallback(root_fd, rel_path);
+    }
+    int saved_errno = errno;
+    ::close(root_fd);
+    errno = saved_errno;
+    return fd;
+}
+
+void appendResponse(SendQueue& out, const Response& response) {
+    uint8_t payload[kResponseSize];
+    payload[0] = static_cast<uint8_t>(response.status);
+    putU64(payload + 1, response.offset);
+    putU64(payload + 9, response.length);
+    putU64(payload + 17, response.file_size);
+    out.beginFrame(Packet::kBulkResponseHeader);
+    out.appendCopy(payload, sizeof(payload));
+    out.endFrame();
+}
+
+}  // namespace
+
+const char* statusName(Status status) {
+    switch (status) {
+        case Status::Ok:
+            return "ok";
+        case Status::NotFound:
+            return "not found";
+        case Status::BadRange:
+            return "bad range";
+        case Status::Denied:
+            return "denied";
+        case Status::IoError:
+        default:
+            return "io error";
+    }
+}
+
+std::string encodeRequest(const Request& request) {
+    std::string payload(kRequestFixedSize, '\0');
+    putU64(reinterpret_cast<uint8_t*>(payload.data()), request.offset);
+    putU64(reinterpret_cast<uint8_t*>(payload.data()) + 8, request.length);
+    payload.append(request.path);
+    auto frame = Packet::make(std::move(payload), Packet::kBulkRequestHeader)
+                     .serialize();
+    return std::string(frame.begin(), frame.end());
+}
+
+bool parseRequest(std::span<const uint8_t> payload, Request& request) {
+    if (payload.size() <= kRequestFixedSize ||
+        payload.size() > kRequestFixedSize + kMaxPathLength) {
+        return false;
+    }
+    request.offset = getU64(payload.data());
+    request.length = getU64(payload.data() + 8);
+    request.path = std::string_view(
+        reinterpret_cast<const char*>(payload.data()) + kRequestFixedSize,
+        payload.size() - kRequestFixedSize);
+    return true;
+}
+
+bool parseResponse(std::span<const uint8_t> payload, Response& response) {
+    if (payload.size() != kResponseSize ||
+        payload[0] > static_cast<uint8_t>(Status::IoError)) {
+        return false;
+    }
+    response.status = static_cast<Status>(payload[0]);
+    response.offset = getU64(payload.data() + 1);
+    response.length = getU64(payload.data() + 9);
+    response.file_size = getU64(payload.data() + 17);
+    return true;
+}
+
+uint64_t serve(const PacketView& request, std::string_view root,
+               SendQueue& out) {
+    Request req;
+    if (!parseRequest(request.payload, req)) {
+        throw std::runtime_error("Malformed bulk request");
+    }
+
+    Response response;
+    response.offset = req.offset;
+    if (root.empty() || !validPath(req.path)) {
+        response.status = Status::Denied;
+        appendResponse(out, response);
+        return 0;
+    }
+
+    int fd = openBeneath(root, req.path);
+    if (fd < 0) {
+        response.status = statusFromErrno(errno);
+        appendResponse(out, response);
+        return 0;
+    }
+    struct stat st {};
+    bool stat_ok = ::fstat(fd, &st) == 0;
+    if (!stat_ok || !S_ISREG(st.st_mode)) {
+        // 目录、设备、FIFO 等不提供：大小无意义，读取还可能阻塞
+        response.status = stat_ok ? Status::Denied : Status::IoError;
+        ::close(fd);
+        appendResponse(out, response);
+        return 0;
+    }
+
+    uint64_t file_size = static_cast<uint64_t>(st.st_size);
+    response.file_size = file_size;
+    if (req.offset > file_size) {
+        response.status = Status::BadRange;
+        ::close(fd);
+        appendResponse(out, response);
+        return 0;
+    }
+    // 区间截断到文件末尾；offset 恰为文件大小时是已经传完的续传，回复空区间
+    uint64_t available = file_size - req.offset;
+    response.length =
+        req.length == 0 ? available : std::min(req.length, available);
+    appendResponse(out, response);
+    if (response.length > 0) {
+        // 顺序预读加大窗口，发送时页缓存大多已就绪
+        ::posix_fadvise(fd, static_cast<off_t>(req.offset),
+                        static_cast<off_t>(response.length),
+                        POSIX_FADV_SEQUENTIAL);
+    }
+    // 接管 fd：区间为空时立即关闭，否则发送完成后关闭
+    out.appendFile(fd, req.offset, static_cast<size_t>(response.length));
+    return response.length;
+}
+
+bool receiveToFile(TcpProtocol& proto, int sock_fd, int file_fd,
+                   uint64_t offset, uint64_t length) {
+    // 固定大小的块缓冲区：内存占用与文件大小无关
+    static constexpr size_t kChunkSize = 1024 * 1024;
+    std::vector<uint8_t> chunk(static_cast<size_t>(
+        std::min<uint64_t>(length, kChunkSize)));
+
+    auto writeAll = [&](const uint8_t* data, size_t size) {
+        while (size > 0) {
+            ssize_t n = ::pwrite(file_fd, data, size, static_cast<off_t>(offset));
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            data += n;
+            size -= static_cast<size_t>(n);
+            offset += static_cast<uint64_t>(n);
+        }
+        return true;
+    };
+
+    while (length > 0) {
+        size_t want = static_cast<size_t>(std::min<uint64_t>(length, kChunkSize));
+        // 与响应帧一起读进接收缓冲区的文件内容先取走
+        size_t n = proto.takeBuffered(chunk.data(), want);
+        if (n == 0) {
+            ssize_t received = ::recv(sock_fd, chunk.data(), want, 0);
+            if (received < 0 && errno == EINTR) continue;
+            if (received <= 0) {
+                if (received == 0) errno = ECONNRESET;
+                return false;
+            }
+            n = static_cast<size_t>(received);
+        }
+        if (!writeAll(chunk.data(), n)) return false;
+        length -= n;
+    }
+    return true;
+}
+
+}  // namespace bulk
@@ -0,0 +1,247 @@
+#include "net/Checksum.hpp"
+
+#include <bit>
+#include <cstddef>
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define MCS_CHECKSUM_X86 1
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#if defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#endif
+#endif
+
+namespace checksum {
+
+namespace {
+
+// 短于此长度时直接走标量循环，省掉间接调用和向量收尾的开销
+constexpr size_t kSimdThreshold = 32;
+
+// ---------------------------------------------------------------- sum16
+// 各内核返回完整字节和（按 2^64 回绕），调用方只取低 16 位，
+// 因此向量化时的分组、分段相加不会改变结果
+
+uint64_t sumScalar(const uint8_t* p, size_t n) {
+    uint64_t sum = 0;
+    for (size_t i = 0; i < n; ++i) {
+        sum += p[i];
+    }
+    return sum;
+}
+
+#if defined(MCS_CHECKSUM_X86)
+// psadbw 对 0 求绝对差之和，即每 8 字节横向相加成一个 64 位和，不会溢出
+uint64_t sumSse2(const uint8_t* p, size_t n) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i acc0 = zero, acc1 = zero;
+    size_t i = 0;
+    for (; i + 64 <= n; i += 64) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i + 16));
+        __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i + 32));
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i + 48));
+        acc0 = _mm_add_epi64(acc0, _mm_sad_epu8(a, zero));
+        acc1 = _mm_add_epi64(acc1, _mm_sad_epu8(b, zero));
+        acc0 = _mm_add_epi64(acc0, _mm_sad_epu8(c, zero));
+        acc1 = _mm_add_epi64(acc1, _mm_sad_epu8(d, zero));
+    }
+    for (; i + 16 <= n; i += 16) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        acc0 = _mm_add_epi64(acc0, _mm_sad_epu8(a, zero));
+    }
+    __m128i acc = _mm_add_epi64(acc0, acc1);
+    uint64_t sum = static_cast<uint64_t>(_mm_cvtsi128_si64(acc)) +
+                   static_cast<uint64_t>(
+                       _mm_cvtsi128_si64(_mm_unpackhi_epi64(acc, acc)));
+    return sum + sumScalar(p + i, n - i);
+}
+
+__attribute__((target("avx2"))) uint64_t sumAvx2(const uint8_t* p, size_t n) {
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i acc0 = zero, acc1 = zero;
+    size_t i = 0;
+    for (; i + 128 <= n; i += 128) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+        __m256i b =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i + 32));
+        __m256i c =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i + 64));
+        __m256i d =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i + 96));
+        acc0 = _mm256_add_epi64(acc0, _mm256_sad_epu8(a, zero));
+        acc1 = _mm256_add_epi64(acc1, _mm256_sad_epu8(b, zero));
+        acc0 = _mm256_add_epi64(acc0, _mm256_sad_epu8(c, zero));
+        acc1 = _mm256_add_epi64(acc1, _mm256_sad_epu8(d, zero));
+    }
+    for (; i + 32 <= n; i += 32) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+        acc0 = _mm256_add_epi64(acc0, _mm256_sad_epu8(a, zero));
+    }
+    __m256i acc = _mm256_add_epi64(acc0, acc1);
+    __m128i half = _mm_add_epi64(_mm256_castsi256_si128(acc),
+                                 _mm256_extracti128_si256(acc, 1));
+    uint64_t sum = static_cast<uint64_t>(_mm_cvtsi128_si64(half)) +
+                   static_cast<uint64_t>(
+                       _mm_cvtsi128_si64(_mm_unpackhi_epi64(half, half)));
+    // 剩余不足 32 字节交给 SSE2/标量
+    return sum + sumSse2(p + i, n - i);
+}
+#elif defined(__aarch64__)
+// 16 位累加器每轮每道最多加 2*255，累加 128 轮后再展宽到 32 位，不会溢出
+uint64_t sumNeon(const uint8_t* p, size_t n) {
+    constexpr size_t kBlocksPerFold = 128;
+    uint32x4_t acc = vdupq_n_u32(0);
+    size_t i = 0;
+    while (n - i >= 16) {
+        size_t blocks = (n - i) / 16;
+        if (blocks > kBlocksPerFold) blocks = kBlocksPerFold;
+        uint16x8_t acc16 = vdupq_n_u16(0);
+        for (size_t b = 0; b < blocks; ++b, i += 16) {
+            acc16 = vpadalq_u8(acc16, vld1q_u8(p + i));
+        }
+        acc = vpadalq_u16(acc, acc16);
+    }
+    // 32 位道回绕不影响低 16 位
+    return vaddvq_u32(acc) + sumScalar(p + i, n - i);
+}
+#endif
+
+const Sum16Impl& sumKernel() {
+    static const Sum16Impl kernel = sum16Impls().front();
+    return kernel;
+}
+
+// ---------------------------------------------------------------- crc32c
+// 内核处理的是取反后的内部状态，初值/终值取反由 crc32c() 统一完成
+
+constexpr uint32_t kCrc32cPoly = 0x82F63B78;  // 0x1EDC6F41 的位反转
+
+struct CrcTables {
+    uint32_t t[8][256];
+};
+
+constexpr CrcTables makeCrcTables() {
+    CrcTables tables{};
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc >> 1) ^ ((crc & 1) ? kCrc32cPoly : 0);
+        }
+        tables.t[0][i] = crc;
+    }
+    for (int k = 1; k < 8; ++k) {
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t prev = tables.t[k - 1][i];
+            tables.t[k][i] = (prev >> 8) ^ tables.t[0][prev & 0xFF];
+        }
+    }
+    return tables;
+}
+
+constexpr CrcTables kCrcTables = makeCrcTables();
+
+// slicing-by-8：每次查 8 张表处理 8 字节
+uint32_t crcSoftware(uint32_t crc, const uint8_t* p, size_t n) {
+    const auto& t = kCrcTables.t;
+    if constexpr (std::endian::native == std::endian::little) {
+        for (; n >= 8; p += 8, n -= 8) {
+            uint32_t lo, hi;
+            std::memcpy(&lo, p, 4);
+            std::memcpy(&hi, p + 4, 4);
+            lo ^= crc;
+            crc = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^
+                  t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24] ^ t[3][hi & 0xFF] ^
+                  t[2][(hi >> 8) & 0xFF] ^ t[1][(hi >> 16) & 0xFF] ^
+                  t[0][hi >> 24];
+        }
+    }
+    for (; n > 0; ++p, --n) {
+        crc = (crc >> 8) ^ t[0][(crc ^ *p) & 0xFF];
+    }
+    return crc;
+}
+
+#if defined(MCS_CHECKSUM_X86)
+__attribute__((target("sse4.2"))) uint32_t crcSse42(uint32_t crc,
+                                                    const uint8_t* p,
+                                                    size_t n) {
+    uint64_t crc64 = crc;
+    for (; n >= 8; p += 8, n -= 8) {
+        uint64_t word;
+        std::memcpy(&word, p, 8);
+        crc64 = _mm_crc32_u64(crc64, word);
+    }
+    crc = static_cast<uint32_t>(crc64);
+    for (; n > 0; ++p, --n) {
+        crc = _mm_crc32_u8(crc, *p);
+    }
+    return crc;
+}
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+uint32_t crcArm(uint32_t crc, const uint8_t* p, size_t n) {
+    for (; n >= 8; p += 8, n -= 8) {
+        uint64_t word;
+        std::memcpy(&word, p, 8);
+        crc = __crc32cd(crc, word);
+    }
+    for (; n > 0; ++p, --n) {
+        crc = __crc32cb(crc, *p);
+    }
+    return crc;
+}
+#endif
+
+const Crc32cImpl& crcKernel() {
+    static const Crc32cImpl kernel = crc32cImpls().front();
+    return kernel;
+}
+
+}  // namespace
+
+uint16_t sum16(std::span<const uint8_t> data) {
+    if (data.size() < kSimdThreshold) {
+        return static_cast<uint16_t>(sumScalar(data.data(), data.size()));
+    }
+    return static_cast<uint16_t>(sumKernel().fn(data.data(), data.size()));
+}
+
+uint32_t crc32c(std::span<const uint8_t> data, uint32_t crc) {
+    return ~crcKernel().fn(~crc, data.data(), data.size());
+}
+
+const char* sum16Kernel() { return sumKernel().name; }
+
+const char* crc32cKernel() { return crcKernel().name; }
+
+std::vector<Sum16Impl> sum16Impls() {
+    std::vector<Sum16Impl> impls;
+#if defined(MCS_CHECKSUM_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) impls.push_back({sumAvx2, "avx2"});
+    impls.push_back({sumSse2, "sse2"});
+#elif defined(__aarch64__)
+    impls.push_back({sumNeon, "neon"});
+#endif
+    impls.push_back({sumScalar, "scalar"});
+    return impls;
+}
+
+std::vector<Crc32cImpl> crc32cImpls() {
+    std::vector<Crc32cImpl> impls;
+#if defined(MCS_CHECKSUM_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse4.2")) {
+        impls.push_back({crcSse42, "sse4.2"});
+    }
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+    impls.push_back({crcArm, "armv8-crc"});
+#endif
+    impls.push_back({crcSoftware, "slice8"});
+    return impls;
+}
+
+}  // namespace checksum
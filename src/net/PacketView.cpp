@@ -0,0 +1,76 @@
+#include "net/PacketView.hpp"
+
+#include <arpa/inet.h>
+
+#include <cstring>
+#include <stdexcept>
+
+Packet PacketView::toPacket() const {
+    Packet pkt;
+    pkt.header = header;
+    pkt.length = length;
+    pkt.payload.assign(payloadString());
+    pkt.checksum = checksum;
+    return pkt;
+}
+
+uint32_t PacketView::peekPayloadLength(const uint8_t* data) {
+    uint32_t network_length;
+    memcpy(&network_length, data + 2, 4);
+    return ntohl(network_length);
+}
+
+uint16_t PacketView::peekHeader(const uint8_t* data) {
+    uint16_t network_header;
+    memcpy(&network_header, data, 2);
+    return ntohs(network_header);
+}
+
+bool PacketView::isKnownHeader(uint16_t header) {
+    return header == Packet::kSum16Header || header == Packet::kCrc32cHeader ||
+           header == Packet::kControlHeader ||
+           header == Packet::kBulkRequestHeader ||
+           header == Packet::kBulkResponseHeader;
+}
+
+size_t PacketView::peekFrameSize(const uint8_t* data) {
+    return kHeaderSize + size_t(peekPayloadLength(data)) +
+           Packet::trailerSize(peekHeader(data));
+}
+
+bool PacketView::parse(std::span<const uint8_t> data, PacketView& view) {
+    if (data.size() < kHeaderSize) return false;
+
+    uint32_t payload_length = peekPayloadLength(data.data());
+    size_t total_needed = peekFrameSize(data.data());
+    if (data.size() < total_needed) return false;
+
+    uint16_t header = peekHeader(data.data());
+    if (!isKnownHeader(header)) {
+        throw std::runtime_error("Invalid packet header");
+    }
+
+    std::span<const uint8_t> payload = data.subspan(kHeaderSize, payload_length);
+
+    const uint8_t* trailer = data.data() + kHeaderSize + payload_length;
+    uint32_t checksum;
+    if (header == Packet::kCrc32cHeader) {
+        uint32_t network_checksum;
+        memcpy(&network_checksum, trailer, 4);
+        checksum = ntohl(network_checksum);
+    } else {
+        uint16_t network_checksum;
+        memcpy(&network_checksum, trailer, 2);
+        checksum = ntohs(network_checksum);
+    }
+    // 直接在缓冲区上计算校验和，不再构造临时 vector
+    if (Packet::computeChecksum(header, payload) != checksum) {
+        throw std::runtime_error("Checksum verification failed");
+    }
+
+    view.header = header;
+    view.length = payload_length;
+    view.checksum = checksum;
+    view.payload = payload;
+    return true;
+}
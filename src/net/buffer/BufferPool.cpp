@@ -0,0 +1,171 @@
+#include "net/buffer/BufferPool.hpp"
+
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <bit>
+#include <new>
+
+namespace {
+
+// arena 每次向操作系统申请的粒度，与 x86-64 大页大小一致
+constexpr size_t kArenaChunkSize = 2 * 1024 * 1024;
+// 小尺寸级别一次切出的 slab 大小；更大的级别一次只切一块
+constexpr size_t kSlabSize = 64 * 1024;
+// 每个线程每个级别缓存的字节预算
+constexpr size_t kThreadCacheBytes = 1024 * 1024;
+constexpr size_t kMaxCachedBlocks = 128;
+
+uint8_t* mapRegion(size_t bytes, bool huge_pages) {
+    constexpr int kFlags = MAP_PRIVATE | MAP_ANONYMOUS;
+    if (huge_pages) {
+        // 需要预留 hugetlbfs 页（vm.nr_hugepages），没有时退回透明大页
+        void* p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                       kFlags | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED) return static_cast<uint8_t*>(p);
+
+        // 多申请一个大页的长度，裁掉首尾得到 2MB 对齐的区域，透明大页才能生效
+        size_t padded = bytes + kArenaChunkSize;
+        p = mmap(nullptr, padded, PROT_READ | PROT_WRITE, kFlags, -1, 0);
+        if (p == MAP_FAILED) throw std::bad_alloc();
+        auto base = reinterpret_cast<uintptr_t>(p);
+        uintptr_t aligned = (base + kArenaChunkSize - 1) & ~(kArenaChunkSize - 1);
+        if (aligned > base) munmap(p, aligned - base);
+        size_t tail = base + padded - (aligned + bytes);
+        if (tail > 0) munmap(reinterpret_cast<void*>(aligned + bytes), tail);
+        madvise(reinterpret_cast<void*>(aligned), bytes, MADV_HUGEPAGE);
+        return reinterpret_cast<uint8_t*>(aligned);
+    }
+    void* p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, kFlags, -1, 0);
+    if (p == MAP_FAILED) throw std::bad_alloc();
+    return static_cast<uint8_t*>(p);
+}
+
+}  // namespace
+
+// 每个线程一份；线程退出时把缓存的块全部还给全局仓库
+struct BufferPoolThreadCache {
+    BufferPool::FreeList lists[BufferPool::kNumClasses];
+
+    ~BufferPoolThreadCache() {
+        BufferPool& pool = BufferPool::getInstance();
+        for (size_t i = 0; i < BufferPool::kNumClasses; ++i) {
+            if (lists[i].count > 0) pool.release(i, lists[i], lists[i].count);
+        }
+    }
+};
+
+static thread_local BufferPoolThreadCache tls_buffer_cache;
+
+BufferPool& BufferPool::getInstance() {
+    // 故意不析构：其他线程的线程本地缓存可能在静态析构之后才退出
+    static BufferPool* instance = new BufferPool();
+    return *instance;
+}
+
+size_t BufferPool::classIndex(size_t size) {
+    if (size <= classSize(0)) return 0;
+    return std::bit_width(size - 1) - kMinClassShift;
+}
+
+size_t BufferPool::cacheLimit(size_t index) {
+    return std::clamp<size_t>(kThreadCacheBytes / classSize(index), 1,
+                              kMaxCachedBlocks);
+}
+
+uint8_t* BufferPool::allocate(size_t size, size_t& capacity) {
+    StatShard& stats = stats_.local();
+    if (size > kMaxPooledSize) {
+        bumpLocal<uint64_t>(stats.misses, 1);
+        capacity = size;
+        return static_cast<uint8_t*>(::operator new(size));
+    }
+    size_t index = classIndex(size);
+    capacity = classSize(index);
+    FreeList& list = tls_buffer_cache.lists[index];
+    if (list.count > 0) {
+        bumpLocal<uint64_t>(stats.hits, 1);
+    } else {
+        // 一次取回半个本地上限，摊薄全局锁
+        bool carved =
+            refill(index, list, std::max<size_t>(cacheLimit(index) / 2, 1));
+        bumpLocal<uint64_t>(carved ? stats.misses : stats.refills, 1);
+    }
+    return reinterpret_cast<uint8_t*>(list.pop());
+}
+
+void BufferPool::deallocate(uint8_t* data, size_t capacity) {
+    if (capacity > kMaxPooledSize) {
+        ::operator delete(data);
+        return;
+    }
+    size_t index = classIndex(capacity);
+    FreeList& list = tls_buffer_cache.lists[index];
+    list.push(reinterpret_cast<FreeBlock*>(data));
+    if (list.count > cacheLimit(index)) {
+        release(index, list, list.count / 2);
+    }
+}
+
+bool BufferPool::refill(size_t index, FreeList& out, size_t n) {
+    {
+        Depot& depot = depots_[index];
+        std::lock_guard<std::mutex> lock(depot.mutex);
+        while (n > 0 && depot.list.count > 0) {
+            out.push(depot.list.pop());
+            --n;
+        }
+    }
+    if (out.count > 0) return false;
+    carveSlab(index, out);
+    return true;
+}
+
+void BufferPool::release(size_t index, FreeList& list, size_t n) {
+    Depot& depot = depots_[index];
+    std::lock_guard<std::mutex> lock(depot.mutex);
+    while (n > 0 && list.count > 0) {
+        depot.list.push(list.pop());
+        --n;
+    }
+}
+
+void BufferPool::carveSlab(size_t index, FreeList& out) {
+    size_t block = classSize(index);
+    size_t slab = std::max(block, kSlabSize);
+    uint8_t* base = reserve(slab);
+    for (size_t offset = slab; offset >= block; offset -= block) {
+        out.push(reinterpret_cast<FreeBlock*>(base + offset - block));
+    }
+    // 小尺寸级别一次切出的块可能超过本地上限，多余的放进全局仓库
+    size_t limit = cacheLimit(index);
+    if (out.count > limit) {
+        release(index, out, out.count - limit);
+    }
+}
+
+uint8_t* BufferPool::reserve(size_t bytes) {
+    std::lock_guard<std::mutex> lock(arena_mutex_);
+    if (static_cast<size_t>(arena_end_ - arena_pos_) < bytes) {
+        // 旧区域剩余的尾巴不足一个 slab，直接放弃
+        size_t region = (std::max(bytes, kArenaChunkSize) + kArenaChunkSize - 1) &
+                        ~(kArenaChunkSize - 1);
+        arena_pos_ = mapRegion(region, huge_pages_);
+        arena_end_ = arena_pos_ + region;
+        reserved_bytes_.fetch_add(region, std::memory_order_relaxed);
+    }
+    uint8_t* p = arena_pos_;
+    arena_pos_ += bytes;
+    return p;
+}
+
+BufferPool::Stats BufferPool::stats() const {
+    Stats total;
+    stats_.forEach([&](const StatShard& shard) {
+        total.hits += shard.hits.load(std::memory_order_relaxed);
+        total.refills += shard.refills.load(std::memory_order_relaxed);
+        total.misses += shard.misses.load(std::memory_order_relaxed);
+    });
+    total.reserved_bytes = reserved_bytes_.load(std::memory_order_relaxed);
+    return total;
+}
@@ -0,0 +1,48 @@
+#include "net/buffer/RecvBuffer.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+RecvBuffer::RecvBuffer(size_t initial_capacity)
+    // 池中的块不做零初始化，避免 vector::resize 的 memset 开销
+    : data_(initial_capacity),
+      capacity_(data_.capacity()),
+      initial_capacity_(initial_capacity) {}
+
+void RecvBuffer::consume(size_t n) {
+    read_pos_ += std::min(n, readableBytes());
+    if (read_pos_ == write_pos_) {
+        // 全部读完，直接复位，下次写入无需搬移
+        read_pos_ = write_pos_ = 0;
+    }
+}
+
+uint8_t* RecvBuffer::prepareWrite(size_t n) {
+    if (writableBytes() >= n) {
+        return data_.data() + write_pos_;
+    }
+
+    size_t readable = readableBytes();
+    if (read_pos_ + writableBytes() >= n) {
+        // 头部已消费空间足够：把剩余未读数据搬到头部
+        std::memmove(data_.data(), data_.data() + read_pos_, readable);
+    } else {
+        // 扩容：至少翻倍，保证摊还 O(1)
+        PoolBuffer bigger(std::max(capacity_ * 2, readable + n));
+        std::memcpy(bigger.data(), data_.data() + read_pos_, readable);
+        data_ = std::move(bigger);
+        capacity_ = data_.capacity();
+    }
+    read_pos_ = 0;
+    write_pos_ = readable;
+    return data_.data() + write_pos_;
+}
+
+void RecvBuffer::shrinkIfIdle(size_t max_idle_capacity) {
+    if (!empty() || capacity_ <= max_idle_capacity) return;
+    // 先归还大块再申请，刚归还的块留在本线程缓存，下一个大帧可以直接复用
+    data_.reset();
+    data_ = PoolBuffer(std::max(initial_capacity_, max_idle_capacity));
+    capacity_ = data_.capacity();
+    read_pos_ = write_pos_ = 0;
+}
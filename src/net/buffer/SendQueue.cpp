@@ -0,0 +1,289 @@
+#include "net/buffer/SendQueue.hpp"
+
+#include <arpa/inet.h>
+#include <sys/sendfile.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include "net/Checksum.hpp"
+#include "net/Packet.hpp"
+
+SendQueue::FileHandle& SendQueue::FileHandle::operator=(
+    FileHandle&& other) noexcept {
+    if (this != &other) {
+        reset();
+        fd_ = other.release();
+    }
+    return *this;
+}
+
+void SendQueue::FileHandle::reset() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+const uint8_t* SendQueue::Segment::data() const {
+    switch (kind) {
+        case Kind::Inline:
+            return inline_data;
+        case Kind::Owned:
+            return reinterpret_cast<const uint8_t*>(owned.data());
+        case Kind::Borrowed:
+        case Kind::Pooled:
+        case Kind::File:
+        default:
+            return borrowed;
+    }
+}
+
+size_t SendQueue::Segment::size() const {
+    switch (kind) {
+        case Kind::Inline:
+            return inline_size;
+        case Kind::Owned:
+            return owned.size();
+        case Kind::Borrowed:
+        case Kind::Pooled:
+        case Kind::File:
+        default:
+            return borrowed_size;
+    }
+}
+
+// 按当前帧的校验方式把一段 payload 累加进校验值：
+// 字节和可分段相加，CRC32C 以上一段结果为初值续算，都不需要整帧连续
+void SendQueue::accumulateChecksum(const uint8_t* data, size_t size) {
+    std::span<const uint8_t> bytes(data, size);
+    if (frame_crc32c_) {
+        frame_checksum_ = checksum::crc32c(bytes, frame_checksum_);
+    } else {
+        frame_checksum_ += checksum::sum16(bytes);
+    }
+}
+
+SendQueue::Segment& SendQueue::pushSegment() {
+    if (count_ == ring_.size()) {
+        growRing();
+    }
+    size_t index = (head_ + count_) & (ring_.size() - 1);
+    ++count_;
+    return *ring_[index];
+}
+
+void SendQueue::popSegment() {
+    // 复位为空片段：Owned 释放字符串，Pooled 把块还给池，File 关闭文件
+    *ring_[head_] = Segment();
+    head_ = (head_ + 1) & (ring_.size() - 1);
+    --count_;
+}
+
+void SendQueue::growRing() {
+    size_t old_size = ring_.size();
+    size_t new_size = old_size == 0 ? kInitialSegments : old_size * 2;
+    // 只搬移指针：片段本身（含内联数据）地址不变，异步发送引用的 iovec 仍然有效
+    std::vector<std::unique_ptr<Segment>> bigger(new_size);
+    for (size_t i = 0; i < old_size; ++i) {
+        bigger[i] = std::move(ring_[(head_ + i) & (old_size - 1)]);
+    }
+    for (size_t i = old_size; i < new_size; ++i) {
+        bigger[i] = std::make_unique<Segment>();
+    }
+    if (frame_header_ != kNoFrame) {
+        frame_header_ = (frame_header_ - head_) & (old_size - 1);
+    }
+    ring_ = std::move(bigger);
+    head_ = 0;
+}
+
+void SendQueue::appendInline(const void* data, size_t size) {
+    Segment& seg = pushSegment();
+    seg.kind = Segment::Kind::Inline;
+    seg.inline_size = static_cast<uint8_t>(size);
+    memcpy(seg.inline_data, data, size);
+    pending_bytes_ += size;
+}
+
+void SendQueue::beginFrame(uint16_t header) {
+    if (frame_header_ != kNoFrame) {
+        throw std::logic_error("SendQueue: nested beginFrame");
+    }
+    // header(2) + length(4)，length 在 endFrame 时回填
+    uint8_t bytes[6];
+    uint16_t network_header = htons(header);
+    memcpy(bytes, &network_header, 2);
+    memset(bytes + 2, 0, 4);
+    appendInline(bytes, sizeof(bytes));
+    frame_header_ = (head_ + count_ - 1) & (ring_.size() - 1);
+    frame_length_ = 0;
+    frame_checksum_ = 0;
+    frame_crc32c_ = header == Packet::kCrc32cHeader;
+}
+
+void SendQueue::appendSegmentData(const uint8_t* data, size_t size) {
+    pending_bytes_ += size;
+    if (frame_header_ != kNoFrame) {
+        frame_length_ += size;
+        accumulateChecksum(data, size);
+    }
+}
+
+void SendQueue::appendBorrowed(const void* data, size_t size) {
+    if (size == 0) return;
+    Segment& seg = pushSegment();
+    seg.kind = Segment::Kind::Borrowed;
+    seg.borrowed = static_cast<const uint8_t*>(data);
+    seg.borrowed_size = size;
+    appendSegmentData(seg.borrowed, size);
+}
+
+void SendQueue::appendOwned(std::string data) {
+    if (data.empty()) return;
+    Segment& seg = pushSegment();
+    seg.kind = Segment::Kind::Owned;
+    seg.owned = std::move(data);
+    appendSegmentData(seg.data(), seg.owned.size());
+}
+
+void SendQueue::appendCopy(const void* data, size_t size) {
+    if (size == 0) return;
+    Segment& seg = pushSegment();
+    seg.kind = Segment::Kind::Pooled;
+    seg.pooled = PoolBuffer(size);
+    memcpy(seg.pooled.data(), data, size);
+    seg.borrowed = seg.pooled.data();
+    seg.borrowed_size = size;
+    appendSegmentData(seg.borrowed, size);
+}
+
+void SendQueue::endFrame() { endFrame(frame_checksum_); }
+
+void SendQueue::endFrame(uint32_t checksum) {
+    if (frame_header_ == kNoFrame) {
+        throw std::logic_error("SendQueue: endFrame without beginFrame");
+    }
+    uint32_t network_length = htonl(frame_length_);
+    memcpy(ring_[frame_header_]->inline_data + 2, &network_length, 4);
+    frame_header_ = kNoFrame;
+
+    if (frame_crc32c_) {
+        uint32_t network_checksum = htonl(checksum);
+        appendInline(&network_checksum, 4);
+    } else {
+        uint16_t network_checksum = htons(static_cast<uint16_t>(checksum));
+        appendInline(&network_checksum, 2);
+    }
+}
+
+void SendQueue::appendRaw(const void* data, size_t size) {
+    appendCopy(data, size);
+}
+
+void SendQueue::appendFile(int fd, uint64_t offset, size_t length) {
+    FileHandle file(fd);
+    if (frame_header_ != kNoFrame) {
+        throw std::logic_error("SendQueue: appendFile inside a frame");
+    }
+    if (length == 0) return;
+    Segment& seg = pushSegment();
+    seg.kind = Segment::Kind::File;
+    seg.file = std::move(file);
+    seg.file_offset = offset;
+    seg.borrowed_size = length;
+    pending_bytes_ += length;
+}
+
+bool SendQueue::frontFile(int& fd, uint64_t& offset, size_t& remaining) const {
+    if (count_ == 0) return false;
+    const Segment& seg = *ring_[head_];
+    if (seg.kind != Segment::Kind::File) return false;
+    fd = seg.file.get();
+    offset = seg.file_offset + head_offset_;
+    remaining = seg.borrowed_size - head_offset_;
+    return true;
+}
+
+size_t SendQueue::prepareIov(iovec* iov, size_t max,
+                             bool* file_follows) const {
+    if (file_follows) *file_follows = false;
+    size_t iov_count = 0;
+    size_t offset = head_offset_;
+    for (size_t i = 0; i < count_ && iov_count < max; ++i) {
+        size_t index = (head_ + i) & (ring_.size() - 1);
+        // 正在构建中的帧还没有回填长度，不能发出
+        if (index == frame_header_) break;
+        const Segment& seg = *ring_[index];
+        // 文件内容不经用户态，iovec 无法描述，由 sendfile / splice 单独发送
+        if (seg.kind == Segment::Kind::File) {
+            if (file_follows) *file_follows = true;
+            break;
+        }
+        iov[iov_count].iov_base = const_cast<uint8_t*>(seg.data()) + offset;
+        iov[iov_count].iov_len = seg.size() - offset;
+        ++iov_count;
+        offset = 0;
+    }
+    return iov_count;
+}
+
+ssize_t SendQueue::sendFileTo(int fd) {
+    int file_fd;
+    uint64_t offset;
+    size_t remaining;
+    if (!frontFile(file_fd, offset, remaining)) return 0;
+    off_t file_pos = static_cast<off_t>(offset);
+    ssize_t n = ::sendfile(fd, file_fd, &file_pos,
+                           std::min(remaining, kMaxSendfileChunk));
+    if (n > 0) {
+        advance(static_cast<size_t>(n));
+    } else if (n == 0) {
+        // 文件在发送过程中被截短，已承诺的长度无法兑现
+        errno = EIO;
+        return -1;
+    }
+    return n;
+}
+
+ssize_t SendQueue::writeTo(int fd) {
+    if (count_ > 0 && ring_[head_]->kind == Segment::Kind::File) {
+        return sendFileTo(fd);
+    }
+    iovec iov[kMaxIov];
+    bool file_follows = false;
+    size_t iov_count = prepareIov(iov, kMaxIov, &file_follows);
+    if (iov_count == 0) return 0;
+
+    msghdr msg{};
+    msg.msg_iov = iov;
+    msg.msg_iovlen = iov_count;
+    // sendmsg 支持 MSG_NOSIGNAL，writev 不支持（对端关闭时会触发 SIGPIPE）
+    ssize_t n =
+        ::sendmsg(fd, &msg, MSG_NOSIGNAL | (file_follows ? MSG_MORE : 0));
+    if (n > 0) {
+        advance(static_cast<size_t>(n));
+    }
+    return n;
+}
+
+void SendQueue::advance(size_t n) {
+    pending_bytes_ -= n;
+    while (n > 0) {
+        Segment& front = *ring_[head_];
+        size_t remaining = front.size() - head_offset_;
+        if (n < remaining) {
+            // 部分写：只推进偏移
+            head_offset_ += n;
+            return;
+        }
+        n -= remaining;
+        head_offset_ = 0;
+        popSegment();
+    }
+}
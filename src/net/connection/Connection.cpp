@@ -1,34 +1,58 @@
 #include "net/connection/Connection.hpp"
 
 #include <sys/epoll.h>  // 包含epoll API
+#include <unistd.h>
 
+#include <algorithm>
 #include <chrono>
 #include <cstring>
+#include <stdexcept>
+#include <string_view>
 
+#include "net/BulkTransfer.hpp"
+#include "net/RequestHandler.hpp"
 #include "utils/Logger.hpp"
 #include "utils/Metrics.hpp"
+#include "utils/TimerWheel.hpp"
 
 Connection::Connection(int fd, int epfd)
-    : fd_(fd), epoll_fd_(epfd), proto_(fd) {
+    : fd_(fd),
+      epoll_fd_(epfd),
+      proto_(fd),
+      epoll_events_(EPOLLIN | EPOLLET),
+      last_request_ms_(TimerWheel::nowMs()),
+      last_receive_ms_(last_request_ms_.load(std::memory_order_relaxed)) {
     Metrics::getInstance().incrementConnections();
     LOG_INFO("New connection created: fd=%d", fd);
 }
 
-Connection::~Connection() {
-    if (fd_ >= 0) {
-        Metrics::getInstance().decrementConnections();
-        close(fd_);
-        LOG_INFO("Connection closed: fd=%d", fd_);
-    }
+Connection::~Connection() { close(); }
+
+void Connection::close() {
+    if (closed_ || fd_ < 0) return;
+    closed_ = true;
+    Metrics::getInstance().decrementConnections();
+    ::close(fd_);
+    LOG_INFO("Connection closed: fd=%d", fd_);
 }
 
 void Connection::modifyEpollEvents(bool want_write) {
-    epoll_event ev{};
-    ev.data.fd = fd_;
-    ev.events = EPOLLIN | EPOLLET;
+    uint32_t events = EPOLLET;
     if (want_write) {
-        ev.events |= EPOLLOUT;
+        events |= EPOLLOUT;
     }
+    if (!readingPaused()) {
+        events |= EPOLLIN;
+    }
+    // 无 epoll（io_uring 后端）或状态未变化时不做系统调用
+    if (epoll_fd_ < 0 || events == epoll_events_) {
+        return;
+    }
+    // 重新加入 EPOLLIN 时内核会重新检查就绪状态，暂停期间到达的数据不会漏掉通知
+    epoll_events_ = events;
+    epoll_event ev{};
+    ev.data.fd = fd_;
+    ev.events = events;
     if (epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd_, &ev) < 0) {
         // 如果 fd 已经被关闭或不在 epoll 中，就不处理
         if (errno == EBADF || errno == ENOENT) {
@@ -38,46 +62,97 @@ void Connection::modifyEpollEvents(bool want_write) {
     }
 }
 
+bool Connection::addPendingEvents(uint32_t events) {
+    uint32_t prev = pending_events_.fetch_or(events | kScheduled,
+                                             std::memory_order_acq_rel);
+    return (prev & kScheduled) == 0;
+}
+
+uint32_t Connection::takePendingEvents() {
+    return pending_events_.exchange(kScheduled, std::memory_order_acq_rel) &
+           ~kScheduled;
+}
+
+bool Connection::finishScheduled() {
+    // 处理期间没有新事件并入时才能清除调度标记，否则继续处理
+    uint32_t expected = kScheduled;
+    return pending_events_.compare_exchange_strong(expected, 0,
+                                                   std::memory_order_acq_rel);
+}
+
 bool Connection::handleRead() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    auto start = std::chrono::high_resolution_clock::now();
+    return processRequests(true);
+}
+
+bool Connection::handleData(std::span<const uint8_t> data) {
+    proto_.appendReceived(data);
+    return processRequests(false);
+}
+
+bool Connection::processRequests(bool read_socket) {
+    auto &metrics = Metrics::getInstance();
+    int64_t now = TimerWheel::nowMs();
+    bool handled_request = false;
+    bool completed_frame = false;
 
     try {
-        bool keep_reading = true;
-        while (keep_reading) {
-            Packet request;
-            auto status = proto_.tryReceivePacket(request);
-            if (status == Protocol::ReadStatus::OK) {
-                // 处理数据...
-                Metrics::getInstance().incrementBytesReceived(request.length +
-                                                              8);
-                Metrics::getInstance().incrementRequests();
-
-                // 生成响应（示例：简单回显）
-                Packet response;
-                response.header = 0xABCD;
-                response.payload = "Server received: " + request.payload;
-                response.length = response.payload.length();
-                response.checksum = calculate_checksum(std::vector<uint8_t>(
-                    response.payload.begin(), response.payload.end()));
-
-                // 将响应加入协议层发送队列（非立即发送）
-                proto_.enqueuePacket(response);
-                if (proto_.hasPendingSendData()) {
-                    modifyEpollEvents(true);
+        // 读取暂停时不再从 socket 读，已缓冲的数据留到恢复后处理
+        while (!readingPaused()) {
+            auto start = std::chrono::steady_clock::now();
+            // 请求以视图形式直接引用接收缓冲区，下一次 tryReceiveView 前有效
+            PacketView request;
+            auto status = read_socket ? proto_.tryReceiveView(request)
+                                      : proto_.tryParseView(request);
+            if (status == BaseProtocol::ReadStatus::OK) {
+                completed_frame = true;
+                if (request.header == Packet::kControlHeader) {
+                    handleControl(request);
+                } else if (request.header == Packet::kBulkResponseHeader) {
+                    throw std::runtime_error("Unexpected bulk response frame");
+                } else {
+                    handled_request = true;
+                    if (request.header == Packet::kBulkRequestHeader) {
+                        handleBulkRequest(request);
+                    } else {
+                        handleRequest(request);
+                    }
+                    // 记录单个请求从读取到响应入队的延迟
+                    auto end = std::chrono::steady_clock::now();
+                    metrics.recordLatency(
+                        Metrics::LatencyStage::Read,
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            end - start)
+                            .count());
                 }
-                // 记录处理延迟
-                auto end = std::chrono::high_resolution_clock::now();
-                auto duration =
-                    std::chrono::duration_cast<std::chrono::microseconds>(
-                        end - start);
-                Metrics::getInstance().recordLatency(duration.count());
-            } else if (status == Protocol::ReadStatus::NeedRetry) {
+                if (send_high_watermark_ > 0 &&
+                    proto_.pendingSendBytes() >= send_high_watermark_) {
+                    reading_paused_.store(true, std::memory_order_relaxed);
+                    metrics.incrementReadPauses();
+                }
+            } else if (status == BaseProtocol::ReadStatus::NeedRetry) {
                 break;  // 数据未就绪
             } else {
                 return false;  // 错误或连接关闭
             }
         }
+        // 时间戳只在每轮结束时写一次，不按请求更新
+        last_receive_ms_.store(now, std::memory_order_relaxed);
+        ping_sent_ms_.store(0, std::memory_order_relaxed);
+        if (handled_request) {
+            last_request_ms_.store(now, std::memory_order_relaxed);
+        }
+        // 半帧从新一帧开始接收时计时，收全即清除
+        if (proto_.bufferedBytes() == 0) {
+            partial_since_ms_.store(0, std::memory_order_relaxed);
+        } else if (completed_frame ||
+                   partial_since_ms_.load(std::memory_order_relaxed) == 0) {
+            partial_since_ms_.store(now, std::memory_order_relaxed);
+        }
+        updateWriteProgress(now, false);
+        // 本轮产生的所有响应只需注册一次 EPOLLOUT（暂停时同时去掉 EPOLLIN）
+        if (proto_.hasPendingSendData()) {
+            modifyEpollEvents(true);
+        }
         return true;
     } catch (const std::exception &e) {
         LOG_ERROR("Failed to handle read on fd=%d: %s", fd_, e.what());
@@ -86,14 +161,22 @@ bool Connection::handleRead() {
     }
 }
 
+void Connection::handleRequest(const PacketView &request) {
+    // 将响应加入协议层发送队列（非立即发送），由 handleWrite 刷出
+    RequestHandler::handleRequest(request, proto_.sendQueue());
+}
+
 bool Connection::handleWrite() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    auto start = std::chrono::high_resolution_clock::now();
+    auto start = std::chrono::steady_clock::now();
 
     try {
         int saved_errno = 0;
+        size_t pending = proto_.sendQueue().pendingBytes();
         bool success = proto_.flushSendBuffer(
             saved_errno);  // 修改 Protocol 方法以返回错误码
+        size_t sent = pending - proto_.sendQueue().pendingBytes();
+        Metrics::getInstance().incrementBytesSent(sent);
+        updateWriteProgress(TimerWheel::nowMs(), sent > 0);
         // 尝试刷新发送缓冲区
         if (!success) {
             // 非阻塞模式下 EAGAIN 是正常情况，无需记录错误
@@ -103,20 +186,134 @@ bool Connection::handleWrite() {
             }
             return false;
         }
+        bool resumed = maybeResumeReading();
         // 只有当 send_buffer_ 真正清空后，才去掉 EPOLLOUT
-        if (!proto_.hasPendingSendData()) {
-            modifyEpollEvents(false);  // 只剩 EPOLLIN | EPOLLET
+        if (resumed || !proto_.hasPendingSendData()) {
+            modifyEpollEvents(proto_.hasPendingSendData());
         }
 
-        auto end = std::chrono::high_resolution_clock::now();
-        auto duration =
-            std::chrono::duration_cast<std::chrono::microseconds>(end - start);
-        Metrics::getInstance().recordLatency(duration.count());
+        auto end = std::chrono::steady_clock::now();
+        Metrics::getInstance().recordLatency(
+            Metrics::LatencyStage::Write,
+            std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
+                .count());
 
-        return true;
+        // 暂停期间已缓冲的请求不会再有读事件触发，恢复后立即处理
+        return resumed ? processRequests(true) : true;
     } catch (const std::exception &e) {
         LOG_ERROR("Failed to handle write on fd=%d: %s", fd_, e.what());
         Metrics::getInstance().incrementErrors();
         return false;
     }
 }
+
+void Connection::handleControl(const PacketView &frame) {
+    RequestHandler::handleControl(frame, proto_.sendQueue());
+}
+
+void Connection::handleBulkRequest(const PacketView &request) {
+    auto &metrics = Metrics::getInstance();
+    metrics.incrementBytesReceived(request.frameSize());
+    metrics.incrementRequests();
+    uint64_t file_bytes = bulk::serve(request, bulk_root_, proto_.sendQueue());
+    if (file_bytes > 0) {
+        metrics.incrementBulkTransfers(file_bytes);
+    }
+}
+
+bool Connection::sendPing() {
+    static constexpr uint8_t kPingType = Packet::kPing;
+    auto &out = proto_.sendQueue();
+    out.beginFrame(Packet::kControlHeader);
+    out.appendBorrowed(&kPingType, 1);
+    out.endFrame();
+    if (epoll_fd_ < 0) {
+        return true;
+    }
+    if (!handleWrite()) {
+        return false;
+    }
+    if (proto_.hasPendingSendData()) {
+        modifyEpollEvents(true);
+    }
+    return true;
+}
+
+bool Connection::maybeResumeReading() {
+    if (!readingPaused() || proto_.pendingSendBytes() > send_low_watermark_) {
+        return false;
+    }
+    reading_paused_.store(false, std::memory_order_relaxed);
+    // 暂停期间的半帧不算对端读得慢，从恢复时重新计时
+    if (partial_since_ms_.load(std::memory_order_relaxed) != 0) {
+        partial_since_ms_.store(TimerWheel::nowMs(), std::memory_order_relaxed);
+    }
+    return true;
+}
+
+void Connection::onBytesSent(size_t bytes) {
+    updateWriteProgress(TimerWheel::nowMs(), bytes > 0);
+}
+
+void Connection::updateWriteProgress(int64_t now_ms, bool progressed) {
+    if (!proto_.hasPendingSendData()) {
+        write_stalled_since_ms_.store(0, std::memory_order_relaxed);
+    } else if (progressed ||
+               write_stalled_since_ms_.load(std::memory_order_relaxed) == 0) {
+        write_stalled_since_ms_.store(now_ms, std::memory_order_relaxed);
+    }
+}
+
+Connection::TimeoutCheck Connection::checkTimeouts(
+    const ConnectionTimeouts &timeouts, int64_t now_ms) {
+    TimeoutCheck check;
+    int64_t next = INT64_MAX;
+    // since 为 0 表示该项当前不在计时：按超时长度再来看一次，
+    // 期间开始计时的项最迟在那时得到准确的期限
+    auto expired = [&](int64_t since, int64_t limit) {
+        if (limit <= 0) return false;
+        int64_t deadline = (since > 0 ? since : now_ms) + limit;
+        if (deadline <= now_ms) return true;
+        next = std::min(next, deadline);
+        return false;
+    };
+    auto timedOut = [&](const char *reason) {
+        check.action = TimeoutAction::Close;
+        check.reason = reason;
+        return check;
+    };
+
+    int64_t write_since =
+        write_stalled_since_ms_.load(std::memory_order_relaxed);
+    if (expired(write_since, timeouts.write_ms)) return timedOut("write");
+    // 有待发数据时由写超时负责，不计空闲（按不在计时处理，之后仍会再检查）
+    if (expired(write_since == 0
+                    ? last_request_ms_.load(std::memory_order_relaxed)
+                    : 0,
+                timeouts.idle_ms)) {
+        return timedOut("idle");
+    }
+    // 读取暂停是本端在等对端收数据，半帧和心跳都不计时，由写超时兜底
+    bool paused = readingPaused();
+    if (expired(paused ? 0 : partial_since_ms_.load(std::memory_order_relaxed),
+                timeouts.read_ms)) {
+        return timedOut("read");
+    }
+    if (paused) {
+        expired(0, timeouts.heartbeat_interval_ms);
+    } else if (timeouts.heartbeat_interval_ms > 0) {
+        int64_t ping_timeout =
+            std::max<int64_t>(timeouts.heartbeat_timeout_ms, 1);
+        int64_t ping = ping_sent_ms_.load(std::memory_order_relaxed);
+        if (ping > 0) {
+            if (expired(ping, ping_timeout)) return timedOut("heartbeat");
+        } else if (expired(last_receive_ms_.load(std::memory_order_relaxed),
+                           timeouts.heartbeat_interval_ms)) {
+            ping_sent_ms_.store(now_ms, std::memory_order_relaxed);
+            check.action = TimeoutAction::SendPing;
+            next = std::min(next, now_ms + ping_timeout);
+        }
+    }
+    check.next_check_ms = next == INT64_MAX ? 0 : next;
+    return check;
+}
@@ -1,18 +1,100 @@
-#include "net/ConnectionManager.hpp"
+#include "net/connection/ConnectionManager.hpp"
 
-void ConnectionManager::addConnection(int fd,
-                                      std::shared_ptr<Connection> conn) {
-    std::unique_lock lock(mutex_);
-    connections_.emplace(fd, std::move(conn));
+#include "utils/Logger.hpp"
+
+ConnectionManager::ConnectionManager()
+    : chunks_(new std::atomic<Chunk*>[kMaxChunks]) {
+    for (size_t i = 0; i < kMaxChunks; ++i) {
+        chunks_[i].store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+ConnectionManager::~ConnectionManager() {
+    for (int fd : getAllFds()) {
+        removeConnection(fd);
+    }
+    // 析构时已没有读者，立即释放退休的连接
+    EpochReclaimer::getInstance().drain();
+    for (size_t i = 0; i < kMaxChunks; ++i) {
+        delete chunks_[i].load(std::memory_order_relaxed);
+    }
+}
+
+ConnectionManager::Slot* ConnectionManager::slotFor(int fd) const {
+    if (fd < 0 || static_cast<size_t>(fd) >= kMaxFds) return nullptr;
+    Chunk* chunk =
+        chunks_[fd >> kChunkBits].load(std::memory_order_acquire);
+    if (!chunk) return nullptr;
+    return &chunk->slots[fd & (kChunkSize - 1)];
+}
+
+ConnectionManager::Slot* ConnectionManager::slotForWrite(int fd) {
+    if (fd < 0 || static_cast<size_t>(fd) >= kMaxFds) return nullptr;
+    std::atomic<Chunk*>& entry = chunks_[fd >> kChunkBits];
+    Chunk* chunk = entry.load(std::memory_order_acquire);
+    if (!chunk) {
+        // 多个 Reactor/线程可能同时分配同一块，CAS 失败的一方释放自己的块
+        auto* fresh = new Chunk();
+        if (entry.compare_exchange_strong(chunk, fresh,
+                                          std::memory_order_acq_rel)) {
+            chunk = fresh;
+        } else {
+            delete fresh;
+        }
+    }
+    return &chunk->slots[fd & (kChunkSize - 1)];
+}
+
+uint32_t ConnectionManager::addConnection(int fd,
+                                          std::unique_ptr<Connection> conn) {
+    Slot* slot = slotForWrite(fd);
+    if (!slot) {
+        LOG_ERROR("fd %d exceeds connection table capacity", fd);
+        return 0;
+    }
+    uint32_t generation = slot->next_generation++;
+    if (slot->next_generation == 0) slot->next_generation = 1;
+    conn->setGeneration(generation);
+    // release：读者拿到指针时能看到完整构造的 Connection
+    Connection* old =
+        slot->conn.exchange(conn.release(), std::memory_order_acq_rel);
+    if (old) {
+        // fd 已被内核复用说明旧连接的 fd 早已在别处关闭，只是未从表中移除；
+        // 不能再 close，否则会关掉新连接
+        LOG_ERROR("Stale connection found in table: fd=%d", fd);
+        count_.fetch_sub(1, std::memory_order_relaxed);
+        old->markClosed();
+        EpochReclaimer::getInstance().retire(old);
+    }
+    count_.fetch_add(1, std::memory_order_relaxed);
+    return generation;
 }
 
 void ConnectionManager::removeConnection(int fd) {
-    std::unique_lock lock(mutex_);
-    connections_.erase(fd);
+    Slot* slot = slotFor(fd);
+    if (!slot) return;
+    Connection* conn = slot->conn.exchange(nullptr, std::memory_order_acq_rel);
+    if (!conn) return;
+    count_.fetch_sub(1, std::memory_order_relaxed);
+    // 立即关闭 fd 让对端尽快感知；对象本身等读者离开后再释放
+    conn->close();
+    EpochReclaimer::getInstance().retire(conn);
+}
+
+Connection* ConnectionManager::getConnection(int fd) const {
+    Slot* slot = slotFor(fd);
+    return slot ? slot->conn.load(std::memory_order_acquire) : nullptr;
+}
+
+Connection* ConnectionManager::getConnection(int fd,
+                                             uint32_t generation) const {
+    Connection* conn = getConnection(fd);
+    return (conn && conn->generation() == generation) ? conn : nullptr;
 }
 
-std::shared_ptr<Connection> ConnectionManager::getConnection(int fd) const {
-    std::shared_lock lock(mutex_);
-    auto it = connections_.find(fd);
-    return (it != connections_.end()) ? it->second : nullptr;
+std::vector<int> ConnectionManager::getAllFds() const {
+    std::vector<int> fds;
+    fds.reserve(size());
+    forEach([&fds](int fd, Connection*) { fds.push_back(fd); });
+    return fds;
 }
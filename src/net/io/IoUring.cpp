@@ -0,0 +1,244 @@
+#include "net/io/IoUring.hpp"
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <vector>
+
+static int sys_io_uring_setup(unsigned entries, io_uring_params* p) {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, p));
+}
+
+static int sys_io_uring_enter(int fd, unsigned to_submit, unsigned min_complete,
+                              unsigned flags) {
+    return static_cast<int>(syscall(__NR_io_uring_enter, fd, to_submit,
+                                    min_complete, flags, nullptr, 0));
+}
+
+static int sys_io_uring_register(int fd, unsigned opcode, void* arg,
+                                 unsigned nr_args) {
+    return static_cast<int>(
+        syscall(__NR_io_uring_register, fd, opcode, arg, nr_args));
+}
+
+IoUring::~IoUring() {
+    if (buf_ring_) munmap(buf_ring_, buf_ring_size_);
+    if (buffers_) munmap(buffers_, buffers_size_);
+    if (sqes_) munmap(sqes_, sqes_size_);
+    if (cq_ring_ptr_ && cq_ring_ptr_ != sq_ring_ptr_)
+        munmap(cq_ring_ptr_, cq_ring_size_);
+    if (sq_ring_ptr_) munmap(sq_ring_ptr_, sq_ring_size_);
+    if (ring_fd_ != -1) close(ring_fd_);
+}
+
+namespace {
+
+// 本项目提交的请求类型；IORING_OP_SEND_ZC 与 multishot recv 同在 6.0 加入，
+// multishot 标志本身无法探测，以它作为内核版本的替代判断
+constexpr uint8_t kRequiredOps[] = {
+    IORING_OP_ACCEPT, IORING_OP_RECV,  IORING_OP_SENDMSG,      IORING_OP_READ,
+    IORING_OP_TIMEOUT, IORING_OP_POLL_ADD, IORING_OP_ASYNC_CANCEL,
+    IORING_OP_SPLICE, IORING_OP_SEND_ZC,
+};
+
+bool probeRing(int fd) {
+    constexpr unsigned kProbeOps = 256;
+    std::vector<uint8_t> storage(sizeof(io_uring_probe) +
+                                 kProbeOps * sizeof(io_uring_probe_op));
+    auto* probe = reinterpret_cast<io_uring_probe*>(storage.data());
+    if (sys_io_uring_register(fd, IORING_REGISTER_PROBE, probe, kProbeOps) < 0) {
+        return false;  // 5.6 之前没有 probe，更不会有下面需要的功能
+    }
+    for (uint8_t op : kRequiredOps) {
+        if (op > probe->last_op ||
+            !(probe->ops[op].flags & IO_URING_OP_SUPPORTED)) {
+            return false;
+        }
+    }
+
+    // provided buffer ring（5.19+）：注册一个单条目的环，随 ring fd 关闭一起释放
+    long page = sysconf(_SC_PAGESIZE);
+    void* ring = mmap(nullptr, page, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ring == MAP_FAILED) return false;
+    io_uring_buf_reg reg{};
+    reg.ring_addr = reinterpret_cast<uint64_t>(ring);
+    reg.ring_entries = 1;
+    reg.bgid = 0;
+    bool ok = sys_io_uring_register(fd, IORING_REGISTER_PBUF_RING, &reg, 1) == 0;
+    if (ok) {
+        sys_io_uring_register(fd, IORING_UNREGISTER_PBUF_RING, &reg, 1);
+    }
+    munmap(ring, page);
+    return ok;
+}
+
+}  // namespace
+
+bool IoUring::isSupported() {
+    // 各 Reactor 创建时都会调用，只探测一次
+    static const bool supported = [] {
+        io_uring_params p{};
+        int fd = sys_io_uring_setup(2, &p);
+        if (fd < 0) return false;  // 内核不支持，或被 seccomp/sysctl 禁用
+        bool ok = probeRing(fd);
+        close(fd);
+        return ok;
+    }();
+    return supported;
+}
+
+bool IoUring::init(unsigned entries) {
+    io_uring_params p{};
+    // multishot 请求会产生大量 CQE，CQ 比 SQ 大得多
+    p.flags = IORING_SETUP_CQSIZE;
+    p.cq_entries = entries * 4;
+    ring_fd_ = sys_io_uring_setup(entries, &p);
+    if (ring_fd_ < 0) return false;
+
+    sq_ring_size_ = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    cq_ring_size_ = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+    bool single_mmap = p.features & IORING_FEAT_SINGLE_MMAP;
+    if (single_mmap) {
+        sq_ring_size_ = cq_ring_size_ =
+            sq_ring_size_ > cq_ring_size_ ? sq_ring_size_ : cq_ring_size_;
+    }
+
+    sq_ring_ptr_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQ_RING);
+    if (sq_ring_ptr_ == MAP_FAILED) {
+        sq_ring_ptr_ = nullptr;
+        return false;
+    }
+    if (single_mmap) {
+        cq_ring_ptr_ = sq_ring_ptr_;
+    } else {
+        cq_ring_ptr_ =
+            mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE,
+                 MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_CQ_RING);
+        if (cq_ring_ptr_ == MAP_FAILED) {
+            cq_ring_ptr_ = nullptr;
+            return false;
+        }
+    }
+
+    sqes_size_ = p.sq_entries * sizeof(io_uring_sqe);
+    void* sqes = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) return false;
+    sqes_ = static_cast<io_uring_sqe*>(sqes);
+
+    auto* sq = static_cast<uint8_t*>(sq_ring_ptr_);
+    sq_head_ = reinterpret_cast<unsigned*>(sq + p.sq_off.head);
+    sq_tail_ = reinterpret_cast<unsigned*>(sq + p.sq_off.tail);
+    sq_mask_ = *reinterpret_cast<unsigned*>(sq + p.sq_off.ring_mask);
+    sq_entries_ = *reinterpret_cast<unsigned*>(sq + p.sq_off.ring_entries);
+    sq_array_ = reinterpret_cast<unsigned*>(sq + p.sq_off.array);
+    // SQ array 与 SQE 一一对应，初始化后无需再改
+    for (unsigned i = 0; i < sq_entries_; ++i) {
+        sq_array_[i] = i;
+    }
+
+    auto* cq = static_cast<uint8_t*>(cq_ring_ptr_);
+    cq_head_ = reinterpret_cast<unsigned*>(cq + p.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned*>(cq + p.cq_off.tail);
+    cq_mask_ = *reinterpret_cast<unsigned*>(cq + p.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<io_uring_cqe*>(cq + p.cq_off.cqes);
+
+    sqe_tail_ = sqe_submitted_ = *sq_tail_;
+    return true;
+}
+
+io_uring_sqe* IoUring::getSqe() {
+    unsigned head =
+        std::atomic_ref<unsigned>(*sq_head_).load(std::memory_order_acquire);
+    if (sqe_tail_ - head >= sq_entries_) {
+        // SQ 已满：先提交，内核消费后再取
+        submitAndWait(0);
+        head = std::atomic_ref<unsigned>(*sq_head_).load(
+            std::memory_order_acquire);
+        if (sqe_tail_ - head >= sq_entries_) return nullptr;
+    }
+    io_uring_sqe* sqe = &sqes_[sqe_tail_ & sq_mask_];
+    ++sqe_tail_;
+    memset(sqe, 0, sizeof(*sqe));
+    return sqe;
+}
+
+unsigned IoUring::flushSq() {
+    unsigned to_submit = sqe_tail_ - sqe_submitted_;
+    if (to_submit > 0) {
+        std::atomic_ref<unsigned>(*sq_tail_).store(sqe_tail_,
+                                                   std::memory_order_release);
+        sqe_submitted_ = sqe_tail_;
+    }
+    return to_submit;
+}
+
+int IoUring::submitAndWait(unsigned wait_nr) {
+    unsigned to_submit = flushSq();
+    unsigned flags = wait_nr > 0 ? IORING_ENTER_GETEVENTS : 0;
+    if (to_submit == 0 && wait_nr == 0) return 0;
+    int ret;
+    do {
+        ret = sys_io_uring_enter(ring_fd_, to_submit, wait_nr, flags);
+    } while (ret < 0 && errno == EINTR && wait_nr == 0);
+    return ret;
+}
+
+bool IoUring::setupBufferRing(uint16_t group_id, unsigned count,
+                              unsigned size) {
+    // 内核要求条目数为 2 的幂且不超过 32768
+    if (count == 0 || (count & (count - 1)) != 0 || count > 32768) {
+        errno = EINVAL;
+        return false;
+    }
+    buffer_count_ = count;
+    buffer_size_ = size;
+
+    long page = sysconf(_SC_PAGESIZE);
+    buf_ring_size_ = (count * sizeof(io_uring_buf) + page - 1) / page * page;
+    void* ring = mmap(nullptr, buf_ring_size_, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ring == MAP_FAILED) return false;
+    buf_ring_ = static_cast<io_uring_buf_ring*>(ring);
+
+    buffers_size_ = size_t(count) * size;
+    void* bufs = mmap(nullptr, buffers_size_, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (bufs == MAP_FAILED) return false;
+    buffers_ = static_cast<uint8_t*>(bufs);
+
+    io_uring_buf_reg reg{};
+    reg.ring_addr = reinterpret_cast<uint64_t>(buf_ring_);
+    reg.ring_entries = count;
+    reg.bgid = group_id;
+    if (sys_io_uring_register(ring_fd_, IORING_REGISTER_PBUF_RING, &reg, 1) <
+        0) {
+        return false;
+    }
+
+    for (unsigned i = 0; i < count; ++i) {
+        io_uring_buf& buf = bufRingEntry(buf_ring_tail_ + i);
+        buf.addr = reinterpret_cast<uint64_t>(bufferAddress(i));
+        buf.len = size;
+        buf.bid = static_cast<uint16_t>(i);
+    }
+    buf_ring_tail_ += count;
+    std::atomic_ref<uint16_t>(buf_ring_->tail)
+        .store(buf_ring_tail_, std::memory_order_release);
+    return true;
+}
+
+void IoUring::recycleBuffer(uint16_t bid) {
+    io_uring_buf& buf = bufRingEntry(buf_ring_tail_);
+    buf.addr = reinterpret_cast<uint64_t>(bufferAddress(bid));
+    buf.len = buffer_size_;
+    buf.bid = bid;
+    ++buf_ring_tail_;
+    std::atomic_ref<uint16_t>(buf_ring_->tail)
+        .store(buf_ring_tail_, std::memory_order_release);
+}
@@ -0,0 +1,640 @@
+#include "net/packet/Compression.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#if MCS_HAVE_LZ4
+// LZ4F 的字典接口（CDict、带字典解码）在 1.9.x 属于 static-only 接口，
+// 只有 CMake 确认能链接时才定义 MCS_HAVE_LZ4F_DICT 并使用
+#if MCS_HAVE_LZ4F_DICT
+#define LZ4F_STATIC_LINKING_ONLY
+#endif
+#include <lz4.h>
+#include <lz4frame.h>
+#endif
+#if MCS_HAVE_ZSTD
+#include <zdict.h>
+#include <zstd.h>
+#endif
+
+#include "net/Checksum.hpp"
+#include "utils/Metrics.hpp"
+
+namespace compression {
+
+namespace {
+
+constexpr size_t kDictionaryIdSize = 4;
+
+uint64_t elapsedNs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now() - start)
+        .count();
+}
+
+void putDictionaryId(std::string& out, uint32_t id) {
+    for (int shift = 24; shift >= 0; shift -= 8) {
+        out.push_back(static_cast<char>((id >> shift) & 0xFF));
+    }
+}
+
+bool takeDictionaryId(std::span<const uint8_t>& in, uint32_t& id) {
+    if (in.size() < kDictionaryIdSize) return false;
+    id = (uint32_t(in[0]) << 24) | (uint32_t(in[1]) << 16) |
+         (uint32_t(in[2]) << 8) | uint32_t(in[3]);
+    in = in.subspan(kDictionaryIdSize);
+    return true;
+}
+
+#if MCS_HAVE_ZSTD
+int zstdLevel(int level) { return level > 0 ? level : ZSTD_CLEVEL_DEFAULT; }
+
+// 无状态路径复用线程本地的上下文，避免每个包创建 / 释放
+ZSTD_CCtx* threadCCtx() {
+    thread_local std::unique_ptr<ZSTD_CCtx, size_t (*)(ZSTD_CCtx*)> cctx(
+        ZSTD_createCCtx(), ZSTD_freeCCtx);
+    return cctx.get();
+}
+
+ZSTD_DCtx* threadDCtx() {
+    thread_local std::unique_ptr<ZSTD_DCtx, size_t (*)(ZSTD_DCtx*)> dctx(
+        ZSTD_createDCtx(), ZSTD_freeDCtx);
+    return dctx.get();
+}
+#endif
+
+}  // namespace
+
+struct Dictionary::Native {
+#if MCS_HAVE_LZ4
+    LZ4_stream_t* lz4_stream = nullptr;  // 已载入字典，压缩时复制一份，省去每包重建哈希表
+#endif
+#if MCS_HAVE_LZ4F_DICT
+    LZ4F_CDict* lz4_cdict = nullptr;  // 流式上下文的初始字典
+#endif
+#if MCS_HAVE_ZSTD
+    ZSTD_CDict* zstd_cdict = nullptr;
+    ZSTD_DDict* zstd_ddict = nullptr;
+#endif
+
+    ~Native() {
+#if MCS_HAVE_LZ4
+        LZ4_freeStream(lz4_stream);
+#endif
+#if MCS_HAVE_LZ4F_DICT
+        LZ4F_freeCDict(lz4_cdict);
+#endif
+#if MCS_HAVE_ZSTD
+        ZSTD_freeCDict(zstd_cdict);
+        ZSTD_freeDDict(zstd_ddict);
+#endif
+    }
+};
+
+bool isAvailable(Algorithm algorithm) {
+    switch (algorithm) {
+        case Algorithm::Lz4:
+#if MCS_HAVE_LZ4
+            return true;
+#else
+            return false;
+#endif
+        case Algorithm::Zstd:
+#if MCS_HAVE_ZSTD
+            return true;
+#else
+            return false;
+#endif
+    }
+    return false;
+}
+
+const char* algorithmName(Algorithm algorithm) {
+    return algorithm == Algorithm::Zstd ? "zstd" : "lz4";
+}
+
+// ----- Dictionary -----
+
+Dictionary::Dictionary(std::string content, int zstd_level)
+    : content_(std::move(content)), native_(std::make_unique<Native>()) {
+    uint32_t crc = checksum::crc32c(std::span<const uint8_t>(
+        reinterpret_cast<const uint8_t*>(content_.data()), content_.size()));
+    id_ = crc != 0 ? crc : 1;
+#if MCS_HAVE_LZ4
+    // LZ4_loadDict 原地引用字典内容，content_ 在对象生命周期内不再修改
+    native_->lz4_stream = LZ4_createStream();
+    if (native_->lz4_stream) {
+        LZ4_loadDict(native_->lz4_stream, content_.data(),
+                     static_cast<int>(content_.size()));
+    }
+#endif
+#if MCS_HAVE_LZ4F_DICT
+    native_->lz4_cdict = LZ4F_createCDict(content_.data(), content_.size());
+#endif
+#if MCS_HAVE_ZSTD
+    native_->zstd_cdict = ZSTD_createCDict(content_.data(), content_.size(),
+                                           zstdLevel(zstd_level));
+    native_->zstd_ddict = ZSTD_createDDict(content_.data(), content_.size());
+#else
+    (void)zstd_level;
+#endif
+}
+
+Dictionary::~Dictionary() = default;
+
+std::shared_ptr<const Dictionary> Dictionary::create(std::string content,
+                                                     int zstd_level) {
+    if (content.empty()) return nullptr;
+    return std::shared_ptr<const Dictionary>(
+        new Dictionary(std::move(content), zstd_level));
+}
+
+std::shared_ptr<const Dictionary> Dictionary::train(
+    const std::vector<std::string>& samples, size_t capacity, int zstd_level) {
+    if (samples.empty() || capacity == 0) return nullptr;
+#if MCS_HAVE_ZSTD
+    std::string joined;
+    std::vector<size_t> sizes;
+    sizes.reserve(samples.size());
+    for (const auto& sample : samples) {
+        joined += sample;
+        sizes.push_back(sample.size());
+    }
+    std::string trained(capacity, '\0');
+    size_t n = ZDICT_trainFromBuffer(trained.data(), capacity, joined.data(),
+                                     sizes.data(),
+                                     static_cast<unsigned>(sizes.size()));
+    if (!ZDICT_isError(n)) {
+        trained.resize(n);
+        return create(std::move(trained), zstd_level);
+    }
+    // 样本太少或太单一时 ZDICT 会失败，退回原始内容字典
+#endif
+    // 原始内容字典：越靠近末尾的内容匹配距离越短，最新的样本放在最后
+    size_t total = 0;
+    size_t first = samples.size();
+    while (first > 0 && total + samples[first - 1].size() <= capacity) {
+        total += samples[--first].size();
+    }
+    std::string content;
+    content.reserve(total);
+    for (size_t i = first; i < samples.size(); ++i) content += samples[i];
+    return create(std::move(content), zstd_level);
+}
+
+std::shared_ptr<const Dictionary> Dictionary::load(const std::string& path,
+                                                   int zstd_level) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return nullptr;
+    std::string content((std::istreambuf_iterator<char>(file)),
+                        std::istreambuf_iterator<char>());
+    return create(std::move(content), zstd_level);
+}
+
+bool Dictionary::save(const std::string& path) const {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(content_.data(), static_cast<std::streamsize>(content_.size()));
+    return static_cast<bool>(file);
+}
+
+// ----- 无状态压缩 -----
+
+namespace {
+
+// 返回压缩后的字节数，失败返回 0；dst 至少为对应算法的压缩上界
+size_t compressBlock(const Options& options, std::span<const uint8_t> in,
+                     [[maybe_unused]] char* dst,
+                     [[maybe_unused]] size_t capacity) {
+    [[maybe_unused]] const Dictionary* dict = options.dictionary.get();
+    [[maybe_unused]] const char* src = reinterpret_cast<const char*>(in.data());
+    if (options.algorithm == Algorithm::Lz4) {
+#if MCS_HAVE_LZ4
+        int acceleration = options.level > 0 ? options.level : 1;
+        if (!dict || !dict->native().lz4_stream) {
+            return static_cast<size_t>(LZ4_compress_fast(
+                src, dst, static_cast<int>(in.size()),
+                static_cast<int>(capacity), acceleration));
+        }
+        thread_local LZ4_stream_t stream;
+        memcpy(&stream, dict->native().lz4_stream, sizeof(stream));
+        return static_cast<size_t>(LZ4_compress_fast_continue(
+            &stream, src, dst, static_cast<int>(in.size()),
+            static_cast<int>(capacity), acceleration));
+#endif
+    } else {
+#if MCS_HAVE_ZSTD
+        ZSTD_CCtx* cctx = threadCCtx();
+        ZSTD_CCtx_reset(cctx, ZSTD_reset_session_and_parameters);
+        ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel,
+                               zstdLevel(options.level));
+        // 原始长度已在包头，字典 id 由本模块携带，帧头里都不再重复
+        ZSTD_CCtx_setParameter(cctx, ZSTD_c_contentSizeFlag, 0);
+        ZSTD_CCtx_setParameter(cctx, ZSTD_c_dictIDFlag, 0);
+        if (dict) ZSTD_CCtx_refCDict(cctx, dict->native().zstd_cdict);
+        size_t n = ZSTD_compress2(cctx, dst, capacity, src, in.size());
+        return ZSTD_isError(n) ? 0 : n;
+#endif
+    }
+    return 0;
+}
+
+size_t compressBound(Algorithm algorithm, size_t size) {
+#if MCS_HAVE_LZ4
+    if (algorithm == Algorithm::Lz4) {
+        return static_cast<size_t>(LZ4_compressBound(static_cast<int>(size)));
+    }
+#endif
+#if MCS_HAVE_ZSTD
+    if (algorithm == Algorithm::Zstd) return ZSTD_compressBound(size);
+#endif
+    (void)algorithm;
+    return size;
+}
+
+bool decompressBlock(uint8_t flags, std::span<const uint8_t> in,
+                     [[maybe_unused]] size_t raw_length,
+                     [[maybe_unused]] const Dictionary* dict,
+                     [[maybe_unused]] char* dst) {
+    [[maybe_unused]] const char* src = reinterpret_cast<const char*>(in.data());
+    if (!(flags & kFlagZstd)) {
+#if MCS_HAVE_LZ4
+        int n = dict ? LZ4_decompress_safe_usingDict(
+                           src, dst, static_cast<int>(in.size()),
+                           static_cast<int>(raw_length), dict->content().data(),
+                           static_cast<int>(dict->content().size()))
+                     : LZ4_decompress_safe(src, dst, static_cast<int>(in.size()),
+                                           static_cast<int>(raw_length));
+        return n >= 0 && static_cast<size_t>(n) == raw_length;
+#endif
+    } else {
+#if MCS_HAVE_ZSTD
+        ZSTD_DCtx* dctx = threadDCtx();
+        size_t n = dict ? ZSTD_decompress_usingDDict(dctx, dst, raw_length, src,
+                                                     in.size(),
+                                                     dict->native().zstd_ddict)
+                        : ZSTD_decompressDCtx(dctx, dst, raw_length, src,
+                                              in.size());
+        return !ZSTD_isError(n) && n == raw_length;
+#endif
+    }
+    return false;
+}
+
+bool algorithmUsable(uint8_t flags) {
+    return isAvailable((flags & kFlagZstd) ? Algorithm::Zstd : Algorithm::Lz4);
+}
+
+}  // namespace
+
+bool compress(const Options& options, std::span<const uint8_t> in,
+              std::string& out, uint8_t& flags) {
+    auto& metrics = Metrics::getInstance();
+    if (in.size() < options.min_size || !isAvailable(options.algorithm)) {
+        metrics.incrementCompressionSkipped();
+        return false;
+    }
+    auto start = std::chrono::steady_clock::now();
+    const Dictionary* dict = options.dictionary.get();
+    out.clear();
+    if (dict) putDictionaryId(out, dict->id());
+    size_t prefix = out.size();
+    out.resize(prefix + compressBound(options.algorithm, in.size()));
+    size_t n = compressBlock(options, in, out.data() + prefix,
+                             out.size() - prefix);
+    // 不比原文小就原样发送，解码方也省一次解压
+    if (n == 0 || prefix + n >= in.size()) {
+        out.clear();
+        metrics.recordCompressionRejected(elapsedNs(start));
+        return false;
+    }
+    out.resize(prefix + n);
+    flags = kFlagCompressed |
+            (options.algorithm == Algorithm::Zstd ? kFlagZstd : 0) |
+            (dict ? kFlagDictionary : 0);
+    metrics.recordCompression(in.size(), out.size(), elapsedNs(start));
+    return true;
+}
+
+bool decompress(uint8_t flags, std::span<const uint8_t> in, size_t raw_length,
+                std::string& out, const Dictionary* dictionary) {
+    if (!(flags & kFlagCompressed) || (flags & kFlagStream) ||
+        !algorithmUsable(flags)) {
+        return false;
+    }
+    auto start = std::chrono::steady_clock::now();
+    size_t in_size = in.size();
+    if (flags & kFlagDictionary) {
+        uint32_t id;
+        if (!takeDictionaryId(in, id) || !dictionary || dictionary->id() != id) {
+            return false;
+        }
+    } else {
+        dictionary = nullptr;
+    }
+    out.resize(raw_length);
+    if (!decompressBlock(flags, in, raw_length, dictionary, out.data())) {
+        out.clear();
+        return false;
+    }
+    Metrics::getInstance().recordDecompression(in_size, raw_length,
+                                               elapsedNs(start));
+    return true;
+}
+
+// ----- 流式上下文 -----
+
+/*
+LZ4 用块链接（blockLinked）的 LZ4F 帧、zstd 用一个不结束的 zstd 帧贯穿整个连接：
+每个包压缩后立即 flush，输出恰好是该包的数据，接收方喂给同一个解码上下文即可还原。
+帧头随第一个流式包发出；后续包可以引用此前 64KB（LZ4）/ 窗口大小（zstd）内的所有内容
+*/
+struct Compressor::Stream {
+    Algorithm algorithm;
+#if MCS_HAVE_LZ4
+    LZ4F_cctx* lz4 = nullptr;
+    LZ4F_preferences_t prefs{};
+#endif
+#if MCS_HAVE_ZSTD
+    ZSTD_CCtx* zstd = nullptr;
+#endif
+    bool started = false;
+
+    ~Stream() {
+#if MCS_HAVE_LZ4
+        LZ4F_freeCompressionContext(lz4);
+#endif
+#if MCS_HAVE_ZSTD
+        ZSTD_freeCCtx(zstd);
+#endif
+    }
+};
+
+Compressor::Compressor(Options options) : options_(std::move(options)) {}
+
+Compressor::~Compressor() = default;
+
+bool Compressor::compress(std::span<const uint8_t> in, std::string& out,
+                          uint8_t& flags) {
+    if (!options_.streaming) {
+        return compression::compress(options_, in, out, flags);
+    }
+    if (in.size() < options_.min_size || !isAvailable(options_.algorithm)) {
+        Metrics::getInstance().incrementCompressionSkipped();
+        return false;
+    }
+    auto start = std::chrono::steady_clock::now();
+    if (!compressStream(in, out, flags)) {
+        out.clear();
+        return false;
+    }
+    Metrics::getInstance().recordCompression(in.size(), out.size(),
+                                             elapsedNs(start));
+    return true;
+}
+
+bool Compressor::compressStream([[maybe_unused]] std::span<const uint8_t> in,
+                                std::string& out, uint8_t& flags) {
+    const Dictionary* dict = options_.dictionary.get();
+#if !MCS_HAVE_LZ4F_DICT
+    // 链接的 liblz4 不提供 LZ4F 字典接口：LZ4 流不带字典，只靠连接内的历史
+    if (options_.algorithm == Algorithm::Lz4) dict = nullptr;
+#endif
+    if (!stream_) {
+        stream_ = std::make_unique<Stream>();
+        stream_->algorithm = options_.algorithm;
+    }
+    Stream& stream = *stream_;
+    out.clear();
+    flags = kFlagCompressed | kFlagStream;
+    // 字典只在开启流的第一个包里声明，之后的包沿用
+    if (!stream.started && dict) {
+        putDictionaryId(out, dict->id());
+        flags |= kFlagDictionary;
+    }
+
+    if (stream.algorithm == Algorithm::Lz4) {
+#if MCS_HAVE_LZ4
+        if (!stream.started) {
+            if (LZ4F_isError(LZ4F_createCompressionContext(&stream.lz4,
+                                                           LZ4F_VERSION))) {
+                return false;
+            }
+            stream.prefs.frameInfo.blockMode = LZ4F_blockLinked;
+            stream.prefs.frameInfo.blockSizeID = LZ4F_max64KB;
+            stream.prefs.autoFlush = 1;
+            // 负的压缩级别即加速因子
+            stream.prefs.compressionLevel =
+                options_.level > 1 ? -options_.level : 0;
+            size_t offset = out.size();
+            out.resize(offset + LZ4F_HEADER_SIZE_MAX);
+#if MCS_HAVE_LZ4F_DICT
+            size_t n = dict ? LZ4F_compressBegin_usingCDict(
+                                  stream.lz4, out.data() + offset,
+                                  LZ4F_HEADER_SIZE_MAX,
+                                  dict->native().lz4_cdict, &stream.prefs)
+                            : LZ4F_compressBegin(stream.lz4, out.data() + offset,
+                                                 LZ4F_HEADER_SIZE_MAX,
+                                                 &stream.prefs);
+#else
+            size_t n = LZ4F_compressBegin(stream.lz4, out.data() + offset,
+                                          LZ4F_HEADER_SIZE_MAX, &stream.prefs);
+#endif
+            if (LZ4F_isError(n)) return false;
+            out.resize(offset + n);
+        }
+        size_t offset = out.size();
+        out.resize(offset + LZ4F_compressBound(in.size(), &stream.prefs));
+        size_t n = LZ4F_compressUpdate(stream.lz4, out.data() + offset,
+                                       out.size() - offset, in.data(),
+                                       in.size(), nullptr);
+        if (LZ4F_isError(n)) return false;
+        out.resize(offset + n);
+        stream.started = true;
+        return true;
+#endif
+    } else {
+#if MCS_HAVE_ZSTD
+        flags |= kFlagZstd;
+        if (!stream.started) {
+            stream.zstd = ZSTD_createCCtx();
+            if (!stream.zstd) return false;
+            ZSTD_CCtx_setParameter(stream.zstd, ZSTD_c_compressionLevel,
+                                   zstdLevel(options_.level));
+            ZSTD_CCtx_setParameter(stream.zstd, ZSTD_c_dictIDFlag, 0);
+            if (dict) ZSTD_CCtx_refCDict(stream.zstd, dict->native().zstd_cdict);
+        }
+        ZSTD_inBuffer input{in.data(), in.size(), 0};
+        size_t offset = out.size();
+        out.resize(offset + ZSTD_compressBound(in.size()) + 64);
+        ZSTD_outBuffer output{out.data() + offset, out.size() - offset, 0};
+        // flush 直到本包的数据全部输出（返回 0）
+        while (true) {
+            size_t remaining = ZSTD_compressStream2(stream.zstd, &output,
+                                                    &input, ZSTD_e_flush);
+            if (ZSTD_isError(remaining)) return false;
+            if (remaining == 0) break;
+            out.resize(out.size() + std::max<size_t>(remaining, 4096));
+            output.dst = out.data() + offset;
+            output.size = out.size() - offset;
+        }
+        out.resize(offset + output.pos);
+        stream.started = true;
+        return true;
+#endif
+    }
+    return false;
+}
+
+struct Decompressor::Stream {
+    bool zstd = false;
+    const Dictionary* dictionary = nullptr;  // 流开始时声明的字典，由 dictionaries_ 持有
+    bool broken = false;
+#if MCS_HAVE_LZ4
+    LZ4F_dctx* lz4 = nullptr;
+#endif
+#if MCS_HAVE_ZSTD
+    ZSTD_DCtx* zstd_ctx = nullptr;
+#endif
+
+    ~Stream() {
+#if MCS_HAVE_LZ4
+        LZ4F_freeDecompressionContext(lz4);
+#endif
+#if MCS_HAVE_ZSTD
+        ZSTD_freeDCtx(zstd_ctx);
+#endif
+    }
+};
+
+Decompressor::Decompressor() = default;
+
+Decompressor::~Decompressor() = default;
+
+void Decompressor::addDictionary(std::shared_ptr<const Dictionary> dictionary) {
+    if (dictionary && !findDictionary(dictionary->id())) {
+        dictionaries_.push_back(std::move(dictionary));
+    }
+}
+
+const Dictionary* Decompressor::findDictionary(uint32_t id) const {
+    for (const auto& dictionary : dictionaries_) {
+        if (dictionary->id() == id) return dictionary.get();
+    }
+    return nullptr;
+}
+
+bool Decompressor::decompress(uint8_t flags, std::span<const uint8_t> in,
+                              size_t raw_length, std::string& out) {
+    if (!(flags & kFlagStream)) {
+        const Dictionary* dict = nullptr;
+        uint32_t id;
+        std::span<const uint8_t> peek = in;
+        if ((flags & kFlagDictionary) && takeDictionaryId(peek, id)) {
+            dict = findDictionary(id);
+        }
+        return compression::decompress(flags, in, raw_length, out, dict);
+    }
+    if (!(flags & kFlagCompressed) || !algorithmUsable(flags)) return false;
+    auto start = std::chrono::steady_clock::now();
+    if (!decompressStream(flags, in, raw_length, out)) {
+        // 流的历史已不一致，之后的流式包都无法还原
+        if (stream_) stream_->broken = true;
+        out.clear();
+        return false;
+    }
+    Metrics::getInstance().recordDecompression(in.size(), raw_length,
+                                               elapsedNs(start));
+    return true;
+}
+
+bool Decompressor::decompressStream(uint8_t flags, std::span<const uint8_t> in,
+                                    size_t raw_length, std::string& out) {
+    bool zstd = flags & kFlagZstd;
+    if (!stream_) {
+        stream_ = std::make_unique<Stream>();
+        stream_->zstd = zstd;
+        if (flags & kFlagDictionary) {
+            uint32_t id;
+            if (!takeDictionaryId(in, id)) return false;
+            stream_->dictionary = findDictionary(id);
+            if (!stream_->dictionary) return false;
+        }
+    } else if (stream_->broken || stream_->zstd != zstd ||
+               (flags & kFlagDictionary)) {
+        return false;
+    }
+    [[maybe_unused]] Stream& stream = *stream_;
+    out.resize(raw_length);
+
+    if (!zstd) {
+#if MCS_HAVE_LZ4
+        if (!stream.lz4 && LZ4F_isError(LZ4F_createDecompressionContext(
+                               &stream.lz4, LZ4F_VERSION))) {
+            return false;
+        }
+        size_t src_pos = 0;
+        size_t dst_pos = 0;
+        while (src_pos < in.size()) {
+            size_t src_size = in.size() - src_pos;
+            size_t dst_size = raw_length - dst_pos;
+#if MCS_HAVE_LZ4F_DICT
+            size_t ret =
+                stream.dictionary
+                    ? LZ4F_decompress_usingDict(
+                          stream.lz4, out.data() + dst_pos, &dst_size,
+                          in.data() + src_pos, &src_size,
+                          stream.dictionary->content().data(),
+                          stream.dictionary->content().size(), nullptr)
+                    : LZ4F_decompress(stream.lz4, out.data() + dst_pos,
+                                      &dst_size, in.data() + src_pos,
+                                      &src_size, nullptr);
+#else
+            if (stream.dictionary) return false;
+            size_t ret = LZ4F_decompress(stream.lz4, out.data() + dst_pos,
+                                         &dst_size, in.data() + src_pos,
+                                         &src_size, nullptr);
+#endif
+            if (LZ4F_isError(ret) || (src_size == 0 && dst_size == 0)) {
+                return false;
+            }
+            src_pos += src_size;
+            dst_pos += dst_size;
+        }
+        return dst_pos == raw_length;
+#endif
+    } else {
+#if MCS_HAVE_ZSTD
+        if (!stream.zstd_ctx) {
+            stream.zstd_ctx = ZSTD_createDCtx();
+            if (!stream.zstd_ctx) return false;
+            if (stream.dictionary) {
+                ZSTD_DCtx_refDDict(stream.zstd_ctx,
+                                   stream.dictionary->native().zstd_ddict);
+            }
+        }
+        ZSTD_inBuffer input{in.data(), in.size(), 0};
+        ZSTD_outBuffer output{out.data(), raw_length, 0};
+        // 输入全部消费、且输出写满或不再有进展时结束
+        while (true) {
+            size_t before_in = input.pos;
+            size_t before_out = output.pos;
+            size_t ret = ZSTD_decompressStream(stream.zstd_ctx, &output, &input);
+            if (ZSTD_isError(ret)) return false;
+            bool progressed =
+                input.pos != before_in || output.pos != before_out;
+            if (input.pos == input.size &&
+                (output.pos == output.size || !progressed)) {
+                break;
+            }
+            if (!progressed) return false;
+        }
+        return output.pos == raw_length;
+#endif
+    }
+    return false;
+}
+
+}  // namespace compression
@@ -1,6 +1,7 @@
 // PacketA.cpp
-#pragma once
 #include "net/packet/PacketA.hpp"
+
+#include "net/Checksum.hpp"
 /*
 +------------+--------+-----------+------------+----------------+------------+
 | TypeID(2) | Ver(1) | Magic(2B)  | Length(4B) | Payload(n字节) | Checksum(2B)|
@@ -12,6 +13,10 @@ uint16_t PacketA::getTypeID() const {
     return TYPE_ID;
 }
 
+uint8_t PacketA::getVersion() const {
+    return VERSION;
+}
+
 std::vector<uint8_t> PacketA::serialize() const {
     std::vector<uint8_t> buffer;
     // 头部固定长度 = 2 + 1 + 2 + 4 + payload + 2
@@ -20,8 +25,8 @@ std::vector<uint8_t> PacketA::serialize() const {
     buffer.resize(2 + 1 + 2 + 4 + length + 2);
     
     // TypeID 2B
-    buffer[1] = (TYPE_ID >> 8) & 0xFF;
-    buffer[2] = TYPE_ID & 0xFF;
+    buffer[0] = (TYPE_ID >> 8) & 0xFF;
+    buffer[1] = TYPE_ID & 0xFF;
     
     // Version 1B
     buffer[2] = VERSION;
@@ -48,42 +53,42 @@ std::vector<uint8_t> PacketA::serialize() const {
     return buffer;
 }
 
-uint16_t PacketA::calculateChecksum(const std::vector<uint8_t>& data) {
-    uint32_t sum = 0;
-    for (auto b : data) {
-        sum += b;
-    }
-    return static_cast<uint16_t>(sum & 0xFFFF);
+uint16_t PacketA::calculateChecksum(std::span<const uint8_t> data) {
+    return checksum::sum16(data);
 }
 
-// 反序列化，成功则返回PacketA智能指针，失败返回nullptr
-std::shared_ptr<BasePacket> PacketA::deserialize(const std::vector<uint8_t>& raw) {
-    if (raw.size() < 2+1+2+4+2) return nullptr; // 长度至少头部+校验
+bool PacketA::decode(std::span<const uint8_t> raw, View& view) {
+    if (raw.size() < 2+1+2+4+2) return false; // 长度至少头部+校验
     // TypeID
     uint16_t TypeID = (raw[0] << 8) | raw[1];
-    if (TypeID != TYPE_ID) return nullptr;
+    if (TypeID != TYPE_ID) return false;
 
     // Version
     uint8_t ver = raw[2];
-    if (ver != VERSION) return nullptr;
+    if (ver != VERSION) return false;
 
     // Magic校验
     uint16_t magic = (raw[3] << 8) | raw[4];
-    if (magic != MAGIC) return nullptr;
+    if (magic != MAGIC) return false;
 
     // Length
-    uint32_t length = (raw[5] << 24) | (raw[6] << 16) | (raw[7] << 8) | raw[8];
-    if (raw.size() != 2+1+2+4 + length + 2) return nullptr; // 长度不符
+    uint32_t length = (uint32_t(raw[5]) << 24) | (raw[6] << 16) | (raw[7] << 8) | raw[8];
+    if (raw.size() != 2+1+2+4 + size_t(length) + 2) return false; // 长度不符
 
-    // Payload
-    std::vector<uint8_t> payload(raw.begin() + 9, raw.begin() + 9 + length);
-
-    // Checksum 校验
+    // Checksum 校验：直接在原始数据上计算
     uint16_t checksum = (raw[9 + length] << 8) | raw[9 + length + 1];
-    if (calculateChecksum(payload) != checksum) {
-        return nullptr;
-    }
+    std::span<const uint8_t> payload = raw.subspan(9, length);
+    if (calculateChecksum(payload) != checksum) return false;
 
-    return std::make_shared<PacketA>(std::move(payload));
+    view.payload = payload;
+    return true;
 }
 
+// 反序列化，成功则返回PacketA智能指针，失败返回nullptr
+std::shared_ptr<BasePacket> PacketA::deserialize(const std::vector<uint8_t>& raw) {
+    View view;
+    if (!decode(raw, view)) return nullptr;
+    // 校验通过后才拷贝 payload
+    return std::make_shared<PacketA>(
+        std::vector<uint8_t>(view.payload.begin(), view.payload.end()));
+}
@@ -1,6 +1,5 @@
 // PacketB.cpp
-#pragma once
-#include "net/packet//PacketB.hpp"
+#include "net/packet/PacketB.hpp"
 /*
 +------------+--------+------------+----------------+
 | TypeID(2) | Ver(1) | Length(4B) | Payload(n字节) | 
@@ -13,6 +12,10 @@ uint16_t PacketB::getTypeID() const {
     return TYPE_ID;
 }
 
+uint8_t PacketB::getVersion() const {
+    return VERSION;
+}
+
 std::vector<uint8_t> PacketB::serialize() const {
     std::vector<uint8_t> buffer;
     // 头部固定长度 = 2 + 1 + 4 + payload
@@ -39,25 +42,28 @@ std::vector<uint8_t> PacketB::serialize() const {
     return buffer;
 }
 
-// 反序列化，成功则返回PacketB智能指针，失败返回nullptr
-std::shared_ptr<BasePacket> PacketB::deserialize(const std::vector<uint8_t>& raw) {
-    if (raw.size() < 2+1+2+4+2) return nullptr; // 长度至少头部+校验
+bool PacketB::decode(std::span<const uint8_t> raw, View& view) {
+    if (raw.size() < 2+1+4) return false; // 长度至少为头部
     // TypeID
     uint16_t TypeID = (raw[0] << 8) | raw[1];
-    if (TypeID != TYPE_ID) return nullptr;
+    if (TypeID != TYPE_ID) return false;
 
     // Version
     uint8_t ver = raw[2];
-    if (ver != VERSION) return nullptr;
+    if (ver != VERSION) return false;
 
     // Length
-    uint32_t length = (raw[5] << 24) | (raw[6] << 16) | (raw[7] << 8) | raw[8];
-    if (raw.size() != 2+1+2+4 + length + 2) return nullptr; // 长度不符
-
-    // Payload
-    std::vector<uint8_t> payload(raw.begin() + 9, raw.begin() + 9 + length);
+    uint32_t length = (uint32_t(raw[3]) << 24) | (raw[4] << 16) | (raw[5] << 8) | raw[6];
+    if (raw.size() != 2+1+4 + size_t(length)) return false; // 长度不符
 
-    return std::make_shared<PacketB>(std::move(payload));
+    view.payload = raw.subspan(7, length);
+    return true;
 }
 
-
+// 反序列化，成功则返回PacketB智能指针，失败返回nullptr
+std::shared_ptr<BasePacket> PacketB::deserialize(const std::vector<uint8_t>& raw) {
+    View view;
+    if (!decode(raw, view)) return nullptr;
+    return std::make_shared<PacketB>(
+        std::vector<uint8_t>(view.payload.begin(), view.payload.end()));
+}
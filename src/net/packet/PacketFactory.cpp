@@ -1,4 +1,4 @@
-#include "net/packet/PacketRegistry.hpp"
+#include "net/packet/PacketFactory.hpp"
 
 PacketFactory& PacketFactory::instance() {
     static PacketFactory factory;
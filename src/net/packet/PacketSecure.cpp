@@ -3,10 +3,13 @@
 // +-----------+---------+--------+--------+------------+-------------+
 
 #include "net/packet/PacketSecure.hpp"
+#include <algorithm>
 #include <cstdint>
 #include <openssl/aes.h>
 #include <openssl/rand.h>
 
+#include "net/Checksum.hpp"
+
 PacketSecure::PacketSecure(std::string payload, 
                             bool compress, 
                             bool encrypt, uint8_t ver)
@@ -15,21 +18,67 @@ PacketSecure::PacketSecure(std::string payload,
     setFlag(SecurityFlags::COMPRESSED, compress);
     setFlag(SecurityFlags::ENCRYPTED, encrypt);
 
+    iv.resize(IV_SIZE);
     if (encrypt) {
-        iv.resize(16);
         RAND_bytes(iv.data(), iv.size());
     }
 }
 
+namespace {
+
+constexpr uint8_t kCompressionMask =
+    compression::kFlagCompressed | compression::kFlagZstd |
+    compression::kFlagStream | compression::kFlagDictionary;
+constexpr uint8_t kEncryptedFlag =
+    static_cast<uint8_t>(PacketSecure::SecurityFlags::ENCRYPTED);
+constexpr uint8_t kKnownFlags = kCompressionMask | kEncryptedFlag;
+
+std::span<const uint8_t> bytesOf(const std::string& s) {
+    return {reinterpret_cast<const uint8_t*>(s.data()), s.size()};
+}
+
+}  // namespace
+
 std::vector<uint8_t> PacketSecure::serialize() const {
+    if (!hasFlag(SecurityFlags::COMPRESSED)) {
+        return encode(bytesOf(raw_payload), flags & ~kCompressionMask);
+    }
+    std::string compressed;
+    uint8_t compression_flags = 0;
+    if (!compression::compress(compression::Options{}, bytesOf(raw_payload),
+                               compressed, compression_flags)) {
+        return encode(bytesOf(raw_payload), flags & ~kCompressionMask);
+    }
+    return encode(bytesOf(compressed),
+                  (flags & ~kCompressionMask) | compression_flags);
+}
+
+std::vector<uint8_t> PacketSecure::serialize(
+    compression::Compressor& compressor) const {
+    if (!hasFlag(SecurityFlags::COMPRESSED)) {
+        return encode(bytesOf(raw_payload), flags & ~kCompressionMask);
+    }
+    std::string compressed;
+    uint8_t compression_flags = 0;
+    if (!compressor.compress(bytesOf(raw_payload), compressed,
+                             compression_flags)) {
+        return encode(bytesOf(raw_payload), flags & ~kCompressionMask);
+    }
+    return encode(bytesOf(compressed),
+                  (flags & ~kCompressionMask) | compression_flags);
+}
+
+std::vector<uint8_t> PacketSecure::encode(std::span<const uint8_t> payload,
+                                          uint8_t wire_flags) const {
     std::vector<uint8_t> buffer;
+    buffer.reserve(OVERHEAD + payload.size());
 
     // TypeID
     buffer.push_back((TYPE_ID >> 8) & 0xFF);
     buffer.push_back(TYPE_ID & 0xFF);
 
     // Flags
-    buffer.push_back(flags);
+    buffer.push_back(wire_flags);
 
     // 原始长度
     uint32_t raw_len = raw_payload.size();
@@ -38,40 +87,103 @@ std::vector<uint8_t> PacketSecure::serialize() const {
     buffer.push_back((raw_len >> 8) & 0xFF);
     buffer.push_back((raw_len) & 0xFF);
 
-    // IV
-    buffer.insert(buffer.end(), iv.begin(), iv.end());
+    // IV：固定 16 字节，不足补零
+    buffer.insert(buffer.end(), iv.begin(), iv.begin() + std::min(iv.size(), IV_SIZE));
+    buffer.resize(2 + 1 + 4 + IV_SIZE, 0);
 
-    // Payload：此处未真正实现压缩/加密逻辑
-    std::vector<uint8_t> encoded_payload(raw_payload.begin(), raw_payload.end());
-    buffer.insert(buffer.end(), encoded_payload.begin(), encoded_payload.end());
+    // Payload：已按 wire_flags 压缩；加密逻辑此处未实现
+    size_t payload_offset = buffer.size();
+    buffer.insert(buffer.end(), payload.begin(), payload.end());
 
-    // Checksum（简化实现）
-    uint16_t checksum = 0xFFFF;
+    // Checksum：编码后 payload 的字节和
+    uint16_t checksum = checksum::sum16(
+        std::span<const uint8_t>(buffer).subspan(payload_offset));
     buffer.push_back((checksum >> 8) & 0xFF);
     buffer.push_back(checksum & 0xFF);
 
     return buffer;
 }
-std::shared_ptr<IPacket> PacketSecure::deserialize(const std::vector<uint8_t>& data) {
-    if (data.size() < 2 + 1 + 4 + 16 + 2) return nullptr;
+bool PacketSecure::decode(std::span<const uint8_t> data, View& view) {
+    if (data.size() < OVERHEAD) return false;
 
-    PacketSecure pkt;
+    uint16_t type_id = (data[0] << 8) | data[1];
+    if (type_id != TYPE_ID) return false;
 
     size_t offset = 2;
-    pkt.flags = data[offset++];
+    uint8_t flags = data[offset++];
 
-    uint32_t length = (data[offset] << 24) | (data[offset + 1] << 16) |
+    uint32_t length = (uint32_t(data[offset]) << 24) | (data[offset + 1] << 16) |
                       (data[offset + 2] << 8) | (data[offset + 3]);
     offset += 4;
 
-    pkt.iv.assign(data.begin() + offset, data.begin() + offset + 16);
-    offset += 16;
+    std::span<const uint8_t> iv = data.subspan(offset, IV_SIZE);
+    offset += IV_SIZE;
 
-    size_t payload_size = data.size() - offset - 2;  // excluding checksum
-    std::string payload(data.begin() + offset, data.begin() + offset + payload_size);
-    pkt.raw_payload = std::move(payload);
+    // 未定义的位，或没有 COMPRESSED 却带压缩算法 / 上下文位的组合都视为非法
+    if (flags & ~kKnownFlags) return false;
+    if ((flags & kCompressionMask) &&
+        !(flags & compression::kFlagCompressed)) {
+        return false;
+    }
+
+    std::span<const uint8_t> payload = data.subspan(offset, data.size() - OVERHEAD);
+    // 未压缩/未加密时编码长度就是原始长度
+    if (!(flags & (compression::kFlagCompressed | kEncryptedFlag)) &&
+        payload.size() != length) {
+        return false;
+    }
+
+    uint16_t checksum = (data[data.size() - 2] << 8) | data[data.size() - 1];
+    if (checksum::sum16(payload) != checksum) return false;
+
+    view.flags = flags;
+    view.raw_length = length;
+    view.iv = iv;
+    view.payload = payload;
+    return true;
+}
+
+bool PacketSecure::restorePayload(const View& view, std::string& out,
+                                  compression::Decompressor* decompressor) {
+    if (view.flags & kEncryptedFlag) return false;
+    if (!(view.flags & compression::kFlagCompressed)) {
+        if (view.payload.size() != view.raw_length) return false;
+        out.assign(view.payload.begin(), view.payload.end());
+        return true;
+    }
+    if (view.raw_length > MAX_RAW_LENGTH) return false;
+    if (decompressor) {
+        return decompressor->decompress(view.flags, view.payload,
+                                        view.raw_length, out);
+    }
+    return compression::decompress(view.flags, view.payload, view.raw_length,
+                                   out);
+}
 
-    // 解压/解密略...
+std::shared_ptr<BasePacket> PacketSecure::deserialize(const std::vector<uint8_t>& data) {
+    return deserializeImpl(data, nullptr);
+}
 
-    return std::make_shared<PacketSecure>(pkt);
+std::shared_ptr<BasePacket> PacketSecure::deserializeWith(
+    const std::vector<uint8_t>& data, compression::Decompressor& decompressor) {
+    return deserializeImpl(data, &decompressor);
+}
+
+std::shared_ptr<BasePacket> PacketSecure::deserializeImpl(
+    const std::vector<uint8_t>& data, compression::Decompressor* decompressor) {
+    View view;
+    if (!decode(data, view)) return nullptr;
+
+    auto pkt = std::make_shared<PacketSecure>();
+    pkt->iv.assign(view.iv.begin(), view.iv.end());
+    if (view.flags & static_cast<uint8_t>(SecurityFlags::ENCRYPTED)) {
+        // 解密略：保留编码后的 payload 与全部标志位
+        pkt->flags = view.flags;
+        pkt->raw_payload.assign(view.payload.begin(), view.payload.end());
+        return pkt;
+    }
+    if (!restorePayload(view, pkt->raw_payload, decompressor)) return nullptr;
+    // 还原后只保留调用方语义上的标志位，重新 serialize 时按发送方的上下文重新压缩
+    pkt->flags = view.flags & static_cast<uint8_t>(SecurityFlags::COMPRESSED);
+    return pkt;
 }
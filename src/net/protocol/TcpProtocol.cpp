@@ -1,20 +1,17 @@
-#include "net/TcpProtocol.hpp"
+#include "net/protocol/TcpProtocol.hpp"
 
 #include <arpa/inet.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <cstring>
 #include <stdexcept>
-#include <vector>
-#include "net/BaseProtocol.hpp"
 
 // 构造函数：初始化 socket 描述符和缓冲区
 TcpProtocol::TcpProtocol(int socket_fd)
     : sockfd_(socket_fd)  // 初始化列表优于函数体内赋值
       ,
-      send_buffer_()  // 显式初始化（可选，但提高可读性）
-      ,
-      recv_buffer_() {
+      recv_buffer_(kInitialReadSize) {
     if (socket_fd < 0) {
         throw std::invalid_argument(
             "Invalid socket descriptor");  // 参数合法性检查
@@ -22,94 +19,222 @@ TcpProtocol::TcpProtocol(int socket_fd)
 }
 
 // 析构函数：无需关闭 socket（由 Connection 类管理）
-TcpProtocol::~TcpProtocol() {
-    // 清空缓冲区（实际可省略，vector 析构时会自动释放）
-    send_buffer_.clear();
-    recv_buffer_.clear();
-}
+TcpProtocol::~TcpProtocol() = default;
 
-// 将接收到的数据包放入发送缓存区
+// 将数据包放入发送队列：header/length/checksum 内联，payload 单独成段
 void TcpProtocol::enqueuePacket(const Packet &pkt) {
-    auto data = pkt.serialize();
-    send_buffer_.insert(send_buffer_.end(), data.begin(), data.end());
+    send_queue_.beginFrame(pkt.header);
+    send_queue_.appendCopy(pkt.payload);
+    send_queue_.endFrame(pkt.checksum);
+}
+
+void TcpProtocol::enqueuePacket(Packet &&pkt) {
+    send_queue_.beginFrame(pkt.header);
+    send_queue_.appendOwned(std::move(pkt.payload));
+    send_queue_.endFrame(pkt.checksum);
 }
 
 bool TcpProtocol::flushSendBuffer(int &saved_errno) {
     saved_errno = 0;
-    size_t total_sent = 0;
-    while (total_sent < send_buffer_.size()) {
-        ssize_t n = ::send(sockfd_, send_buffer_.data() + total_sent,
-                           send_buffer_.size() - total_sent, MSG_NOSIGNAL);
+    while (!send_queue_.empty()) {
+        // 一次 sendmsg 提交多个片段；部分写只推进偏移
+        ssize_t n = send_queue_.writeTo(sockfd_);
         if (n > 0) {
-            total_sent += n;
-        } else {
-            saved_errno = errno;
-            if (errno == EAGAIN || errno == EWOULDBLOCK) {
-                // 内核缓冲区已满，等待下次 EPOLLOUT
-                break;
-            }
-            return false;
+            continue;
+        }
+        if (n == 0) {
+            // 只剩尚未 endFrame 的帧
+            break;
+        }
+        if (errno == EINTR) {
+            continue;
         }
+        saved_errno = errno;
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            // 内核缓冲区已满，等待下次 EPOLLOUT
+            break;
+        }
+        return false;
     }
-    // 删除已发送的数据
-    send_buffer_.erase(send_buffer_.begin(), send_buffer_.begin() + total_sent);
     return true;
 }
 
 BaseProtocol::ReadStatus TcpProtocol::tryReceivePacket(Packet &pkt) {
+    PacketView view;
+    ReadStatus status = tryReceiveView(view);
+    if (status == ReadStatus::OK) {
+        // 需要所有权时才物化，物化后立即归还缓冲区
+        pkt = view.toPacket();
+        releaseView();
+    }
+    return status;
+}
+
+BaseProtocol::ReadStatus TcpProtocol::tryReceiveView(PacketView &view) {
+    // 上一个视图到此失效
+    releaseView();
+
     // 1) 先从缓冲区尝试解析
-    if (parseFromBuffer(recv_buffer_, pkt)) {
+    if (parseFromBuffer(recv_buffer_, view)) {
         return ReadStatus::OK;
     }
+    // 对端已关闭且缓冲区内的完整包都已取走
+    if (peer_closed_) {
+        return ReadStatus::Error;
+    }
 
-    // 2) 从 socket 再读数据
-    uint8_t buf[4096];
-    ssize_t n = ::recv(sockfd_, buf, sizeof(buf), 0);
-    if (n > 0) {
-        recv_buffer_.insert(recv_buffer_.end(), buf, buf + n);
-        // 再次尝试解析
-        if (parseFromBuffer(recv_buffer_, pkt)) {
-            return ReadStatus::OK;
-        } else {
-            return ReadStatus::NeedRetry;
-        }
+    // 2) 把 socket 一次读到 EAGAIN（EPOLLET 要求），再次尝试解析
+    FillStatus status = fillFromSocket();
+    if (parseFromBuffer(recv_buffer_, view)) {
+        return ReadStatus::OK;
     }
 
     // 3) 处理连接关闭和错误
-    if (n == 0) {
-        // 对端正常关闭
-        return ReadStatus::Error;
-    } else {
-        // n < 0
-        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+    switch (status) {
+        case FillStatus::Drained:
+        case FillStatus::BudgetExhausted:
             // 非阻塞下读空了，后续等待 EPOLLIN 再来
             return ReadStatus::NeedRetry;
-        } else {
-            // 真正的错误
+        case FillStatus::Closed:
+        case FillStatus::Error:
+        default:
             return ReadStatus::Error;
+    }
+}
+
+void TcpProtocol::appendReceived(std::span<const uint8_t> data) {
+    // 追加前先归还上一个视图，避免扩容/搬移使视图悬空
+    releaseView();
+    if (data.empty()) return;
+    uint8_t *dst = recv_buffer_.prepareWrite(data.size());
+    memcpy(dst, data.data(), data.size());
+    recv_buffer_.commitWrite(data.size());
+}
+
+BaseProtocol::ReadStatus TcpProtocol::tryParseView(PacketView &view) {
+    releaseView();
+    return parseFromBuffer(recv_buffer_, view) ? ReadStatus::OK
+                                                : ReadStatus::NeedRetry;
+}
+
+size_t TcpProtocol::takeBuffered(void *out, size_t max) {
+    releaseView();
+    size_t n = std::min(max, recv_buffer_.readableBytes());
+    if (n == 0) return 0;
+    memcpy(out, recv_buffer_.peek(), n);
+    recv_buffer_.consume(n);
+    // 此前按缓冲区开头估算的帧长已不再成立
+    expected_frame_size_ = 0;
+    return n;
+}
+
+void TcpProtocol::releaseView() {
+    if (pending_consume_ == 0) return;
+    // 从缓冲区消费已处理数据：O(1)，仅移动读指针
+    recv_buffer_.consume(pending_consume_);
+    pending_consume_ = 0;
+    // 大帧处理完后把缓冲区缩回常规大小
+    recv_buffer_.shrinkIfIdle(kMaxReadSize);
+}
+
+TcpProtocol::FillStatus TcpProtocol::fillFromSocket() {
+    size_t total = 0;
+    int flags = 0;
+    while (true) {
+        size_t want = nextReadSize();
+        uint8_t *dst = recv_buffer_.prepareWrite(want);
+        ssize_t n = ::recv(sockfd_, dst, want, flags);
+        if (n > 0) {
+            recv_buffer_.commitWrite(n);
+            adaptReadSize(n, want);
+            total += n;
+            // 达到预算且缓冲区里确有完整帧：先交给上层处理，上层会继续调用直到 NeedRetry。
+            // 必须按缓冲区实际内容判断，否则在 EPOLLET 下半帧返回会丢失后续读事件
+            if (total >= kMaxBytesPerPass && hasCompleteFrame()) {
+                return FillStatus::BudgetExhausted;
+            }
+            // 第一次 recv 之后改为 MSG_DONTWAIT：阻塞 socket（客户端）也能读到
+            // EAGAIN 而不会卡住
+            flags = MSG_DONTWAIT;
+            continue;
+        }
+        if (n == 0) {
+            // 对端正常关闭
+            peer_closed_ = true;
+            return FillStatus::Closed;
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return FillStatus::Drained;
+        }
+        // 真正的错误
+        peer_closed_ = true;
+        return FillStatus::Error;
+    }
+}
+
+bool TcpProtocol::hasCompleteFrame() const {
+    size_t readable = recv_buffer_.readableBytes();
+    if (readable < PacketView::kHeaderSize) return false;
+    return readable >= PacketView::peekFrameSize(recv_buffer_.peek());
+}
+
+size_t TcpProtocol::nextReadSize() const {
+    size_t want = read_size_;
+    // 已知正在接收的大帧还差多少字节时放大读窗口，让单次 recv 能读满 socket 接收缓冲区；
+    // 长度字段来自对端，预留上限为 kMaxReadSize，缓冲区只随实际到达的数据增长
+    size_t readable = recv_buffer_.readableBytes();
+    if (expected_frame_size_ > readable) {
+        want = std::max(want, std::min(expected_frame_size_ - readable,
+                                       kMaxReadSize));
+    }
+    return want;
+}
+
+void TcpProtocol::adaptReadSize(size_t received, size_t requested) {
+    if (received == requested) {
+        // 读满了窗口，说明内核里可能还有更多数据
+        read_size_ = std::min(read_size_ * 2, kMaxReadSize);
+        small_reads_ = 0;
+    } else if (received < read_size_ / 4) {
+        // 连续两次读到的数据远小于窗口才缩小，避免抖动
+        if (++small_reads_ >= 2) {
+            read_size_ = std::max(read_size_ / 2, kMinReadSize);
+            small_reads_ = 0;
         }
+    } else {
+        small_reads_ = 0;
     }
 }
 
-bool TcpProtocol::parseFromBuffer(std::vector<uint8_t> &buffer, Packet &pkt) {
+bool TcpProtocol::parseFromBuffer(RecvBuffer &buffer, PacketView &view) {
     // 包头长度不足，无法解析
-    if (buffer.size() < 6) return false;
+    if (buffer.readableBytes() < PacketView::kHeaderSize) return false;
 
+    // 先校验魔数再信任长度字段：伪造的帧头不能让缓冲区按其声明的长度预留空间
+    if (!PacketView::isKnownHeader(PacketView::peekHeader(buffer.peek()))) {
+        throw std::runtime_error("Invalid packet header");
+    }
     // 解析 payload 长度
-    uint32_t network_length;
-    memcpy(&network_length, buffer.data() + 2, 4);  // 从第3字节开始取4字节
-    uint32_t payload_length = ntohl(network_length);
-    size_t total_needed = 6 + payload_length + 2;  // 包头+payload+校验和
+    uint32_t payload_length = PacketView::peekPayloadLength(buffer.peek());
+    if (payload_length > kMaxPayloadLength) {
+        throw std::runtime_error("Packet payload too large");
+    }
+    // 包头+payload+校验和（长度由 header 决定）
+    size_t total_needed = PacketView::peekFrameSize(buffer.peek());
 
     // 检查缓冲区是否足够
-    if (buffer.size() < total_needed) return false;
-
-    // 提取完整包数据
-    std::vector<uint8_t> packet_data(buffer.begin(),
-                                     buffer.begin() + total_needed);
-    pkt = Packet::deserialize(packet_data);
+    if (buffer.readableBytes() < total_needed) {
+        expected_frame_size_ = total_needed;
+        return false;
+    }
+    expected_frame_size_ = 0;
 
-    // 从缓冲区删除已处理数据
-    buffer.erase(buffer.begin(), buffer.begin() + total_needed);
+    // 在缓冲区上原地校验并建立视图，不拷贝帧数据
+    PacketView::parse({buffer.peek(), buffer.readableBytes()}, view);
+    // 视图失效前不能消费，推迟到下一次接收或 releaseView()
+    pending_consume_ = total_needed;
     return true;
 }
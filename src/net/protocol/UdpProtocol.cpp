@@ -1,53 +1,357 @@
 // UdpProtocol.cpp
-#include "net/UdpProtocol.hpp"
+#include "net/protocol/UdpProtocol.hpp"
+
+#include <arpa/inet.h>
+#include <netinet/udp.h>
 #include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
 #include <stdexcept>
-#include <sys/socket.h>
 
-UdpProtocol::UdpProtocol(int socket_fd, sockaddr_in peer_addr)
-    : sockfd_(socket_fd), peer_(peer_addr) {
-        if (socket_fd < 0) {
-            throw std::invalid_argument(
-                "Invalid socket descriptor");  // 参数合法性检查
-        }
+namespace {
+
+// 一条 GSO 消息最多切出的段数（内核 UDP_MAX_SEGMENTS，老内核为 64）
+constexpr size_t kMaxGsoSegments = 64;
+// 参与 GSO 的单段上限：超过路径 MTU 时内核拒绝整条消息，按以太网 MTU 取保守值
+constexpr size_t kMaxGsoSegmentSize = 1472;
+constexpr size_t kInitialSendArea = 64 * 1024;
+
+bool samePeer(const sockaddr_in& a, const sockaddr_in& b) {
+    return a.sin_port == b.sin_port && a.sin_addr.s_addr == b.sin_addr.s_addr;
+}
+
+}  // namespace
+
+UdpProtocol::UdpProtocol(int socket_fd) : UdpProtocol(socket_fd, Options()) {}
+
+UdpProtocol::UdpProtocol(int socket_fd, sockaddr_in peer)
+    : UdpProtocol(socket_fd, peer, Options()) {}
+
+UdpProtocol::UdpProtocol(int socket_fd, sockaddr_in peer,
+                         const Options& options)
+    : UdpProtocol(socket_fd, options) {
+    peer_ = peer;
+}
+
+UdpProtocol::UdpProtocol(int socket_fd, const Options& options)
+    : sockfd_(socket_fd),
+      batch_size_(std::max<size_t>(options.batch_size, 1)),
+      slot_size_(std::clamp<size_t>(options.max_datagram, 64, kMaxDatagram)),
+      gso_(options.gso),
+      gro_(options.gro) {
+    if (socket_fd < 0) {
+        throw std::invalid_argument(
+            "Invalid socket descriptor");  // 参数合法性检查
     }
+    setupReceive();
+
+    send_msgs_.resize(batch_size_);
+    send_iov_.resize(batch_size_);
+    send_control_.resize(batch_size_ * CMSG_SPACE(sizeof(uint16_t)));
+    send_counts_.resize(batch_size_);
+}
 
 UdpProtocol::~UdpProtocol() {
     if (sockfd_ >= 0) close(sockfd_);
 }
 
+void UdpProtocol::setupReceive() {
+    if (gro_) {
+        int one = 1;
+        // 内核不支持时退回逐报文接收
+        gro_ = setsockopt(sockfd_, SOL_UDP, UDP_GRO, &one, sizeof(one)) == 0;
+    }
+    // GRO 合并后的报文最长可达 64KB，槽位需要容纳整条
+    if (gro_) slot_size_ = 65536;
+
+    recv_slots_ = PoolBuffer(batch_size_ * slot_size_);
+    recv_msgs_.assign(batch_size_, mmsghdr{});
+    recv_iov_.resize(batch_size_);
+    recv_addrs_.resize(batch_size_);
+    size_t control_size = gro_ ? CMSG_SPACE(sizeof(int)) : 0;
+    recv_control_.assign(batch_size_ * control_size, 0);
+    for (size_t i = 0; i < batch_size_; ++i) {
+        recv_iov_[i].iov_base = recv_slots_.data() + i * slot_size_;
+        recv_iov_[i].iov_len = slot_size_;
+        msghdr& hdr = recv_msgs_[i].msg_hdr;
+        hdr.msg_name = &recv_addrs_[i];
+        hdr.msg_iov = &recv_iov_[i];
+        hdr.msg_iovlen = 1;
+        hdr.msg_control =
+            control_size ? recv_control_.data() + i * control_size : nullptr;
+    }
+    in_.reserve(batch_size_);
+}
+
+BaseProtocol::ReadStatus UdpProtocol::receiveBatch() {
+    in_.clear();
+    in_pos_ = 0;
+    size_t control_size = gro_ ? CMSG_SPACE(sizeof(int)) : 0;
+    for (mmsghdr& msg : recv_msgs_) {
+        // 每次调用前恢复输入长度，内核会改写它们
+        msg.msg_hdr.msg_namelen = sizeof(sockaddr_in);
+        msg.msg_hdr.msg_controllen = control_size;
+        msg.msg_hdr.msg_flags = 0;
+    }
+
+    int received;
+    do {
+        received = recvmmsg(sockfd_, recv_msgs_.data(),
+                            static_cast<unsigned>(batch_size_), MSG_DONTWAIT,
+                            nullptr);
+    } while (received < 0 && errno == EINTR);
+    if (received < 0) {
+        return (errno == EAGAIN || errno == EWOULDBLOCK) ? ReadStatus::NeedRetry
+                                                         : ReadStatus::Error;
+    }
+    ++stats_.recv_calls;
+
+    for (int i = 0; i < received; ++i) {
+        const msghdr& hdr = recv_msgs_[i].msg_hdr;
+        size_t length = recv_msgs_[i].msg_len;
+        if (hdr.msg_flags & MSG_TRUNC) {
+            ++stats_.dropped;
+            continue;
+        }
+        // GRO 合并的报文由 cmsg 给出原始数据报大小，除最后一段外都等长
+        size_t segment = length;
+        for (cmsghdr* cmsg = CMSG_FIRSTHDR(&hdr); cmsg != nullptr;
+             cmsg = CMSG_NXTHDR(const_cast<msghdr*>(&hdr), cmsg)) {
+            if (cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO) {
+                int gso_size;
+                memcpy(&gso_size, CMSG_DATA(cmsg), sizeof(gso_size));
+                if (gso_size > 0) segment = static_cast<size_t>(gso_size);
+            }
+        }
+        const uint8_t* base = static_cast<const uint8_t*>(recv_iov_[i].iov_base);
+        if (length == 0 || segment == 0) {
+            in_.push_back({{base, 0}, recv_addrs_[i]});
+            continue;
+        }
+        for (size_t offset = 0; offset < length; offset += segment) {
+            in_.push_back({{base + offset, std::min(segment, length - offset)},
+                           recv_addrs_[i]});
+        }
+    }
+    stats_.datagrams_in += in_.size();
+    return ReadStatus::OK;
+}
+
 BaseProtocol::ReadStatus UdpProtocol::tryReceivePacket(Packet& pkt) {
-    uint8_t buffer[4096];
-    socklen_t len = sizeof(peer_);
-    ssize_t received = recvfrom(sockfd_, buffer, sizeof(buffer), 0,
-                                (sockaddr*)&peer_, &len);
-    if (received > 0) {
-        std::vector<uint8_t> data(buffer, buffer + received);
-        pkt = Packet::deserialize(data);
-        return ReadStatus::OK;
-    } else if (received == 0 || (received < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
-        return ReadStatus::Error;
-    } else {
-        return ReadStatus::NeedRetry;
+    while (true) {
+        while (in_pos_ < in_.size()) {
+            const Datagram& datagram = in_[in_pos_++];
+            // 一个数据报恰好是一帧；校验失败的数据报只丢弃，不影响 socket 上的其他对端
+            try {
+                PacketView view;
+                if (PacketView::parse(datagram.data, view) &&
+                    view.frameSize() == datagram.data.size()) {
+                    pkt = view.toPacket();
+                    return ReadStatus::OK;
+                }
+            } catch (const std::runtime_error&) {
+            }
+            ++stats_.dropped;
+        }
+        ReadStatus status = receiveBatch();
+        if (status != ReadStatus::OK) return status;
     }
 }
 
-void UdpProtocol::enqueuePacket(const Packet& pkt) {
-    send_buffer_ = pkt.serialize(); // UDP 每次发送一个完整包
+uint8_t* UdpProtocol::reserveSend(size_t size) {
+    if (send_used_ + size > send_area_.capacity()) {
+        // 先把已发出的部分挤掉，仍不够再换更大的块
+        if (out_head_ > 0) {
+            size_t start = out_head_ < out_.size() ? out_[out_head_].offset
+                           : frame_start_ != SIZE_MAX ? frame_start_
+                                                      : send_used_;
+            memmove(send_area_.data(), send_area_.data() + start,
+                    send_used_ - start);
+            send_used_ -= start;
+            if (frame_start_ != SIZE_MAX) frame_start_ -= start;
+            out_.erase(out_.begin(), out_.begin() + out_head_);
+            out_head_ = 0;
+            for (Outbound& datagram : out_) datagram.offset -= start;
+        }
+        if (send_used_ + size > send_area_.capacity()) {
+            size_t capacity = std::max(send_area_.capacity() * 2,
+                                       std::max(send_used_ + size,
+                                                kInitialSendArea));
+            PoolBuffer bigger(capacity);
+            if (send_used_ > 0) {
+                memcpy(bigger.data(), send_area_.data(), send_used_);
+            }
+            send_area_ = std::move(bigger);
+        }
+    }
+    uint8_t* dst = send_area_.data() + send_used_;
+    send_used_ += size;
+    return dst;
 }
 
-bool UdpProtocol::flushSendBuffer(int& saved_errno) {
-    if (send_buffer_.empty()) return true;
-    ssize_t sent = sendto(sockfd_, send_buffer_.data(), send_buffer_.size(), 0,
-                          (sockaddr*)&peer_, sizeof(peer_));
-    if (sent < 0) {
-        saved_errno = errno;
+void UdpProtocol::beginFrame(const sockaddr_in& peer, uint16_t header) {
+    if (frame_start_ != SIZE_MAX) {
+        throw std::logic_error("UdpProtocol: nested beginFrame");
+    }
+    frame_start_ = send_used_;
+    frame_header_ = header;
+    frame_peer_ = peer;
+    // header(2) + length(4)，length 在 endFrame 时回填
+    uint8_t* dst = reserveSend(PacketView::kHeaderSize);
+    uint16_t network_header = htons(header);
+    memcpy(dst, &network_header, 2);
+}
+
+void UdpProtocol::appendFrame(std::span<const uint8_t> data) {
+    if (data.empty()) return;
+    memcpy(reserveSend(data.size()), data.data(), data.size());
+}
+
+bool UdpProtocol::endFrame() {
+    if (frame_start_ == SIZE_MAX) {
+        throw std::logic_error("UdpProtocol: endFrame without beginFrame");
+    }
+    size_t start = frame_start_;
+    frame_start_ = SIZE_MAX;
+    size_t payload_length = send_used_ - start - PacketView::kHeaderSize;
+    size_t trailer = Packet::trailerSize(frame_header_);
+    if (PacketView::kHeaderSize + payload_length + trailer > kMaxDatagram) {
+        send_used_ = start;
+        ++stats_.dropped;
         return false;
     }
-    send_buffer_.clear();
+
+    uint8_t* frame = send_area_.data() + start;
+    uint32_t network_length = htonl(static_cast<uint32_t>(payload_length));
+    memcpy(frame + 2, &network_length, 4);
+    uint32_t checksum = Packet::computeChecksum(
+        frame_header_, {frame + PacketView::kHeaderSize, payload_length});
+    // 追加校验字段可能换块，之后不再使用 frame
+    uint8_t* dst = reserveSend(trailer);
+    if (trailer == 4) {
+        uint32_t network_checksum = htonl(checksum);
+        memcpy(dst, &network_checksum, 4);
+    } else {
+        uint16_t network_checksum = htons(static_cast<uint16_t>(checksum));
+        memcpy(dst, &network_checksum, 2);
+    }
+    out_.push_back({start, static_cast<uint32_t>(send_used_ - start),
+                    frame_peer_});
     return true;
 }
 
-bool UdpProtocol::hasPendingSendData() const {
-    return !send_buffer_.empty();
+void UdpProtocol::enqueueDatagram(const sockaddr_in& peer,
+                                  std::span<const uint8_t> data) {
+    if (data.size() > kMaxDatagram) {
+        ++stats_.dropped;
+        return;
+    }
+    // 帧构建过程中不能插入其他数据报
+    if (frame_start_ != SIZE_MAX) {
+        throw std::logic_error("UdpProtocol: enqueueDatagram inside a frame");
+    }
+    uint8_t* dst = reserveSend(data.size());
+    if (!data.empty()) memcpy(dst, data.data(), data.size());
+    out_.push_back({send_used_ - data.size(),
+                    static_cast<uint32_t>(data.size()), peer});
+}
+
+void UdpProtocol::enqueuePacket(const Packet& pkt) {
+    beginFrame(peer_, pkt.header);
+    appendFrame({reinterpret_cast<const uint8_t*>(pkt.payload.data()),
+                 pkt.payload.size()});
+    endFrame();
+}
+
+size_t UdpProtocol::buildSendBatch(uint32_t* counts) {
+    size_t messages = 0;
+    size_t index = out_head_;
+    while (index < out_.size() && messages < batch_size_) {
+        const Outbound& first = out_[index];
+        size_t count = 1;
+        size_t bytes = first.size;
+        // 同一对端、等长、在发送区中连续的数据报合并成一条 GSO 消息，
+        // 只有最后一段允许更短
+        if (gso_ && first.size > 0 && first.size <= kMaxGsoSegmentSize) {
+            while (index + count < out_.size() && count < kMaxGsoSegments) {
+                const Outbound& next = out_[index + count];
+                if (next.size == 0 || next.size > first.size ||
+                    bytes + next.size > kMaxDatagram ||
+                    !samePeer(next.peer, first.peer)) {
+                    break;
+                }
+                bytes += next.size;
+                ++count;
+                if (next.size < first.size) break;
+            }
+        }
+
+        iovec& iov = send_iov_[messages];
+        iov.iov_base = send_area_.data() + first.offset;
+        iov.iov_len = bytes;
+        msghdr& hdr = send_msgs_[messages].msg_hdr;
+        hdr = msghdr{};
+        hdr.msg_name = const_cast<sockaddr_in*>(&first.peer);
+        hdr.msg_namelen = sizeof(sockaddr_in);
+        hdr.msg_iov = &iov;
+        hdr.msg_iovlen = 1;
+        if (count > 1) {
+            uint8_t* control =
+                send_control_.data() + messages * CMSG_SPACE(sizeof(uint16_t));
+            hdr.msg_control = control;
+            hdr.msg_controllen = CMSG_SPACE(sizeof(uint16_t));
+            cmsghdr* cmsg = CMSG_FIRSTHDR(&hdr);
+            cmsg->cmsg_level = SOL_UDP;
+            cmsg->cmsg_type = UDP_SEGMENT;
+            cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+            uint16_t gso_size = static_cast<uint16_t>(first.size);
+            memcpy(CMSG_DATA(cmsg), &gso_size, sizeof(gso_size));
+        }
+        counts[messages] = static_cast<uint32_t>(count);
+        index += count;
+        ++messages;
+    }
+    return messages;
+}
+
+bool UdpProtocol::flushSendBuffer(int& saved_errno) {
+    bool ok = true;
+    while (out_head_ < out_.size()) {
+        size_t messages = buildSendBatch(send_counts_.data());
+        int sent = sendmmsg(sockfd_, send_msgs_.data(),
+                            static_cast<unsigned>(messages), 0);
+        if (sent < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                saved_errno = errno;
+                return false;
+            }
+            // 内核或网卡不支持 GSO：关闭后按逐报文重发
+            if (gso_ && send_counts_[0] > 1 &&
+                (errno == EIO || errno == EINVAL || errno == ENOPROTOOPT)) {
+                gso_ = false;
+                continue;
+            }
+            // 单个对端不可达等错误只丢弃出错的这条消息，其余照常发送
+            saved_errno = errno;
+            ok = false;
+            stats_.dropped += send_counts_[0];
+            out_head_ += send_counts_[0];
+            continue;
+        }
+        ++stats_.send_calls;
+        for (int i = 0; i < sent; ++i) {
+            out_head_ += send_counts_[i];
+            stats_.datagrams_out += send_counts_[i];
+        }
+    }
+    // 全部发出后整块复用
+    if (frame_start_ == SIZE_MAX) {
+        out_.clear();
+        out_head_ = 0;
+        send_used_ = 0;
+    }
+    return ok;
 }
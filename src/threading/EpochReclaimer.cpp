@@ -0,0 +1,123 @@
+#include "threading/EpochReclaimer.hpp"
+
+#include <algorithm>
+
+// 线程退出时归还记录，避免已退出的线程阻塞纪元推进
+struct ThreadRecordOwner {
+    EpochReclaimer::ThreadRecord* record = nullptr;
+    ~ThreadRecordOwner() {
+        if (record) {
+            record->state.store(0, std::memory_order_release);
+            record->in_use.store(false, std::memory_order_release);
+        }
+    }
+};
+
+namespace {
+thread_local ThreadRecordOwner tls_record;
+}  // namespace
+
+EpochReclaimer::~EpochReclaimer() {
+    // 进程退出时不再有读者
+    for (auto& item : retired_) {
+        item.deleter(item.ptr);
+    }
+    ThreadRecord* rec = records_.load(std::memory_order_acquire);
+    while (rec) {
+        ThreadRecord* next = rec->next;
+        delete rec;
+        rec = next;
+    }
+}
+
+EpochReclaimer::ThreadRecord* EpochReclaimer::acquireRecord() {
+    // 先尝试复用已退出线程的记录
+    for (ThreadRecord* rec = records_.load(std::memory_order_acquire); rec;
+         rec = rec->next) {
+        bool expected = false;
+        if (!rec->in_use.load(std::memory_order_relaxed) &&
+            rec->in_use.compare_exchange_strong(expected, true,
+                                                std::memory_order_acq_rel)) {
+            return rec;
+        }
+    }
+    auto* rec = new ThreadRecord();
+    rec->in_use.store(true, std::memory_order_relaxed);
+    ThreadRecord* head = records_.load(std::memory_order_relaxed);
+    do {
+        rec->next = head;
+    } while (!records_.compare_exchange_weak(head, rec,
+                                             std::memory_order_release,
+                                             std::memory_order_relaxed));
+    return rec;
+}
+
+EpochReclaimer::ThreadRecord* EpochReclaimer::localRecord() {
+    if (!tls_record.record) {
+        tls_record.record = acquireRecord();
+    }
+    return tls_record.record;
+}
+
+void EpochReclaimer::enter() {
+    ThreadRecord* rec = localRecord();
+    if (rec->nesting++ > 0) return;
+    uint64_t epoch = global_epoch_.load(std::memory_order_relaxed);
+    rec->state.store((epoch << 1) | 1, std::memory_order_relaxed);
+    // 发布“已进入”之后才能读取共享指针
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+void EpochReclaimer::exit() {
+    ThreadRecord* rec = tls_record.record;
+    if (--rec->nesting > 0) return;
+    rec->state.store(0, std::memory_order_release);
+}
+
+bool EpochReclaimer::tryAdvance() {
+    uint64_t epoch = global_epoch_.load(std::memory_order_seq_cst);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    for (ThreadRecord* rec = records_.load(std::memory_order_acquire); rec;
+         rec = rec->next) {
+        uint64_t state = rec->state.load(std::memory_order_acquire);
+        if ((state & 1) && (state >> 1) != epoch) {
+            return false;  // 仍有读者停留在旧纪元
+        }
+    }
+    return global_epoch_.compare_exchange_strong(epoch, epoch + 1,
+                                                 std::memory_order_seq_cst);
+}
+
+void EpochReclaimer::retire(void* ptr, Deleter deleter) {
+    {
+        std::lock_guard<std::mutex> lock(retired_mutex_);
+        retired_.push_back(
+            {ptr, deleter, global_epoch_.load(std::memory_order_seq_cst)});
+    }
+    collect();
+}
+
+void EpochReclaimer::collect() {
+    tryAdvance();
+    std::vector<Retired> expired;
+    {
+        std::lock_guard<std::mutex> lock(retired_mutex_);
+        uint64_t epoch = global_epoch_.load(std::memory_order_seq_cst);
+        auto it = std::partition(
+            retired_.begin(), retired_.end(),
+            [epoch](const Retired& r) { return r.epoch + 2 > epoch; });
+        expired.assign(it, retired_.end());
+        retired_.erase(it, retired_.end());
+    }
+    // 在锁外执行析构，析构函数可能较重（关闭缓冲区、写日志等）
+    for (auto& item : expired) {
+        item.deleter(item.ptr);
+    }
+}
+
+void EpochReclaimer::drain() {
+    // 没有读者时每次都能推进，两轮即可让所有对象过期
+    for (int i = 0; i < 3; ++i) {
+        collect();
+    }
+}
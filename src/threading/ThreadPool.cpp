@@ -1,41 +1,106 @@
 #include "threading/ThreadPool.hpp"
 
-#include <mutex>
+#include <stdexcept>
 
-ThreadPool::ThreadPool(size_t threads) : stop(false) {
-    // 创建线程池中的线程
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace {
+// 当前线程所属的线程池与工作线程编号，用于工作线程内提交时走本地队列
+thread_local ThreadPool* tls_pool = nullptr;
+thread_local size_t tls_index = 0;
+
+inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+// xorshift64：挑选窃取对象，足够快且各线程独立
+inline uint64_t nextRandom(uint64_t& state) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+}  // namespace
+
+struct ThreadPool::NodeCache {
+    TaskNode* head = nullptr;
+
+    ~NodeCache() {
+        while (head != nullptr) {
+            TaskNode* next = head->next.load(std::memory_order_relaxed);
+            delete head;
+            head = next;
+        }
+    }
+};
+
+ThreadPool::Inbox::Inbox() : head_(&stub_), tail_(&stub_) {}
+
+void ThreadPool::Inbox::push(TaskNode* node) {
+    node->next.store(nullptr, std::memory_order_relaxed);
+    TaskNode* prev = head_.exchange(node, std::memory_order_acq_rel);
+    prev->next.store(node, std::memory_order_release);
+}
+
+ThreadPool::TaskNode* ThreadPool::Inbox::pop() {
+    TaskNode* tail = tail_;
+    TaskNode* next = tail->next.load(std::memory_order_acquire);
+    if (tail == &stub_) {
+        if (next == nullptr) return nullptr;
+        tail_ = next;
+        tail = next;
+        next = next->next.load(std::memory_order_acquire);
+    }
+    if (next != nullptr) {
+        tail_ = next;
+        return tail;
+    }
+    // tail 是最后一个节点：若生产者正在追加（head 已前移但 next 未链接），稍后再取
+    if (tail != head_.load(std::memory_order_acquire)) return nullptr;
+    push(&stub_);
+    next = tail->next.load(std::memory_order_acquire);
+    if (next != nullptr) {
+        tail_ = next;
+        return tail;
+    }
+    return nullptr;
+}
+
+ThreadPool::ThreadPool(size_t threads, size_t max_pending,
+                       TaskOverflowPolicy policy)
+    : stop(false), max_pending(max_pending), overflow_policy(policy) {
     for (size_t i = 0; i < threads; ++i) {
-        workers.emplace_back([this] {
-            while (true) {
-                Task task;
-                {
-                    // 加锁
-                    std::unique_lock<std::mutex> lock(mtx);
-                    cv.wait(lock, [this] { return stop || !tasks.empty(); });
-                    // 如果线程池停止并且任务队列为空，则退出循环
-                    if (stop && tasks.empty()) return;
-                    // 从任务队列中获取任务
-                    task = std::move(tasks.front());
-                    // 从任务队列中移除任务
-                    tasks.pop();
-                }
-                task();
-            }
-        });
+        queues.push_back(std::make_unique<Worker>());
+    }
+    // 队列全部就绪后再启动线程，窃取时可以安全遍历 queues
+    for (size_t i = 0; i < threads; ++i) {
+        workers.emplace_back([this, i] { workerLoop(i); });
     }
 }
 
 ThreadPool::~ThreadPool() {
     shutdown();
     wait();
+    TaskNode* node = free_nodes.exchange(nullptr, std::memory_order_acquire);
+    while (node != nullptr) {
+        TaskNode* next = node->next.load(std::memory_order_relaxed);
+        delete node;
+        node = next;
+    }
 }
 
 void ThreadPool::shutdown() {
-    {
-        std::unique_lock<std::mutex> lock(mtx);
-        stop = true;
+    stop.store(true, std::memory_order_seq_cst);
+    for (auto& w : queues) {
+        w->wake_seq.fetch_add(1, std::memory_order_seq_cst);
+        w->wake_seq.notify_all();
     }
-    cv.notify_all();
 }
 
 void ThreadPool::wait() {
@@ -46,15 +111,243 @@ void ThreadPool::wait() {
     }
 }
 
-void ThreadPool::enqueue(Task task) {
-    {
-        std::lock_guard<std::mutex> lock(mtx);
-        if (stop) {
-            throw std::runtime_error("Enqueue on stopped ThreadPool");
+bool ThreadPool::admit() {
+    if (max_pending == 0) return true;
+    if (admitted.fetch_add(1, std::memory_order_relaxed) < max_pending) {
+        return true;
+    }
+    admitted.fetch_sub(1, std::memory_order_relaxed);
+    return false;
+}
+
+bool ThreadPool::overflow(Task& task) {
+    if (overflow_policy == TaskOverflowPolicy::CallerRuns) {
+        caller_runs.fetch_add(1, std::memory_order_relaxed);
+        task();
+        return true;
+    }
+    rejected.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+bool ThreadPool::enqueue(Task task) {
+    if (stop.load(std::memory_order_acquire)) {
+        throw std::runtime_error("Enqueue on stopped ThreadPool");
+    }
+    if (queues.empty()) {
+        // 没有工作线程（如多 Reactor 模式）时直接执行，避免任务永远得不到处理
+        task();
+        return true;
+    }
+    if (!admit()) {
+        return overflow(task);
+    }
+
+    TaskNode* node = allocateNode(std::move(task));
+    if (tls_pool == this) {
+        // 工作线程内提交：压入自己的队列，无需任何同步
+        queues[tls_index]->deque.push(node);
+    } else {
+        size_t target =
+            next_worker.fetch_add(1, std::memory_order_relaxed) % queues.size();
+        Worker& w = *queues[target];
+        w.inbox_size.fetch_add(1, std::memory_order_relaxed);
+        w.inbox.push(node);
+    }
+    wakeOne();
+    return true;
+}
+
+bool ThreadPool::enqueuePinned(size_t worker, Task task) {
+    if (stop.load(std::memory_order_acquire)) {
+        throw std::runtime_error("Enqueue on stopped ThreadPool");
+    }
+    if (queues.empty()) {
+        task();
+        return true;
+    }
+    if (!admit()) {
+        return overflow(task);
+    }
+
+    TaskNode* node = allocateNode(std::move(task));
+    Worker& w = *queues[worker % queues.size()];
+    w.pinned_size.fetch_add(1, std::memory_order_relaxed);
+    w.pinned.push(node);
+    // 专属任务只有目标线程能执行，必须唤醒它本身
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    wakeWorker(w);
+    return true;
+}
+
+ThreadPool::TaskNode* ThreadPool::allocateNode(Task task) {
+    // 节点与具体线程池无关，同一线程向多个线程池提交也可以共用
+    static thread_local NodeCache cache;
+    if (cache.head == nullptr) {
+        cache.head = free_nodes.exchange(nullptr, std::memory_order_acquire);
+    }
+    TaskNode* node = cache.head;
+    if (node != nullptr) {
+        cache.head = node->next.load(std::memory_order_relaxed);
+    } else {
+        node = new TaskNode();
+    }
+    node->fn = std::move(task);
+    return node;
+}
+
+void ThreadPool::recycleNode(TaskNode* node) {
+    // 先释放任务持有的捕获对象，再放回空闲栈
+    node->fn = nullptr;
+    TaskNode* head = free_nodes.load(std::memory_order_relaxed);
+    do {
+        node->next.store(head, std::memory_order_relaxed);
+    } while (!free_nodes.compare_exchange_weak(head, node,
+                                               std::memory_order_release,
+                                               std::memory_order_relaxed));
+}
+
+void ThreadPool::wakeWorker(Worker& w) {
+    // exchange 保证多个提交方不会重复唤醒同一个线程
+    if (w.sleeping.load(std::memory_order_seq_cst) &&
+        w.sleeping.exchange(false, std::memory_order_seq_cst)) {
+        w.wake_seq.fetch_add(1, std::memory_order_seq_cst);
+        w.wake_seq.notify_one();
+    }
+}
+
+void ThreadPool::wakeOne() {
+    // 与 park() 中 sleeping 置位构成 Dekker 式配对：
+    // 要么这里看到挂起者并唤醒，要么挂起者在检查时看到刚提交的任务
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleepers.load(std::memory_order_seq_cst) == 0) return;
+    size_t n = queues.size();
+    size_t start = next_worker.load(std::memory_order_relaxed);
+    for (size_t k = 0; k < n; ++k) {
+        Worker& w = *queues[(start + k) % n];
+        if (w.sleeping.load(std::memory_order_seq_cst)) {
+            wakeWorker(w);
+            return;
         }
-        // 将任务添加到任务队列中
-        tasks.push(std::move(task));
     }
-    // notify_one 函数会唤醒一个等待的线程
-    cv.notify_one();
-}
\ No newline at end of file
+}
+
+ThreadPool::TaskNode* ThreadPool::takeInbox(Worker& victim, Worker& self) {
+    if (victim.inbox_size.load(std::memory_order_relaxed) == 0) return nullptr;
+    if (victim.inbox_busy.exchange(true, std::memory_order_acquire)) {
+        return nullptr;
+    }
+    // 把收件箱整体搬到自己的队列，之后其他线程可以再从这里窃取
+    TaskNode* first = nullptr;
+    int64_t moved = 0;
+    while (TaskNode* node = victim.inbox.pop()) {
+        ++moved;
+        if (first == nullptr) {
+            first = node;
+        } else {
+            self.deque.push(node);
+        }
+    }
+    victim.inbox_busy.store(false, std::memory_order_release);
+    if (moved > 0) {
+        victim.inbox_size.fetch_sub(moved, std::memory_order_relaxed);
+    }
+    return first;
+}
+
+ThreadPool::TaskNode* ThreadPool::takePinned(Worker& self) {
+    if (self.pinned_size.load(std::memory_order_relaxed) == 0) return nullptr;
+    TaskNode* node = self.pinned.pop();
+    if (node != nullptr) {
+        self.pinned_size.fetch_sub(1, std::memory_order_relaxed);
+    }
+    return node;
+}
+
+ThreadPool::TaskNode* ThreadPool::findTask(size_t index, uint64_t& rng) {
+    Worker& self = *queues[index];
+    // 专属任务优先：通常是连接 I/O，延迟敏感且只能由本线程执行
+    if (TaskNode* node = takePinned(self)) return node;
+    if (TaskNode* node = self.deque.pop()) return node;
+    if (TaskNode* node = takeInbox(self, self)) return node;
+
+    size_t n = queues.size();
+    if (n <= 1) return nullptr;
+    // 从随机位置开始遍历一圈，避免所有线程同时盯着同一个受害者
+    size_t start = nextRandom(rng) % n;
+    for (size_t k = 0; k < n; ++k) {
+        size_t victim = (start + k) % n;
+        if (victim == index) continue;
+        Worker& w = *queues[victim];
+        if (TaskNode* node = w.deque.steal()) return node;
+        if (TaskNode* node = takeInbox(w, self)) return node;
+    }
+    return nullptr;
+}
+
+size_t ThreadPool::pendingTasks() const {
+    int64_t pending = 0;
+    for (const auto& w : queues) {
+        pending += w->deque.sizeApprox();
+        pending += w->inbox_size.load(std::memory_order_relaxed);
+        pending += w->pinned_size.load(std::memory_order_relaxed);
+    }
+    return pending > 0 ? static_cast<size_t>(pending) : 0;
+}
+
+bool ThreadPool::hasPendingWork(size_t index) const {
+    if (queues[index]->pinned_size.load(std::memory_order_relaxed) > 0) {
+        return true;
+    }
+    for (const auto& w : queues) {
+        if (w->deque.sizeApprox() > 0 ||
+            w->inbox_size.load(std::memory_order_relaxed) > 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::park(size_t index) {
+    Worker& self = *queues[index];
+    self.sleeping.store(true, std::memory_order_seq_cst);
+    sleepers.fetch_add(1, std::memory_order_seq_cst);
+    uint32_t seq = self.wake_seq.load(std::memory_order_seq_cst);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!hasPendingWork(index) && !stop.load(std::memory_order_seq_cst)) {
+        self.wake_seq.wait(seq, std::memory_order_seq_cst);
+    }
+    self.sleeping.store(false, std::memory_order_seq_cst);
+    sleepers.fetch_sub(1, std::memory_order_seq_cst);
+}
+
+void ThreadPool::workerLoop(size_t index) {
+    tls_pool = this;
+    tls_index = index;
+    uint64_t rng = 0x9E3779B97F4A7C15ull * (index + 1);
+
+    while (true) {
+        TaskNode* node = findTask(index, rng);
+        // 短暂自旋：突发流量下任务往往很快到来，避免一次挂起/唤醒的系统调用
+        for (int i = 0; node == nullptr && i < kSpinRounds; ++i) {
+            cpuRelax();
+            node = findTask(index, rng);
+        }
+        if (node != nullptr) {
+            // 开始执行即归还积压名额
+            if (max_pending != 0) {
+                admitted.fetch_sub(1, std::memory_order_relaxed);
+            }
+            node->fn();
+            recycleNode(node);
+            continue;
+        }
+        // 停止后把已提交的任务全部执行完再退出
+        if (stop.load(std::memory_order_acquire)) {
+            if (!hasPendingWork(index)) return;
+            std::this_thread::yield();
+            continue;
+        }
+        park(index);
+    }
+}
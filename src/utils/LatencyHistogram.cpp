@@ -0,0 +1,64 @@
+#include "utils/LatencyHistogram.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+LatencyHistogram::Snapshot LatencyHistogram::snapshot() const {
+    Snapshot snap;
+    snap.counts.assign(kBucketCount, 0);
+    shards_.forEach([&snap](const Shard& shard) {
+        for (size_t i = 0; i < kBucketCount; ++i) {
+            snap.counts[i] += shard.counts[i].load(std::memory_order_relaxed);
+        }
+        snap.count += shard.count.load(std::memory_order_relaxed);
+        snap.sum += shard.sum.load(std::memory_order_relaxed);
+        snap.max =
+            std::max(snap.max, shard.max.load(std::memory_order_relaxed));
+    });
+    return snap;
+}
+
+void LatencyHistogram::reset() {
+    shards_.forEach([](Shard& shard) {
+        for (auto& c : shard.counts) c.store(0, std::memory_order_relaxed);
+        shard.count.store(0, std::memory_order_relaxed);
+        shard.sum.store(0, std::memory_order_relaxed);
+        shard.max.store(0, std::memory_order_relaxed);
+    });
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(size_t index) {
+    if (index < kSubBuckets) return index;
+    size_t group = index / kSubBuckets;  // >= 1
+    uint64_t sub = index % kSubBuckets;
+    uint32_t shift = static_cast<uint32_t>(group - 1);
+    return ((kSubBuckets + sub + 1) << shift) - 1;
+}
+
+uint64_t LatencyHistogram::Snapshot::percentile(double p) const {
+    if (count == 0) return 0;
+    p = std::clamp(p, 0.0, 100.0);
+    // 第 rank 个样本（从 1 开始）所在的桶
+    uint64_t rank = static_cast<uint64_t>(std::ceil(p / 100.0 * count));
+    rank = std::max<uint64_t>(rank, 1);
+    uint64_t seen = 0;
+    for (size_t i = 0; i < counts.size(); ++i) {
+        seen += counts[i];
+        if (seen >= rank) {
+            return std::min(bucketUpperBound(i), max);
+        }
+    }
+    return max;
+}
+
+void LatencyHistogram::Snapshot::merge(const Snapshot& other) {
+    if (counts.size() < other.counts.size()) {
+        counts.resize(other.counts.size(), 0);
+    }
+    for (size_t i = 0; i < other.counts.size(); ++i) {
+        counts[i] += other.counts[i];
+    }
+    count += other.count;
+    sum += other.sum;
+    max = std::max(max, other.max);
+}
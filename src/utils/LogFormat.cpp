@@ -0,0 +1,182 @@
+#include "utils/LogFormat.hpp"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace utils {
+
+namespace {
+
+struct DecodedArg {
+    LogArgType type;
+    int64_t i = 0;
+    uint64_t u = 0;
+    double d = 0;
+    std::string_view s;
+};
+
+// 从参数缓冲区取出下一个参数，数据不完整时返回 false
+bool nextArg(const uint8_t*& pos, const uint8_t* end, DecodedArg& arg) {
+    if (pos >= end) return false;
+    arg.type = static_cast<LogArgType>(*pos++);
+    switch (arg.type) {
+        case LogArgType::Int:
+        case LogArgType::UInt:
+        case LogArgType::Double:
+        case LogArgType::Pointer:
+            if (end - pos < 8) return false;
+            std::memcpy(&arg.u, pos, 8);
+            std::memcpy(&arg.i, pos, 8);
+            std::memcpy(&arg.d, pos, 8);
+            pos += 8;
+            return true;
+        case LogArgType::String: {
+            if (end - pos < 2) return false;
+            uint16_t length;
+            std::memcpy(&length, pos, 2);
+            pos += 2;
+            if (end - pos < length) return false;
+            arg.s = std::string_view(reinterpret_cast<const char*>(pos), length);
+            pos += length;
+            return true;
+        }
+    }
+    return false;
+}
+
+class Output {
+   public:
+    Output(char* out, size_t capacity) : out_(out), capacity_(capacity) {}
+
+    void append(const char* data, size_t size) {
+        size_t room = capacity_ > size_ + 1 ? capacity_ - size_ - 1 : 0;
+        size = std::min(size, room);
+        std::memcpy(out_ + size_, data, size);
+        size_ += size;
+    }
+    void append(std::string_view s) { append(s.data(), s.size()); }
+
+    // 用单个转换说明格式化一个值
+    template <typename T>
+    void appendFormatted(const std::string& spec, T value) {
+        char buffer[512];
+        int n = std::snprintf(buffer, sizeof(buffer), spec.c_str(), value);
+        if (n > 0) {
+            append(buffer, std::min(static_cast<size_t>(n), sizeof(buffer) - 1));
+        }
+    }
+
+    size_t finish() {
+        if (capacity_ > 0) out_[size_] = '\0';
+        return size_;
+    }
+
+   private:
+    char* out_;
+    size_t capacity_;
+    size_t size_ = 0;
+};
+
+}  // namespace
+
+size_t renderLogMessage(char* out, size_t capacity, const char* format,
+                        const uint8_t* args, size_t args_size) {
+    Output output(out, capacity);
+    const uint8_t* pos = args;
+    const uint8_t* end = args + args_size;
+    const char* p = format;
+
+    while (*p) {
+        const char* percent = std::strchr(p, '%');
+        if (!percent) {
+            output.append(p, std::strlen(p));
+            break;
+        }
+        output.append(p, static_cast<size_t>(percent - p));
+        p = percent + 1;
+        if (*p == '%') {
+            output.append("%", 1);
+            ++p;
+            continue;
+        }
+
+        // 保留 flags/width/precision，去掉长度修饰符，按实际参数类型重新补上
+        std::string spec = "%";
+        while (*p && std::strchr("-+ #0", *p)) spec += *p++;
+        while (*p >= '0' && *p <= '9') spec += *p++;
+        if (*p == '.') {
+            spec += *p++;
+            while (*p >= '0' && *p <= '9') spec += *p++;
+        }
+        while (*p && std::strchr("hlLqjzt", *p)) ++p;
+        char conv = *p;
+        if (!conv) break;
+        ++p;
+
+        DecodedArg arg;
+        if (!nextArg(pos, end, arg)) {
+            output.append("<missing>");
+            continue;
+        }
+        switch (conv) {
+            case 'd':
+            case 'i':
+            case 'u':
+            case 'o':
+            case 'x':
+            case 'X':
+            case 'c':
+                if (arg.type == LogArgType::String) {
+                    output.append(arg.s);
+                } else if (arg.type == LogArgType::Double) {
+                    output.appendFormatted("%g", arg.d);
+                } else if (conv == 'c') {
+                    output.appendFormatted(spec + 'c', static_cast<int>(arg.i));
+                } else if (conv == 'd' || conv == 'i') {
+                    output.appendFormatted(spec + "lld",
+                                           static_cast<long long>(arg.i));
+                } else {
+                    output.appendFormatted(spec + "ll" + conv,
+                                           static_cast<unsigned long long>(arg.u));
+                }
+                break;
+            case 'f':
+            case 'F':
+            case 'e':
+            case 'E':
+            case 'g':
+            case 'G':
+            case 'a':
+            case 'A':
+                if (arg.type == LogArgType::Double) {
+                    output.appendFormatted(spec + conv, arg.d);
+                } else if (arg.type == LogArgType::Int) {
+                    output.appendFormatted(spec + conv, static_cast<double>(arg.i));
+                } else if (arg.type == LogArgType::String) {
+                    output.append(arg.s);
+                } else {
+                    output.appendFormatted(spec + conv, static_cast<double>(arg.u));
+                }
+                break;
+            case 's':
+                if (arg.type == LogArgType::String) {
+                    // 参数里的字符串不以 '\0' 结尾，先复制一份再交给 snprintf
+                    std::string text(arg.s);
+                    output.appendFormatted(spec + 's', text.c_str());
+                } else {
+                    output.append("<bad-arg>");
+                }
+                break;
+            case 'p':
+                output.appendFormatted(spec + 'p',
+                                       reinterpret_cast<void*>(arg.u));
+                break;
+            default:
+                output.append("<bad-format>");
+                break;
+        }
+    }
+    return output.finish();
+}
+
+}  // namespace utils
@@ -0,0 +1,417 @@
+#include "utils/Logger.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+
+namespace utils {
+
+namespace {
+
+// 环中每条记录的头部
+struct RecordHeader {
+    int64_t timestamp_ns;
+    uint32_t size;    // 整条记录占用的字节数（含头部和对齐）
+    uint8_t level;
+    uint8_t flags;    // kTextRecord / kBinaryRecord / kPaddingRecord
+    uint16_t length;  // 头部之后的有效字节数
+};
+static_assert(sizeof(RecordHeader) == 16, "RecordHeader must be 16 bytes");
+
+constexpr uint8_t kTextRecord = 0;     // 正文为已格式化的文本
+constexpr uint8_t kBinaryRecord = 1;   // 正文为 格式串 id(u32) + 编码后的参数
+constexpr uint8_t kPaddingRecord = 2;  // 回绕前的填充
+constexpr size_t kRecordAlign = 16;
+// 后台线程空闲时的轮询间隔，也是异步日志的最大延迟
+constexpr auto kFlushInterval = std::chrono::milliseconds(5);
+// 输出缓冲区攒到这么多字节就 write 一次
+constexpr size_t kOutputBatchSize = 256 * 1024;
+
+const char* levelTag(LogLevel level) {
+    switch (level) {
+        case LogLevel::DEBUG:   return "[DEBUG] ";
+        case LogLevel::INFO:    return "[INFO] ";
+        case LogLevel::WARNING: return "[WARNING] ";
+        case LogLevel::ERROR:   return "[ERROR] ";
+        case LogLevel::FATAL:   return "[FATAL] ";
+    }
+    return "";
+}
+
+int64_t nowNanoseconds() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+// 热路径用的粗粒度时钟：精度为一个时钟节拍（毫秒级），日志只输出到秒，足够；
+// 在虚拟机上比 system_clock::now() 便宜数倍
+int64_t coarseNowNanoseconds() {
+    timespec ts;
+    clock_gettime(CLOCK_REALTIME_COARSE, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+bool writeAll(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t n = ::write(fd, data, size);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+}  // namespace
+
+const char* Logger::TimestampCache::format(int64_t seconds) {
+    if (seconds != second) {
+        time_t t = static_cast<time_t>(seconds);
+        struct tm tm_buf;
+        localtime_r(&t, &tm_buf);
+        strftime(text, sizeof(text), "%Y-%m-%d %H:%M:%S", &tm_buf);
+        second = seconds;
+    }
+    return text;
+}
+
+Logger::Logger() : currentLevel(LogLevel::INFO) {
+    formats_.push_back({LogLevel::INFO, "%s", "", 0});
+}
+
+Logger::~Logger() { stopAsync(); }
+
+uint32_t Logger::registerFormat(LogLevel level, const char* format,
+                                const char* file, int line) {
+    Logger& logger = getInstance();
+    std::lock_guard<std::mutex> lock(logger.formats_mutex_);
+    logger.formats_.push_back({level, format, file, line});
+    return static_cast<uint32_t>(logger.formats_.size() - 1);
+}
+
+Logger::FormatInfo Logger::formatInfo(uint32_t format_id) {
+    // 后台线程持有一份登记表副本，只有遇到新 id 时才加锁同步
+    if (format_id >= format_cache_.size()) {
+        std::lock_guard<std::mutex> lock(formats_mutex_);
+        format_cache_ = formats_;
+    }
+    if (format_id < format_cache_.size()) return format_cache_[format_id];
+    return {LogLevel::ERROR, "<unknown log format>", "", 0};
+}
+
+void Logger::write(LogLevel level, const char* message, size_t size) {
+    if (async_.load(std::memory_order_acquire)) {
+        pushRecord(level, kTextRecord, nullptr, 0, message, size);
+        if (level == LogLevel::FATAL) {
+            flush();
+        }
+    } else {
+        writeSync(level, message, size);
+    }
+}
+
+void Logger::pushBinary(LogLevel level, uint32_t format_id,
+                        const uint8_t* args, size_t size) {
+    pushRecord(level, kBinaryRecord, &format_id, sizeof(format_id), args, size);
+    if (level == LogLevel::FATAL) {
+        flush();
+    }
+}
+
+void Logger::writeSync(LogLevel level, const char* message, size_t size) {
+    int64_t seconds = nowNanoseconds() / 1000000000;
+    std::lock_guard<std::mutex> lock(logMutex);
+    const char* timestamp = sync_timestamp_.format(seconds);
+    std::fprintf(stdout, "%s %s%.*s\n", timestamp, levelTag(level),
+                 static_cast<int>(size), message);
+    std::fflush(stdout);
+}
+
+void Logger::pushRecord(LogLevel level, uint16_t flags, const void* prefix,
+                        size_t prefix_size, const void* body,
+                        size_t body_size) {
+    LogRing& ring = rings_.local();
+    constexpr size_t kMask = LogRing::kCapacity - 1;
+    size_t size = prefix_size + body_size;
+    size_t need = (sizeof(RecordHeader) + size + kRecordAlign - 1) &
+                  ~(kRecordAlign - 1);
+
+    uint64_t tail = ring.tail.load(std::memory_order_relaxed);
+    size_t contiguous = LogRing::kCapacity - (tail & kMask);
+    // 尾部放不下整条记录时，需要额外占用剩余空间做填充
+    size_t total = need <= contiguous ? need : contiguous + need;
+    while (tail + total - ring.head.load(std::memory_order_acquire) >
+           LogRing::kCapacity) {
+        if (overflow_ == LogOverflowPolicy::Drop) {
+            ring.dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        wakeWriter();
+        std::this_thread::yield();
+    }
+
+    if (need > contiguous) {
+        RecordHeader pad{0, static_cast<uint32_t>(contiguous), 0,
+                         kPaddingRecord, 0};
+        std::memcpy(&ring.data[tail & kMask], &pad, sizeof(pad));
+        tail += contiguous;
+    }
+    uint8_t* dst = &ring.data[tail & kMask];
+    RecordHeader header{coarseNowNanoseconds(), static_cast<uint32_t>(need),
+                        static_cast<uint8_t>(level),
+                        static_cast<uint8_t>(flags),
+                        static_cast<uint16_t>(size)};
+    std::memcpy(dst, &header, sizeof(header));
+    if (prefix_size > 0) {
+        std::memcpy(dst + sizeof(header), prefix, prefix_size);
+    }
+    std::memcpy(dst + sizeof(header) + prefix_size, body, body_size);
+    tail += need;
+    // release：后台线程看到新的 tail 时记录内容已完整写入
+    ring.tail.store(tail, std::memory_order_release);
+
+    // 积压超过一半时提前唤醒后台线程，平时由它按固定间隔轮询，生产者不做系统调用
+    if (tail - ring.head.load(std::memory_order_relaxed) >
+        LogRing::kCapacity / 2) {
+        wakeWriter();
+    }
+}
+
+void Logger::wakeWriter() {
+    if (!wake_requested_.exchange(true, std::memory_order_acq_rel)) {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        wake_cv_.notify_one();
+    }
+}
+
+bool Logger::startAsync(const AsyncLogOptions& options) {
+    if (async_.load(std::memory_order_acquire)) return true;
+    if (options.binary && options.path.empty()) {
+        log(LogLevel::ERROR, "Binary logging requires a log file");
+        return false;
+    }
+    int fd = STDOUT_FILENO;
+    if (!options.path.empty()) {
+        fd = ::open(options.path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC,
+                    0644);
+        if (fd < 0) {
+            log(LogLevel::ERROR, "Failed to open log file %s: %s",
+                options.path.c_str(), strerror(errno));
+            return false;
+        }
+    }
+    // 切换前把同步模式下已缓冲的标准输出写出，避免乱序
+    std::fflush(stdout);
+    out_fd_ = fd;
+    overflow_ = options.overflow;
+    binary_ = options.binary;
+    out_buffer_.reserve(kOutputBatchSize * 2);
+    formats_written_.clear();
+    if (binary_) {
+        out_buffer_.push_back(binlog::kSession);
+        out_buffer_.append(binlog::kMagic, binlog::kMagicSize);
+    }
+    stopping_.store(false, std::memory_order_relaxed);
+    writer_ = std::thread([this]() { writerLoop(); });
+    async_.store(true, std::memory_order_release);
+    return true;
+}
+
+void Logger::stopAsync() {
+    if (!async_.exchange(false, std::memory_order_acq_rel)) return;
+    stopping_.store(true, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        wake_cv_.notify_one();
+    }
+    if (writer_.joinable()) writer_.join();
+    if (out_fd_ >= 0 && out_fd_ != STDOUT_FILENO) {
+        ::close(out_fd_);
+    }
+    out_fd_ = -1;
+}
+
+void Logger::flush() {
+    if (!async_.load(std::memory_order_acquire)) {
+        std::fflush(stdout);
+        return;
+    }
+    // 等到所有环都被消费完；后台线程在每轮结束时会把输出缓冲区写出
+    while (true) {
+        bool empty = true;
+        rings_.forEach([&empty](const LogRing& ring) {
+            if (ring.head.load(std::memory_order_acquire) !=
+                ring.tail.load(std::memory_order_acquire)) {
+                empty = false;
+            }
+        });
+        if (empty) break;
+        wakeWriter();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    // 环已空只说明记录被取走，再等后台线程完成一轮，保证最后一批已经 write 出去
+    uint64_t pass = writer_passes_.load(std::memory_order_acquire);
+    while (writer_passes_.load(std::memory_order_acquire) == pass &&
+           async_.load(std::memory_order_acquire)) {
+        wakeWriter();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+void Logger::writerLoop() {
+    while (true) {
+        bool stopping = stopping_.load(std::memory_order_acquire);
+        bool busy = drainRings();
+        flushOutput();
+        writer_passes_.fetch_add(1, std::memory_order_release);
+        if (stopping) {
+            // 退出前最后再收一轮：stopping_ 置位前提交的记录都已可见
+            if (drainRings()) flushOutput();
+            return;
+        }
+        if (busy) continue;
+        std::unique_lock<std::mutex> lock(wake_mutex_);
+        wake_cv_.wait_for(lock, kFlushInterval, [this]() {
+            return wake_requested_.load(std::memory_order_acquire) ||
+                   stopping_.load(std::memory_order_acquire);
+        });
+        wake_requested_.store(false, std::memory_order_release);
+    }
+}
+
+bool Logger::drainRings() {
+    // 只在锁内取出环列表：forEach 持有 ThreadShards 的锁，新线程首次写日志注册分片时
+    // 要拿同一把锁，不能让它等在下面的写盘后面。分片注册后地址不变，锁外访问是安全的
+    drain_list_.clear();
+    rings_.forEach([this](LogRing& ring) { drain_list_.push_back(&ring); });
+
+    bool busy = false;
+    for (LogRing* ring_ptr : drain_list_) {
+        LogRing& ring = *ring_ptr;
+        uint64_t dropped = ring.dropped.exchange(0, std::memory_order_relaxed);
+        if (dropped > 0) {
+            char note[64];
+            int n = std::snprintf(note, sizeof(note),
+                                  "Logger dropped %llu records (ring full)",
+                                  static_cast<unsigned long long>(dropped));
+            appendText(nowNanoseconds(), LogLevel::WARNING, note,
+                       static_cast<size_t>(n));
+        }
+
+        constexpr size_t kMask = LogRing::kCapacity - 1;
+        uint64_t head = ring.head.load(std::memory_order_relaxed);
+        uint64_t tail = ring.tail.load(std::memory_order_acquire);
+        if (head == tail) continue;
+        busy = true;
+        while (head < tail) {
+            const uint8_t* src = &ring.data[head & kMask];
+            RecordHeader header;
+            std::memcpy(&header, src, sizeof(header));
+            const uint8_t* body = src + sizeof(header);
+            LogLevel level = static_cast<LogLevel>(header.level);
+            if (header.flags == kTextRecord) {
+                appendText(header.timestamp_ns, level,
+                           reinterpret_cast<const char*>(body), header.length);
+            } else if (header.flags == kBinaryRecord) {
+                uint32_t format_id;
+                std::memcpy(&format_id, body, sizeof(format_id));
+                const uint8_t* args = body + sizeof(format_id);
+                size_t args_size = header.length - sizeof(format_id);
+                if (binary_) {
+                    appendBinaryEvent(header.timestamp_ns, level, format_id,
+                                      args, args_size);
+                } else {
+                    char text[kMaxMessageSize];
+                    size_t size =
+                        renderLogMessage(text, sizeof(text),
+                                         formatInfo(format_id).format, args,
+                                         args_size);
+                    appendLine(header.timestamp_ns, level, text, size);
+                }
+            }
+            head += header.size;
+            if (out_buffer_.size() >= kOutputBatchSize) {
+                // 先归还空间再做系统调用，阻塞策略下的生产者可以尽早继续
+                ring.head.store(head, std::memory_order_release);
+                flushOutput();
+            }
+        }
+        ring.head.store(head, std::memory_order_release);
+    }
+    return busy;
+}
+
+void Logger::appendLine(int64_t timestamp_ns, LogLevel level,
+                        const char* message, size_t size) {
+    out_buffer_.append(async_timestamp_.format(timestamp_ns / 1000000000));
+    out_buffer_.push_back(' ');
+    out_buffer_.append(levelTag(level));
+    out_buffer_.append(message, size);
+    out_buffer_.push_back('\n');
+}
+
+void Logger::appendText(int64_t timestamp_ns, LogLevel level,
+                        const char* text, size_t size) {
+    if (!binary_) {
+        appendLine(timestamp_ns, level, text, size);
+        return;
+    }
+    // 二进制文件中以 0 号格式串 "%s" 写出
+    uint8_t args[kMaxMessageSize + 8];
+    size_t args_size =
+        encodeLogArgs(args, sizeof(args), std::string_view(text, size));
+    appendBinaryEvent(timestamp_ns, level, 0, args, args_size);
+}
+
+void Logger::appendBinaryEvent(int64_t timestamp_ns, LogLevel level,
+                               uint32_t format_id, const uint8_t* args,
+                               size_t size) {
+    auto put = [this](const void* data, size_t n) {
+        out_buffer_.append(static_cast<const char*>(data), n);
+    };
+    if (format_id >= formats_written_.size() || !formats_written_[format_id]) {
+        FormatInfo info = formatInfo(format_id);
+        uint8_t level = static_cast<uint8_t>(info.level);
+        uint32_t line = static_cast<uint32_t>(info.line);
+        uint16_t file_size = static_cast<uint16_t>(std::strlen(info.file));
+        uint16_t format_size = static_cast<uint16_t>(std::strlen(info.format));
+        out_buffer_.push_back(binlog::kFormat);
+        put(&format_id, sizeof(format_id));
+        put(&level, sizeof(level));
+        put(&line, sizeof(line));
+        put(&file_size, sizeof(file_size));
+        put(info.file, file_size);
+        put(&format_size, sizeof(format_size));
+        put(info.format, format_size);
+        if (format_id >= formats_written_.size()) {
+            formats_written_.resize(format_id + 1, false);
+        }
+        formats_written_[format_id] = true;
+    }
+    uint8_t event_level = static_cast<uint8_t>(level);
+    uint16_t args_size = static_cast<uint16_t>(size);
+    out_buffer_.push_back(binlog::kEvent);
+    put(&timestamp_ns, sizeof(timestamp_ns));
+    put(&format_id, sizeof(format_id));
+    put(&event_level, sizeof(event_level));
+    put(&args_size, sizeof(args_size));
+    put(args, size);
+}
+
+void Logger::flushOutput() {
+    if (out_buffer_.empty()) return;
+    if (!writeAll(out_fd_, out_buffer_.data(), out_buffer_.size())) {
+        // 日志本身写失败时无处可报，只能丢弃这一批
+        std::fprintf(stderr, "Logger write failed: %s\n", strerror(errno));
+    }
+    out_buffer_.clear();
+}
+
+}  // namespace utils
@@ -0,0 +1,126 @@
+#include "utils/TimerWheel.hpp"
+
+#include <time.h>
+
+#include <bit>
+#include <climits>
+
+TimerWheel::TimerWheel(uint32_t tick_ms)
+    : tick_ms_(tick_ms > 0 ? tick_ms : 1), current_tick_(0) {
+    for (Timer& head : slots_) {
+        head.prev = head.next = &head;
+    }
+    current_tick_ = floorTick(nowMs());
+}
+
+int64_t TimerWheel::nowMs() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+}
+
+void TimerWheel::schedule(Timer& timer, int64_t deadline_ms) {
+    cancel(timer);
+    timer.expires = ceilTick(deadline_ms);
+    insert(timer);
+    ++size_;
+}
+
+void TimerWheel::cancel(Timer& timer) {
+    if (!timer.scheduled()) return;
+    uint32_t slot = timer.slot;
+    unlink(timer);
+    --size_;
+    if (slot < kLevel0Slots && slots_[slot].next == &slots_[slot]) {
+        level0_bitmap_[slot / 64] &= ~(uint64_t(1) << (slot % 64));
+    }
+}
+
+void TimerWheel::insert(Timer& timer) {
+    // 已过期的定时器放进当前槽，下一次 step 就触发
+    if (timer.expires < current_tick_) timer.expires = current_tick_;
+    uint64_t delta = timer.expires - current_tick_;
+    if (delta > kMaxTicks) {
+        timer.expires = current_tick_ + kMaxTicks;
+        delta = kMaxTicks;
+    }
+
+    uint32_t slot;
+    if (delta < kLevel0Slots) {
+        slot = static_cast<uint32_t>(timer.expires & (kLevel0Slots - 1));
+        level0_bitmap_[slot / 64] |= uint64_t(1) << (slot % 64);
+    } else {
+        uint32_t level = 1;
+        uint32_t shift = kLevel0Bits;
+        while (delta >= (uint64_t(1) << (shift + kLevelBits))) {
+            ++level;
+            shift += kLevelBits;
+        }
+        slot = kLevel0Slots + (level - 1) * kLevelSlots +
+               static_cast<uint32_t>((timer.expires >> shift) &
+                                     (kLevelSlots - 1));
+    }
+
+    // 挂到槽链表尾部
+    Timer& head = slots_[slot];
+    timer.slot = slot;
+    timer.prev = head.prev;
+    timer.next = &head;
+    head.prev->next = &timer;
+    head.prev = &timer;
+}
+
+uint32_t TimerWheel::cascade(uint32_t level) {
+    uint32_t shift = kLevel0Bits + (level - 1) * kLevelBits;
+    uint32_t index =
+        static_cast<uint32_t>((current_tick_ >> shift) & (kLevelSlots - 1));
+    Timer& head = slots_[kLevel0Slots + (level - 1) * kLevelSlots + index];
+    // 按当前时刻重新计算层级，期限更近的定时器落到更低的层
+    while (head.next != &head) {
+        Timer& timer = *head.next;
+        unlink(timer);
+        insert(timer);
+    }
+    return index;
+}
+
+void TimerWheel::step(Timer& expired) {
+    uint32_t index = static_cast<uint32_t>(current_tick_ & (kLevel0Slots - 1));
+    if (index == 0) {
+        // 第 0 层转完一圈：逐层下放，上一层也转完一圈时才继续往上
+        for (uint32_t level = 1; level < kLevels; ++level) {
+            if (cascade(level) != 0) break;
+        }
+    }
+    ++current_tick_;
+
+    Timer& head = slots_[index];
+    if (head.next == &head) return;
+    expired.next = head.next;
+    expired.prev = head.prev;
+    head.next->prev = &expired;
+    head.prev->next = &expired;
+    head.prev = head.next = &head;
+    level0_bitmap_[index / 64] &= ~(uint64_t(1) << (index % 64));
+}
+
+int TimerWheel::timeoutMs(int64_t now_ms) const {
+    if (size_ == 0) return -1;
+
+    // 第 0 层当前位置之后最近的非空槽；没有则等到下一次下放
+    uint32_t index = static_cast<uint32_t>(current_tick_ & (kLevel0Slots - 1));
+    uint64_t ahead = kLevel0Slots - index;
+    for (uint32_t word = index / 64; word < kLevel0Slots / 64; ++word) {
+        uint64_t bits = level0_bitmap_[word];
+        if (word == index / 64) bits &= ~uint64_t(0) << (index % 64);
+        if (bits) {
+            ahead = word * 64 + std::countr_zero(bits) - index;
+            break;
+        }
+    }
+
+    int64_t due_ms = static_cast<int64_t>((current_tick_ + ahead) * tick_ms_);
+    if (due_ms <= now_ms) return 0;
+    int64_t wait = due_ms - now_ms;
+    return wait > INT_MAX ? INT_MAX : static_cast<int>(wait);
+}
@@ -0,0 +1,112 @@
+#include "net/Checksum.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <random>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+constexpr size_t kMaxLength = 4096;
+constexpr size_t kMaxOffset = 15;  // 覆盖 16 字节向量宽度内的所有起始对齐
+
+// 原来的逐字节实现
+uint16_t baselineSum16Step(uint16_t sum, uint8_t byte) {
+    return static_cast<uint16_t>(sum + byte);
+}
+
+// 逐位计算的 CRC32C（反射多项式 0x82F63B78），内部状态已取反
+uint32_t baselineCrcStep(uint32_t state, uint8_t byte) {
+    state ^= byte;
+    for (int bit = 0; bit < 8; ++bit) {
+        state = (state >> 1) ^ ((state & 1) ? 0x82F63B78u : 0);
+    }
+    return state;
+}
+
+std::vector<uint8_t> randomBytes(size_t size, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::vector<uint8_t> data(size);
+    // 高位字节多的数据更容易暴露累加溢出
+    for (uint8_t& byte : data) byte = static_cast<uint8_t>(rng() | 0x80);
+    for (size_t i = 0; i < size; i += 7) data[i] = static_cast<uint8_t>(rng());
+    return data;
+}
+
+std::span<const uint8_t> bytesOf(std::string_view text) {
+    return {reinterpret_cast<const uint8_t*>(text.data()), text.size()};
+}
+
+}  // namespace
+
+TEST(ChecksumTest, EverySum16KernelMatchesByteLoop) {
+    std::vector<uint8_t> data = randomBytes(kMaxLength + kMaxOffset, 1);
+    std::vector<checksum::Sum16Impl> impls = checksum::sum16Impls();
+    ASSERT_FALSE(impls.empty());
+    EXPECT_STREQ(impls.front().name, checksum::sum16Kernel());
+
+    for (size_t offset = 0; offset <= kMaxOffset; ++offset) {
+        const uint8_t* start = data.data() + offset;
+        uint16_t expected = 0;
+        for (size_t length = 0; length <= kMaxLength; ++length) {
+            if (length > 0) {
+                expected = baselineSum16Step(expected, start[length - 1]);
+            }
+            for (const checksum::Sum16Impl& impl : impls) {
+                uint16_t actual = static_cast<uint16_t>(impl.fn(start, length));
+                ASSERT_EQ(actual, expected) << impl.name << " offset=" << offset
+                                            << " length=" << length;
+            }
+            ASSERT_EQ(checksum::sum16({start, length}), expected)
+                << "offset=" << offset << " length=" << length;
+        }
+    }
+}
+
+TEST(ChecksumTest, EveryCrc32cKernelMatchesBitwiseCrc) {
+    std::vector<uint8_t> data = randomBytes(kMaxLength + kMaxOffset, 2);
+    std::vector<checksum::Crc32cImpl> impls = checksum::crc32cImpls();
+    ASSERT_FALSE(impls.empty());
+    EXPECT_STREQ(impls.front().name, checksum::crc32cKernel());
+
+    for (size_t offset = 0; offset <= kMaxOffset; ++offset) {
+        const uint8_t* start = data.data() + offset;
+        uint32_t state = ~0u;
+        for (size_t length = 0; length <= kMaxLength; ++length) {
+            if (length > 0) state = baselineCrcStep(state, start[length - 1]);
+            for (const checksum::Crc32cImpl& impl : impls) {
+                ASSERT_EQ(~impl.fn(~0u, start, length), ~state)
+                    << impl.name << " offset=" << offset
+                    << " length=" << length;
+            }
+            ASSERT_EQ(checksum::crc32c({start, length}), ~state)
+                << "offset=" << offset << " length=" << length;
+        }
+    }
+}
+
+TEST(ChecksumTest, Crc32cCheckValue) {
+    EXPECT_EQ(checksum::crc32c(bytesOf("123456789")), 0xE3069283u);
+    for (const checksum::Crc32cImpl& impl : checksum::crc32cImpls()) {
+        std::span<const uint8_t> check = bytesOf("123456789");
+        EXPECT_EQ(~impl.fn(~0u, check.data(), check.size()), 0xE3069283u)
+            << impl.name;
+    }
+    EXPECT_EQ(checksum::crc32c({}), 0u);
+}
+
+TEST(ChecksumTest, Crc32cChainsAcrossSegments) {
+    std::vector<uint8_t> data = randomBytes(3000, 3);
+    std::span<const uint8_t> all(data);
+    uint32_t whole = checksum::crc32c(all);
+    for (size_t split : {size_t(0), size_t(1), size_t(7), size_t(8), size_t(31),
+                         size_t(1024), size_t(2999), size_t(3000)}) {
+        std::span<const uint8_t> a = all.first(split);
+        std::span<const uint8_t> b = all.subspan(split);
+        EXPECT_EQ(checksum::crc32c(b, checksum::crc32c(a)), whole)
+            << "split=" << split;
+    }
+}
@@ -0,0 +1,295 @@
+#include "net/packet/Compression.hpp"
+#include "net/Checksum.hpp"
+#include "net/packet/PacketSecure.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace {
+
+using compression::Algorithm;
+
+constexpr size_t kFlagsOffset = 2;
+constexpr size_t kLengthOffset = 3;
+
+// 结构重复的业务报文，任何算法都能压下来
+std::string structuredPayload(int seq, size_t size = 1024) {
+    std::string out;
+    while (out.size() < size) {
+        out += "{\"seq\":" + std::to_string(seq) +
+               ",\"user\":\"alice\",\"action\":\"update\",\"status\":\"ok\"}";
+        ++seq;
+    }
+    out.resize(size);
+    return out;
+}
+
+std::string randomPayload(size_t size, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::string out(size, '\0');
+    for (char& c : out) c = static_cast<char>(rng());
+    return out;
+}
+
+std::vector<uint8_t> encodeWith(compression::Compressor& compressor,
+                                const std::string& payload) {
+    PacketSecure packet(payload, /*compress=*/true);
+    return packet.serialize(compressor);
+}
+
+// 解码失败返回 nullptr
+std::shared_ptr<PacketSecure> decodeWith(compression::Decompressor& decompressor,
+                                         const std::vector<uint8_t>& frame) {
+    return std::static_pointer_cast<PacketSecure>(
+        PacketSecure::deserializeWith(frame, decompressor));
+}
+
+uint8_t zstdBit(Algorithm algorithm) {
+    return algorithm == Algorithm::Zstd ? compression::kFlagZstd : 0;
+}
+
+void putLength(std::vector<uint8_t>& frame, uint32_t length) {
+    for (int i = 0; i < 4; ++i) {
+        frame[kLengthOffset + i] = static_cast<uint8_t>(length >> (24 - 8 * i));
+    }
+}
+
+// 改动 payload 后重新计算尾部的 sum16，让篡改只在解压阶段暴露
+void resealChecksum(std::vector<uint8_t>& frame) {
+    size_t payload_offset = PacketSecure::OVERHEAD - 2;
+    uint16_t sum = checksum::sum16(std::span<const uint8_t>(frame).subspan(
+        payload_offset, frame.size() - PacketSecure::OVERHEAD));
+    frame[frame.size() - 2] = static_cast<uint8_t>(sum >> 8);
+    frame[frame.size() - 1] = static_cast<uint8_t>(sum);
+}
+
+class CompressionTest : public ::testing::TestWithParam<Algorithm> {
+   protected:
+    void SetUp() override {
+        if (!compression::isAvailable(GetParam())) {
+            GTEST_SKIP() << compression::algorithmName(GetParam())
+                         << " not compiled in";
+        }
+    }
+
+    compression::Options options() const {
+        compression::Options opts;
+        opts.algorithm = GetParam();
+        opts.min_size = 64;
+        return opts;
+    }
+
+    std::shared_ptr<const compression::Dictionary> dictionary() const {
+        std::vector<std::string> samples;
+        for (int i = 0; i < 64; ++i) samples.push_back(structuredPayload(i, 256));
+        return compression::Dictionary::train(samples, 4096);
+    }
+};
+
+}  // namespace
+
+TEST_P(CompressionTest, StatelessRoundTrip) {
+    compression::Compressor compressor(options());
+    compression::Decompressor decompressor;
+    for (int seq = 0; seq < 8; ++seq) {
+        std::string payload = structuredPayload(seq * 100, 512 + seq * 700);
+        std::vector<uint8_t> frame = encodeWith(compressor, payload);
+        EXPECT_EQ(frame[kFlagsOffset],
+                  compression::kFlagCompressed | zstdBit(GetParam()));
+        EXPECT_LT(frame.size(), payload.size() + PacketSecure::OVERHEAD);
+
+        auto packet = decodeWith(decompressor, frame);
+        ASSERT_TRUE(packet);
+        EXPECT_EQ(packet->raw_payload, payload);
+        EXPECT_TRUE(packet->hasFlag(PacketSecure::SecurityFlags::COMPRESSED));
+
+        // 无状态包不依赖连接上下文
+        auto plain = PacketSecure::deserialize(frame);
+        ASSERT_TRUE(plain);
+        EXPECT_EQ(std::static_pointer_cast<PacketSecure>(plain)->raw_payload,
+                  payload);
+    }
+}
+
+TEST_P(CompressionTest, DictionaryRoundTrip) {
+    auto dict = dictionary();
+    ASSERT_TRUE(dict);
+    compression::Options opts = options();
+    opts.dictionary = dict;
+    compression::Compressor compressor(opts);
+    compression::Decompressor decompressor;
+    decompressor.addDictionary(dict);
+
+    for (int seq = 0; seq < 16; ++seq) {
+        std::string payload = structuredPayload(1000 + seq, 200);
+        std::vector<uint8_t> frame = encodeWith(compressor, payload);
+        ASSERT_EQ(frame[kFlagsOffset], compression::kFlagCompressed |
+                                           compression::kFlagDictionary |
+                                           zstdBit(GetParam()));
+        auto packet = decodeWith(decompressor, frame);
+        ASSERT_TRUE(packet);
+        EXPECT_EQ(packet->raw_payload, payload);
+    }
+}
+
+TEST_P(CompressionTest, MismatchedDictionaryIsRejected) {
+    auto dict = dictionary();
+    ASSERT_TRUE(dict);
+    compression::Options opts = options();
+    opts.dictionary = dict;
+    compression::Compressor compressor(opts);
+    std::vector<uint8_t> frame =
+        encodeWith(compressor, structuredPayload(7, 200));
+    ASSERT_TRUE(frame[kFlagsOffset] & compression::kFlagDictionary);
+
+    // 对端登记的是另一份字典，id 不同
+    auto other = compression::Dictionary::create(randomPayload(4096, 3));
+    ASSERT_TRUE(other);
+    ASSERT_NE(other->id(), dict->id());
+    compression::Decompressor wrong;
+    wrong.addDictionary(other);
+    EXPECT_FALSE(decodeWith(wrong, frame));
+
+    // 没有登记任何字典，以及不带上下文的解码
+    compression::Decompressor none;
+    EXPECT_FALSE(decodeWith(none, frame));
+    EXPECT_FALSE(PacketSecure::deserialize(frame));
+
+    // 帧内的字典 id 被篡改：payload 的前 4 字节
+    std::vector<uint8_t> tampered = frame;
+    tampered[PacketSecure::OVERHEAD - 2] ^= 0x01;
+    resealChecksum(tampered);
+    compression::Decompressor right;
+    right.addDictionary(dict);
+    EXPECT_FALSE(decodeWith(right, tampered));
+    EXPECT_TRUE(decodeWith(right, frame));
+}
+
+TEST_P(CompressionTest, StreamingRoundTrip) {
+    compression::Options opts = options();
+    opts.streaming = true;
+    compression::Compressor compressor(opts);
+    compression::Decompressor decompressor;
+
+    std::vector<std::vector<uint8_t>> frames;
+    std::vector<std::string> payloads;
+    for (int seq = 0; seq < 32; ++seq) {
+        payloads.push_back(structuredPayload(seq, 300));
+        frames.push_back(encodeWith(compressor, payloads.back()));
+        EXPECT_EQ(frames.back()[kFlagsOffset], compression::kFlagCompressed |
+                                                   compression::kFlagStream |
+                                                   zstdBit(GetParam()));
+    }
+    for (size_t i = 0; i < frames.size(); ++i) {
+        auto packet = decodeWith(decompressor, frames[i]);
+        ASSERT_TRUE(packet) << "frame " << i;
+        EXPECT_EQ(packet->raw_payload, payloads[i]);
+    }
+
+    // 流式包离开连接上下文、或跳过前面的包都无法还原
+    EXPECT_FALSE(PacketSecure::deserialize(frames[1]));
+    compression::Decompressor late;
+    EXPECT_FALSE(decodeWith(late, frames[1]));
+}
+
+TEST_P(CompressionTest, StreamingWithDictionaryRoundTrip) {
+    auto dict = dictionary();
+    ASSERT_TRUE(dict);
+    compression::Options opts = options();
+    opts.streaming = true;
+    opts.dictionary = dict;
+    compression::Compressor compressor(opts);
+    compression::Decompressor decompressor;
+    decompressor.addDictionary(dict);
+
+    for (int seq = 0; seq < 16; ++seq) {
+        std::string payload = structuredPayload(500 + seq, 200);
+        std::vector<uint8_t> frame = encodeWith(compressor, payload);
+        // 字典只在流的第一个包里声明（链接的 liblz4 不支持帧字典时 LZ4 流不带字典）
+        if (seq > 0) {
+            EXPECT_FALSE(frame[kFlagsOffset] & compression::kFlagDictionary);
+        }
+        auto packet = decodeWith(decompressor, frame);
+        ASSERT_TRUE(packet) << "frame " << seq;
+        EXPECT_EQ(packet->raw_payload, payload);
+    }
+}
+
+TEST_P(CompressionTest, BelowThresholdIsSentUncompressed) {
+    compression::Options opts = options();
+    compression::Compressor compressor(opts);
+    std::string payload = structuredPayload(1, opts.min_size - 1);
+    std::vector<uint8_t> frame = encodeWith(compressor, payload);
+    EXPECT_EQ(frame[kFlagsOffset], 0);
+    EXPECT_EQ(frame.size(), payload.size() + PacketSecure::OVERHEAD);
+
+    compression::Decompressor decompressor;
+    auto packet = decodeWith(decompressor, frame);
+    ASSERT_TRUE(packet);
+    EXPECT_EQ(packet->raw_payload, payload);
+}
+
+TEST_P(CompressionTest, IncompressiblePayloadClearsCompressedFlag) {
+    compression::Compressor compressor(options());
+    std::string payload = randomPayload(4096, 42);
+    std::vector<uint8_t> frame = encodeWith(compressor, payload);
+    EXPECT_EQ(frame[kFlagsOffset], 0);
+    EXPECT_EQ(frame.size(), payload.size() + PacketSecure::OVERHEAD);
+
+    compression::Decompressor decompressor;
+    auto packet = decodeWith(decompressor, frame);
+    ASSERT_TRUE(packet);
+    EXPECT_EQ(packet->raw_payload, payload);
+}
+
+TEST_P(CompressionTest, RawLengthAboveLimitIsRejected) {
+    compression::Compressor compressor(options());
+    std::vector<uint8_t> frame =
+        encodeWith(compressor, structuredPayload(0, 4096));
+    ASSERT_TRUE(frame[kFlagsOffset] & compression::kFlagCompressed);
+
+    // Len 不在 checksum 覆盖范围内，伪造后帧本身仍然合法
+    putLength(frame, PacketSecure::MAX_RAW_LENGTH + 1);
+    PacketSecure::View view;
+    ASSERT_TRUE(PacketSecure::decode(frame, view));
+    EXPECT_EQ(view.raw_length, PacketSecure::MAX_RAW_LENGTH + 1);
+    std::string out;
+    EXPECT_FALSE(PacketSecure::restorePayload(view, out));
+    compression::Decompressor decompressor;
+    EXPECT_FALSE(decodeWith(decompressor, frame));
+
+    // 与实际解压长度不符的 Len 同样被拒绝
+    putLength(frame, 4095);
+    EXPECT_FALSE(decodeWith(decompressor, frame));
+}
+
+INSTANTIATE_TEST_SUITE_P(Algorithms, CompressionTest,
+                         ::testing::Values(Algorithm::Lz4, Algorithm::Zstd),
+                         [](const ::testing::TestParamInfo<Algorithm>& info) {
+                             return std::string(
+                                 compression::algorithmName(info.param));
+                         });
+
+TEST(PacketSecureFlagsTest, InconsistentOrUnknownFlagsAreRejected) {
+    PacketSecure packet(structuredPayload(0, 100));
+    std::vector<uint8_t> frame = packet.serialize();
+    ASSERT_EQ(frame[kFlagsOffset], 0);
+    PacketSecure::View view;
+    ASSERT_TRUE(PacketSecure::decode(frame, view));
+
+    // 没有 COMPRESSED 的压缩子标志、未定义的位
+    for (uint8_t flags :
+         {compression::kFlagZstd, compression::kFlagStream,
+          compression::kFlagDictionary, uint8_t{0x20}, uint8_t{0x80}}) {
+        std::vector<uint8_t> forged = frame;
+        forged[kFlagsOffset] = flags;
+        EXPECT_FALSE(PacketSecure::decode(forged, view))
+            << "flags=" << int(flags);
+    }
+}
@@ -0,0 +1,128 @@
+#include "net/connection/ConnectionManager.hpp"
+
+#include <gtest/gtest.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <thread>
+
+/*
+替换全局 operator new / delete，记录被观察的对象是否已释放：
+Connection 没有可供观察的析构钩子，延迟回收是否生效只能从内存释放的时机判断
+*/
+namespace {
+std::atomic<void*> g_watched{nullptr};
+std::atomic<bool> g_watched_freed{false};
+
+void noteFree(void* ptr) {
+    if (ptr != nullptr && ptr == g_watched.load(std::memory_order_relaxed)) {
+        g_watched_freed.store(true);
+    }
+}
+}  // namespace
+
+void* operator new(std::size_t size) {
+    if (void* ptr = std::malloc(size ? size : 1)) return ptr;
+    throw std::bad_alloc();
+}
+void operator delete(void* ptr) noexcept {
+    noteFree(ptr);
+    std::free(ptr);
+}
+void operator delete(void* ptr, std::size_t) noexcept {
+    noteFree(ptr);
+    std::free(ptr);
+}
+
+namespace {
+
+// 返回一个可以交给 Connection 的 socket，另一端一并关闭
+int makeSocket() {
+    int fds[2];
+    if (::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) return -1;
+    ::close(fds[1]);
+    return fds[0];
+}
+
+void watch(void* ptr) {
+    g_watched_freed.store(false);
+    g_watched.store(ptr);
+}
+
+}  // namespace
+
+// 读者持有 EpochGuard 期间删除连接：fd 立即关闭，对象在读者离开后才释放
+TEST(ConnectionManagerTest, RemovedConnectionFreedAfterGuardReleased) {
+    ConnectionManager manager;
+    int fd = makeSocket();
+    ASSERT_GE(fd, 0);
+    uint32_t generation =
+        manager.addConnection(fd, std::make_unique<Connection>(fd, -1));
+    ASSERT_NE(generation, 0u);
+
+    std::atomic<Connection*> seen{nullptr};
+    std::atomic<bool> release{false};
+    std::atomic<uint32_t> generation_after_remove{0};
+    std::thread reader([&] {
+        EpochGuard guard;
+        Connection* conn = manager.getConnection(fd, generation);
+        seen.store(conn);
+        while (!release.load()) std::this_thread::yield();
+        // 删除之后仍在同一个临界区内：对象必须还能访问
+        generation_after_remove.store(conn->generation());
+    });
+    while (seen.load() == nullptr) std::this_thread::yield();
+    Connection* conn = seen.load();
+    watch(conn);
+
+    manager.removeConnection(fd);
+    EXPECT_EQ(manager.size(), 0u);
+    EXPECT_EQ(manager.getConnection(fd), nullptr);
+    // fd 在删除时已关闭
+    EXPECT_EQ(::fcntl(fd, F_GETFD), -1);
+
+    for (int i = 0; i < 10; ++i) EpochReclaimer::getInstance().collect();
+    EXPECT_FALSE(g_watched_freed.load())
+        << "connection freed while a reader still holds an EpochGuard";
+
+    release.store(true);
+    reader.join();
+    EXPECT_EQ(generation_after_remove.load(), generation);
+
+    for (int i = 0; i < 3; ++i) EpochReclaimer::getInstance().collect();
+    EXPECT_TRUE(g_watched_freed.load());
+    g_watched.store(nullptr);
+}
+
+// 删除后 fd 被新连接复用：按 fd 查到新连接，旧 generation 查不到
+TEST(ConnectionManagerTest, FdReuseReturnsNewConnection) {
+    ConnectionManager manager;
+    int fd = makeSocket();
+    ASSERT_GE(fd, 0);
+    uint32_t old_generation =
+        manager.addConnection(fd, std::make_unique<Connection>(fd, -1));
+    manager.removeConnection(fd);
+
+    // 让新 socket 占用同一个 fd 号，模拟内核复用
+    int fresh = makeSocket();
+    ASSERT_GE(fresh, 0);
+    if (fresh != fd) {
+        ASSERT_EQ(::dup2(fresh, fd), fd);
+        ::close(fresh);
+    }
+    auto owned = std::make_unique<Connection>(fd, -1);
+    Connection* conn = owned.get();
+    uint32_t new_generation = manager.addConnection(fd, std::move(owned));
+    EXPECT_NE(new_generation, old_generation);
+    EXPECT_EQ(manager.size(), 1u);
+
+    EpochGuard guard;
+    EXPECT_EQ(manager.getConnection(fd), conn);
+    EXPECT_EQ(manager.getConnection(fd, new_generation), conn);
+    EXPECT_EQ(manager.getConnection(fd, old_generation), nullptr);
+}
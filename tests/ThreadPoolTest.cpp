@@ -0,0 +1,177 @@
+#include "threading/ThreadPool.hpp"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using namespace std::chrono_literals;
+
+// 等待条件成立，超时返回 false，避免测试失败时卡死
+template <typename Pred>
+bool waitFor(Pred pred, std::chrono::milliseconds timeout = 10s) {
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (!pred()) {
+        if (std::chrono::steady_clock::now() > deadline) return false;
+        std::this_thread::sleep_for(100us);
+    }
+    return true;
+}
+
+// 占住工作线程直到 release()，用来让后续任务留在队列里
+class Gate {
+   public:
+    ThreadPool::Task blocker() {
+        return [this] {
+            started_.fetch_add(1);
+            while (!open_.load()) std::this_thread::sleep_for(50us);
+        };
+    }
+    bool waitStarted(int count) {
+        return waitFor([&] { return started_.load() >= count; });
+    }
+    void release() { open_.store(true); }
+
+   private:
+    std::atomic<int> started_{0};
+    std::atomic<bool> open_{false};
+};
+
+}  // namespace
+
+// 外部线程、工作线程内部、专属投递三种提交混合，每个任务恰好执行一次
+TEST(ThreadPoolTest, EveryTaskRunsExactlyOnce) {
+    constexpr int kProducers = 4;
+    constexpr int kPerProducer = 20000;
+    constexpr int kExternal = kProducers * kPerProducer;
+    // 每个外部任务在工作线程内再提交一个子任务
+    constexpr int kTotal = kExternal * 2;
+
+    auto runs = std::make_unique<std::atomic<int>[]>(kTotal);
+    std::atomic<int> done{0};
+    ThreadPool pool(4);
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < kProducers; ++p) {
+        producers.emplace_back([&, p] {
+            for (int i = 0; i < kPerProducer; ++i) {
+                int id = p * kPerProducer + i;
+                ThreadPool::Task task = [&, id] {
+                    runs[id].fetch_add(1);
+                    int child = kExternal + id;
+                    ASSERT_TRUE(pool.enqueue([&, child] {
+                        runs[child].fetch_add(1);
+                        done.fetch_add(1);
+                    }));
+                    done.fetch_add(1);
+                };
+                bool accepted = (id % 3 == 0)
+                                    ? pool.enqueuePinned(id, std::move(task))
+                                    : pool.enqueue(std::move(task));
+                ASSERT_TRUE(accepted);
+            }
+        });
+    }
+    for (auto& t : producers) t.join();
+
+    ASSERT_TRUE(waitFor([&] { return done.load() == kTotal; }))
+        << "done=" << done.load();
+    pool.shutdown();
+    pool.wait();
+
+    for (int id = 0; id < kTotal; ++id) {
+        ASSERT_EQ(runs[id].load(), 1) << "task " << id;
+    }
+    EXPECT_EQ(done.load(), kTotal);
+    EXPECT_EQ(pool.pendingTasks(), 0u);
+}
+
+TEST(ThreadPoolTest, RejectWhenPendingLimitReached) {
+    ThreadPool pool(1, 2, TaskOverflowPolicy::Reject);
+    Gate gate;
+    ASSERT_TRUE(pool.enqueue(gate.blocker()));
+    // 开始执行即归还名额，之后积压的 2 个任务占满上限
+    ASSERT_TRUE(gate.waitStarted(1));
+
+    std::atomic<int> runs{0};
+    EXPECT_TRUE(pool.enqueue([&] { runs.fetch_add(1); }));
+    EXPECT_TRUE(pool.enqueuePinned(0, [&] { runs.fetch_add(1); }));
+    EXPECT_FALSE(pool.enqueue([&] { runs.fetch_add(100); }));
+    EXPECT_FALSE(pool.enqueuePinned(0, [&] { runs.fetch_add(100); }));
+    EXPECT_EQ(pool.rejectedTasks(), 2u);
+    EXPECT_EQ(pool.callerRunsTasks(), 0u);
+
+    gate.release();
+    ASSERT_TRUE(waitFor([&] { return runs.load() >= 2; }));
+    // 名额归还后可以继续提交
+    EXPECT_TRUE(pool.enqueue([&] { runs.fetch_add(1); }));
+    pool.shutdown();
+    pool.wait();
+    EXPECT_EQ(runs.load(), 3);
+}
+
+TEST(ThreadPoolTest, CallerRunsWhenPendingLimitReached) {
+    ThreadPool pool(1, 2, TaskOverflowPolicy::CallerRuns);
+    Gate gate;
+    ASSERT_TRUE(pool.enqueue(gate.blocker()));
+    ASSERT_TRUE(gate.waitStarted(1));
+
+    std::atomic<int> queued{0};
+    EXPECT_TRUE(pool.enqueue([&] { queued.fetch_add(1); }));
+    EXPECT_TRUE(pool.enqueue([&] { queued.fetch_add(1); }));
+
+    // 超出上限：在提交线程内同步执行，enqueue 返回前已经完成
+    const std::thread::id caller = std::this_thread::get_id();
+    std::thread::id ran_on;
+    int inline_runs = 0;
+    EXPECT_TRUE(pool.enqueue([&] {
+        ran_on = std::this_thread::get_id();
+        ++inline_runs;
+    }));
+    EXPECT_EQ(inline_runs, 1);
+    EXPECT_EQ(ran_on, caller);
+    EXPECT_TRUE(pool.enqueuePinned(0, [&] { ++inline_runs; }));
+    EXPECT_EQ(inline_runs, 2);
+    EXPECT_EQ(pool.callerRunsTasks(), 2u);
+    EXPECT_EQ(pool.rejectedTasks(), 0u);
+    EXPECT_EQ(queued.load(), 0);
+
+    gate.release();
+    pool.shutdown();
+    pool.wait();
+    EXPECT_EQ(queued.load(), 2);
+}
+
+// shutdown 之前已接受的任务（包括积压在队列里的）全部执行；之后的提交抛异常
+TEST(ThreadPoolTest, ShutdownRunsAcceptedTasks) {
+    constexpr int kWorkers = 3;
+    constexpr int kTasks = 50000;
+    ThreadPool pool(kWorkers);
+    Gate gate;
+    for (int i = 0; i < kWorkers; ++i) {
+        ASSERT_TRUE(pool.enqueuePinned(i, gate.blocker()));
+    }
+    ASSERT_TRUE(gate.waitStarted(kWorkers));
+
+    std::atomic<int> runs{0};
+    for (int i = 0; i < kTasks; ++i) {
+        auto task = [&] { runs.fetch_add(1); };
+        ASSERT_TRUE(i % 2 ? pool.enqueue(task) : pool.enqueuePinned(i, task));
+    }
+    EXPECT_EQ(runs.load(), 0);
+
+    pool.shutdown();
+    EXPECT_THROW(pool.enqueue([] {}), std::runtime_error);
+    EXPECT_THROW(pool.enqueuePinned(0, [] {}), std::runtime_error);
+
+    gate.release();
+    pool.wait();
+    EXPECT_EQ(runs.load(), kTasks);
+    EXPECT_EQ(pool.pendingTasks(), 0u);
+}
@@ -0,0 +1,198 @@
+#include "utils/TimerWheel.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+using Timer = TimerWheel::Timer;
+
+// 逐毫秒推进到 end_ms，记录每个定时器（data 为下标）的触发时刻
+void walk(TimerWheel& wheel, int64_t start_ms, int64_t end_ms,
+          std::vector<int64_t>& fired_at) {
+    for (int64_t now = start_ms; now <= end_ms; ++now) {
+        wheel.advance(now, [&](Timer& timer) { fired_at[timer.data] = now; });
+    }
+}
+
+}  // namespace
+
+// 期限落在各层边界（相对期限和绝对 tick 对齐两种）上时，下放后既不提前也不延后
+TEST(TimerWheelTest, CascadesAcrossLevelBoundaries) {
+    TimerWheel wheel(1);
+    const int64_t start = TimerWheel::nowMs();
+
+    std::vector<int64_t> deadlines;
+    for (int64_t span : {int64_t(256), int64_t(256) * 64,
+                         int64_t(256) * 64 * 64}) {
+        for (int64_t offset : {-1, 0, 1}) {
+            deadlines.push_back(start + span + offset);
+            // 绝对 tick 恰好是该层转完一圈的位置
+            int64_t aligned = (start / span + 1) * span;
+            deadlines.push_back(aligned + offset);
+        }
+    }
+
+    std::vector<Timer> timers(deadlines.size());
+    for (size_t i = 0; i < timers.size(); ++i) {
+        timers[i].data = i;
+        wheel.schedule(timers[i], deadlines[i]);
+    }
+    ASSERT_EQ(wheel.size(), timers.size());
+
+    std::vector<int64_t> fired_at(timers.size(), -1);
+    walk(wheel, start, start + int64_t(256) * 64 * 64 * 2 + 2, fired_at);
+
+    EXPECT_EQ(wheel.size(), 0u);
+    for (size_t i = 0; i < timers.size(); ++i) {
+        EXPECT_EQ(fired_at[i], deadlines[i]) << "timer " << i;
+        EXPECT_FALSE(timers[i].scheduled());
+    }
+}
+
+// tick 大于 1ms 时期限向上取整：触发时刻不早于期限，且晚不过一个 tick
+TEST(TimerWheelTest, NeverFiresEarly) {
+    constexpr uint32_t kTick = 10;
+    TimerWheel wheel(kTick);
+    const int64_t start = TimerWheel::nowMs();
+
+    std::vector<int64_t> deadlines;
+    for (int64_t delta = 1; delta < 6000; delta = delta * 3 / 2 + 7) {
+        deadlines.push_back(start + delta);
+    }
+    deadlines.push_back(start + int64_t(kTick) * 256);
+    deadlines.push_back(start + int64_t(kTick) * 256 + 1);
+
+    std::vector<Timer> timers(deadlines.size());
+    for (size_t i = 0; i < timers.size(); ++i) {
+        timers[i].data = i;
+        wheel.schedule(timers[i], deadlines[i]);
+    }
+
+    std::vector<int64_t> fired_at(timers.size(), -1);
+    walk(wheel, start, start + 6000 + 2 * kTick, fired_at);
+
+    for (size_t i = 0; i < timers.size(); ++i) {
+        EXPECT_GE(fired_at[i], deadlines[i]) << "timer " << i;
+        EXPECT_LT(fired_at[i], deadlines[i] + kTick) << "timer " << i;
+    }
+}
+
+// 回调里重新 schedule 自己（周期定时器）和取消同一批到期的其他定时器
+TEST(TimerWheelTest, RescheduleFromCallback) {
+    TimerWheel wheel(1);
+    const int64_t start = TimerWheel::nowMs();
+
+    Timer periodic;
+    periodic.data = 0;
+    Timer victim;
+    victim.data = 1;
+    wheel.schedule(periodic, start + 5);
+    wheel.schedule(victim, start + 5);
+
+    int periodic_fires = 0;
+    int victim_fires = 0;
+    int64_t last_fire = 0;
+    for (int64_t now = start; now <= start + 300; ++now) {
+        wheel.advance(now, [&](Timer& timer) {
+            if (timer.data == 1) {
+                ++victim_fires;
+                return;
+            }
+            ++periodic_fires;
+            last_fire = now;
+            if (victim.scheduled()) wheel.cancel(victim);
+            if (periodic_fires < 50) wheel.schedule(timer, now + 5);
+        });
+    }
+
+    EXPECT_EQ(periodic_fires, 50);
+    EXPECT_EQ(victim_fires, 0);
+    EXPECT_EQ(last_fire, start + 5 * 50);
+    EXPECT_EQ(wheel.size(), 0u);
+}
+
+// 回调里把定时器重新挂到已过去的期限：本轮不再触发，下一个 tick 触发
+TEST(TimerWheelTest, PastDueRescheduleFromCallbackFiresNextTick) {
+    TimerWheel wheel(1);
+    const int64_t start = TimerWheel::nowMs();
+
+    Timer timer;
+    wheel.schedule(timer, start + 1);
+    int fires = 0;
+    auto on_expire = [&](Timer& t) {
+        if (++fires == 1) wheel.schedule(t, start - 100);
+    };
+
+    EXPECT_EQ(wheel.advance(start + 1, on_expire), 1u);
+    EXPECT_EQ(fires, 1);
+    EXPECT_TRUE(timer.scheduled());
+    EXPECT_EQ(wheel.timeoutMs(start + 1), 1);
+
+    EXPECT_EQ(wheel.advance(start + 1, on_expire), 0u);
+    EXPECT_EQ(wheel.advance(start + 2, on_expire), 1u);
+    EXPECT_EQ(fires, 2);
+    EXPECT_EQ(wheel.size(), 0u);
+}
+
+TEST(TimerWheelTest, TimeoutOnEmptyWheel) {
+    TimerWheel wheel;
+    const int64_t start = TimerWheel::nowMs();
+    EXPECT_EQ(wheel.timeoutMs(start), -1);
+
+    Timer timer;
+    wheel.schedule(timer, start + 100);
+    wheel.cancel(timer);
+    EXPECT_EQ(wheel.size(), 0u);
+    EXPECT_EQ(wheel.timeoutMs(start), -1);
+
+    // 空轮推进任意远都不触发，之后仍返回 -1
+    EXPECT_EQ(wheel.advance(start + 1000000, [](Timer&) {}), 0u);
+    EXPECT_EQ(wheel.timeoutMs(start + 1000000), -1);
+}
+
+TEST(TimerWheelTest, TimeoutOnPastDueWheel) {
+    TimerWheel wheel;
+    const int64_t start = TimerWheel::nowMs();
+
+    Timer overdue;
+    wheel.schedule(overdue, start - 500);
+    EXPECT_EQ(wheel.timeoutMs(start), 0);
+
+    Timer pending;
+    wheel.schedule(pending, start + 50);
+    EXPECT_EQ(wheel.timeoutMs(start), 0);
+    // 调用方迟迟没有 advance：已到期的定时器仍返回 0
+    EXPECT_EQ(wheel.timeoutMs(start + 10000), 0);
+
+    EXPECT_EQ(wheel.advance(start, [](Timer&) {}), 1u);
+    EXPECT_FALSE(overdue.scheduled());
+    EXPECT_EQ(wheel.timeoutMs(start + 10000), 0);
+}
+
+// 按 timeoutMs 等待后醒来恰好能触发：等待不会偏短，也不会过长
+TEST(TimerWheelTest, TimeoutMatchesNextExpiry) {
+    TimerWheel wheel;
+    const int64_t start = TimerWheel::nowMs();
+    wheel.advance(start, [](Timer&) {});
+
+    Timer timer;
+    wheel.schedule(timer, start + 55);
+    int wait = wheel.timeoutMs(start);
+    EXPECT_GE(wait, 55);
+    EXPECT_LT(wait, 55 + static_cast<int>(TimerWheel::kDefaultTickMs));
+
+    EXPECT_EQ(wheel.advance(start + wait - 1, [](Timer&) {}), 0u);
+    EXPECT_EQ(wheel.advance(start + wait, [](Timer&) {}), 1u);
+    EXPECT_EQ(wheel.timeoutMs(start + wait), -1);
+
+    // 高层的定时器：等待到下一次下放为止，不会越过期限
+    Timer far;
+    int64_t now = start + wait;
+    wheel.schedule(far, now + 60000);
+    int far_wait = wheel.timeoutMs(now);
+    EXPECT_GT(far_wait, 0);
+    EXPECT_LE(far_wait, 60000);
+}
@@ -0,0 +1,147 @@
+#include "app/UdpSessionTable.hpp"
+
+#include <arpa/inet.h>
+#include <gtest/gtest.h>
+
+#include <bit>
+#include <cstdint>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+sockaddr_in makePeer(uint32_t ip, uint16_t port) {
+    sockaddr_in peer{};
+    peer.sin_family = AF_INET;
+    peer.sin_addr.s_addr = htonl(ip);
+    peer.sin_port = htons(port);
+    return peer;
+}
+
+// 与 UdpSessionTable::home 相同的散列，用来挑出起始槽落在表尾附近的对端
+size_t homeOf(const sockaddr_in& peer, size_t capacity) {
+    unsigned shift = 64 - static_cast<unsigned>(std::countr_zero(capacity));
+    return static_cast<size_t>(
+        (UdpSessionTable::keyOf(peer) * 0x9E3779B97F4A7C15ull) >> shift);
+}
+
+// 找 count 个起始槽为 home 的对端（端口从 next_port 起递增搜索）
+std::vector<sockaddr_in> peersWithHome(size_t home, size_t capacity,
+                                       size_t count, uint16_t& next_port) {
+    std::vector<sockaddr_in> peers;
+    while (peers.size() < count) {
+        sockaddr_in peer = makePeer(0x7F000001, next_port++);
+        if (homeOf(peer, capacity) == home) peers.push_back(peer);
+    }
+    return peers;
+}
+
+}  // namespace
+
+/*
+探测链跨过表尾回绕：起始槽为 capacity-2 / capacity-1 / 0 的对端依次占据
+capacity-2, capacity-1, 0, 1, 2 ...；对每一种"哪些会话空闲"的组合做一次淘汰，
+反向移位会把链上的元素从表头移回表尾，之后剩余会话必须都还能查到
+*/
+TEST(UdpSessionTableTest, LookupAfterEvictingWrappedChains) {
+    UdpSessionTable probe(8);
+    const size_t capacity = probe.capacity();
+    ASSERT_EQ(capacity, 16u);
+
+    uint16_t port = 1;
+    std::vector<sockaddr_in> peers;
+    for (sockaddr_in peer : peersWithHome(capacity - 1, capacity, 3, port)) {
+        peers.push_back(peer);
+    }
+    peers.push_back(peersWithHome(capacity - 2, capacity, 1, port)[0]);
+    for (sockaddr_in peer : peersWithHome(0, capacity, 2, port)) {
+        peers.push_back(peer);
+    }
+    peers.push_back(peersWithHome(1, capacity, 1, port)[0]);
+    ASSERT_LE(peers.size(), probe.maxSessions());
+
+    for (uint32_t idle_mask = 0; idle_mask < (1u << peers.size());
+         ++idle_mask) {
+        UdpSessionTable table(8);
+        bool created = false;
+        for (const sockaddr_in& peer : peers) {
+            ASSERT_NE(table.findOrCreate(peer, 0, created), nullptr);
+            ASSERT_TRUE(created);
+        }
+        size_t idle = 0;
+        for (size_t i = 0; i < peers.size(); ++i) {
+            if (idle_mask & (1u << i)) {
+                ++idle;
+            } else {
+                table.find(peers[i])->last_active_ms = 1000;
+            }
+        }
+
+        EXPECT_EQ(table.evictIdle(1000, 500), idle) << "mask " << idle_mask;
+        EXPECT_EQ(table.size(), peers.size() - idle);
+        for (size_t i = 0; i < peers.size(); ++i) {
+            UdpSession* session = table.find(peers[i]);
+            if (idle_mask & (1u << i)) {
+                EXPECT_EQ(session, nullptr) << "mask " << idle_mask;
+                continue;
+            }
+            ASSERT_NE(session, nullptr) << "mask " << idle_mask << " peer " << i;
+            EXPECT_EQ(session->key, UdpSessionTable::keyOf(peers[i]));
+            EXPECT_EQ(table.findOrCreate(peers[i], 2000, created), session);
+            EXPECT_FALSE(created);
+        }
+    }
+}
+
+// 随机的建立 / 活跃 / 淘汰序列，与参考实现对照
+TEST(UdpSessionTableTest, MatchesReferenceUnderChurn) {
+    constexpr size_t kMaxSessions = 12;
+    UdpSessionTable table(kMaxSessions);
+    std::unordered_map<uint64_t, int64_t> reference;  // key -> last_active_ms
+    std::mt19937 rng(12345);
+    std::uniform_int_distribution<uint16_t> port_dist(1, 40);
+
+    for (int64_t now = 1; now <= 20000; ++now) {
+        sockaddr_in peer = makePeer(0x0A000001, port_dist(rng));
+        uint64_t key = UdpSessionTable::keyOf(peer);
+        bool created = false;
+        UdpSession* session = table.findOrCreate(peer, now, created);
+        bool known = reference.count(key) > 0;
+        if (known || reference.size() < kMaxSessions) {
+            ASSERT_NE(session, nullptr);
+            EXPECT_EQ(created, !known);
+            session->last_active_ms = now;
+            reference[key] = now;
+        } else {
+            EXPECT_EQ(session, nullptr);
+        }
+
+        if (now % 7 == 0) {
+            const int64_t idle_ms = 20;
+            size_t expected = 0;
+            for (auto it = reference.begin(); it != reference.end();) {
+                if (it->second <= now - idle_ms) {
+                    it = reference.erase(it);
+                    ++expected;
+                } else {
+                    ++it;
+                }
+            }
+            ASSERT_EQ(table.evictIdle(now, idle_ms), expected);
+        }
+
+        ASSERT_EQ(table.size(), reference.size());
+        for (uint16_t p = 1; p <= 40; ++p) {
+            sockaddr_in other = makePeer(0x0A000001, p);
+            auto it = reference.find(UdpSessionTable::keyOf(other));
+            UdpSession* found = table.find(other);
+            if (it == reference.end()) {
+                ASSERT_EQ(found, nullptr) << "port " << p;
+            } else {
+                ASSERT_NE(found, nullptr) << "port " << p;
+                EXPECT_EQ(found->last_active_ms, it->second);
+            }
+        }
+    }
+}